@@ -8,10 +8,14 @@
 #include "src/SystemSettings.h"
 #include "src/HAL/SimulatedVehicleHAL.h"
 #include "src/HAL/SimulatedAudioHAL.h"
+#include "src/HAL/SimulatedRadioHAL.h"
+#include "src/HAL/SdrRadioHAL.h"
 #include "src/VehicleService.h"
 #include "src/MediaService.h"
+#include "src/Audio/AudioFocusManager.h"
 #include "src/NavigationService.h"
 #include "src/PhoneService.h"
+#include "src/TileService.h"
 #include "src/AppModel.h"
 
 #include "src/LayoutService.h"
@@ -33,6 +37,7 @@ int main(int argc, char *argv[])
     // Create Threads
     QThread *vehicleThread = new QThread();
     QThread *audioThread = new QThread();
+    QThread *radioThread = new QThread();
     
     // 1. Vehicle HAL
     // Create without parent so we can move to thread
@@ -51,6 +56,14 @@ int main(int argc, char *argv[])
     QObject::connect(audioThread, &QThread::finished, audioHal, &QObject::deleteLater);
     audioThread->start();
 
+    // 3. Radio HAL (seek/scan run here, off the GUI thread)
+    // An IQ capture in NORDIC_SDR_IQ selects the software demodulator
+    IRadioHAL *radioHal = SdrRadioHAL::isConfigured() ? static_cast<IRadioHAL *>(new SdrRadioHAL(nullptr))
+                                                      : new SimulatedRadioHAL(nullptr);
+    radioHal->moveToThread(radioThread);
+    QObject::connect(radioThread, &QThread::finished, radioHal, &QObject::deleteLater);
+    radioThread->start();
+
     // -------------------------------------------------------------------------
     // Application Services (Dependency Injection)
     // -------------------------------------------------------------------------
@@ -62,9 +75,32 @@ int main(int argc, char *argv[])
     // Business Logic Services
     // VehicleService depends on VehicleHAL
     VehicleService *vehicleService = new VehicleService(vehicleHal, &app);
-    MediaService *media = new MediaService(&app);
+    // MediaService's RadioTuner depends on RadioHAL
+    MediaService *media = new MediaService(radioHal, &app);
     NavigationService *nav = new NavigationService(&app);
     PhoneService *phone = new PhoneService(&app);
+
+    // Audio focus arbiter + output mixer (media, guidance prompts, voice)
+    AudioFocusManager *audioFocus = new AudioFocusManager(&app);
+    audioFocus->mixer()->start();
+    media->setAudioFocus(audioFocus);
+    QObject::connect(phone, &PhoneService::callStateChanged, audioFocus, [phone, audioFocus]() {
+        audioFocus->setCallActive(phone->callState() != "Idle");
+    });
+    // Prompts come ahead of their point by the time the mixer takes to play them
+    nav->setPromptLatency(AudioFocusManager::PromptLatencyMs);
+    QObject::connect(nav, &NavigationService::voiceInstruction, audioFocus, [audioFocus](const QString &text) {
+        // The spoken prompt if one was prepared under its text, else the chime
+        audioFocus->playNavigationPrompt(audioFocus->hasPrompt(text) ? text : QString());
+    });
+    // Offline map tiles: the map's tile source, prefetched along each route
+    TileService *tiles = new TileService(settings, &app);
+    QObject::connect(nav, &NavigationService::routeCalculated, tiles, [nav, tiles]() {
+        tiles->prefetchRoute(nav->routePath());
+    });
+    QObject::connect(nav, &NavigationService::navigationStateChanged, tiles, [nav, tiles]() {
+        if (!nav->isNavigating()) tiles->cancelPrefetch();
+    });
     // Layout Service (Responsive Design)
     // Layout Service (Responsive Design)
     LayoutService *layoutService = new LayoutService(&app);
@@ -79,6 +115,8 @@ int main(int argc, char *argv[])
     qmlRegisterSingletonInstance("NordicHeadunit", 1, 0, "MediaService", media);
     qmlRegisterSingletonInstance("NordicHeadunit", 1, 0, "NavigationService", nav);
     qmlRegisterSingletonInstance("NordicHeadunit", 1, 0, "PhoneService", phone);
+    qmlRegisterSingletonInstance("NordicHeadunit", 1, 0, "AudioFocus", audioFocus);
+    qmlRegisterSingletonInstance("NordicHeadunit", 1, 0, "TileService", tiles);
 
     qmlRegisterSingletonInstance("NordicHeadunit", 1, 0, "LayoutService", layoutService);
     qmlRegisterSingletonInstance("NordicHeadunit", 1, 0, "TranslationService", translationService);
@@ -15,20 +15,21 @@ Item {
     property real bearing: 0.0
     property geoCoordinate center: QtPositioning.coordinate(59.3293, 18.0686)
     property geoCoordinate userLocation: center // Alias removed due to Loader scoping
-    property var routePath: [] // Coordinates for polyline
+    property bool showRoute: false // Current route from NavigationService
     property bool showTraffic: false
     property bool showRange: false // EV Range Ring
 
-    // Style Logic
+    // Vehicle pose at display rate. NavigationService publishes where the
+    // vehicle will be over the next second or so as timestamped keyframes,
+    // about once a second; only the marker follows them frame by frame
+    property var vehicleKeyframes: NavigationService.vehicleMotion
+    property geoCoordinate vehicleCoordinate: QtPositioning.coordinate(59.3293, 18.0686)
+    property real vehicleHeading: 0.0
+
+    // Style Logic. Tiles come through TileService, which keeps them on the
+    // flash and fetches the route's ahead of time
     property int mapStyle: SystemSettings.mapStyle
-    property string tileUrl: {
-        switch(mapStyle) {
-            case 1: return "https://a.basemaps.cartocdn.com/dark_all/" // Dark
-            case 2: return "https://server.arcgisonline.com/ArcGIS/rest/services/World_Imagery/MapServer/tile/" // Satellite
-            case 3: return "https://a.basemaps.cartocdn.com/light_all/" // Hybrid/Light placeholder
-            default: return "https://tile.openstreetmap.org/" // Standard
-        }
-    }
+    property string tileUrl: TileService.tileHost
 
     // NOTE: Plugin is now defined INSIDE mapComponent for dynamic tileUrl binding
 
@@ -67,6 +68,47 @@ Item {
         return points
     }
 
+    function updateVehiclePose() {
+        var frames = vehicleKeyframes
+        if (frames.length === 0) {
+            vehicleCoordinate = NavigationService.vehiclePosition
+            vehicleHeading = NavigationService.vehicleBearing
+            return
+        }
+        // Between the keyframes either side of now, held at either end
+        var now = Date.now()
+        var i = 0
+        while (i + 1 < frames.length && frames[i + 1].time <= now) ++i
+        var a = frames[i], b = frames[Math.min(i + 1, frames.length - 1)]
+        var f = b.time > a.time ? Math.min(Math.max((now - a.time) / (b.time - a.time), 0), 1) : 0
+        vehicleCoordinate = QtPositioning.coordinate(a.latitude + f * (b.latitude - a.latitude),
+                                                     a.longitude + f * (b.longitude - a.longitude))
+        var turn = ((b.bearing - a.bearing) % 360 + 540) % 360 - 180
+        vehicleHeading = (a.bearing + f * turn + 360) % 360
+    }
+
+    // Frames only while the pose still moves: up to the last keyframe
+    function animatingVehicle() {
+        var frames = vehicleKeyframes
+        return frames.length > 1 && Date.now() < frames[frames.length - 1].time
+    }
+
+    function restartVehicleAnimation() {
+        updateVehiclePose()
+        vehicleAnimation.running = animatingVehicle()
+    }
+
+    onVehicleKeyframesChanged: restartVehicleAnimation()
+    Component.onCompleted: restartVehicleAnimation()
+
+    FrameAnimation {
+        id: vehicleAnimation
+        onTriggered: {
+            root.updateVehiclePose()
+            if (!root.animatingVehicle()) stop()
+        }
+    }
+
     // -------------------------------------------------------------------------
     // Map Engine Loader
     // -------------------------------------------------------------------------
@@ -89,7 +131,11 @@ Item {
                 PluginParameter { name: "osm.mapping.custom.host"; value: root.tileUrl }
                 PluginParameter { name: "osm.mapping.providersrepository.disabled"; value: "true" }
                 PluginParameter { name: "osm.mapping.providersrepository.address"; value: "http://maps-redirect.qt.io/osm/5.6/" }
+                // TileService is the disk cache
+                PluginParameter { name: "osm.mapping.cache.disk.size"; value: "0" }
             }
+            // The custom host's map type comes last
+            activeMapType: supportedMapTypes[supportedMapTypes.length - 1]
             
             onCopyrightLinkActivated: Qt.openUrlExternally(link)
             
@@ -111,36 +157,88 @@ Item {
             
             property geoCoordinate userLocation: root.center
 
+            // Route drawn at the detail of the zoom level and cut to an area
+            // three views wide around the visible region, so the polylines
+            // only change when the zoom level or that area does
+            property var routeLines: []
+            property var trafficLines: []
+            property int routeLevel: -1
+            property var routeArea: QtPositioning.rectangle()
+
+            function updateRoute(force) {
+                if (!root.showRoute) {
+                    routeLines = []
+                    trafficLines = []
+                    routeLevel = -1
+                    return
+                }
+                var view = visibleRegion.boundingGeoRectangle()
+                var level = Math.ceil(zoomLevel)
+                if (!force && level === routeLevel && routeArea.contains(view.topLeft) && routeArea.contains(view.bottomRight)) return
+                routeLevel = level
+                routeArea = QtPositioning.rectangle(view.center, Math.min(view.width * 3, 360), Math.min(view.height * 3, 170))
+                routeLines = NavigationService.routeLines(level, routeArea)
+                trafficLines = root.showTraffic ? NavigationService.trafficLines(level, routeArea) : []
+            }
+
+            onZoomLevelChanged: updateRoute(false)
+            onVisibleRegionChanged: updateRoute(false)
+            Component.onCompleted: updateRoute(true)
+
+            // A new route comes with its traffic and state in one go:
+            // redrawn once, after the last of them
+            Connections {
+                target: NavigationService
+                function onRouteCalculated() { Qt.callLater(mapContent.updateRoute, true) }
+                function onNavigationStateChanged() { Qt.callLater(mapContent.updateRoute, true) }
+                function onTrafficChanged() { Qt.callLater(mapContent.updateRoute, true) }
+            }
+            Connections {
+                target: root
+                function onShowRouteChanged() { Qt.callLater(mapContent.updateRoute, true) }
+                function onShowTrafficChanged() { Qt.callLater(mapContent.updateRoute, true) }
+            }
+
             // Route Line (Shadow Layer - for visibility on busy tiles)
-            MapPolyline {
-                id: routeShadow
-                line.width: 18
-                line.color: "#000000"
-                opacity: 0.4
-                path: root.routePath
+            MapItemView {
+                model: mapContent.routeLines
+                delegate: MapPolyline {
+                    z: 1
+                    line.width: 18
+                    line.color: "#000000"
+                    opacity: 0.4
+                    path: modelData
+                }
             }
             
             // Route Line (Outline Layer - Dark Accent)
-            MapPolyline {
-                id: routeOutline
-                line.width: 14
-                line.color: Qt.darker(Theme.accent, 1.6)
-                path: root.routePath
+            MapItemView {
+                model: mapContent.routeLines
+                delegate: MapPolyline {
+                    z: 2
+                    line.width: 14
+                    line.color: Qt.darker(Theme.accent, 1.6)
+                    path: modelData
+                }
             }
             
             // Route Line (Fill Layer - Accent)
-            MapPolyline {
-                id: routeLine
-                line.width: 10
-                line.color: Theme.accent
-                path: root.routePath
+            MapItemView {
+                model: mapContent.routeLines
+                delegate: MapPolyline {
+                    z: 3
+                    line.width: 10
+                    line.color: Theme.accent
+                    path: modelData
+                }
             }
 
             // Traffic Segments Overlay (Premium Traffic Flow)
             MapItemView {
-                model: NavigationService.trafficSegments
+                model: mapContent.trafficLines
                 visible: root.showTraffic
                 delegate: MapPolyline {
+                    z: 4
                     line.width: 10
                     line.color: modelData.color
                     path: modelData.path
@@ -161,7 +259,7 @@ Item {
             // GPS Accuracy Circle (Breathable Animation)
             MapCircle {
                 id: accuracyCircle
-                center: NavigationService.vehiclePosition
+                center: root.vehicleCoordinate
                 radius: 50 // Meters - would be dynamic from GPS accuracy
                 color: Qt.rgba(Theme.accent.r, Theme.accent.g, Theme.accent.b, 0.1)
                 border.color: Qt.rgba(Theme.accent.r, Theme.accent.g, Theme.accent.b, 0.3)
@@ -178,7 +276,7 @@ Item {
             // Vehicle Cursor (3D Puck)
             MapQuickItem {
                 id: vehicleCursor
-                coordinate: NavigationService.vehiclePosition
+                coordinate: root.vehicleCoordinate
                 anchorPoint.x: carContainer.width / 2
                 anchorPoint.y: carContainer.height / 2
 
@@ -186,9 +284,7 @@ Item {
                     id: carContainer
                     width: 80; height: 80
                     
-                    rotation: NavigationService.vehicleBearing - mapContent.bearing
-                    
-                    Behavior on rotation { RotationAnimation { duration: 150; direction: RotationAnimation.Shortest } }
+                    rotation: root.vehicleHeading - mapContent.bearing
 
                     // Glow
                     Rectangle {
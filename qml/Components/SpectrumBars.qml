@@ -0,0 +1,51 @@
+import QtQuick
+import NordicHeadunit
+
+// Spectrum Bars - renders MediaService.spectrum.bands
+// Registers as a viewer only while effectively visible, so the analyzer
+// thread and PCM tap are shut down whenever no visualizer is on screen.
+
+Item {
+    id: root
+
+    property color barColor: "white"
+    property real barSpacing: NordicTheme.spacing.space_1
+    property real minBarHeight: 4
+
+    readonly property var analyzer: MediaService?.spectrum ?? null
+    readonly property var bands: analyzer?.bands ?? []
+    readonly property int barCount: analyzer?.bandCount ?? 0
+
+    property bool _registered: false
+
+    function _syncViewer() {
+        if (!analyzer) return
+        if (visible && !_registered) {
+            analyzer.addViewer()
+            _registered = true
+        } else if (!visible && _registered) {
+            analyzer.removeViewer()
+            _registered = false
+        }
+    }
+
+    onVisibleChanged: _syncViewer()
+    Component.onCompleted: _syncViewer()
+    Component.onDestruction: if (_registered) analyzer.removeViewer()
+
+    Row {
+        anchors.fill: parent
+        spacing: root.barSpacing
+
+        Repeater {
+            model: root.barCount
+            Rectangle {
+                width: Math.max(1, (root.width - root.barSpacing * (root.barCount - 1)) / Math.max(1, root.barCount))
+                height: Math.max(root.minBarHeight, root.height * (root.bands[index] ?? 0))
+                anchors.verticalCenter: parent.verticalCenter
+                radius: width / 2
+                color: root.barColor
+            }
+        }
+    }
+}
@@ -14,7 +14,6 @@ Item {
     // Bottom Bar Control (unified bar)
     property alias showBottomBar: bottomBar.visible
     property alias currentTab: bottomBar.currentIndex
-    property var audioPolicy: null
     
     // Legacy alias for backwards compatibility
     property alias showDockBar: bottomBar.visible
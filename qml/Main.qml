@@ -18,9 +18,6 @@ ApplicationWindow {
         id: appLayout
         anchors.fill: parent
         
-        // Inject Services
-        audioPolicy: audioPolicy
-        
         onSettingsRequested: {
             overlayManager.toggleControlCenter()
         }
@@ -117,8 +114,8 @@ ApplicationWindow {
         // Connect Signals
         onOpenSettings: appLayout.currentTab = 6 // Switch to Settings Tab
         
-        // Bind Voice State to Audio Policy
-        onIsVoiceVisibleChanged: audioPolicy.voiceAssistantActive = isVoiceVisible
+        // Voice assistant takes audio focus while visible
+        onIsVoiceVisibleChanged: AudioFocus.setVoiceActive(isVoiceVisible)
         
         // Link History
         notificationModel: toastManager.model
@@ -132,9 +129,6 @@ ApplicationWindow {
         // Let's keep Toast high for now.
     }
     
-    // Services
-    AudioPolicy { id: audioPolicy }
-    
     // Hardware Keys
     Item {
         focus: true
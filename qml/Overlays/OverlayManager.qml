@@ -1,5 +1,5 @@
 import QtQuick
-import "qrc:/qt/qml/NordicHeadunit/qml/Services" // For AudioPolicy if needed, or pass in
+import "qrc:/qt/qml/NordicHeadunit/qml/Services" // Service singletons
 // Actually we import services in Main, so they are available via injection or id execution if passed.
 // We will use signals/functions to control them.
 
@@ -73,7 +73,7 @@ Page {
         // If HeadingUp AND Active, follow car. Else 0 (North Up).
         bearing: {
             if (navState === MapPage.NavState.Active && SystemSettings.mapOrientation === 1) 
-                return NavigationService.vehicleBearing
+                return mapSurface.vehicleHeading
             return 0.0
         }
     }
@@ -162,7 +162,7 @@ Page {
         
         onResultSelected: (result) => {
             navState = MapPage.NavState.Preview
-            mapSurface.routePath = []
+            mapSurface.showRoute = false
             // Fix: Construct coordinate from raw lat/lon properties
             var destCoord = QtPositioning.coordinate(result.lat, result.lon)
             NavigationService.calculateRoute(mapSurface.userLocation, destCoord)
@@ -198,7 +198,7 @@ Page {
         onCancelClicked: {
             NavigationService.stopNavigation() // Clear route line
             navState = MapPage.NavState.Idle
-            mapSurface.routePath = [] // Clear line
+            mapSurface.showRoute = false // Clear line
         }
     }
     
@@ -227,7 +227,7 @@ Page {
         }
         
         function onRouteCalculated(routeData) {
-             mapSurface.routePath = routeData.path
+             mapSurface.showRoute = true
              var distKm = (routeData.distance / 1000).toFixed(1) + " km"
              var timeMin = Math.round(routeData.duration / 60) + " min"
              root.selectedRoute = { time: timeMin, dist: distKm }
@@ -63,11 +63,8 @@ Item {
     // -------------------------------------------------------------------------
     readonly property real vizBarWidthRatio: 0.04
     readonly property real vizBarHeightRatio: 0.15
-    readonly property real vizAnimMinHeightRatio: 0.08
-    readonly property real vizAnimMaxHeightRatio: 0.1
-    readonly property real vizAnimStepRatio: 0.04
-    readonly property int vizAnimBaseDuration: 300
-    readonly property int vizAnimStepDuration: 80
+    readonly property real vizWidthRatio: 0.6
+    readonly property real vizHeightRatio: 0.3
     
     // Note: Background blur is handled by MediaPage parent - no duplicate needed
     
@@ -221,35 +218,13 @@ Item {
                         }
                     }
                     
-                    // Visualizer (respects reducedMotion)
-                    Row {
+                    // Visualizer (respects reducedMotion) - live spectrum from MediaService
+                    SpectrumBars {
                         anchors.centerIn: parent
-                        spacing: NordicTheme.spacing.space_1
+                        width: root.artSize * root.vizWidthRatio
+                        height: root.artSize * root.vizHeightRatio
+                        barSpacing: NordicTheme.spacing.space_1 / 2
                         visible: root.isPlaying && !root.isRadioMode && !root.reducedMotion
-                        Repeater {
-                            model: 5
-                            Rectangle {
-                                width: Math.max(6, root.artSize * root.vizBarWidthRatio)
-                                height: root.artSize * root.vizBarHeightRatio
-                                radius: width / 2
-                                color: "white"
-                                anchors.verticalCenter: parent.verticalCenter
-                                SequentialAnimation on height {
-                                    loops: Animation.Infinite
-                                    running: parent.visible
-                                    NumberAnimation { 
-                                        to: root.artSize * root.vizAnimMaxHeightRatio + (index + 1) * root.artSize * root.vizAnimStepRatio
-                                        duration: root.vizAnimBaseDuration + index * root.vizAnimStepDuration
-                                        easing.type: Easing.InOutSine
-                                    }
-                                    NumberAnimation { 
-                                        to: root.artSize * root.vizAnimMinHeightRatio + index * (root.artSize * 0.03)
-                                        duration: (root.vizAnimBaseDuration + 100) + index * (root.vizAnimStepDuration - 20)
-                                        easing.type: Easing.InOutSine
-                                    }
-                                }
-                            }
-                        }
                     }
                     
                     // Static visualizer bars (shown when reducedMotion is on)
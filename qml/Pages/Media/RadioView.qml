@@ -17,6 +17,7 @@ Item {
     readonly property int currentRadioIndex: MediaService?.currentRadioIndex ?? 0
     readonly property bool playing: MediaService?.playing ?? false
     readonly property int signalStrength: MediaService?.radioTuner?.signalStrength ?? 75
+    readonly property string radioText: MediaService?.radioTuner?.radioText ?? ""
     readonly property bool hasError: MediaService?.radioTuner?.hasError ?? false
     readonly property string errorMessage: MediaService?.radioTuner?.errorMessage ?? ""
     
@@ -124,6 +125,17 @@ Item {
                             type: NordicText.Type.BodyLarge
                             color: Theme.textSecondary
                         }
+
+                        // RDS RadioText
+                        NordicText {
+                            anchors.horizontalCenter: parent.horizontalCenter
+                            visible: root.radioText.length > 0
+                            text: root.radioText
+                            type: NordicText.Type.BodySmall
+                            color: Theme.textSecondary
+                            elide: Text.ElideRight
+                            width: Math.min(implicitWidth, 360)
+                        }
                         
                         // Signal Strength Indicator
                         Row {
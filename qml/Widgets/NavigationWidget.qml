@@ -12,6 +12,7 @@ Item {
     // Safe NavigationService bindings with fallbacks
     readonly property bool isNavigating: NavigationService?.isNavigating ?? false
     readonly property string distanceToDestination: NavigationService?.distanceToDestination ?? ""
+    readonly property string arrivalTime: NavigationService?.arrivalTime ?? ""
     
     // Grid Spans (Injected by DraggableWidget)
     property int spanX: 1
@@ -73,7 +74,7 @@ Item {
             }
             
             NordicText { 
-                text: root.isNavigating ? root.distanceToDestination : qsTr("Tap to navigate")
+                text: root.isNavigating ? root.distanceToDestination + " · " + root.arrivalTime : qsTr("Tap to navigate")
                 type: NordicText.Type.BodyMedium
                 color: NordicTheme.colors.text.secondary
                 Layout.alignment: Qt.AlignHCenter
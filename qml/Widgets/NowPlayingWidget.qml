@@ -63,6 +63,18 @@ Item {
                         source: "qrc:/qt/qml/NordicHeadunit/assets/icons/music.svg"
                         color: NordicTheme.colors.text.inverse
                         size: root.isCompact ? NordicIcon.Size.SM : NordicIcon.Size.MD
+                        visible: !spectrum.visible
+                    }
+                    
+                    // Live spectrum (hidden in compact mode to keep the tile quiet)
+                    SpectrumBars {
+                        id: spectrum
+                        anchors.fill: parent
+                        anchors.margins: parent.width * 0.15
+                        barSpacing: 1
+                        minBarHeight: 2
+                        barColor: NordicTheme.colors.text.inverse
+                        visible: root.isPlaying && !root.isCompact && !(MediaService?.isRadioMode ?? false)
                     }
                 }
                 
@@ -0,0 +1,164 @@
+#include "AudioFocusManager.h"
+#include <QDebug>
+#include <cmath>
+
+namespace {
+const QString kChimeKey = QStringLiteral("chime");
+
+struct FocusGains {
+    float media, voice, navigation;
+};
+
+// Gain of each channel while `top` holds focus. Calls keep guidance
+// audible but soft; everything else simply ducks what ranks below it.
+FocusGains gainsFor(AudioFocusManager::Stream top) {
+    switch (top) {
+    case AudioFocusManager::Call:       return {0.0f, 0.0f, 0.5f};
+    case AudioFocusManager::Navigation: return {0.3f, 0.3f, 1.0f};
+    case AudioFocusManager::Voice:      return {0.3f, 1.0f, 1.0f};
+    case AudioFocusManager::Media:      break;
+    }
+    return {1.0f, 1.0f, 1.0f};
+}
+}
+
+AudioFocusManager::AudioFocusManager(QObject *parent)
+    : QObject(parent),
+      m_mixer(new AudioMixer(this))
+{
+    connect(m_mixer, &AudioMixer::clipFinished, this, &AudioFocusManager::onClipFinished);
+    buildChime();
+}
+
+// =============================================================================
+// ARBITRATION
+// =============================================================================
+
+void AudioFocusManager::request(Stream stream) {
+    if (isActive(stream)) return;
+    m_active |= (1u << stream);
+    applyPolicy();
+}
+
+void AudioFocusManager::abandon(Stream stream) {
+    if (!isActive(stream)) return;
+    m_active &= ~(1u << stream);
+    applyPolicy();
+}
+
+void AudioFocusManager::setVoiceActive(bool active) {
+    if (active) request(Voice);
+    else abandon(Voice);
+}
+
+void AudioFocusManager::setCallActive(bool active) {
+    if (active) request(Call);
+    else abandon(Call);
+}
+
+AudioFocusManager::Stream AudioFocusManager::topStream() const {
+    for (int s = Call; s > Media; --s)
+        if (m_active & (1u << s)) return Stream(s);
+    return Media;
+}
+
+QString AudioFocusManager::focusState() const {
+    if (isActive(Call)) return "call";
+    if (isActive(Navigation)) return "navigation";
+    if (isActive(Voice)) return "voice";
+    if (isActive(Media)) return "media";
+    return "idle";
+}
+
+void AudioFocusManager::applyPolicy() {
+    const FocusGains gains = gainsFor(topStream());
+    const float targets[AudioMixer::ChannelCount] = {gains.media, gains.voice, gains.navigation, 1.0f};
+
+    for (int channel = 0; channel < AudioMixer::ChannelCount; ++channel) {
+        const float target = targets[channel];
+        if (m_appliedGain[channel] == target) continue;
+        // Duck fast so the prompt is clear, release slowly so it sounds natural
+        const int rampMs = target < m_appliedGain[channel] ? DuckRampMs : RestoreRampMs;
+        m_mixer->setChannelGain(AudioMixer::Channel(channel), target, rampMs);
+        m_appliedGain[channel] = target;
+        if (channel == AudioMixer::Media) {
+            m_mediaGain = target;
+            emit mediaGainChanged(m_mediaGain, rampMs);
+        }
+    }
+    emit focusChanged();
+}
+
+// =============================================================================
+// PROMPTS
+// =============================================================================
+
+void AudioFocusManager::preparePrompt(const QString &key, const float *stereo, int frames, int sampleRate) {
+    if (frames <= 0 || sampleRate <= 0) return;
+    auto clip = std::make_shared<PcmClip>();
+    if (sampleRate == AudioMixer::SampleRate) {
+        clip->samples.assign(stereo, stereo + size_t(frames) * 2);
+    } else {
+        // Prompts are short; linear interpolation is plenty for speech
+        const double step = double(sampleRate) / AudioMixer::SampleRate;
+        const int outFrames = int(frames / step);
+        clip->samples.resize(size_t(outFrames) * 2);
+        for (int i = 0; i < outFrames; ++i) {
+            const double pos = i * step;
+            const int i0 = qMin(int(pos), frames - 1);
+            const int i1 = qMin(i0 + 1, frames - 1);
+            const float t = float(pos - i0);
+            for (int c = 0; c < 2; ++c)
+                clip->samples[size_t(i) * 2 + c] = stereo[i0 * 2 + c] + (stereo[i1 * 2 + c] - stereo[i0 * 2 + c]) * t;
+        }
+    }
+    m_prompts.insert(key, clip);
+}
+
+bool AudioFocusManager::playNavigationPrompt(const QString &key) {
+    const PcmClipPtr clip = m_prompts.value(key.isEmpty() ? kChimeKey : key);
+    if (!clip) {
+        qWarning() << "Navigation prompt not prepared:" << key;
+        return false;
+    }
+    // Duck and prompt are queued together; the prompt starts as the ramp ends
+    request(Navigation);
+    m_promptId = m_mixer->playClip(AudioMixer::Navigation, clip.get(), DuckRampMs);
+    // Held until its finish, as preparePrompt() may replace it in the cache meanwhile
+    m_inFlight.insert(m_promptId, clip);
+    if (!m_promptPlaying) {
+        m_promptPlaying = true;
+        emit promptPlayingChanged();
+    }
+    return true;
+}
+
+void AudioFocusManager::onClipFinished(AudioMixer::Channel channel, quint32 id) {
+    if (channel != AudioMixer::Navigation) return;
+    m_inFlight.remove(id);
+    // A prompt replaced before its finish came through: the new one plays on
+    if (id != m_promptId) return;
+    abandon(Navigation);
+    if (m_promptPlaying) {
+        m_promptPlaying = false;
+        emit promptPlayingChanged();
+    }
+}
+
+void AudioFocusManager::buildChime() {
+    // Two-tone guidance chime until spoken prompts are supplied via preparePrompt()
+    constexpr int toneFrames = AudioMixer::SampleRate * 120 / 1000;
+    constexpr int fadeFrames = AudioMixer::SampleRate * 10 / 1000;
+    std::vector<float> pcm(size_t(toneFrames) * 2 * 2);
+    const double freqs[2] = {880.0, 1320.0};
+    for (int tone = 0; tone < 2; ++tone) {
+        for (int i = 0; i < toneFrames; ++i) {
+            const float fade = float(qMin(1.0, qMin(i, toneFrames - 1 - i) / double(fadeFrames)));
+            const float v = 0.35f * fade * float(std::sin(2.0 * M_PI * freqs[tone] * i / AudioMixer::SampleRate));
+            const size_t frame = size_t(tone * toneFrames + i);
+            pcm[frame * 2] = v;
+            pcm[frame * 2 + 1] = v;
+        }
+    }
+    preparePrompt(kChimeKey, pcm.data(), toneFrames * 2, AudioMixer::SampleRate);
+}
@@ -0,0 +1,80 @@
+#ifndef AUDIOFOCUSMANAGER_H
+#define AUDIOFOCUSMANAGER_H
+
+#include <QObject>
+#include <QHash>
+#include <QString>
+#include "AudioMixer.h"
+
+/**
+ * @brief Audio focus arbiter: call > navigation prompt > voice > media.
+ *
+ * Streams request and abandon focus; the highest active stream decides the
+ * gain of every other channel, and the gains are applied as per-sample
+ * ramps inside AudioMixer. Navigation prompts are decoded into the prompt
+ * cache up front, so playing one is a pointer handoff: the media duck and
+ * the prompt start are scheduled in the same mixer block, the prompt
+ * beginning exactly when the duck ramp completes.
+ */
+class AudioFocusManager : public QObject
+{
+    Q_OBJECT
+    Q_PROPERTY(QString focusState READ focusState NOTIFY focusChanged)
+    Q_PROPERTY(double mediaGain READ mediaGain NOTIFY focusChanged)
+    Q_PROPERTY(bool promptPlaying READ promptPlaying NOTIFY promptPlayingChanged)
+
+public:
+    // Ascending priority
+    enum Stream { Media, Voice, Navigation, Call };
+    Q_ENUM(Stream)
+
+    static constexpr int DuckRampMs = 20;
+    static constexpr int RestoreRampMs = 300;
+    // From playNavigationPrompt() to the prompt being heard
+    static constexpr int PromptLatencyMs = DuckRampMs + AudioMixer::SinkBufferMs;
+
+    explicit AudioFocusManager(QObject *parent = nullptr);
+
+    AudioMixer *mixer() const { return m_mixer; }
+
+    Q_INVOKABLE void request(Stream stream);
+    Q_INVOKABLE void abandon(Stream stream);
+    Q_INVOKABLE void setVoiceActive(bool active);
+    void setCallActive(bool active);
+
+    // Prompt cache. Clips are converted to the mixer format once, here.
+    void preparePrompt(const QString &key, const float *stereo, int frames, int sampleRate);
+    bool hasPrompt(const QString &key) const { return m_prompts.contains(key); }
+
+    // Plays a cached prompt on the navigation channel (empty key: guidance chime)
+    Q_INVOKABLE bool playNavigationPrompt(const QString &key = QString());
+
+    QString focusState() const;
+    double mediaGain() const { return m_mediaGain; }
+    bool promptPlaying() const { return m_promptPlaying; }
+    bool isActive(Stream stream) const { return m_active & (1u << stream); }
+
+signals:
+    void focusChanged();
+    void mediaGainChanged(double gain, int rampMs);
+    void promptPlayingChanged();
+
+private slots:
+    void onClipFinished(AudioMixer::Channel channel, quint32 id);
+
+private:
+    Stream topStream() const;
+    void applyPolicy();
+    void buildChime();
+
+    AudioMixer *m_mixer;
+    QHash<QString, PcmClipPtr> m_prompts;
+    QHash<quint32, PcmClipPtr> m_inFlight; // by clip id, alive until the mixer lets go of them
+    quint32 m_promptId = 0;                // the mixer's id of the latest prompt
+    quint32 m_active = 0;
+    double m_mediaGain = 1.0;
+    bool m_promptPlaying = false;
+    float m_appliedGain[AudioMixer::ChannelCount] = {1.0f, 1.0f, 1.0f, 1.0f};
+};
+
+#endif // AUDIOFOCUSMANAGER_H
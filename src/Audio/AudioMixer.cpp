@@ -0,0 +1,201 @@
+#include "AudioMixer.h"
+#include "StreamPlaybackDevice.h"
+#include <QtMultimedia/QAudioSink>
+#include <QtMultimedia/QMediaDevices>
+#include <QDebug>
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+namespace {
+constexpr int kBlockFrames = 256; // bytesAvailable() granularity
+}
+
+// =============================================================================
+// DEVICE (audio pull thread)
+// =============================================================================
+
+AudioMixerDevice::AudioMixerDevice(AudioMixer *mixer, QObject *parent)
+    : QIODevice(parent),
+      m_mixer(mixer)
+{
+}
+
+qint64 AudioMixerDevice::bytesAvailable() const {
+    // Always-on output: silence when nothing plays
+    return qint64(kBlockFrames * AudioMixer::Channels * sizeof(qint16)) + QIODevice::bytesAvailable();
+}
+
+qint64 AudioMixerDevice::writeData(const char *, qint64) {
+    return -1;
+}
+
+qint64 AudioMixerDevice::readData(char *data, qint64 maxlen) {
+    const qint64 bytesPerFrame = AudioMixer::Channels * qint64(sizeof(qint16));
+    const int frames = int(maxlen / bytesPerFrame);
+    m_mix.resize(size_t(frames) * AudioMixer::Channels);
+    m_mixer->render(m_mix.data(), frames);
+
+    qint16 *out = reinterpret_cast<qint16 *>(data);
+    for (size_t i = 0; i < m_mix.size(); ++i)
+        out[i] = qint16(qBound(-32768L, std::lround(m_mix[i] * 32767.0f), 32767L));
+    return frames * bytesPerFrame;
+}
+
+// =============================================================================
+// MIXER
+// =============================================================================
+
+AudioMixer::AudioMixer(QObject *parent)
+    : QObject(parent)
+{
+    for (auto &monitor : m_gainMonitor) monitor.store(1.0f);
+    m_device = new AudioMixerDevice(this, this);
+    m_device->open(QIODevice::ReadOnly);
+}
+
+AudioMixer::~AudioMixer() {
+    stop();
+}
+
+void AudioMixer::start() {
+    if (!m_sinkEnabled || m_sink) return;
+
+    QAudioFormat format;
+    format.setSampleRate(SampleRate);
+    format.setChannelCount(Channels);
+    format.setSampleFormat(QAudioFormat::Int16);
+
+    m_sink = new QAudioSink(QMediaDevices::defaultAudioOutput(), format, this);
+    m_sink->setBufferSize(SampleRate * Channels * int(sizeof(qint16)) * SinkBufferMs / 1000);
+    m_sink->start(m_device);
+    if (m_sink->error() != QAudio::NoError) qWarning() << "AudioMixer: audio output unavailable";
+}
+
+void AudioMixer::stop() {
+    if (!m_sink) return;
+    m_sink->stop();
+    delete m_sink;
+    m_sink = nullptr;
+}
+
+void AudioMixer::post(const Command &command) {
+    if (m_commands.write(&command, 1) == 0)
+        qWarning() << "AudioMixer: command queue full, dropping command" << command.type;
+}
+
+void AudioMixer::setMediaSource(StreamPlaybackDevice *source) {
+    post({SetMedia, Media, 0.0f, 0, source});
+}
+
+void AudioMixer::setChannelGain(Channel channel, float gain, int rampMs) {
+    post({SetGain, channel, qBound(0.0f, gain, 1.0f), qMax(0, rampMs) * SampleRate / 1000, nullptr});
+}
+
+quint32 AudioMixer::playClip(Channel channel, const PcmClip *clip, int delayMs) {
+    if (channel == Media || !clip) return 0;
+    if (++m_lastClipId == 0) ++m_lastClipId;
+    post({PlayClip, channel, 0.0f, qMax(0, delayMs) * SampleRate / 1000, clip, m_lastClipId});
+    return m_lastClipId;
+}
+
+void AudioMixer::stopClip(Channel channel) {
+    post({StopClip, channel, 0.0f, 0, nullptr});
+}
+
+void AudioMixer::applyCommands() {
+    // A clip let go of before its end is finished too: no longer read from here on
+    auto release = [this](int channel, const ChannelState &state) {
+        if (!state.clip) return;
+        const quint32 id = state.clipId;
+        QMetaObject::invokeMethod(this, [this, channel, id]() { emit clipFinished(Channel(channel), id); }, Qt::QueuedConnection);
+    };
+    Command command;
+    while (m_commands.read(&command, 1) == 1) {
+        ChannelState &state = m_channels[command.channel];
+        switch (command.type) {
+        case SetGain:
+            state.target = command.gain;
+            state.rampLeft = command.frames;
+            if (state.rampLeft == 0) state.gain = state.target;
+            else state.step = (state.target - state.gain) / float(state.rampLeft);
+            break;
+        case PlayClip:
+            release(command.channel, state);
+            state.clip = static_cast<const PcmClip *>(command.ptr);
+            state.clipId = command.id;
+            state.clipPos = 0;
+            state.delay = command.frames;
+            break;
+        case StopClip:
+            release(command.channel, state);
+            state.clip = nullptr;
+            break;
+        case SetMedia:
+            m_media = static_cast<StreamPlaybackDevice *>(const_cast<void *>(command.ptr));
+            break;
+        }
+    }
+}
+
+void AudioMixer::mixChannel(ChannelState &state, const float *src, float *out, int frames) {
+    int i = 0;
+    // Ramp section, per sample
+    for (; i < frames && state.rampLeft > 0; ++i) {
+        state.gain += state.step;
+        if (--state.rampLeft == 0) state.gain = state.target;
+        if (src) {
+            out[i * Channels] += src[i * Channels] * state.gain;
+            out[i * Channels + 1] += src[i * Channels + 1] * state.gain;
+        }
+    }
+    // Steady section, constant gain
+    if (!src || state.gain == 0.0f) return;
+    const float gain = state.gain;
+    for (int s = i * Channels; s < frames * Channels; ++s) out[s] += src[s] * gain;
+}
+
+void AudioMixer::renderClip(int channel, ChannelState &state, float *out, int frames) {
+    if (!state.clip) {
+        mixChannel(state, nullptr, out, frames);
+        return;
+    }
+
+    // Delay: the channel's gain still ramps while the clip waits
+    const int wait = qMin(state.delay, frames);
+    mixChannel(state, nullptr, out, wait);
+    state.delay -= wait;
+    if (wait == frames) return;
+
+    // Queued: the id tells a late event from the clip playing by then
+    const quint32 id = state.clipId;
+    if (state.clipPos == 0)
+        QMetaObject::invokeMethod(this, [this, channel, id]() { emit clipStarted(Channel(channel), id); }, Qt::QueuedConnection);
+
+    const int count = qMin(frames - wait, state.clip->frames() - state.clipPos);
+    mixChannel(state, state.clip->samples.data() + size_t(state.clipPos) * Channels, out + wait * Channels, count);
+    state.clipPos += count;
+    if (state.clipPos >= state.clip->frames()) {
+        state.clip = nullptr;
+        QMetaObject::invokeMethod(this, [this, channel, id]() { emit clipFinished(Channel(channel), id); }, Qt::QueuedConnection);
+        mixChannel(state, nullptr, out, frames - wait - count);
+    }
+}
+
+void AudioMixer::render(float *out, int frames) {
+    applyCommands();
+    std::memset(out, 0, size_t(frames) * Channels * sizeof(float));
+
+    if (m_media) {
+        m_scratch.resize(size_t(frames) * Channels);
+        m_media->render(m_scratch.data(), frames, SampleRate);
+        mixChannel(m_channels[Media], m_scratch.data(), out, frames);
+    } else {
+        mixChannel(m_channels[Media], nullptr, out, frames);
+    }
+    for (int channel = Voice; channel < ChannelCount; ++channel)
+        renderClip(channel, m_channels[channel], out, frames);
+
+    for (int channel = 0; channel < ChannelCount; ++channel)
+        m_gainMonitor[channel].store(m_channels[channel].gain, std::memory_order_relaxed);
+}
@@ -0,0 +1,135 @@
+#ifndef AUDIOMIXER_H
+#define AUDIOMIXER_H
+
+#include <QObject>
+#include <QIODevice>
+#include <atomic>
+#include <memory>
+#include <vector>
+#include "SpscRingBuffer.h"
+
+class QAudioSink;
+class StreamPlaybackDevice;
+
+/**
+ * @brief Decoded, ready-to-mix PCM (interleaved stereo float at the mixer rate).
+ */
+struct PcmClip {
+    std::vector<float> samples;
+    int frames() const { return int(samples.size() / 2); }
+};
+using PcmClipPtr = std::shared_ptr<const PcmClip>;
+
+class AudioMixer;
+
+/**
+ * @brief Pull-mode device handed to the mixer's QAudioSink.
+ */
+class AudioMixerDevice : public QIODevice
+{
+    Q_OBJECT
+
+public:
+    explicit AudioMixerDevice(AudioMixer *mixer, QObject *parent = nullptr);
+
+    bool isSequential() const override { return true; }
+    qint64 bytesAvailable() const override;
+
+protected:
+    qint64 readData(char *data, qint64 maxlen) override;
+    qint64 writeData(const char *data, qint64 len) override;
+
+private:
+    AudioMixer *m_mixer;
+    std::vector<float> m_mix;
+};
+
+/**
+ * @brief The single output mix: media bus plus prompt/voice channels.
+ *
+ * The GUI thread posts commands (gain targets, clip starts) through a
+ * lock-free queue; the audio pull thread applies them at the start of the
+ * next block and ramps every channel gain per sample, so a duck lands
+ * exactly under the prompt it makes room for. Clips are owned by the caller
+ * (the prompt cache) and must outlive their playback.
+ */
+class AudioMixer : public QObject
+{
+    Q_OBJECT
+
+public:
+    enum Channel { Media, Voice, Navigation, Call, ChannelCount };
+    Q_ENUM(Channel)
+
+    static constexpr int SampleRate = 48000;
+    static constexpr int Channels = 2;
+    static constexpr int SinkBufferMs = 20;
+
+    explicit AudioMixer(QObject *parent = nullptr);
+    ~AudioMixer();
+
+    void start();
+    void stop();
+    // Tests pull the mix themselves through device() instead of a sink
+    void setSinkEnabled(bool enabled) { m_sinkEnabled = enabled; }
+    QIODevice *device() const { return m_device; }
+
+    // GUI thread. The source must stay alive until replaced.
+    void setMediaSource(StreamPlaybackDevice *source);
+    void setChannelGain(Channel channel, float gain, int rampMs);
+    // Starts `clip` on `channel` after `delayMs` of mixed output; returns the
+    // id its clipStarted and clipFinished carry (0 if not played). The clip
+    // must stay alive until its clipFinished, which also comes when another
+    // clip or a stop replaces it
+    quint32 playClip(Channel channel, const PcmClip *clip, int delayMs = 0);
+    void stopClip(Channel channel);
+
+    // Audio thread
+    void render(float *out, int frames);
+    float currentGain(Channel channel) const { return m_gainMonitor[channel].load(std::memory_order_relaxed); }
+
+signals:
+    void clipStarted(AudioMixer::Channel channel, quint32 id);
+    void clipFinished(AudioMixer::Channel channel, quint32 id);
+
+private:
+    enum CommandType { SetGain, PlayClip, StopClip, SetMedia };
+    struct Command {
+        CommandType type;
+        int channel;
+        float gain;
+        int frames;   // ramp length or start delay
+        const void *ptr;
+        quint32 id = 0; // of a clip
+    };
+    struct ChannelState {
+        float gain = 1.0f;
+        float target = 1.0f;
+        float step = 0.0f;
+        int rampLeft = 0;
+        const PcmClip *clip = nullptr;
+        quint32 clipId = 0;
+        int clipPos = 0;
+        int delay = 0;
+    };
+
+    void post(const Command &command);
+    void applyCommands();
+    void mixChannel(ChannelState &state, const float *src, float *out, int frames);
+    void renderClip(int channel, ChannelState &state, float *out, int frames);
+
+    SpscRingBuffer<Command> m_commands{256};
+    quint32 m_lastClipId = 0; // GUI thread
+    AudioMixerDevice *m_device;
+    QAudioSink *m_sink = nullptr;
+    bool m_sinkEnabled = true;
+
+    // Audio thread only
+    ChannelState m_channels[ChannelCount];
+    StreamPlaybackDevice *m_media = nullptr;
+    std::vector<float> m_scratch;
+
+    std::atomic<float> m_gainMonitor[ChannelCount];
+};
+
+#endif // AUDIOMIXER_H
@@ -0,0 +1,110 @@
+#include "RealFft.h"
+#include "SimdOps.h"
+#include <cmath>
+
+RealFft::RealFft(int size)
+    : m_size(size),
+      m_half(size / 2)
+{
+    const double pi = 3.14159265358979323846;
+
+    m_window.resize(m_size);
+    for (int n = 0; n < m_size; ++n)
+        m_window[n] = static_cast<float>(0.5 - 0.5 * std::cos(2.0 * pi * n / m_size));
+
+    int bits = 0;
+    while ((1 << bits) < m_half) ++bits;
+    m_bitReverse.resize(m_half);
+    for (int i = 0; i < m_half; ++i) {
+        int r = 0;
+        for (int b = 0; b < bits; ++b) r |= ((i >> b) & 1) << (bits - 1 - b);
+        m_bitReverse[i] = r;
+    }
+
+    // Stage with span `len` uses len/2 twiddles; they are stored back to back
+    // so every butterfly loop reads contiguous memory.
+    for (int len = 2; len <= m_half; len <<= 1) {
+        for (int k = 0; k < len / 2; ++k) {
+            const double a = -2.0 * pi * k / len;
+            m_stageCos.push_back(static_cast<float>(std::cos(a)));
+            m_stageSin.push_back(static_cast<float>(std::sin(a)));
+        }
+    }
+
+    m_postCos.resize(m_half + 1);
+    m_postSin.resize(m_half + 1);
+    for (int k = 0; k <= m_half; ++k) {
+        const double a = -2.0 * pi * k / m_size;
+        m_postCos[k] = static_cast<float>(std::cos(a));
+        m_postSin[k] = static_cast<float>(std::sin(a));
+    }
+
+    m_re.resize(m_half);
+    m_im.resize(m_half);
+}
+
+void RealFft::butterflies()
+{
+    float *re = m_re.data();
+    float *im = m_im.data();
+    const float *twc = m_stageCos.data();
+    const float *tws = m_stageSin.data();
+
+    for (int len = 2; len <= m_half; len <<= 1) {
+        const int h = len / 2;
+        for (int base = 0; base < m_half; base += len) {
+            float *ar = re + base, *ai = im + base;
+            float *br = ar + h, *bi = ai + h;
+            int k = 0;
+            for (; k + 4 <= h; k += 4) {
+                const simd::f32x4 wr = simd::load(twc + k);
+                const simd::f32x4 wi = simd::load(tws + k);
+                const simd::f32x4 xr = simd::load(br + k);
+                const simd::f32x4 xi = simd::load(bi + k);
+                const simd::f32x4 tr = simd::sub(simd::mul(xr, wr), simd::mul(xi, wi));
+                const simd::f32x4 ti = simd::add(simd::mul(xr, wi), simd::mul(xi, wr));
+                const simd::f32x4 ur = simd::load(ar + k);
+                const simd::f32x4 ui = simd::load(ai + k);
+                simd::store(br + k, simd::sub(ur, tr));
+                simd::store(bi + k, simd::sub(ui, ti));
+                simd::store(ar + k, simd::add(ur, tr));
+                simd::store(ai + k, simd::add(ui, ti));
+            }
+            for (; k < h; ++k) {
+                const float tr = br[k] * twc[k] - bi[k] * tws[k];
+                const float ti = br[k] * tws[k] + bi[k] * twc[k];
+                br[k] = ar[k] - tr;
+                bi[k] = ai[k] - ti;
+                ar[k] += tr;
+                ai[k] += ti;
+            }
+        }
+        twc += h;
+        tws += h;
+    }
+}
+
+void RealFft::powerSpectrum(const float *input, float *power)
+{
+    // Window, pack even/odd samples as re/im and scatter into bit-reversed order
+    for (int n = 0; n < m_half; ++n) {
+        const int r = m_bitReverse[n];
+        m_re[r] = input[2 * n] * m_window[2 * n];
+        m_im[r] = input[2 * n + 1] * m_window[2 * n + 1];
+    }
+
+    butterflies();
+
+    // Unpack: X[k] = E[k] + W^k * O[k], with E/O recovered from Z[k] and conj(Z[M-k])
+    for (int k = 0; k <= m_half; ++k) {
+        const int a = (k == m_half) ? 0 : k;
+        const int b = (k == 0) ? 0 : m_half - k;
+        const float zr = m_re[a], zi = m_im[a];
+        const float cr = m_re[b], ci = -m_im[b];
+        const float er = 0.5f * (zr + cr), ei = 0.5f * (zi + ci);
+        const float orr = 0.5f * (zi - ci), oi = -0.5f * (zr - cr);
+        const float xr = er + orr * m_postCos[k] - oi * m_postSin[k];
+        const float xi = ei + orr * m_postSin[k] + oi * m_postCos[k];
+        power[k] = xr * xr + xi * xi;
+    }
+}
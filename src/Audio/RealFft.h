@@ -0,0 +1,39 @@
+#ifndef REALFFT_H
+#define REALFFT_H
+
+#include <vector>
+
+/**
+ * @brief Hann-windowed real-input FFT producing a power spectrum.
+ *
+ * N real samples are packed into an N/2-point complex FFT (split re/im
+ * arrays, radix-2, SIMD butterflies) and unpacked into N/2 + 1 bins.
+ * All tables are built once in the constructor; forward() never allocates.
+ */
+class RealFft
+{
+public:
+    explicit RealFft(int size = 2048); // size must be a power of two >= 16
+
+    int size() const { return m_size; }
+    int binCount() const { return m_size / 2 + 1; }
+
+    // input: size() samples, power: binCount() values (|X[k]|^2, window applied)
+    void powerSpectrum(const float *input, float *power);
+
+private:
+    void butterflies();
+
+    int m_size;
+    int m_half;
+    std::vector<float> m_window;
+    std::vector<int> m_bitReverse;
+    std::vector<float> m_stageCos; // concatenated per-stage twiddles
+    std::vector<float> m_stageSin;
+    std::vector<float> m_postCos;  // unpack twiddles e^{-2*pi*i*k/N}
+    std::vector<float> m_postSin;
+    std::vector<float> m_re;
+    std::vector<float> m_im;
+};
+
+#endif // REALFFT_H
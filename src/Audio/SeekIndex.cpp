@@ -0,0 +1,459 @@
+#include "SeekIndex.h"
+#include <QCryptographicHash>
+#include <QDataStream>
+#include <QDateTime>
+#include <QDir>
+#include <QFileInfo>
+#include <QStandardPaths>
+#include <QtEndian>
+#include <QtConcurrent/QtConcurrent>
+#include <QDebug>
+#include <algorithm>
+#include <cstring>
+
+namespace {
+
+constexpr quint32 kCacheMagic = 0x5849534E; // "NSIX"
+constexpr quint16 kCacheVersion = 1;
+
+// =============================================================================
+// MP3
+// =============================================================================
+
+struct Mp3Header {
+    int bitrateKbps = 0;
+    int sampleRate = 0;
+    int samplesPerFrame = 0;
+    int frameBytes = 0;
+    bool mpeg1 = false;
+    bool mono = false;
+};
+
+// MPEG audio Layer III only; .mp3 files with Layer I/II are left to the backend
+bool parseMp3Header(const uchar *h, Mp3Header &out) {
+    if (h[0] != 0xFF || (h[1] & 0xE0) != 0xE0) return false;
+    const int version = (h[1] >> 3) & 3;  // 0: MPEG 2.5, 1: reserved, 2: MPEG 2, 3: MPEG 1
+    const int layer = (h[1] >> 1) & 3;    // 1: Layer III
+    const int bitrateIndex = h[2] >> 4;
+    const int rateIndex = (h[2] >> 2) & 3;
+    if (version == 1 || layer != 1 || bitrateIndex == 0 || bitrateIndex == 15 || rateIndex == 3) return false;
+
+    static const int kBitratesV1[16] = {0, 32, 40, 48, 56, 64, 80, 96, 112, 128, 160, 192, 224, 256, 320, 0};
+    static const int kBitratesV2[16] = {0, 8, 16, 24, 32, 40, 48, 56, 64, 80, 96, 112, 128, 144, 160, 0};
+    static const int kRates[3] = {44100, 48000, 32000};
+
+    out.mpeg1 = version == 3;
+    out.mono = (h[3] >> 6) == 3;
+    out.bitrateKbps = out.mpeg1 ? kBitratesV1[bitrateIndex] : kBitratesV2[bitrateIndex];
+    out.sampleRate = kRates[rateIndex] >> (out.mpeg1 ? 0 : (version == 2 ? 1 : 2));
+    out.samplesPerFrame = out.mpeg1 ? 1152 : 576;
+    const int padding = (h[2] >> 1) & 1;
+    out.frameBytes = (out.mpeg1 ? 144 : 72) * out.bitrateKbps * 1000 / out.sampleRate + padding;
+    return true;
+}
+
+// Xing/Info (LAME) and VBRI headers sit in an otherwise silent first frame
+bool isInfoFrame(const uchar *frame, qint64 available, const Mp3Header &h) {
+    const int sideInfo = h.mpeg1 ? (h.mono ? 17 : 32) : (h.mono ? 9 : 17);
+    if (4 + sideInfo + 4 <= available) {
+        const uchar *tag = frame + 4 + sideInfo;
+        if (std::memcmp(tag, "Xing", 4) == 0 || std::memcmp(tag, "Info", 4) == 0) return true;
+    }
+    return available >= 40 && std::memcmp(frame + 36, "VBRI", 4) == 0;
+}
+
+// =============================================================================
+// MP4
+// =============================================================================
+
+struct Span {
+    const uchar *data = nullptr;
+    qint64 size = 0;
+    bool isNull() const { return !data; }
+};
+
+quint32 be32(const uchar *p) { return qFromBigEndian<quint32>(p); }
+quint64 be64(const uchar *p) { return qFromBigEndian<quint64>(p); }
+
+// `index`-th child box of `parent` with the given type (payload only)
+Span childBox(Span parent, const char *type, int index = 0) {
+    qint64 pos = 0;
+    while (pos + 8 <= parent.size) {
+        const uchar *box = parent.data + pos;
+        quint64 size = be32(box);
+        int header = 8;
+        if (size == 1) {
+            if (pos + 16 > parent.size) break;
+            size = be64(box + 8);
+            header = 16;
+        } else if (size == 0) {
+            size = quint64(parent.size - pos);
+        }
+        if (size < quint64(header) || pos + qint64(size) > parent.size) break;
+        if (std::memcmp(box + 4, type, 4) == 0 && index-- == 0)
+            return {box + header, qint64(size) - header};
+        pos += qint64(size);
+    }
+    return {};
+}
+
+} // namespace
+
+// =============================================================================
+// BUILD
+// =============================================================================
+
+SeekIndex SeekIndex::build(const QString &path, int intervalMs) {
+    SeekIndex index;
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly)) return index;
+
+    const QFileInfo info(path);
+    index.m_fileSize = info.size();
+    index.m_fileMtime = info.lastModified().toMSecsSinceEpoch();
+    intervalMs = qMax(20, intervalMs);
+
+    const QByteArray head = file.peek(12);
+    if (head.size() >= 8 && head.mid(4, 4) == "ftyp") {
+        if (!index.parseMp4(file, intervalMs)) index.m_entries.clear();
+        return index;
+    }
+
+    // MP3: walk every frame header over a read-only mapping
+    const qint64 size = file.size();
+    uchar *mapped = file.map(0, size);
+    QByteArray fallback;
+    const uchar *data = mapped;
+    if (!data) {
+        fallback = file.readAll();
+        data = reinterpret_cast<const uchar *>(fallback.constData());
+    }
+    if (!index.parseMp3(data, size, intervalMs)) index.m_entries.clear();
+    if (mapped) file.unmap(mapped);
+    return index;
+}
+
+bool SeekIndex::parseMp3(const uchar *data, qint64 size, int intervalMs) {
+    qint64 pos = 0;
+    // ID3v2 tags (syncsafe sizes, optional footer) may be stacked
+    while (pos + 10 <= size && std::memcmp(data + pos, "ID3", 3) == 0) {
+        const qint64 tagSize = (qint64(data[pos + 6] & 0x7F) << 21) | ((data[pos + 7] & 0x7F) << 14)
+                             | ((data[pos + 8] & 0x7F) << 7) | (data[pos + 9] & 0x7F);
+        pos += 10 + tagSize + ((data[pos + 5] & 0x10) ? 10 : 0);
+    }
+    qint64 end = size;
+    if (end >= 128 && std::memcmp(data + end - 128, "TAG", 3) == 0) end -= 128; // ID3v1
+
+    qint64 samples = 0;
+    qint64 nextCheckpoint = 0;
+    qint64 interval = 0;
+    int firstBitrate = 0;
+
+    while (pos + 4 <= end) {
+        Mp3Header h;
+        if (!parseMp3Header(data + pos, h) || pos + h.frameBytes > end
+            || (m_sampleRate && h.sampleRate != m_sampleRate)) {
+            ++pos; // lost sync: scan for the next header
+            continue;
+        }
+        if (!m_sampleRate) {
+            // First frame: confirm with its successor so stray 0xFFE bits in a tag do not lock on
+            Mp3Header next;
+            const qint64 nextPos = pos + h.frameBytes;
+            if (nextPos + 4 <= end && (!parseMp3Header(data + nextPos, next) || next.sampleRate != h.sampleRate)) {
+                ++pos;
+                continue;
+            }
+            m_sampleRate = h.sampleRate;
+            m_samplesPerFrame = h.samplesPerFrame;
+            interval = qint64(m_sampleRate) * intervalMs / 1000;
+            if (isInfoFrame(data + pos, end - pos, h)) {
+                pos += h.frameBytes;
+                continue;
+            }
+        }
+
+        if (!firstBitrate) firstBitrate = h.bitrateKbps;
+        else if (h.bitrateKbps != firstBitrate) m_vbr = true;
+
+        if (samples >= nextCheckpoint) {
+            m_entries.append({samples, pos});
+            nextCheckpoint += interval;
+        }
+        samples += h.samplesPerFrame;
+        pos += h.frameBytes;
+        m_audioEnd = pos;
+    }
+
+    m_totalSamples = samples;
+    m_format = Mp3;
+    return !m_entries.isEmpty();
+}
+
+bool SeekIndex::parseMp4(QFile &file, int intervalMs) {
+    // Only the moov box is read; it often sits at the end of large files
+    QByteArray moov;
+    const qint64 fileSize = file.size();
+    qint64 pos = 0;
+    while (pos + 8 <= fileSize) {
+        if (!file.seek(pos)) return false;
+        const QByteArray header = file.read(16);
+        if (header.size() < 8) return false;
+        const uchar *h = reinterpret_cast<const uchar *>(header.constData());
+        quint64 size = be32(h);
+        int headerLen = 8;
+        if (size == 1) {
+            if (header.size() < 16) return false;
+            size = be64(h + 8);
+            headerLen = 16;
+        } else if (size == 0) {
+            size = quint64(fileSize - pos);
+        }
+        if (size < quint64(headerLen)) return false;
+        if (header.mid(4, 4) == "moov") {
+            file.seek(pos + headerLen);
+            moov = file.read(qint64(size) - headerLen);
+            break;
+        }
+        pos += qint64(size);
+    }
+    if (moov.isEmpty()) return false;
+
+    const Span root{reinterpret_cast<const uchar *>(moov.constData()), moov.size()};
+    Span stbl;
+    quint32 timescale = 0;
+    for (int t = 0; stbl.isNull(); ++t) {
+        const Span trak = childBox(root, "trak", t);
+        if (trak.isNull()) return false;
+        const Span mdia = childBox(trak, "mdia");
+        const Span hdlr = childBox(mdia, "hdlr");
+        if (hdlr.isNull() || hdlr.size < 12 || std::memcmp(hdlr.data + 8, "soun", 4) != 0) continue;
+        const Span mdhd = childBox(mdia, "mdhd");
+        if (mdhd.isNull() || mdhd.size < 24) return false;
+        timescale = mdhd.data[0] == 1 ? be32(mdhd.data + 20) : be32(mdhd.data + 12);
+        stbl = childBox(childBox(mdia, "minf"), "stbl");
+        if (stbl.isNull()) return false;
+    }
+    if (timescale == 0) return false;
+
+    const Span stts = childBox(stbl, "stts");
+    const Span stsc = childBox(stbl, "stsc");
+    const Span stsz = childBox(stbl, "stsz");
+    Span stco = childBox(stbl, "stco");
+    const bool wideOffsets = stco.isNull();
+    if (wideOffsets) stco = childBox(stbl, "co64");
+    if (stts.isNull() || stsc.isNull() || stsz.isNull() || stco.isNull()) return false;
+    if (stts.size < 8 || stsc.size < 8 || stsz.size < 12 || stco.size < 8) return false;
+
+    const quint32 sttsCount = be32(stts.data + 4);
+    const quint32 stscCount = be32(stsc.data + 4);
+    const quint32 fixedSize = be32(stsz.data + 4);
+    const quint32 sampleCount = be32(stsz.data + 8);
+    const quint32 chunkCount = be32(stco.data + 4);
+    if (8 + qint64(sttsCount) * 8 > stts.size || 8 + qint64(stscCount) * 12 > stsc.size
+        || (fixedSize == 0 && 12 + qint64(sampleCount) * 4 > stsz.size)
+        || 8 + qint64(chunkCount) * (wideOffsets ? 8 : 4) > stco.size || sttsCount == 0 || stscCount == 0)
+        return false;
+
+    m_sampleRate = int(timescale);
+    m_vbr = fixedSize == 0;
+    m_samplesPerFrame = sttsCount == 1 ? int(be32(stts.data + 12)) : 0;
+    const qint64 interval = qint64(timescale) * intervalMs / 1000;
+
+    qint64 time = 0;
+    qint64 nextCheckpoint = 0;
+    quint32 sample = 0;
+    quint32 sttsIndex = 0;
+    quint32 sttsLeft = be32(stts.data + 8);
+    quint32 stscIndex = 0;
+
+    for (quint32 chunk = 0; chunk < chunkCount && sample < sampleCount; ++chunk) {
+        // stsc runs are keyed by 1-based first chunk
+        while (stscIndex + 1 < stscCount && be32(stsc.data + 8 + (stscIndex + 1) * 12) <= chunk + 1) ++stscIndex;
+        const quint32 perChunk = be32(stsc.data + 8 + stscIndex * 12 + 4);
+        qint64 offset = wideOffsets ? qint64(be64(stco.data + 8 + chunk * 8)) : qint64(be32(stco.data + 8 + chunk * 4));
+
+        for (quint32 s = 0; s < perChunk && sample < sampleCount; ++s, ++sample) {
+            if (time >= nextCheckpoint) {
+                m_entries.append({time, offset});
+                nextCheckpoint += interval;
+            }
+            offset += fixedSize ? fixedSize : be32(stsz.data + 12 + sample * 4);
+            m_audioEnd = qMax(m_audioEnd, offset);
+
+            while (sttsLeft == 0 && sttsIndex + 1 < sttsCount) sttsLeft = be32(stts.data + 8 + ++sttsIndex * 8);
+            time += be32(stts.data + 8 + sttsIndex * 8 + 4);
+            if (sttsLeft > 0) --sttsLeft;
+        }
+    }
+
+    m_totalSamples = time;
+    m_format = Mp4;
+    return !m_entries.isEmpty();
+}
+
+// =============================================================================
+// LOOKUP
+// =============================================================================
+
+SeekIndex::Position SeekIndex::locate(qint64 ms, QIODevice *file) const {
+    if (!isValid()) return {ms, 0};
+
+    const qint64 target = qBound<qint64>(0, ms, durationMs()) * m_sampleRate / 1000;
+    auto it = std::upper_bound(m_entries.cbegin(), m_entries.cend(), target,
+                               [](qint64 t, const Entry &e) { return t < e.sample; });
+    Entry entry = it == m_entries.cbegin() ? *it : *(it - 1);
+
+    if (m_format == Mp3 && file) {
+        // At most intervalMs worth of frames between checkpoints
+        uchar header[4];
+        while (entry.sample + m_samplesPerFrame <= target) {
+            Mp3Header h;
+            if (!file->seek(entry.offset) || file->read(reinterpret_cast<char *>(header), 4) != 4
+                || !parseMp3Header(header, h) || entry.offset + h.frameBytes >= m_audioEnd)
+                break;
+            entry.offset += h.frameBytes;
+            entry.sample += m_samplesPerFrame;
+        }
+    } else if (m_samplesPerFrame > 0) {
+        // Frame-aligned time; MP4 backends seek by time through the container's sample table
+        entry.sample += (target - entry.sample) / m_samplesPerFrame * m_samplesPerFrame;
+    }
+    return {entry.sample * 1000 / m_sampleRate, entry.offset};
+}
+
+// =============================================================================
+// CACHE
+// =============================================================================
+
+QString SeekIndex::cachePath(const QString &path) {
+    const QByteArray key = QCryptographicHash::hash(QFileInfo(path).absoluteFilePath().toUtf8(), QCryptographicHash::Sha1).toHex();
+    return QStandardPaths::writableLocation(QStandardPaths::CacheLocation) + "/seekindex/" + QString::fromLatin1(key) + ".idx";
+}
+
+bool SeekIndex::supports(const QString &path) {
+    const QString suffix = QFileInfo(path).suffix().toLower();
+    return suffix == "mp3" || suffix == "mp4" || suffix == "m4a";
+}
+
+SeekIndex SeekIndex::loadOrBuild(const QString &path, int intervalMs) {
+    const QFileInfo info(path);
+    const QString cacheFile = cachePath(path);
+
+    SeekIndex cached;
+    if (cached.load(cacheFile) && cached.m_fileSize == info.size()
+        && cached.m_fileMtime == info.lastModified().toMSecsSinceEpoch())
+        return cached;
+
+    SeekIndex index = build(path, intervalMs);
+    if (index.isValid()) {
+        QDir().mkpath(QFileInfo(cacheFile).absolutePath());
+        if (!index.save(cacheFile)) qWarning() << "SeekIndex: cannot write cache" << cacheFile;
+    }
+    return index;
+}
+
+bool SeekIndex::save(const QString &cacheFile) const {
+    QFile file(cacheFile);
+    if (!file.open(QIODevice::WriteOnly)) return false;
+    QDataStream out(&file);
+    out << kCacheMagic << kCacheVersion << quint8(m_format) << m_vbr << qint32(m_sampleRate)
+        << qint32(m_samplesPerFrame) << m_totalSamples << m_audioEnd << m_fileSize << m_fileMtime
+        << qint32(m_entries.size());
+    for (const Entry &e : m_entries) out << e.sample << e.offset;
+    return out.status() == QDataStream::Ok;
+}
+
+bool SeekIndex::load(const QString &cacheFile) {
+    QFile file(cacheFile);
+    if (!file.open(QIODevice::ReadOnly)) return false;
+    QDataStream in(&file);
+    quint32 magic = 0;
+    quint16 version = 0;
+    quint8 format = 0;
+    qint32 sampleRate = 0, samplesPerFrame = 0, count = 0;
+    in >> magic >> version;
+    if (magic != kCacheMagic || version != kCacheVersion) return false;
+    in >> format >> m_vbr >> sampleRate >> samplesPerFrame >> m_totalSamples >> m_audioEnd
+       >> m_fileSize >> m_fileMtime >> count;
+    if (in.status() != QDataStream::Ok || count <= 0 || count > (1 << 24)) return false;
+
+    m_entries.resize(count);
+    for (Entry &e : m_entries) in >> e.sample >> e.offset;
+    if (in.status() != QDataStream::Ok) {
+        m_entries.clear();
+        return false;
+    }
+    m_format = Format(format);
+    m_sampleRate = sampleRate;
+    m_samplesPerFrame = samplesPerFrame;
+    return isValid() && m_sampleRate > 0;
+}
+
+// =============================================================================
+// RANGE DEVICE
+// =============================================================================
+
+FileRangeDevice::FileRangeDevice(const QString &path, qint64 begin, qint64 end, QObject *parent)
+    : QIODevice(parent),
+      m_file(path),
+      m_begin(begin),
+      m_end(end)
+{
+}
+
+bool FileRangeDevice::open(OpenMode mode) {
+    if (mode & WriteOnly) return false;
+    if (!m_file.open(QIODevice::ReadOnly)) return false;
+    if (m_end <= m_begin || m_end > m_file.size()) m_end = m_file.size();
+    m_file.seek(m_begin);
+    return QIODevice::open(mode | Unbuffered);
+}
+
+void FileRangeDevice::close() {
+    m_file.close();
+    QIODevice::close();
+}
+
+bool FileRangeDevice::seek(qint64 pos) {
+    if (pos < 0 || pos > size() || !m_file.seek(m_begin + pos)) return false;
+    return QIODevice::seek(pos);
+}
+
+qint64 FileRangeDevice::readData(char *data, qint64 maxlen) {
+    const qint64 left = m_end - m_file.pos();
+    if (left <= 0) return -1;
+    return m_file.read(data, qMin(maxlen, left));
+}
+
+qint64 FileRangeDevice::writeData(const char *, qint64) {
+    return -1;
+}
+
+// =============================================================================
+// LOADER
+// =============================================================================
+
+SeekIndexLoader::SeekIndexLoader(QObject *parent)
+    : QObject(parent),
+      m_watcher(new QFutureWatcher<SeekIndex>(this))
+{
+    connect(m_watcher, &QFutureWatcher<SeekIndex>::finished, this, &SeekIndexLoader::onFinished);
+}
+
+void SeekIndexLoader::load(const QString &path) {
+    if (path == m_path) return;
+    m_path = path;
+    m_index = SeekIndex();
+    // Re-pointed even when there is nothing to build, so the previous
+    // track's build is never taken for this one
+    if (SeekIndex::supports(path)) m_watcher->setFuture(QtConcurrent::run([path]() { return SeekIndex::loadOrBuild(path); }));
+    else m_watcher->setFuture(QFuture<SeekIndex>());
+}
+
+void SeekIndexLoader::onFinished() {
+    // A finish queued before the watcher was re-pointed, or the empty future
+    if (!m_watcher->isFinished() || m_watcher->isCanceled() || m_watcher->future().resultCount() == 0) return;
+    m_index = m_watcher->result();
+    emit ready();
+}
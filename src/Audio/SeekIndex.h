@@ -0,0 +1,131 @@
+#ifndef SEEKINDEX_H
+#define SEEKINDEX_H
+
+#include <QString>
+#include <QVector>
+#include <QIODevice>
+#include <QFile>
+#include <QFutureWatcher>
+
+/**
+ * @brief Per-file seek table for MP3 and MP4/M4A audio.
+ *
+ * Built once by walking the container (MP3 frame headers, MP4 sample
+ * tables), then cached under the app cache directory keyed by path and
+ * validated by size and mtime. Checkpoints every `intervalMs` hold the
+ * exact sample position and byte offset of a frame start, so a lookup is a
+ * binary search plus a walk over at most a handful of frame headers.
+ */
+class SeekIndex
+{
+public:
+    enum Format : quint8 { Unknown = 0, Mp3 = 1, Mp4 = 2 };
+
+    struct Entry {
+        qint64 sample = 0;  // first PCM sample of the frame
+        qint64 offset = 0;  // byte offset of the frame in the file
+    };
+
+    struct Position {
+        qint64 ms = 0;      // exact start time of the frame containing the target
+        qint64 offset = 0;  // byte offset of that frame (frame-exact for MP3)
+    };
+
+    static constexpr int DefaultIntervalMs = 500;
+
+    // Cached index if still valid for the file, otherwise builds and caches it
+    static SeekIndex loadOrBuild(const QString &path, int intervalMs = DefaultIntervalMs);
+    static SeekIndex build(const QString &path, int intervalMs = DefaultIntervalMs);
+    static QString cachePath(const QString &path);
+    // Whether the file is a container the index reads, by its extension
+    static bool supports(const QString &path);
+
+    bool isValid() const { return m_format != Unknown && !m_entries.isEmpty(); }
+    Format format() const { return m_format; }
+    bool isVbr() const { return m_vbr; }
+    int sampleRate() const { return m_sampleRate; }
+    qint64 durationMs() const { return m_sampleRate > 0 ? m_totalSamples * 1000 / m_sampleRate : 0; }
+    qint64 audioEnd() const { return m_audioEnd; }
+    int entryCount() const { return int(m_entries.size()); }
+
+    // Frame containing `ms`: O(log n) checkpoint search, then (MP3) a short
+    // forward walk over frame headers in `file`
+    Position locate(qint64 ms, QIODevice *file = nullptr) const;
+
+    bool save(const QString &cacheFile) const;
+    bool load(const QString &cacheFile);
+
+private:
+    bool parseMp3(const uchar *data, qint64 size, int intervalMs);
+    bool parseMp4(QFile &file, int intervalMs);
+
+    Format m_format = Unknown;
+    bool m_vbr = false;
+    int m_sampleRate = 0;
+    int m_samplesPerFrame = 0;
+    qint64 m_totalSamples = 0;
+    qint64 m_audioEnd = 0;
+    qint64 m_fileSize = 0;
+    qint64 m_fileMtime = 0;
+    QVector<Entry> m_entries;
+};
+
+/**
+ * @brief Random-access view of [begin, end) of a file, so the player can
+ * start decoding at a frame boundary found through the seek index.
+ */
+class FileRangeDevice : public QIODevice
+{
+    Q_OBJECT
+
+public:
+    FileRangeDevice(const QString &path, qint64 begin, qint64 end, QObject *parent = nullptr);
+
+    bool open(OpenMode mode) override;
+    void close() override;
+    bool isSequential() const override { return false; }
+    qint64 size() const override { return m_end - m_begin; }
+    bool seek(qint64 pos) override;
+
+protected:
+    qint64 readData(char *data, qint64 maxlen) override;
+    qint64 writeData(const char *data, qint64 len) override;
+
+private:
+    QFile m_file;
+    qint64 m_begin;
+    qint64 m_end;
+};
+
+/**
+ * @brief Seek index of the track playing, loaded or built off the GUI thread.
+ *
+ * Only the index of the last path given is delivered: one still being
+ * built for an earlier track is dropped, whatever the next track's format.
+ */
+class SeekIndexLoader : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit SeekIndexLoader(QObject *parent = nullptr);
+
+    // Starts on `path` unless it is already the one loaded; a path the
+    // index does not read leaves it empty
+    void load(const QString &path);
+    bool isLoading() const { return m_watcher->isRunning(); }
+    const QString &path() const { return m_path; }
+    const SeekIndex &index() const { return m_index; }
+
+signals:
+    void ready();
+
+private:
+    void onFinished();
+
+    QFutureWatcher<SeekIndex> *m_watcher;
+    QString m_path;
+    SeekIndex m_index;
+};
+
+#endif // SEEKINDEX_H
@@ -0,0 +1,100 @@
+#ifndef SIMDOPS_H
+#define SIMDOPS_H
+
+/**
+ * @brief Minimal 4-lane float vector wrapper for the DSP kernels.
+ *
+ * Maps onto SSE on x86 and NEON on the ARM head unit. Builds without either
+ * fall back to a plain struct so the kernels stay portable (and the compiler
+ * is still free to auto-vectorize the scalar path).
+ */
+
+#if defined(__SSE__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1)
+#include <xmmintrin.h>
+#define NORDIC_SIMD_SSE 1
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#define NORDIC_SIMD_NEON 1
+#endif
+
+namespace simd {
+
+#if defined(NORDIC_SIMD_SSE)
+using f32x4 = __m128;
+inline f32x4 load(const float *p) { return _mm_loadu_ps(p); }
+inline void store(float *p, f32x4 v) { _mm_storeu_ps(p, v); }
+inline f32x4 splat(float v) { return _mm_set1_ps(v); }
+inline f32x4 add(f32x4 a, f32x4 b) { return _mm_add_ps(a, b); }
+inline f32x4 sub(f32x4 a, f32x4 b) { return _mm_sub_ps(a, b); }
+inline f32x4 mul(f32x4 a, f32x4 b) { return _mm_mul_ps(a, b); }
+inline f32x4 madd(f32x4 acc, f32x4 a, f32x4 b) { return _mm_add_ps(acc, _mm_mul_ps(a, b)); }
+inline float hsum(f32x4 v) {
+    __m128 shuf = _mm_shuffle_ps(v, v, _MM_SHUFFLE(2, 3, 0, 1));
+    __m128 sums = _mm_add_ps(v, shuf);
+    shuf = _mm_movehl_ps(shuf, sums);
+    return _mm_cvtss_f32(_mm_add_ss(sums, shuf));
+}
+#elif defined(NORDIC_SIMD_NEON)
+using f32x4 = float32x4_t;
+inline f32x4 load(const float *p) { return vld1q_f32(p); }
+inline void store(float *p, f32x4 v) { vst1q_f32(p, v); }
+inline f32x4 splat(float v) { return vdupq_n_f32(v); }
+inline f32x4 add(f32x4 a, f32x4 b) { return vaddq_f32(a, b); }
+inline f32x4 sub(f32x4 a, f32x4 b) { return vsubq_f32(a, b); }
+inline f32x4 mul(f32x4 a, f32x4 b) { return vmulq_f32(a, b); }
+inline f32x4 madd(f32x4 acc, f32x4 a, f32x4 b) { return vmlaq_f32(acc, a, b); }
+inline float hsum(f32x4 v) {
+#if defined(__aarch64__)
+    return vaddvq_f32(v);
+#else
+    float32x2_t s = vadd_f32(vget_low_f32(v), vget_high_f32(v));
+    return vget_lane_f32(vpadd_f32(s, s), 0);
+#endif
+}
+#else
+struct f32x4 { float v[4]; };
+inline f32x4 load(const float *p) { return {{p[0], p[1], p[2], p[3]}}; }
+inline void store(float *p, f32x4 a) { for (int i = 0; i < 4; ++i) p[i] = a.v[i]; }
+inline f32x4 splat(float s) { return {{s, s, s, s}}; }
+inline f32x4 add(f32x4 a, f32x4 b) { return {{a.v[0] + b.v[0], a.v[1] + b.v[1], a.v[2] + b.v[2], a.v[3] + b.v[3]}}; }
+inline f32x4 sub(f32x4 a, f32x4 b) { return {{a.v[0] - b.v[0], a.v[1] - b.v[1], a.v[2] - b.v[2], a.v[3] - b.v[3]}}; }
+inline f32x4 mul(f32x4 a, f32x4 b) { return {{a.v[0] * b.v[0], a.v[1] * b.v[1], a.v[2] * b.v[2], a.v[3] * b.v[3]}}; }
+inline f32x4 madd(f32x4 acc, f32x4 a, f32x4 b) { return add(acc, mul(a, b)); }
+inline float hsum(f32x4 a) { return (a.v[0] + a.v[1]) + (a.v[2] + a.v[3]); }
+#endif
+
+// Dot product of two float arrays (no alignment requirement).
+inline float dot(const float *a, const float *b, int n)
+{
+    f32x4 acc0 = splat(0.0f);
+    f32x4 acc1 = splat(0.0f);
+    int i = 0;
+    for (; i + 8 <= n; i += 8) {
+        acc0 = madd(acc0, load(a + i), load(b + i));
+        acc1 = madd(acc1, load(a + i + 4), load(b + i + 4));
+    }
+    for (; i + 4 <= n; i += 4) acc0 = madd(acc0, load(a + i), load(b + i));
+    float sum = hsum(add(acc0, acc1));
+    for (; i < n; ++i) sum += a[i] * b[i];
+    return sum;
+}
+
+// dst[i] = a[i] * b[i]
+inline void multiply(float *dst, const float *a, const float *b, int n)
+{
+    int i = 0;
+    for (; i + 4 <= n; i += 4) store(dst + i, mul(load(a + i), load(b + i)));
+    for (; i < n; ++i) dst[i] = a[i] * b[i];
+}
+
+// dst[i] += a[i] * b[i]
+inline void multiplyAccumulate(float *dst, const float *a, const float *b, int n)
+{
+    int i = 0;
+    for (; i + 4 <= n; i += 4) store(dst + i, madd(load(dst + i), load(a + i), load(b + i)));
+    for (; i < n; ++i) dst[i] += a[i] * b[i];
+}
+
+} // namespace simd
+
+#endif // SIMDOPS_H
@@ -0,0 +1,222 @@
+#include "SpectrumAnalyzer.h"
+#include <QDebug>
+#include <cmath>
+
+namespace {
+constexpr float kLowHz = 40.0f;
+constexpr float kHighHz = 16000.0f;
+constexpr float kFloorDb = -70.0f;
+constexpr float kDecay = 0.80f;           // per published frame
+constexpr float kPublishEpsilon = 0.004f; // skip repaints for invisible changes
+constexpr int kPushChunk = 512;
+}
+
+// =============================================================================
+// WORKER (analyzer thread)
+// =============================================================================
+
+SpectrumWorker::SpectrumWorker(SpscRingBuffer<float> *ring, const std::atomic<int> *sampleRate, int bandCount)
+    : QObject(nullptr),
+      m_ring(ring),
+      m_sampleRate(sampleRate),
+      m_fft(SpectrumAnalyzer::FftSize),
+      m_window(SpectrumAnalyzer::FftSize),
+      m_power(SpectrumAnalyzer::FftSize / 2 + 1),
+      m_bandCount(bandCount)
+{
+    // Parented so it follows the worker onto the analyzer thread
+    m_timer = new QTimer(this);
+    m_timer->setInterval(SpectrumAnalyzer::PublishIntervalMs);
+    m_timer->setTimerType(Qt::PreciseTimer);
+    connect(m_timer, &QTimer::timeout, this, &SpectrumWorker::process);
+    m_levels.fill(0.0f, m_bandCount);
+    m_published = m_levels;
+}
+
+void SpectrumWorker::start() {
+    m_ring->reset();
+    m_timer->start();
+}
+
+void SpectrumWorker::stop() {
+    m_timer->stop();
+    m_levels.fill(0.0f, m_bandCount);
+    m_published = m_levels;
+}
+
+void SpectrumWorker::setBandCount(int count) {
+    if (m_bandCount == count) return;
+    m_bandCount = count;
+    m_levels.fill(0.0f, m_bandCount);
+    m_published = m_levels;
+    m_edgesRate = 0; // force rebuild
+}
+
+void SpectrumWorker::rebuildBandEdges(int sampleRate) {
+    const int bins = SpectrumAnalyzer::FftSize / 2 + 1;
+    const float binHz = float(sampleRate) / SpectrumAnalyzer::FftSize;
+    const float high = qMin(kHighHz, 0.45f * sampleRate);
+    const float ratio = high / kLowHz;
+
+    m_bandEdges.resize(m_bandCount + 1);
+    for (int i = 0; i <= m_bandCount; ++i) {
+        const float hz = kLowHz * std::pow(ratio, float(i) / m_bandCount);
+        int bin = qBound(1, int(std::lround(hz / binHz)), bins - 1);
+        if (i > 0 && bin <= m_bandEdges[i - 1]) bin = qMin(m_bandEdges[i - 1] + 1, bins - 1);
+        m_bandEdges[i] = bin;
+    }
+    m_edgesRate = sampleRate;
+}
+
+void SpectrumWorker::process() {
+    const int sampleRate = m_sampleRate->load(std::memory_order_relaxed);
+    if (sampleRate != m_edgesRate) rebuildBandEdges(sampleRate);
+
+    // Only the newest window matters; drop everything older
+    const size_t avail = m_ring->available();
+    const bool fresh = avail >= size_t(SpectrumAnalyzer::FftSize);
+    if (fresh) {
+        m_ring->peekLatest(m_window.data(), SpectrumAnalyzer::FftSize);
+        m_ring->skip(avail);
+        m_fft.powerSpectrum(m_window.data(), m_power.data());
+    }
+
+    // Full-scale sine through a Hann window peaks at (N/4)^2
+    const float reference = float(SpectrumAnalyzer::FftSize) * SpectrumAnalyzer::FftSize / 16.0f;
+    bool changed = false;
+    for (int b = 0; b < m_bandCount; ++b) {
+        float level = 0.0f;
+        if (fresh) {
+            const int lo = m_bandEdges[b];
+            const int hi = qMax(lo + 1, m_bandEdges[b + 1]);
+            float sum = 0.0f;
+            for (int k = lo; k < hi; ++k) sum += m_power[k];
+            const float db = 10.0f * std::log10(sum / (hi - lo) / reference + 1e-12f);
+            level = qBound(0.0f, (db - kFloorDb) / -kFloorDb, 1.0f);
+        }
+        // Instant attack, exponential release
+        m_levels[b] = level > m_levels[b] ? level : m_levels[b] * kDecay + level * (1.0f - kDecay);
+        if (std::fabs(m_levels[b] - m_published[b]) > kPublishEpsilon) changed = true;
+    }
+
+    if (changed) {
+        m_published = m_levels;
+        emit bandsReady(m_published);
+    }
+}
+
+// =============================================================================
+// ANALYZER (GUI thread facade)
+// =============================================================================
+
+SpectrumAnalyzer::SpectrumAnalyzer(QObject *parent)
+    : QObject(parent),
+      m_ring(FftSize * 8)
+{
+    m_bands.fill(0.0f, m_bandCount);
+
+    m_thread = new QThread(this);
+    m_thread->setObjectName("SpectrumAnalyzer");
+    m_worker = new SpectrumWorker(&m_ring, &m_sampleRate, m_bandCount);
+    m_worker->moveToThread(m_thread);
+    connect(m_worker, &SpectrumWorker::bandsReady, this, &SpectrumAnalyzer::onBandsReady);
+}
+
+SpectrumAnalyzer::~SpectrumAnalyzer() {
+    if (m_thread->isRunning()) {
+        QMetaObject::invokeMethod(m_worker, &SpectrumWorker::stop, Qt::BlockingQueuedConnection);
+        m_thread->quit();
+        m_thread->wait();
+    }
+    delete m_worker;
+}
+
+void SpectrumAnalyzer::setBandCount(int count) {
+    count = qBound(MinBands, count, MaxBands);
+    if (m_bandCount == count) return;
+    m_bandCount = count;
+    m_bands.fill(0.0f, m_bandCount);
+    QMetaObject::invokeMethod(m_worker, [this, count]() { m_worker->setBandCount(count); }, Qt::QueuedConnection);
+    emit bandCountChanged();
+    emit bandsChanged();
+}
+
+void SpectrumAnalyzer::addViewer() {
+    ++m_viewers;
+    updateActive();
+}
+
+void SpectrumAnalyzer::removeViewer() {
+    m_viewers = qMax(0, m_viewers - 1);
+    updateActive();
+}
+
+void SpectrumAnalyzer::setSourceRunning(bool running) {
+    if (m_sourceRunning == running) return;
+    m_sourceRunning = running;
+    updateActive();
+}
+
+void SpectrumAnalyzer::updateActive() {
+    const bool active = m_viewers > 0 && m_sourceRunning;
+    if (m_active == active) return;
+    m_active = active;
+    m_tapEnabled.store(active, std::memory_order_relaxed);
+
+    if (m_active) {
+        m_thread->start(QThread::LowPriority);
+        QMetaObject::invokeMethod(m_worker, &SpectrumWorker::start, Qt::QueuedConnection);
+    } else {
+        QMetaObject::invokeMethod(m_worker, &SpectrumWorker::stop, Qt::BlockingQueuedConnection);
+        m_thread->quit();
+        m_thread->wait();
+        m_bands.fill(0.0f, m_bandCount);
+        emit bandsChanged();
+    }
+    emit activeChanged(m_active);
+}
+
+void SpectrumAnalyzer::onBandsReady(const QList<float> &bands) {
+    // Late frames may still be queued after a stop or band count change
+    if (!m_active || bands.size() != m_bandCount) return;
+    m_bands = bands;
+    emit bandsChanged();
+}
+
+void SpectrumAnalyzer::pushSamples(const float *interleaved, int frames, int channels, int sampleRate) {
+    if (!m_tapEnabled.load(std::memory_order_relaxed) || channels <= 0) return;
+    m_sampleRate.store(sampleRate, std::memory_order_relaxed);
+
+    float mono[kPushChunk];
+    const float scale = 1.0f / channels;
+    while (frames > 0) {
+        const int n = qMin(frames, kPushChunk);
+        for (int i = 0; i < n; ++i) {
+            float sum = 0.0f;
+            for (int c = 0; c < channels; ++c) sum += interleaved[i * channels + c];
+            mono[i] = sum * scale;
+        }
+        m_ring.write(mono, n);
+        interleaved += n * channels;
+        frames -= n;
+    }
+}
+
+void SpectrumAnalyzer::pushSamples(const qint16 *interleaved, int frames, int channels, int sampleRate) {
+    if (!m_tapEnabled.load(std::memory_order_relaxed) || channels <= 0) return;
+    m_sampleRate.store(sampleRate, std::memory_order_relaxed);
+
+    float mono[kPushChunk];
+    const float scale = 1.0f / (32768.0f * channels);
+    while (frames > 0) {
+        const int n = qMin(frames, kPushChunk);
+        for (int i = 0; i < n; ++i) {
+            int sum = 0;
+            for (int c = 0; c < channels; ++c) sum += interleaved[i * channels + c];
+            mono[i] = sum * scale;
+        }
+        m_ring.write(mono, n);
+        interleaved += n * channels;
+        frames -= n;
+    }
+}
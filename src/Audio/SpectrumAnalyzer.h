@@ -0,0 +1,113 @@
+#ifndef SPECTRUMANALYZER_H
+#define SPECTRUMANALYZER_H
+
+#include <QObject>
+#include <QList>
+#include <QThread>
+#include <QTimer>
+#include <atomic>
+#include <vector>
+#include "SpscRingBuffer.h"
+#include "RealFft.h"
+
+/**
+ * @brief Worker living on the analyzer thread.
+ *
+ * Pulls the newest FFT window from the PCM ring at a capped rate, folds the
+ * power spectrum into log-spaced bands and hands them back to the GUI thread.
+ */
+class SpectrumWorker : public QObject
+{
+    Q_OBJECT
+
+public:
+    SpectrumWorker(SpscRingBuffer<float> *ring, const std::atomic<int> *sampleRate, int bandCount);
+
+public slots:
+    void start();
+    void stop();
+    void setBandCount(int count);
+
+signals:
+    void bandsReady(const QList<float> &bands);
+
+private:
+    void process();
+    void rebuildBandEdges(int sampleRate);
+
+    SpscRingBuffer<float> *m_ring;
+    const std::atomic<int> *m_sampleRate;
+    QTimer *m_timer;
+    RealFft m_fft;
+    std::vector<float> m_window;
+    std::vector<float> m_power;
+    std::vector<int> m_bandEdges; // bandCount + 1 bin indices
+    QList<float> m_levels;
+    QList<float> m_published;
+    int m_bandCount;
+    int m_edgesRate = 0;
+};
+
+/**
+ * @brief Real-time spectrum feed for the media visualizers.
+ *
+ * The decoded PCM tap calls pushSamples() (any single thread); the analyzer
+ * thread only runs while at least one view is registered and media is
+ * playing, so a hidden visualizer costs nothing.
+ */
+class SpectrumAnalyzer : public QObject
+{
+    Q_OBJECT
+    Q_PROPERTY(QList<float> bands READ bands NOTIFY bandsChanged)
+    Q_PROPERTY(int bandCount READ bandCount WRITE setBandCount NOTIFY bandCountChanged)
+    Q_PROPERTY(bool active READ isActive NOTIFY activeChanged)
+
+public:
+    static constexpr int FftSize = 2048;
+    static constexpr int MinBands = 16;
+    static constexpr int MaxBands = 32;
+    static constexpr int PublishIntervalMs = 33; // ~30 Hz cap
+
+    explicit SpectrumAnalyzer(QObject *parent = nullptr);
+    ~SpectrumAnalyzer();
+
+    QList<float> bands() const { return m_bands; }
+    int bandCount() const { return m_bandCount; }
+    void setBandCount(int count);
+    bool isActive() const { return m_active; }
+
+    // Visibility reference count, driven by SpectrumBars.qml
+    Q_INVOKABLE void addViewer();
+    Q_INVOKABLE void removeViewer();
+
+    // Set by the owning service: true while there is decoded PCM to look at
+    void setSourceRunning(bool running);
+
+    // PCM tap (producer side). Interleaved float samples, downmixed to mono.
+    void pushSamples(const float *interleaved, int frames, int channels, int sampleRate);
+    void pushSamples(const qint16 *interleaved, int frames, int channels, int sampleRate);
+
+signals:
+    void bandsChanged();
+    void bandCountChanged();
+    void activeChanged(bool active);
+
+private slots:
+    void onBandsReady(const QList<float> &bands);
+
+private:
+    void updateActive();
+
+    SpscRingBuffer<float> m_ring;
+    std::atomic<int> m_sampleRate{48000};
+    QThread *m_thread;
+    SpectrumWorker *m_worker;
+    QList<float> m_bands;
+    int m_bandCount = 24;
+    int m_viewers = 0;
+    bool m_sourceRunning = false;
+    bool m_active = false;
+    std::atomic<bool> m_tapEnabled{false}; // read by the PCM producer thread
+};
+
+#endif // SPECTRUMANALYZER_H
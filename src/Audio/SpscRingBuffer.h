@@ -0,0 +1,106 @@
+#ifndef SPSCRINGBUFFER_H
+#define SPSCRINGBUFFER_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstring>
+#include <vector>
+
+/**
+ * @brief Lock-free single-producer/single-consumer ring of trivially copyable samples.
+ *
+ * One thread may call write(), one other thread may call read()/skip().
+ * Capacity is rounded up to a power of two so indices wrap with a mask;
+ * the read/write counters run free and are only masked on access.
+ */
+template <typename T>
+class SpscRingBuffer
+{
+public:
+    explicit SpscRingBuffer(size_t minCapacity = 4096)
+    {
+        size_t cap = 1;
+        while (cap < minCapacity) cap <<= 1;
+        m_buffer.resize(cap);
+        m_mask = cap - 1;
+    }
+
+    size_t capacity() const { return m_buffer.size(); }
+
+    size_t available() const
+    {
+        return m_write.load(std::memory_order_acquire) - m_read.load(std::memory_order_acquire);
+    }
+
+    size_t freeSpace() const { return capacity() - available(); }
+
+    // Producer side. Returns the number of items actually written.
+    size_t write(const T *data, size_t count)
+    {
+        const size_t w = m_write.load(std::memory_order_relaxed);
+        const size_t r = m_read.load(std::memory_order_acquire);
+        const size_t space = capacity() - (w - r);
+        if (count > space) count = space;
+        copyIn(w, data, count);
+        m_write.store(w + count, std::memory_order_release);
+        return count;
+    }
+
+    // Consumer side. Returns the number of items actually read.
+    size_t read(T *out, size_t count)
+    {
+        const size_t r = m_read.load(std::memory_order_relaxed);
+        const size_t w = m_write.load(std::memory_order_acquire);
+        if (count > w - r) count = w - r;
+        copyOut(r, out, count);
+        m_read.store(r + count, std::memory_order_release);
+        return count;
+    }
+
+    // Consumer side. Copies the most recent `count` items without consuming them.
+    size_t peekLatest(T *out, size_t count) const
+    {
+        const size_t w = m_write.load(std::memory_order_acquire);
+        const size_t r = m_read.load(std::memory_order_relaxed);
+        if (count > w - r) count = w - r;
+        copyOut(w - count, out, count);
+        return count;
+    }
+
+    // Consumer side. Drops up to `count` of the oldest items.
+    size_t skip(size_t count)
+    {
+        const size_t r = m_read.load(std::memory_order_relaxed);
+        const size_t w = m_write.load(std::memory_order_acquire);
+        if (count > w - r) count = w - r;
+        m_read.store(r + count, std::memory_order_release);
+        return count;
+    }
+
+    // Consumer side. Discards everything currently buffered.
+    void reset() { m_read.store(m_write.load(std::memory_order_acquire), std::memory_order_release); }
+
+private:
+    void copyIn(size_t pos, const T *data, size_t count)
+    {
+        const size_t start = pos & m_mask;
+        const size_t first = count < capacity() - start ? count : capacity() - start;
+        std::memcpy(m_buffer.data() + start, data, first * sizeof(T));
+        std::memcpy(m_buffer.data(), data + first, (count - first) * sizeof(T));
+    }
+
+    void copyOut(size_t pos, T *out, size_t count) const
+    {
+        const size_t start = pos & m_mask;
+        const size_t first = count < capacity() - start ? count : capacity() - start;
+        std::memcpy(out, m_buffer.data() + start, first * sizeof(T));
+        std::memcpy(out + first, m_buffer.data(), (count - first) * sizeof(T));
+    }
+
+    std::vector<T> m_buffer;
+    size_t m_mask = 0;
+    alignas(64) std::atomic<size_t> m_write{0};
+    alignas(64) std::atomic<size_t> m_read{0};
+};
+
+#endif // SPSCRINGBUFFER_H
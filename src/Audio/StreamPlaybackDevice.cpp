@@ -0,0 +1,153 @@
+#include "StreamPlaybackDevice.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+namespace {
+constexpr size_t kStagingFrames = 256;
+constexpr int kUnderrunStepMs = 20;
+constexpr int kRelaxStepMs = 10;
+constexpr int kRelaxAfterSeconds = 30;
+constexpr double kMaxCorrection = 0.005; // +/-0.5% (5000 ppm)
+constexpr double kDriftGain = 0.01;
+constexpr double kErrorSmoothing = 0.002;
+}
+
+StreamPlaybackDevice::StreamPlaybackDevice(StreamState *state, QObject *parent)
+    : QIODevice(parent),
+      m_state(state),
+      m_staging(kStagingFrames * StreamState::Channels)
+{
+}
+
+void StreamPlaybackDevice::resetPlayback() {
+    m_stagingPos = 0;
+    m_stagingLen = 0;
+    std::fill(std::begin(m_prev), std::end(m_prev), 0.0f);
+    std::fill(std::begin(m_cur), std::end(m_cur), 0.0f);
+    m_phase = 1.0;
+    m_errorAvg = 0.0;
+    m_prefilling = true;
+    m_framesSinceUnderrun = 0;
+}
+
+qint64 StreamPlaybackDevice::bytesAvailable() const {
+    // Live source: always offer data, silence covers the gaps
+    return qint64(kStagingFrames * StreamState::Channels * sizeof(qint16)) + QIODevice::bytesAvailable();
+}
+
+qint64 StreamPlaybackDevice::writeData(const char *, qint64) {
+    return -1;
+}
+
+bool StreamPlaybackDevice::nextInputFrame() {
+    if (m_stagingPos + StreamState::Channels > m_stagingLen) {
+        m_stagingLen = m_state->ring.read(m_staging.data(), m_staging.size());
+        m_stagingPos = 0;
+        if (m_stagingLen < size_t(StreamState::Channels)) return false;
+    }
+    for (int c = 0; c < StreamState::Channels; ++c) {
+        m_prev[c] = m_cur[c];
+        m_cur[c] = m_staging[m_stagingPos + c];
+    }
+    m_stagingPos += StreamState::Channels;
+    return true;
+}
+
+void StreamPlaybackDevice::onUnderrun() {
+    m_state->underruns.fetch_add(1, std::memory_order_relaxed);
+    const int target = m_state->targetMs.load(std::memory_order_relaxed);
+    m_state->targetMs.store(qMin(StreamState::MaxTargetMs, target + kUnderrunStepMs), std::memory_order_relaxed);
+    m_prefilling = true;
+    m_framesSinceUnderrun = 0;
+}
+
+void StreamPlaybackDevice::adaptTarget() {
+    const int rate = m_state->sampleRate.load(std::memory_order_relaxed);
+    const int jitterMs = m_state->jitterUs.load(std::memory_order_relaxed) / 1000;
+    const int floorMs = qBound(StreamState::MinTargetMs, 4 * jitterMs + 20, StreamState::MaxTargetMs);
+    int target = m_state->targetMs.load(std::memory_order_relaxed);
+
+    if (target < floorMs) {
+        target = floorMs; // jitter grew: deepen right away
+    } else if (m_framesSinceUnderrun > quint64(rate) * kRelaxAfterSeconds) {
+        target = qMax(floorMs, target - kRelaxStepMs); // stable: claw latency back slowly
+        m_framesSinceUnderrun = 0;
+    }
+    m_state->targetMs.store(target, std::memory_order_relaxed);
+}
+
+int StreamPlaybackDevice::render(float *out, int frames, int outputRate) {
+    if (m_state->flushRequested.exchange(false)) {
+        m_state->ring.skip(m_state->ring.available());
+        resetPlayback();
+    }
+
+    // Paused or deselected: silence without counting it as an underrun
+    if (!m_state->accepting.load(std::memory_order_relaxed)) {
+        std::memset(out, 0, size_t(frames) * StreamState::Channels * sizeof(float));
+        m_prefilling = true;
+        return 0;
+    }
+    if (m_state->holding.load(std::memory_order_relaxed)) {
+        std::memset(out, 0, size_t(frames) * StreamState::Channels * sizeof(float));
+        return 0;
+    }
+
+    const int target = m_state->targetMs.load(std::memory_order_relaxed);
+    const int fill = m_state->fillMs();
+    if (m_prefilling) {
+        if (fill < target) {
+            std::memset(out, 0, size_t(frames) * StreamState::Channels * sizeof(float));
+            return 0;
+        }
+        m_prefilling = false;
+    }
+
+    // Drift compensation: hold the ring at its target depth by consuming
+    // slightly faster (producer clock ahead) or slower (producer behind).
+    // The same interpolator converts the source rate to the output rate.
+    const double error = double(fill - target) / qMax(1, target);
+    m_errorAvg += kErrorSmoothing * (error - m_errorAvg);
+    const double correction = qBound(-kMaxCorrection, m_errorAvg * kDriftGain, kMaxCorrection);
+    const int inputRate = m_state->sampleRate.load(std::memory_order_relaxed);
+    const double step = double(inputRate) / qMax(1, outputRate) * (1.0 + correction);
+    m_state->driftPpm.store(int(correction * 1e6), std::memory_order_relaxed);
+
+    int produced = 0;
+    for (; produced < frames; ++produced) {
+        bool starved = false;
+        while (m_phase >= 1.0) {
+            if (!nextInputFrame()) { starved = true; break; }
+            m_phase -= 1.0;
+        }
+        if (starved) {
+            onUnderrun();
+            break;
+        }
+        const float t = float(m_phase);
+        for (int c = 0; c < StreamState::Channels; ++c)
+            out[produced * StreamState::Channels + c] = m_prev[c] + (m_cur[c] - m_prev[c]) * t;
+        m_phase += step;
+    }
+
+    if (produced < frames)
+        std::memset(out + produced * StreamState::Channels, 0, size_t(frames - produced) * StreamState::Channels * sizeof(float));
+
+    m_state->framesPlayed.fetch_add(quint64(produced), std::memory_order_relaxed);
+    m_framesSinceUnderrun += quint64(produced);
+    adaptTarget();
+    return produced;
+}
+
+qint64 StreamPlaybackDevice::readData(char *data, qint64 maxlen) {
+    const qint64 bytesPerFrame = StreamState::Channels * qint64(sizeof(qint16));
+    const int frames = int(maxlen / bytesPerFrame);
+    m_mix.resize(size_t(frames) * StreamState::Channels);
+    render(m_mix.data(), frames, m_state->sampleRate.load(std::memory_order_relaxed));
+
+    qint16 *out = reinterpret_cast<qint16 *>(data);
+    for (size_t i = 0; i < m_mix.size(); ++i)
+        out[i] = qint16(qBound(-32768L, std::lround(m_mix[i] * 32767.0f), 32767L));
+    return frames * bytesPerFrame;
+}
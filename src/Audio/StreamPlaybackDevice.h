@@ -0,0 +1,83 @@
+#ifndef STREAMPLAYBACKDEVICE_H
+#define STREAMPLAYBACKDEVICE_H
+
+#include <QIODevice>
+#include <atomic>
+#include <vector>
+#include "SpscRingBuffer.h"
+
+/**
+ * @brief State shared between a live PCM producer thread, the audio pull
+ * callback (consumer) and the GUI thread (stats only).
+ */
+struct StreamState {
+    static constexpr int Channels = 2;      // ring is always interleaved stereo float
+    static constexpr int MinTargetMs = 40;
+    static constexpr int MaxTargetMs = 300;
+
+    SpscRingBuffer<float> ring{1 << 17};    // ~1.3 s at 48 kHz stereo
+    std::atomic<int> sampleRate{48000};
+    std::atomic<bool> accepting{false};     // false: producer data is drained and dropped
+    std::atomic<bool> holding{false};       // true: output silence but keep the buffered audio
+    std::atomic<bool> flushRequested{false};
+    std::atomic<int> jitterUs{0};           // RFC 3550 style inter-arrival jitter
+    std::atomic<int> targetMs{60};          // adaptive jitter buffer depth
+    std::atomic<int> driftPpm{0};           // current resampling correction
+    std::atomic<quint32> underruns{0};
+    std::atomic<quint32> overruns{0};
+    std::atomic<quint64> framesReceived{0};
+    std::atomic<quint64> framesPlayed{0};
+
+    int fillMs() const {
+        const int rate = sampleRate.load(std::memory_order_relaxed);
+        return rate > 0 ? int(ring.available() / Channels * 1000 / size_t(rate)) : 0;
+    }
+};
+
+/**
+ * @brief Pull-mode reader of a live PCM ring, used by the audio mixer
+ * (render()) or directly as a QAudioSink device (readData()).
+ *
+ * Implements the jitter buffer (prefill to the adaptive target, re-prefill
+ * after an underrun) and clock-drift compensation: a fractional linear
+ * resampler nudged by at most +/-0.5% to hold the ring at its target depth.
+ */
+class StreamPlaybackDevice : public QIODevice
+{
+    Q_OBJECT
+
+public:
+    explicit StreamPlaybackDevice(StreamState *state, QObject *parent = nullptr);
+
+    void resetPlayback();
+
+    // Consumer side: fills `frames` interleaved stereo frames at `outputRate`
+    // (silence where nothing is due). Returns the frames that carried audio.
+    int render(float *out, int frames, int outputRate);
+
+    bool isSequential() const override { return true; }
+    qint64 bytesAvailable() const override;
+
+protected:
+    qint64 readData(char *data, qint64 maxlen) override;
+    qint64 writeData(const char *data, qint64 len) override;
+
+private:
+    bool nextInputFrame();
+    void onUnderrun();
+    void adaptTarget();
+
+    StreamState *m_state;
+    std::vector<float> m_staging;
+    std::vector<float> m_mix;   // readData() scratch
+    size_t m_stagingPos = 0;
+    size_t m_stagingLen = 0;
+    float m_prev[StreamState::Channels] = {0, 0};
+    float m_cur[StreamState::Channels] = {0, 0};
+    double m_phase = 1.0;
+    double m_errorAvg = 0.0;
+    bool m_prefilling = true;
+    quint64 m_framesSinceUnderrun = 0;
+};
+
+#endif // STREAMPLAYBACKDEVICE_H
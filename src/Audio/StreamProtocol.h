@@ -0,0 +1,44 @@
+#ifndef STREAMPROTOCOL_H
+#define STREAMPROTOCOL_H
+
+#include <QtGlobal>
+#include <QString>
+
+/**
+ * @brief Wire format of the local A2DP stand-in socket.
+ *
+ * Every frame is a fixed 24-byte little-endian header followed by
+ * `payloadBytes` of codec data. The producer (BlueZ bridge or the
+ * pcm_feed_client test tool) sends frames in real time.
+ */
+namespace StreamProtocol {
+
+constexpr quint32 Magic = 0x5341484E; // "NHAS"
+constexpr quint32 MaxPayloadBytes = 64 * 1024;
+
+enum Codec : quint8 {
+    CodecPcmS16 = 0,   // interleaved signed 16-bit little-endian
+    CodecSbc = 1,
+    CodecAac = 2,
+    CodecMetadata = 0x7F // UTF-8 "title\x1Fartist"
+};
+
+#pragma pack(push, 1)
+struct FrameHeader {
+    quint32 magic;
+    quint8 codec;
+    quint8 channels;
+    quint16 reserved;
+    quint32 sampleRate;
+    quint32 payloadBytes;
+    quint64 timestampUs; // producer clock, informational
+};
+#pragma pack(pop)
+
+static_assert(sizeof(FrameHeader) == 24, "StreamProtocol::FrameHeader must stay 24 bytes");
+
+inline QString defaultSocketName() { return QStringLiteral("nordic-a2dp-sink"); }
+
+} // namespace StreamProtocol
+
+#endif // STREAMPROTOCOL_H
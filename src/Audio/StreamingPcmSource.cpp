@@ -0,0 +1,294 @@
+#include "StreamingPcmSource.h"
+#include "SpectrumAnalyzer.h"
+#include <QLocalServer>
+#include <QLocalSocket>
+#include <QtEndian>
+#include <QDebug>
+#include <cmath>
+#include <cstring>
+
+Q_LOGGING_CATEGORY(vcBluetoothStream, "nordic.audio.bluetooth")
+
+// =============================================================================
+// RECEIVER (socket thread)
+// =============================================================================
+
+StreamReceiver::StreamReceiver(StreamState *state)
+    : QObject(nullptr),
+      m_state(state)
+{
+    m_clock.start();
+}
+
+void StreamReceiver::listen(const QString &socketName) {
+    if (!m_server) {
+        m_server = new QLocalServer(this);
+        connect(m_server, &QLocalServer::newConnection, this, &StreamReceiver::onNewConnection);
+    }
+    // A stale socket file from a crashed run would make listen() fail
+    QLocalServer::removeServer(socketName);
+    if (!m_server->listen(socketName)) {
+        emit errorOccurred("Stream socket unavailable: " + m_server->errorString());
+        return;
+    }
+    qCInfo(vcBluetoothStream) << "Listening on" << m_server->fullServerName();
+}
+
+void StreamReceiver::close() {
+    if (m_socket) {
+        m_socket->disconnect(this);
+        m_socket->abort();
+        m_socket->deleteLater();
+        m_socket = nullptr;
+    }
+    if (m_server) m_server->close();
+}
+
+void StreamReceiver::onNewConnection() {
+    while (QLocalSocket *incoming = m_server->nextPendingConnection()) {
+        if (m_socket) {
+            // One producer at a time, like a single A2DP sink endpoint
+            incoming->abort();
+            incoming->deleteLater();
+            continue;
+        }
+        m_socket = incoming;
+        m_pending.clear();
+        m_lastArrivalUs = -1;
+        m_jitterUs = 0.0;
+        m_reportedCodec = StreamProtocol::CodecPcmS16;
+        connect(m_socket, &QLocalSocket::readyRead, this, &StreamReceiver::onReadyRead);
+        connect(m_socket, &QLocalSocket::disconnected, this, &StreamReceiver::onDisconnected);
+        emit producerConnected();
+    }
+}
+
+void StreamReceiver::onDisconnected() {
+    if (!m_socket) return;
+    m_socket->deleteLater();
+    m_socket = nullptr;
+    m_pending.clear();
+    emit producerDisconnected();
+}
+
+void StreamReceiver::onReadyRead() {
+    using StreamProtocol::FrameHeader;
+    m_pending.append(m_socket->readAll());
+
+    qsizetype offset = 0;
+    while (m_pending.size() - offset >= qsizetype(sizeof(FrameHeader))) {
+        FrameHeader header;
+        std::memcpy(&header, m_pending.constData() + offset, sizeof(FrameHeader));
+        header.magic = qFromLittleEndian(header.magic);
+        header.sampleRate = qFromLittleEndian(header.sampleRate);
+        header.payloadBytes = qFromLittleEndian(header.payloadBytes);
+        header.timestampUs = qFromLittleEndian(header.timestampUs);
+
+        if (header.magic != StreamProtocol::Magic) {
+            // Lost framing: resync on the next magic
+            ++offset;
+            continue;
+        }
+        if (header.payloadBytes > StreamProtocol::MaxPayloadBytes) {
+            emit errorOccurred("Stream frame too large, dropping producer");
+            m_socket->abort();
+            return;
+        }
+        const qsizetype frameBytes = qsizetype(sizeof(FrameHeader)) + header.payloadBytes;
+        if (m_pending.size() - offset < frameBytes) break;
+
+        handleFrame(header, m_pending.constData() + offset + sizeof(FrameHeader));
+        offset += frameBytes;
+    }
+    if (offset > 0) m_pending.remove(0, offset);
+}
+
+void StreamReceiver::handleFrame(const StreamProtocol::FrameHeader &header, const char *payload) {
+    switch (header.codec) {
+    case StreamProtocol::CodecPcmS16:
+        handlePcm(header, payload);
+        break;
+    case StreamProtocol::CodecMetadata: {
+        const QStringList parts = QString::fromUtf8(payload, header.payloadBytes).split(QChar(0x1F));
+        emit metadataReceived(parts.value(0), parts.value(1));
+        break;
+    }
+    case StreamProtocol::CodecSbc:
+    case StreamProtocol::CodecAac:
+        // Frames are parsed and counted but there is no codec backend to decode them
+        if (m_reportedCodec != header.codec) {
+            m_reportedCodec = header.codec;
+            emit errorOccurred(header.codec == StreamProtocol::CodecSbc
+                                   ? "SBC decoding is not available in this build"
+                                   : "AAC decoding is not available in this build");
+        }
+        break;
+    default:
+        break;
+    }
+}
+
+void StreamReceiver::handlePcm(const StreamProtocol::FrameHeader &header, const char *payload) {
+    const int channels = header.channels;
+    if ((channels != 1 && channels != 2) || header.sampleRate == 0) return;
+    const int frames = int(header.payloadBytes / (sizeof(qint16) * channels));
+    if (frames == 0) return;
+
+    const int rate = int(header.sampleRate);
+    if (m_state->sampleRate.exchange(rate) != rate) {
+        m_state->flushRequested.store(true);
+        emit formatChanged(rate);
+    }
+    updateJitter(qint64(frames) * 1000000 / rate);
+    if (!m_state->accepting.load(std::memory_order_relaxed)) return;
+
+    // Normalize to interleaved stereo float
+    m_scratch.resize(size_t(frames) * StreamState::Channels);
+    const uchar *src = reinterpret_cast<const uchar *>(payload);
+    for (int i = 0; i < frames; ++i) {
+        const float l = qFromLittleEndian<qint16>(src + (i * channels) * 2) / 32768.0f;
+        const float r = channels == 2 ? qFromLittleEndian<qint16>(src + (i * channels + 1) * 2) / 32768.0f : l;
+        m_scratch[i * 2] = l;
+        m_scratch[i * 2 + 1] = r;
+    }
+
+    const size_t written = m_state->ring.write(m_scratch.data(), m_scratch.size());
+    if (written < m_scratch.size()) m_state->overruns.fetch_add(1, std::memory_order_relaxed);
+    m_state->framesReceived.fetch_add(written / StreamState::Channels, std::memory_order_relaxed);
+
+    if (m_spectrum) m_spectrum->pushSamples(m_scratch.data(), frames, StreamState::Channels, rate);
+}
+
+void StreamReceiver::updateJitter(qint64 frameDurationUs) {
+    const qint64 now = m_clock.nsecsElapsed() / 1000;
+    if (m_lastArrivalUs >= 0) {
+        const double d = double((now - m_lastArrivalUs) - m_lastDurationUs);
+        m_jitterUs += (std::fabs(d) - m_jitterUs) / 16.0;
+        m_state->jitterUs.store(int(m_jitterUs), std::memory_order_relaxed);
+    }
+    m_lastArrivalUs = now;
+    m_lastDurationUs = frameDurationUs;
+}
+
+// =============================================================================
+// SOURCE (GUI thread)
+// =============================================================================
+
+StreamingPcmSource::StreamingPcmSource(QObject *parent)
+    : QObject(parent)
+{
+    m_thread = new QThread(this);
+    m_thread->setObjectName("BluetoothStream");
+    m_receiver = new StreamReceiver(&m_state);
+    m_receiver->moveToThread(m_thread);
+
+    connect(m_receiver, &StreamReceiver::producerConnected, this, &StreamingPcmSource::onProducerConnected);
+    connect(m_receiver, &StreamReceiver::producerDisconnected, this, &StreamingPcmSource::onProducerDisconnected);
+    connect(m_receiver, &StreamReceiver::formatChanged, this, &StreamingPcmSource::onFormatChanged);
+    connect(m_receiver, &StreamReceiver::metadataReceived, this, &StreamingPcmSource::onMetadata);
+    connect(m_receiver, &StreamReceiver::errorOccurred, this, &StreamingPcmSource::onError);
+
+    m_device = new StreamPlaybackDevice(&m_state, this);
+    m_device->open(QIODevice::ReadOnly);
+
+    m_statsTimer = new QTimer(this);
+    m_statsTimer->setInterval(500);
+    connect(m_statsTimer, &QTimer::timeout, this, &StreamingPcmSource::updateStats);
+}
+
+StreamingPcmSource::~StreamingPcmSource() {
+    if (m_thread->isRunning()) {
+        QMetaObject::invokeMethod(m_receiver, &StreamReceiver::close, Qt::BlockingQueuedConnection);
+        m_thread->quit();
+        m_thread->wait();
+    }
+    delete m_receiver;
+}
+
+void StreamingPcmSource::start(const QString &socketName) {
+    if (!m_thread->isRunning()) m_thread->start(QThread::HighPriority);
+    QMetaObject::invokeMethod(m_receiver, [this, socketName]() { m_receiver->listen(socketName); }, Qt::QueuedConnection);
+}
+
+void StreamingPcmSource::setSpectrumTap(SpectrumAnalyzer *spectrum) {
+    QMetaObject::invokeMethod(m_receiver, [this, spectrum]() { m_receiver->setSpectrumTap(spectrum); }, Qt::QueuedConnection);
+}
+
+void StreamingPcmSource::setOutputActive(bool active) {
+    if (m_outputActive == active) return;
+    m_outputActive = active;
+    updateAccepting();
+}
+
+void StreamingPcmSource::setPaused(bool paused) {
+    if (m_paused == paused) return;
+    m_paused = paused;
+    updateAccepting();
+    emit pausedChanged();
+}
+
+void StreamingPcmSource::updateAccepting() {
+    const bool accepting = m_connected && m_outputActive && !m_paused;
+    // Resuming a live stream starts from "now", not from stale buffered audio
+    if (m_state.accepting.exchange(accepting) != accepting && !accepting)
+        m_state.flushRequested.store(true);
+    if (accepting) m_statsTimer->start();
+    else m_statsTimer->stop();
+}
+
+void StreamingPcmSource::onProducerConnected() {
+    m_connected = true;
+    if (!m_errorMessage.isEmpty()) {
+        m_errorMessage.clear();
+        emit errorChanged();
+    }
+    m_state.underruns.store(0);
+    m_state.targetMs.store(60);
+    updateAccepting();
+    emit connectedChanged();
+}
+
+void StreamingPcmSource::onProducerDisconnected() {
+    m_connected = false;
+    updateAccepting();
+    m_title.clear();
+    m_artist.clear();
+    emit metadataChanged();
+    emit connectedChanged();
+}
+
+void StreamingPcmSource::onFormatChanged(int sampleRate) {
+    // The playback device resamples to the mixer rate; nothing to reopen
+    qCDebug(vcBluetoothStream) << "Format:" << sampleRate << "Hz";
+}
+
+void StreamingPcmSource::onMetadata(const QString &title, const QString &artist) {
+    if (m_title == title && m_artist == artist) return;
+    m_title = title;
+    m_artist = artist;
+    emit metadataChanged();
+}
+
+void StreamingPcmSource::onError(const QString &message) {
+    qWarning() << "Bluetooth stream:" << message;
+    m_errorMessage = message;
+    emit errorChanged();
+}
+
+void StreamingPcmSource::updateStats() {
+    const int latency = m_state.fillMs();
+    const int jitter = m_state.jitterUs.load() / 1000;
+    const int target = m_state.targetMs.load();
+    const int drift = m_state.driftPpm.load();
+    const int underruns = int(m_state.underruns.load());
+
+    if (latency == m_latencyMs && jitter == m_jitterMs && target == m_targetMs
+        && drift == m_driftPpm && underruns == m_underruns) return;
+
+    m_latencyMs = latency;
+    m_jitterMs = jitter;
+    m_targetMs = target;
+    m_driftPpm = drift;
+    m_underruns = underruns;
+    emit statsChanged();
+}
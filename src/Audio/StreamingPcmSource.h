@@ -0,0 +1,154 @@
+#ifndef STREAMINGPCMSOURCE_H
+#define STREAMINGPCMSOURCE_H
+
+#include <QObject>
+#include <QThread>
+#include <QTimer>
+#include <QByteArray>
+#include <QElapsedTimer>
+#include <QLoggingCategory>
+#include <atomic>
+#include <vector>
+#include "StreamPlaybackDevice.h"
+#include "StreamProtocol.h"
+
+class QLocalServer;
+class QLocalSocket;
+class SpectrumAnalyzer;
+
+/**
+ * @brief Socket side. Lives on its own thread so GUI stalls never delay ingest.
+ */
+class StreamReceiver : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit StreamReceiver(StreamState *state);
+
+    void setSpectrumTap(SpectrumAnalyzer *spectrum) { m_spectrum = spectrum; }
+
+public slots:
+    void listen(const QString &socketName);
+    void close();
+
+signals:
+    void producerConnected();
+    void producerDisconnected();
+    void formatChanged(int sampleRate);
+    void metadataReceived(const QString &title, const QString &artist);
+    void errorOccurred(const QString &message);
+
+private slots:
+    void onNewConnection();
+    void onReadyRead();
+    void onDisconnected();
+
+private:
+    void handleFrame(const StreamProtocol::FrameHeader &header, const char *payload);
+    void handlePcm(const StreamProtocol::FrameHeader &header, const char *payload);
+    void updateJitter(qint64 frameDurationUs);
+
+    StreamState *m_state;
+    SpectrumAnalyzer *m_spectrum = nullptr;
+    QLocalServer *m_server = nullptr;
+    QLocalSocket *m_socket = nullptr;
+    QByteArray m_pending;
+    std::vector<float> m_scratch;
+    QElapsedTimer m_clock;
+    qint64 m_lastArrivalUs = -1;
+    qint64 m_lastDurationUs = 0;
+    double m_jitterUs = 0.0;
+    quint8 m_reportedCodec = StreamProtocol::CodecPcmS16;
+};
+
+/**
+ * @brief Streaming "Bluetooth" media source.
+ *
+ * Accepts PCM frames from a local producer over a Unix domain socket (a
+ * stand-in for a BlueZ A2DP sink), buffers them through a lock-free SPSC
+ * ring and hands them to the audio mixer through playbackDevice() (the
+ * mixer's media bus renders it). SBC/AAC frames are recognised but
+ * need a codec backend this build does not ship, so they are reported and
+ * dropped.
+ */
+class StreamingPcmSource : public QObject
+{
+    Q_OBJECT
+    Q_PROPERTY(bool connected READ isConnected NOTIFY connectedChanged)
+    Q_PROPERTY(bool paused READ isPaused NOTIFY pausedChanged)
+    Q_PROPERTY(QString title READ title NOTIFY metadataChanged)
+    Q_PROPERTY(QString artist READ artist NOTIFY metadataChanged)
+    Q_PROPERTY(int latencyMs READ latencyMs NOTIFY statsChanged)
+    Q_PROPERTY(int jitterMs READ jitterMs NOTIFY statsChanged)
+    Q_PROPERTY(int bufferTargetMs READ bufferTargetMs NOTIFY statsChanged)
+    Q_PROPERTY(int driftPpm READ driftPpm NOTIFY statsChanged)
+    Q_PROPERTY(int underrunCount READ underrunCount NOTIFY statsChanged)
+    Q_PROPERTY(QString errorMessage READ errorMessage NOTIFY errorChanged)
+
+public:
+    explicit StreamingPcmSource(QObject *parent = nullptr);
+    ~StreamingPcmSource();
+
+    void start(const QString &socketName = StreamProtocol::defaultSocketName());
+
+    // Output routing: only the selected source accepts and plays audio
+    void setOutputActive(bool active);
+    bool isOutputActive() const { return m_outputActive; }
+    StreamPlaybackDevice *playbackDevice() const { return m_device; }
+
+    void setPaused(bool paused);
+    void setSpectrumTap(SpectrumAnalyzer *spectrum);
+
+    bool isConnected() const { return m_connected; }
+    bool isPaused() const { return m_paused; }
+    QString title() const { return m_title; }
+    QString artist() const { return m_artist; }
+    int latencyMs() const { return m_latencyMs; }
+    int jitterMs() const { return m_jitterMs; }
+    int bufferTargetMs() const { return m_targetMs; }
+    int driftPpm() const { return m_driftPpm; }
+    int underrunCount() const { return m_underruns; }
+    QString errorMessage() const { return m_errorMessage; }
+    quint64 framesReceived() const { return m_state.framesReceived.load(); }
+
+signals:
+    void connectedChanged();
+    void pausedChanged();
+    void metadataChanged();
+    void statsChanged();
+    void errorChanged();
+
+private slots:
+    void onProducerConnected();
+    void onProducerDisconnected();
+    void onFormatChanged(int sampleRate);
+    void onMetadata(const QString &title, const QString &artist);
+    void onError(const QString &message);
+    void updateStats();
+
+private:
+    void updateAccepting();
+
+    StreamState m_state;
+    QThread *m_thread;
+    StreamReceiver *m_receiver;
+    StreamPlaybackDevice *m_device;
+    QTimer *m_statsTimer;
+
+    bool m_connected = false;
+    bool m_paused = false;
+    bool m_outputActive = false;
+    QString m_title;
+    QString m_artist;
+    QString m_errorMessage;
+    int m_latencyMs = 0;
+    int m_jitterMs = 0;
+    int m_targetMs = 0;
+    int m_driftPpm = 0;
+    int m_underruns = 0;
+};
+
+Q_DECLARE_LOGGING_CATEGORY(vcBluetoothStream)
+
+#endif // STREAMINGPCMSOURCE_H
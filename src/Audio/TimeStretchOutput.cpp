@@ -0,0 +1,83 @@
+#include "TimeStretchOutput.h"
+
+TimeStretchOutput::TimeStretchOutput(QObject *parent)
+    : QObject(parent)
+{
+    m_device = new StreamPlaybackDevice(&m_state, this);
+    m_device->open(QIODevice::ReadOnly);
+}
+
+void TimeStretchOutput::setEngaged(bool engaged) {
+    if (m_engaged == engaged) return;
+    m_engaged = engaged;
+    m_state.accepting.store(engaged);
+    flush();
+}
+
+void TimeStretchOutput::setTempo(double tempo) {
+    m_tempo.store(qBound(TimeStretcher::MinTempo, tempo, TimeStretcher::MaxTempo));
+}
+
+void TimeStretchOutput::setPaused(bool paused) {
+    // The player stops delivering while paused; hold what is buffered
+    // instead of draining it into an underrun
+    m_state.holding.store(paused);
+}
+
+void TimeStretchOutput::flush() {
+    m_resetRequested.store(true);
+    m_state.flushRequested.store(true);
+}
+
+// =============================================================================
+// PRODUCER (decoder thread)
+// =============================================================================
+
+void TimeStretchOutput::pushSamples(const float *data, int frames, int channels, int sampleRate) {
+    if (!m_state.accepting.load(std::memory_order_relaxed) || frames <= 0 || channels <= 0) return;
+    m_input.resize(size_t(frames) * StreamState::Channels);
+    for (int i = 0; i < frames; ++i) {
+        const float *frame = data + size_t(i) * channels;
+        m_input[size_t(i) * 2] = frame[0];
+        m_input[size_t(i) * 2 + 1] = channels > 1 ? frame[1] : frame[0];
+    }
+    stretchAndQueue(frames, sampleRate);
+}
+
+void TimeStretchOutput::pushSamples(const qint16 *data, int frames, int channels, int sampleRate) {
+    if (!m_state.accepting.load(std::memory_order_relaxed) || frames <= 0 || channels <= 0) return;
+    m_input.resize(size_t(frames) * StreamState::Channels);
+    for (int i = 0; i < frames; ++i) {
+        const qint16 *frame = data + size_t(i) * channels;
+        m_input[size_t(i) * 2] = frame[0] / 32768.0f;
+        m_input[size_t(i) * 2 + 1] = (channels > 1 ? frame[1] : frame[0]) / 32768.0f;
+    }
+    stretchAndQueue(frames, sampleRate);
+}
+
+void TimeStretchOutput::stretchAndQueue(int frames, int sampleRate) {
+    if (sampleRate != m_stretcher.sampleRate()) {
+        m_stretcher.configure(sampleRate);
+        m_resetRequested.store(false);
+    } else if (m_resetRequested.exchange(false)) {
+        m_stretcher.reset();
+    }
+    // The reader resamples to the mixer rate, a new rate only invalidates the buffer
+    if (m_state.sampleRate.exchange(sampleRate) != sampleRate)
+        m_state.flushRequested.store(true);
+
+    const double tempo = m_tempo.load(std::memory_order_relaxed);
+    if (tempo == 1.0) {
+        // Pass-through; the next stretched segment starts from a clean state
+        m_resetRequested.store(true);
+        m_output.swap(m_input);
+    } else {
+        m_stretcher.setTempo(tempo);
+        m_output.clear();
+        if (m_stretcher.process(m_input.data(), frames, m_output) == 0) return;
+    }
+
+    const size_t written = m_state.ring.write(m_output.data(), m_output.size());
+    if (written < m_output.size()) m_state.overruns.fetch_add(1, std::memory_order_relaxed);
+    m_state.framesReceived.fetch_add(written / StreamState::Channels, std::memory_order_relaxed);
+}
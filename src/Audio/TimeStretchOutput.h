@@ -0,0 +1,58 @@
+#ifndef TIMESTRETCHOUTPUT_H
+#define TIMESTRETCHOUTPUT_H
+
+#include <QObject>
+#include <atomic>
+#include <vector>
+#include "StreamPlaybackDevice.h"
+#include "TimeStretcher.h"
+
+/**
+ * @brief Library playback output stage feeding the audio mixer.
+ *
+ * While engaged, MediaService runs the player without a backend audio
+ * output and feeds its decoded PCM tap into pushSamples(). At speed 1.0 the
+ * PCM passes straight through; at other speeds the buffers arrive `tempo`
+ * times faster than real time and the WSOLA stage brings them back to real
+ * time at the original pitch. Either way the result reaches the mixer's
+ * media bus through the same jitter-buffered, drift-corrected reader as the
+ * Bluetooth stream.
+ */
+class TimeStretchOutput : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit TimeStretchOutput(QObject *parent = nullptr);
+
+    void setEngaged(bool engaged);
+    bool isEngaged() const { return m_engaged; }
+
+    void setTempo(double tempo);
+    void setPaused(bool paused);
+    StreamPlaybackDevice *playbackDevice() const { return m_device; }
+    // Drops buffered audio, e.g. after a seek or a track change
+    void flush();
+
+    // Producer side (the player's decoder thread)
+    void pushSamples(const float *data, int frames, int channels, int sampleRate);
+    void pushSamples(const qint16 *data, int frames, int channels, int sampleRate);
+
+private:
+    void stretchAndQueue(int frames, int sampleRate);
+
+    StreamState m_state;
+    StreamPlaybackDevice *m_device;
+
+    // Producer thread only
+    TimeStretcher m_stretcher;
+    std::vector<float> m_input;
+    std::vector<float> m_output;
+
+    std::atomic<double> m_tempo{1.0};
+    std::atomic<bool> m_resetRequested{false};
+
+    bool m_engaged = false;
+};
+
+#endif // TIMESTRETCHOUTPUT_H
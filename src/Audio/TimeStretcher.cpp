@@ -0,0 +1,147 @@
+#include "TimeStretcher.h"
+#include "SimdOps.h"
+#include <algorithm>
+#include <cmath>
+
+namespace {
+constexpr double kWindowSeconds = 0.020;
+constexpr double kSearchSeconds = 0.008;
+constexpr int kCoarseStep = 4;           // lag stride of the first search pass
+constexpr double kEnergyFloor = 1e-9;
+constexpr double kTwoPi = 6.283185307179586;
+}
+
+TimeStretcher::TimeStretcher(int sampleRate)
+{
+    configure(sampleRate);
+}
+
+void TimeStretcher::configure(int sampleRate)
+{
+    m_sampleRate = sampleRate;
+    // Multiples of 8 keep the SIMD loops free of scalar tails
+    m_window = std::max(64, int(sampleRate * kWindowSeconds) / 8 * 8);
+    m_hop = m_window / 2;
+    m_search = std::max(kCoarseStep, int(sampleRate * kSearchSeconds) / kCoarseStep * kCoarseStep);
+
+    // Periodic Hann sums to exactly 1 at 50% overlap. Stored interleaved so
+    // the overlap-add runs over both channels in one contiguous pass.
+    m_hann.resize(size_t(m_window) * Channels);
+    for (int i = 0; i < m_window; ++i) {
+        const float w = float(0.5 - 0.5 * std::cos(kTwoPi * i / m_window));
+        for (int c = 0; c < Channels; ++c) m_hann[size_t(i) * Channels + c] = w;
+    }
+    m_overlap.assign(size_t(m_window) * Channels, 0.0f);
+    m_energy.reserve(size_t(2 * m_search + m_hop + 1));
+    reset();
+}
+
+void TimeStretcher::reset()
+{
+    m_input.clear();
+    m_mono.clear();
+    std::fill(m_overlap.begin(), m_overlap.end(), 0.0f);
+    m_analysisPos = 0.0;
+    m_prevPos = -1;
+}
+
+void TimeStretcher::setTempo(double tempo)
+{
+    m_tempo = std::clamp(tempo, MinTempo, MaxTempo);
+}
+
+int TimeStretcher::process(const float *in, int frames, std::vector<float> &out)
+{
+    if (frames > 0) {
+        m_input.insert(m_input.end(), in, in + size_t(frames) * Channels);
+        const size_t monoStart = m_mono.size();
+        m_mono.resize(monoStart + size_t(frames));
+        for (int i = 0; i < frames; ++i)
+            m_mono[monoStart + size_t(i)] = 0.5f * (in[i * Channels] + in[i * Channels + 1]);
+    }
+
+    const int available = int(m_mono.size());
+    int produced = 0;
+    for (;;) {
+        const int nominal = int(std::lround(m_analysisPos));
+        int pos = nominal;
+        if (m_prevPos < 0) {
+            // First grain after a reset has nothing to line up with
+            if (nominal + m_window > available) break;
+        } else {
+            if (nominal + m_search + m_window > available) break;
+            pos = bestOffset(nominal);
+        }
+        overlapAdd(pos, out);
+        produced += m_hop;
+        m_prevPos = pos;
+        m_analysisPos += m_hop * m_tempo;
+    }
+
+    trimInput();
+    return produced;
+}
+
+int TimeStretcher::bestOffset(int nominal) const
+{
+    // Template: the natural continuation of the previous grain over the
+    // region the new grain will overlap
+    const int length = m_hop;
+    const float *target = m_mono.data() + m_prevPos + m_hop;
+    const int lo = std::max(0, nominal - m_search);
+    const int hi = nominal + m_search;
+
+    // Prefix sums of squares give every candidate's energy in O(1)
+    const int span = hi - lo + length;
+    m_energy.resize(size_t(span) + 1);
+    m_energy[0] = 0.0;
+    for (int i = 0; i < span; ++i) {
+        const double v = m_mono[size_t(lo + i)];
+        m_energy[size_t(i) + 1] = m_energy[size_t(i)] + v * v;
+    }
+
+    auto score = [&](int pos) {
+        const double energy = m_energy[size_t(pos - lo + length)] - m_energy[size_t(pos - lo)];
+        const double corr = simd::dot(target, m_mono.data() + pos, length);
+        return corr / std::sqrt(energy + kEnergyFloor);
+    };
+
+    int best = nominal;
+    double bestScore = score(nominal);
+    for (int pos = lo; pos <= hi; pos += kCoarseStep) {
+        const double s = score(pos);
+        if (s > bestScore) { bestScore = s; best = pos; }
+    }
+    const int coarse = best;
+    for (int pos = std::max(lo, coarse - kCoarseStep + 1); pos <= std::min(hi, coarse + kCoarseStep - 1); ++pos) {
+        if (pos == coarse) continue;
+        const double s = score(pos);
+        if (s > bestScore) { bestScore = s; best = pos; }
+    }
+    return best;
+}
+
+void TimeStretcher::overlapAdd(int pos, std::vector<float> &out)
+{
+    const int n = m_window * Channels;
+    const int hop = m_hop * Channels;
+    simd::multiplyAccumulate(m_overlap.data(), m_hann.data(), m_input.data() + size_t(pos) * Channels, n);
+
+    // The first hop is complete: no later grain reaches back into it
+    out.insert(out.end(), m_overlap.begin(), m_overlap.begin() + hop);
+    std::copy(m_overlap.begin() + hop, m_overlap.end(), m_overlap.begin());
+    std::fill(m_overlap.end() - hop, m_overlap.end(), 0.0f);
+}
+
+void TimeStretcher::trimInput()
+{
+    // Keep the previous grain (search template) and the next search range
+    const int nominal = int(std::lround(m_analysisPos));
+    const int keep = std::min(nominal - m_search, m_prevPos < 0 ? nominal : m_prevPos);
+    if (keep < m_window) return; // batch the memmove
+
+    m_input.erase(m_input.begin(), m_input.begin() + size_t(keep) * Channels);
+    m_mono.erase(m_mono.begin(), m_mono.begin() + keep);
+    m_analysisPos -= keep;
+    m_prevPos -= keep;
+}
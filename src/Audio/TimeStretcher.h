@@ -0,0 +1,62 @@
+#ifndef TIMESTRETCHER_H
+#define TIMESTRETCHER_H
+
+#include <vector>
+
+/**
+ * @brief Pitch-preserving tempo change (WSOLA) for interleaved stereo float.
+ *
+ * Hann-windowed 20 ms grains are overlap-added at a fixed 50% synthesis hop
+ * while the analysis hop scales with the tempo. Each grain is shifted by up
+ * to +/-8 ms to the position whose waveform best continues the previous one
+ * (normalized cross-correlation on a mono downmix, coarse-to-fine, SIMD dot
+ * products). Input latency is bounded by window + search range (~28 ms),
+ * independent of the tempo; process() never blocks and only grows its
+ * buffers up to that bound.
+ */
+class TimeStretcher
+{
+public:
+    static constexpr int Channels = 2;
+    static constexpr double MinTempo = 0.5;
+    static constexpr double MaxTempo = 2.0;
+
+    explicit TimeStretcher(int sampleRate = 48000);
+
+    void configure(int sampleRate);
+    void reset();
+
+    void setTempo(double tempo);
+    double tempo() const { return m_tempo; }
+
+    // Consumes `frames` input frames and appends the stretched output to `out`.
+    // Returns the number of output frames appended.
+    int process(const float *in, int frames, std::vector<float> &out);
+
+    int sampleRate() const { return m_sampleRate; }
+    int windowFrames() const { return m_window; }
+    int searchFrames() const { return m_search; }
+    int latencyFrames() const { return m_window + m_search; }
+
+private:
+    int bestOffset(int nominal) const;
+    void overlapAdd(int pos, std::vector<float> &out);
+    void trimInput();
+
+    int m_sampleRate = 0;
+    int m_window = 0;   // grain length N
+    int m_hop = 0;      // synthesis hop N/2
+    int m_search = 0;   // max grain shift
+    double m_tempo = 1.0;
+
+    std::vector<float> m_input;   // interleaved stereo, consumed from the front
+    std::vector<float> m_mono;    // downmix used for the similarity search
+    std::vector<float> m_hann;
+    std::vector<float> m_overlap; // N frames of pending overlap-add output
+    mutable std::vector<double> m_energy;
+
+    double m_analysisPos = 0.0;   // nominal input position of the next grain
+    int m_prevPos = -1;           // actual position of the previous grain
+};
+
+#endif // TIMESTRETCHER_H
@@ -0,0 +1,90 @@
+#include "TimeshiftBuffer.h"
+#include <QDir>
+#include <QFileInfo>
+#include <QDebug>
+#include <algorithm>
+#include <cstring>
+
+namespace {
+constexpr size_t kSegmentBytes = TimeshiftBuffer::SegmentFrames * TimeshiftBuffer::Channels * sizeof(qint16);
+}
+
+TimeshiftBuffer::TimeshiftBuffer(int sampleRate, int seconds)
+    : m_sampleRate(sampleRate),
+      m_segments(std::max<size_t>(2, (size_t(sampleRate) * size_t(seconds) + SegmentFrames - 1) / SegmentFrames))
+{
+    m_head.reserve(SegmentFrames * Channels);
+}
+
+TimeshiftBuffer::~TimeshiftBuffer() {
+    close();
+}
+
+bool TimeshiftBuffer::open(const QString &path) {
+    close();
+    QDir().mkpath(QFileInfo(path).absolutePath());
+    m_file.setFileName(path);
+    const qint64 size = qint64(m_segments * kSegmentBytes);
+    // Sparse until written; reused across runs, so the flash is not reallocated at every start
+    if (!m_file.open(QIODevice::ReadWrite) || (m_file.size() != size && !m_file.resize(size))) {
+        qWarning() << "Timeshift: cannot create" << path << m_file.errorString();
+        m_file.close();
+        return false;
+    }
+    m_map = m_file.map(0, size);
+    if (!m_map) {
+        qWarning() << "Timeshift: cannot map" << path << m_file.errorString();
+        m_file.close();
+        return false;
+    }
+    m_head.clear();
+    m_written = m_committed = m_floor = 0;
+    return true;
+}
+
+void TimeshiftBuffer::close() {
+    if (m_map) m_file.unmap(m_map);
+    m_map = nullptr;
+    m_file.close();
+}
+
+void TimeshiftBuffer::append(const qint16 *frames, size_t count) {
+    if (!m_map) return;
+    while (count > 0) {
+        const size_t room = SegmentFrames - m_head.size() / Channels;
+        const size_t take = std::min(room, count);
+        m_head.insert(m_head.end(), frames, frames + take * Channels);
+        m_written += take;
+        frames += take * Channels;
+        count -= take;
+        if (take == room) commitHead();
+    }
+}
+
+void TimeshiftBuffer::commitHead() {
+    const size_t slot = size_t(m_committed / SegmentFrames) % m_segments;
+    std::memcpy(m_map + slot * kSegmentBytes, m_head.data(), kSegmentBytes);
+    m_committed += SegmentFrames;
+    m_head.clear();
+    ++m_stats.segmentWrites;
+    m_stats.bytesWritten += kSegmentBytes;
+}
+
+quint64 TimeshiftBuffer::oldestPosition() const {
+    const quint64 capacity = capacityFrames();
+    const quint64 ringStart = m_committed > capacity ? m_committed - capacity : 0;
+    return std::max(ringStart, m_floor);
+}
+
+size_t TimeshiftBuffer::span(quint64 position, const qint16 **data) const {
+    if (!m_map || position < oldestPosition() || position >= m_written) return 0;
+    if (position >= m_committed) {
+        const size_t offset = size_t(position - m_committed);
+        *data = m_head.data() + offset * Channels;
+        return size_t(m_written - position);
+    }
+    const size_t inSegment = size_t(position % SegmentFrames);
+    const size_t slot = size_t(position / SegmentFrames) % m_segments;
+    *data = reinterpret_cast<const qint16 *>(m_map + slot * kSegmentBytes) + inSegment * Channels;
+    return size_t(std::min<quint64>(SegmentFrames - inSegment, m_committed - position));
+}
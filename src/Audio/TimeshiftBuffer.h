@@ -0,0 +1,71 @@
+#ifndef TIMESHIFTBUFFER_H
+#define TIMESHIFTBUFFER_H
+
+#include <QFile>
+#include <QString>
+#include <vector>
+
+/**
+ * @brief Fixed-length recording of live audio in a memory-mapped ring file.
+ *
+ * Interleaved 16-bit stereo, addressed by absolute frame position (frames
+ * appended since open). The file is a ring of SegmentFrames segments; the
+ * segment being recorded is assembled in RAM and copied into the mapping
+ * in one piece when full. Every page of the file is therefore dirtied
+ * once per pass and reaches the flash as part of one sequential 256 KB
+ * segment instead of being rewritten by every 100 ms batch.
+ *
+ * Readers get pointers into the mapping (or the RAM head), so pause,
+ * rewind and catch-up never copy through an intermediate buffer or issue
+ * file reads. Single-threaded: append() and span() run on the same thread.
+ */
+class TimeshiftBuffer
+{
+public:
+    static constexpr int Channels = 2;
+    static constexpr size_t SegmentFrames = size_t(1) << 16; // 256 KB, ~1.4 s at 48 kHz
+
+    struct Stats {
+        quint64 segmentWrites = 0;
+        quint64 bytesWritten = 0;
+    };
+
+    TimeshiftBuffer(int sampleRate, int seconds);
+    ~TimeshiftBuffer();
+
+    // Creates or reuses the ring file at `path` (previous contents are not replayed)
+    bool open(const QString &path);
+    void close();
+    bool isOpen() const { return m_map != nullptr; }
+
+    int sampleRate() const { return m_sampleRate; }
+    quint64 capacityFrames() const { return quint64(m_segments) * SegmentFrames; }
+
+    void append(const qint16 *frames, size_t count);
+
+    // Window of recorded frames: [oldestPosition(), writePosition())
+    quint64 writePosition() const { return m_written; }
+    quint64 oldestPosition() const;
+    // Up to the next segment boundary or the write position. Returns the
+    // frame count readable in place at *data; 0 outside the window.
+    size_t span(quint64 position, const qint16 **data) const;
+    // A new programme: the window restarts empty at the write position
+    void discardHistory() { m_floor = m_written; }
+
+    const Stats &stats() const { return m_stats; }
+
+private:
+    void commitHead();
+
+    int m_sampleRate;
+    size_t m_segments;
+    QFile m_file;
+    uchar *m_map = nullptr;
+    std::vector<qint16> m_head; // segment being recorded
+    quint64 m_written = 0;
+    quint64 m_committed = 0;    // frames in the mapping, a multiple of SegmentFrames
+    quint64 m_floor = 0;
+    Stats m_stats;
+};
+
+#endif // TIMESHIFTBUFFER_H
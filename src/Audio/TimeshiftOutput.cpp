@@ -0,0 +1,169 @@
+#include "TimeshiftOutput.h"
+#include "../HAL/IRadioHAL.h"
+#include <QStandardPaths>
+#include <algorithm>
+
+namespace {
+constexpr int kSampleRate = IRadioHAL::AudioSampleRate;
+}
+
+TimeshiftOutput::TimeshiftOutput(const QString &path, int seconds, QObject *parent)
+    : QObject(parent),
+      m_buffer(kSampleRate, seconds)
+{
+    m_buffer.open(path.isEmpty() ? QStandardPaths::writableLocation(QStandardPaths::CacheLocation) + "/timeshift.pcm"
+                                 : path);
+    m_state.sampleRate.store(kSampleRate);
+    m_device = new StreamPlaybackDevice(&m_state, this);
+    m_device->open(QIODevice::ReadOnly);
+
+    m_feedTimer = new QTimer(this);
+    m_feedTimer->setInterval(FeedIntervalMs);
+    connect(m_feedTimer, &QTimer::timeout, this, &TimeshiftOutput::feed);
+}
+
+int TimeshiftOutput::bufferedSeconds() const {
+    return int((m_buffer.writePosition() - m_buffer.oldestPosition()) / quint64(m_buffer.sampleRate()));
+}
+
+quint64 TimeshiftOutput::playPosition() const {
+    // Audio already handed to the playback ring is not heard yet
+    if (m_state.flushRequested.load()) return m_cursor;
+    return m_cursor - std::min<quint64>(m_cursor, m_state.ring.available() / StreamState::Channels);
+}
+
+quint64 TimeshiftOutput::delayFrames() const {
+    return m_buffer.writePosition() - std::min(m_buffer.writePosition(), playPosition());
+}
+
+// =============================================================================
+// CONTROL
+// =============================================================================
+
+void TimeshiftOutput::setOutputActive(bool active) {
+    if (m_active == active) return;
+    m_active = active;
+    m_state.accepting.store(active);
+    if (active) {
+        // Back on the radio: live again, unless it was paused on purpose
+        if (!m_paused) goLive();
+        m_feedTimer->start();
+    } else {
+        m_feedTimer->stop();
+    }
+}
+
+void TimeshiftOutput::setPaused(bool paused) {
+    if (m_paused == paused) return;
+    m_paused = paused;
+    // Silence, but keep what the playback ring holds: resuming continues seamlessly
+    m_state.holding.store(paused);
+    if (paused) setLive(false);
+    emit stateChanged();
+    if (!paused) feed();
+}
+
+void TimeshiftOutput::rewind(int seconds) {
+    const quint64 back = quint64(qMax(0, seconds)) * quint64(m_buffer.sampleRate());
+    const quint64 position = playPosition();
+    seekTo(position - std::min(position, back));
+    setLive(false);
+}
+
+void TimeshiftOutput::forward(int seconds) {
+    const quint64 target = playPosition() + quint64(qMax(0, seconds)) * quint64(m_buffer.sampleRate());
+    if (target >= m_buffer.writePosition()) goLive();
+    else seekTo(target);
+}
+
+void TimeshiftOutput::goLive() {
+    seekTo(m_buffer.writePosition());
+    setLive(true);
+}
+
+void TimeshiftOutput::restart() {
+    m_buffer.discardHistory();
+    if (m_paused) {
+        m_paused = false;
+        m_state.holding.store(false);
+        emit stateChanged();
+    }
+    goLive();
+}
+
+void TimeshiftOutput::seekTo(quint64 position) {
+    m_cursor = std::clamp(position, m_buffer.oldestPosition(), m_buffer.writePosition());
+    // The reader drops what it holds; nothing is fed until it has (see feed())
+    m_state.flushRequested.store(true);
+    notifyPosition();
+}
+
+void TimeshiftOutput::setLive(bool live) {
+    if (m_live == live) return;
+    m_live = live;
+    emit stateChanged();
+}
+
+void TimeshiftOutput::notifyPosition() {
+    const int delay = delaySeconds();
+    const int buffered = bufferedSeconds();
+    if (delay == m_reportedDelay && buffered == m_reportedBuffered) return;
+    m_reportedDelay = delay;
+    m_reportedBuffered = buffered;
+    emit positionChanged();
+}
+
+// =============================================================================
+// RECORD AND FEED
+// =============================================================================
+
+void TimeshiftOutput::pushPcm(const QByteArray &pcm) {
+    const qint16 *data = reinterpret_cast<const qint16 *>(pcm.constData());
+    const size_t frames = size_t(pcm.size()) / (StreamState::Channels * sizeof(qint16));
+    if (!m_buffer.isOpen()) {
+        // No ring file: plain live radio
+        if (m_active && !m_paused) queue(data, frames);
+        return;
+    }
+    m_buffer.append(data, frames);
+    if (m_live) feed(); // forward the batch right away
+    notifyPosition();
+}
+
+void TimeshiftOutput::feed() {
+    // A seek waits until the reader has dropped the audio queued before it
+    if (!m_active || m_paused || m_state.flushRequested.load()) return;
+    if (m_cursor < m_buffer.oldestPosition()) {
+        // Paused for longer than the buffer: the oldest audio kept
+        seekTo(m_buffer.oldestPosition());
+        return;
+    }
+
+    quint64 end = m_buffer.writePosition();
+    if (!m_live) {
+        // Time-shifted: stay just ahead of the reader, which then sets the pace
+        const quint64 ahead = quint64(m_buffer.sampleRate()) * quint64(m_state.targetMs.load() + 2 * FeedIntervalMs) / 1000;
+        const quint64 queued = m_state.ring.available() / StreamState::Channels;
+        if (queued >= ahead) return;
+        end = std::min(end, m_cursor + (ahead - queued));
+    }
+    while (m_cursor < end) {
+        const qint16 *data = nullptr;
+        const size_t frames = std::min<quint64>(m_buffer.span(m_cursor, &data), end - m_cursor);
+        if (frames == 0) break;
+        const size_t queuedFrames = queue(data, frames);
+        m_cursor += queuedFrames;
+        if (queuedFrames < frames) break; // playback ring full
+    }
+    if (!m_live && m_cursor >= m_buffer.writePosition()) setLive(true); // caught up
+    notifyPosition();
+}
+
+size_t TimeshiftOutput::queue(const qint16 *data, size_t frames) {
+    frames = std::min(frames, m_state.ring.freeSpace() / StreamState::Channels);
+    m_scratch.resize(frames * StreamState::Channels);
+    for (size_t i = 0; i < m_scratch.size(); ++i) m_scratch[i] = data[i] / 32768.0f;
+    m_state.ring.write(m_scratch.data(), m_scratch.size());
+    m_state.framesReceived.fetch_add(frames, std::memory_order_relaxed);
+    return frames;
+}
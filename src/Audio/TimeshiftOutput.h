@@ -0,0 +1,91 @@
+#ifndef TIMESHIFTOUTPUT_H
+#define TIMESHIFTOUTPUT_H
+
+#include <QObject>
+#include <QByteArray>
+#include <QTimer>
+#include <vector>
+#include "StreamPlaybackDevice.h"
+#include "TimeshiftBuffer.h"
+
+/**
+ * @brief Live radio output stage with pause, rewind and catch-up.
+ *
+ * Every batch of tuner audio is recorded into a TimeshiftBuffer, whether or
+ * not it is being heard. Playback is a cursor into that recording: live,
+ * it sits at the write position and forwards each batch as it arrives;
+ * paused, it stays put while recording goes on, and resuming plays from
+ * where it stopped. A feed timer moves audio from the cursor (read in place
+ * from the mapping) into the mixer's media bus just ahead of its jitter
+ * target, so time-shifted playback follows the output clock and the
+ * recording depth stays constant. A cursor that falls out of the window
+ * (paused longer than the buffer) restarts at the oldest audio kept.
+ */
+class TimeshiftOutput : public QObject
+{
+    Q_OBJECT
+    Q_PROPERTY(bool available READ isAvailable CONSTANT)
+    Q_PROPERTY(bool paused READ isPaused WRITE setPaused NOTIFY stateChanged)
+    Q_PROPERTY(bool live READ isLive NOTIFY stateChanged)
+    Q_PROPERTY(int delaySeconds READ delaySeconds NOTIFY positionChanged)
+    Q_PROPERTY(int bufferedSeconds READ bufferedSeconds NOTIFY positionChanged)
+
+public:
+    static constexpr int DefaultSeconds = 30 * 60;
+    static constexpr int FeedIntervalMs = 20;
+
+    // Ring file in the cache directory unless `path` is given
+    explicit TimeshiftOutput(const QString &path = QString(), int seconds = DefaultSeconds, QObject *parent = nullptr);
+
+    bool isAvailable() const { return m_buffer.isOpen(); }
+    bool isPaused() const { return m_paused; }
+    bool isLive() const { return m_live; }
+    int delaySeconds() const { return int(delayFrames() / quint64(m_buffer.sampleRate())); }
+    int bufferedSeconds() const;
+    quint64 delayFrames() const;       // audible position behind live
+    quint64 playPosition() const;      // absolute frame now audible (or next, when paused)
+
+    // Output routing: the media bus reads this while the radio is the source
+    void setOutputActive(bool active);
+    StreamPlaybackDevice *playbackDevice() const { return m_device; }
+    const TimeshiftBuffer &buffer() const { return m_buffer; }
+
+    void setPaused(bool paused);
+    Q_INVOKABLE void rewind(int seconds);
+    Q_INVOKABLE void forward(int seconds);
+    Q_INVOKABLE void goLive();
+
+public slots:
+    // Tuner audio, interleaved 16-bit stereo at the buffer rate
+    void pushPcm(const QByteArray &pcm);
+    // Another station: the recorded past belongs to the old one
+    void restart();
+
+signals:
+    void stateChanged();
+    void positionChanged();
+
+private slots:
+    void feed();
+
+private:
+    size_t queue(const qint16 *data, size_t frames);
+    void seekTo(quint64 position);
+    void setLive(bool live);
+    void notifyPosition();
+
+    TimeshiftBuffer m_buffer;
+    StreamState m_state;
+    StreamPlaybackDevice *m_device;
+    QTimer *m_feedTimer;
+    std::vector<float> m_scratch;
+
+    quint64 m_cursor = 0; // next frame to hand to the playback ring
+    bool m_active = false;
+    bool m_paused = false;
+    bool m_live = true;
+    int m_reportedDelay = -1;
+    int m_reportedBuffered = -1;
+};
+
+#endif // TIMESHIFTOUTPUT_H
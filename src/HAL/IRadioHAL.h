@@ -0,0 +1,136 @@
+#ifndef IRADIOHAL_H
+#define IRADIOHAL_H
+
+#include <QObject>
+#include <QByteArray>
+#include <QLoggingCategory>
+#include <QStringList>
+#include <QVector>
+
+/**
+ * @brief Abstract Interface for the Radio Tuner Hardware Abstraction Layer.
+ *
+ * Lives on its own thread. Commands may be called from any thread; the
+ * implementation runs them on the HAL thread, so a seek never blocks the
+ * UI. Only final results (tuned, seek finished) and a throttled progress
+ * indicator are reported back.
+ *
+ * Frequencies use the tuner's integer units: 10 kHz for FM (98.3 MHz ->
+ * 9830), kHz for AM, channel index for DAB.
+ *
+ * Band scans use the background tuner: they never move the audible
+ * frequency and run interleaved with tune and seek commands.
+ *
+ * While an FM station is tuned (and no seek runs) the demodulated RDS
+ * stream is delivered raw, one bit per byte, in batches of
+ * ProgressIntervalMs; decoding is left to the consumer. A tuned DAB
+ * channel delivers its Fast Information Channel the same way, as whole
+ * 32-byte FIBs.
+ *
+ * The audible programme itself is delivered as PCM in the same batches
+ * (interleaved 16-bit stereo at AudioSampleRate), silent while a seek
+ * runs, so the consumer can record it as well as play it.
+ *
+ * Given the RDS network of the tuned FM station (PI and AF list), the HAL
+ * follows it: it watches the tuned signal and checks the alternates on
+ * the background tuner, verifying their PI, and moves the audible tuner
+ * to a better one without muting. Any tune, seek or band change ends
+ * following until the next network arrives.
+ */
+class IRadioHAL : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit IRadioHAL(QObject *parent = nullptr) : QObject(parent) {}
+    virtual ~IRadioHAL() = default;
+
+    enum Band { BandFM = 0, BandAM = 1, BandDAB = 2 };
+    Q_ENUM(Band)
+
+    struct BandPlan {
+        int min;
+        int max;
+        int step;
+    };
+
+    static BandPlan bandPlan(Band band) {
+        switch (band) {
+        case BandFM: return {8750, 10800, 10}; // 87.5 - 108.0 MHz, 100 kHz raster
+        case BandAM: return {531, 1602, 9};    // 531 - 1602 kHz, 9 kHz raster
+        case BandDAB: break;
+        }
+        return {0, 40, 1}; // DAB Band III channel index, 5A - 13F
+    }
+
+    // Display label of a raster channel (MHz for FM, kHz for AM, block for DAB)
+    static QString channelLabel(Band band, int frequency) {
+        if (band == BandFM) return QString::number(frequency / 100.0, 'f', 1);
+        if (band == BandAM) return QString::number(frequency);
+        static const QStringList dabChannels = {
+            "5A", "5B", "5C", "5D", "6A", "6B", "6C", "6D", "7A", "7B", "7C", "7D", "8A", "8B", "8C", "8D",
+            "9A", "9B", "9C", "9D", "10A", "10N", "10B", "10C", "10D", "11A", "11N", "11B", "11C", "11D",
+            "12A", "12N", "12B", "12C", "12D", "13A", "13B", "13C", "13D", "13E", "13F" };
+        if (frequency >= 0 && frequency < dabChannels.size()) return dabChannels[frequency];
+        return "5A";
+    }
+
+    // Reception quality of one channel
+    struct ChannelQuality {
+        int frequency = 0;
+        int rssi = 0;      // 0-100
+        int snr = 0;       // dB
+        int multipath = 0; // 0-100, higher is worse
+    };
+
+    static constexpr int ProgressIntervalMs = 100;
+    static constexpr int AudioSampleRate = 48000;
+
+    // --- Commands (asynchronous) ---
+    // A new command supersedes a seek in progress.
+    virtual void setBand(Band band) = 0;
+    virtual void tune(int frequency) = 0;
+    virtual void seek(bool up) = 0;
+    // Full sweep of `band` on the background tuner. Results carry `scanId`;
+    // a new scan replaces a running one, and neither that nor cancelScan()
+    // reports anything further for the old sweep.
+    virtual void startScan(Band band, int scanId) = 0;
+    virtual void cancelScan() = 0;
+    // RDS network of the station on `frequency`; ignored once the tuner has
+    // moved on. An empty list stops following.
+    virtual void followAlternatives(int frequency, quint16 pi, const QVector<int> &afs) = 0;
+
+    // --- Synchronization ---
+    virtual void fetchData() = 0;
+
+signals:
+    // --- Results ---
+    void tuned(int frequency, int signalStrength);
+    void seekFinished(int frequency, int signalStrength, bool found);
+    // AF following moved the audible tuner (same programme, no retune gap)
+    void alternativeSwitched(int from, int to, int signalStrength);
+
+    // --- Progress (throttled to ProgressIntervalMs) ---
+    void seekProgress(int frequency);
+    // Scan results arrive in ascending raster order, batched at the same rate
+    void scanMeasured(int scanId, const QVector<IRadioHAL::ChannelQuality> &channels);
+    void scanFinished(int scanId);
+    // Level of the playing station when it moves by a few points
+    void signalMeasured(int frequency, int signalStrength);
+
+    // --- Data ---
+    // Raw RDS bits (0/1 per byte) of the audible station, ~119 per batch
+    void rdsData(const QByteArray &bits);
+    // FIBs (32 bytes each, CRC unchecked) of the tuned DAB channel
+    void ficData(int channel, const QByteArray &fibs);
+    // Programme audio, interleaved 16-bit stereo at AudioSampleRate
+    void audioData(const QByteArray &pcm);
+
+    // --- System Signals ---
+    void errorOccurred(const QString &message);
+};
+
+Q_DECLARE_METATYPE(IRadioHAL::ChannelQuality)
+Q_DECLARE_LOGGING_CATEGORY(vcRadioHAL)
+
+#endif // IRADIOHAL_H
@@ -0,0 +1,350 @@
+#include "SdrRadioHAL.h"
+#include <QFileInfo>
+#include <QDebug>
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+int captureRate() {
+    bool ok = false;
+    const int rate = qEnvironmentVariableIntValue("NORDIC_SDR_RATE", &ok);
+    return ok ? rate : 2400000;
+}
+
+} // namespace
+
+SdrRadioHAL::SdrRadioHAL(QObject *parent)
+    : IRadioHAL(parent)
+    , m_rate(captureRate())
+    , m_plan(bandPlan(BandFM))
+    , m_frequency(m_plan.min)
+    , m_demod(m_rate)
+    , m_checkDemod(m_rate)
+{
+    // Children of the HAL, so they follow moveToThread and fire on the HAL thread
+    m_seekTimer = new QTimer(this);
+    m_seekTimer->setInterval(StepDwellMs);
+    connect(m_seekTimer, &QTimer::timeout, this, &SdrRadioHAL::seekStep);
+
+    m_scanTimer = new QTimer(this);
+    m_scanTimer->setInterval(ScanDwellMs);
+    connect(m_scanTimer, &QTimer::timeout, this, &SdrRadioHAL::scanStep);
+
+    m_dataTimer = new QTimer(this);
+    m_dataTimer->setInterval(ProgressIntervalMs);
+    connect(m_dataTimer, &QTimer::timeout, this, &SdrRadioHAL::dataStep);
+    m_afClock.start();
+
+    const QString path = qEnvironmentVariable("NORDIC_SDR_IQ");
+    const QString suffix = QFileInfo(path).suffix().toLower();
+    if (suffix == "cs16") m_format = FmDemodulator::IqFormat::S16;
+    else if (suffix == "cf32") m_format = FmDemodulator::IqFormat::F32;
+    m_center = qEnvironmentVariable("NORDIC_SDR_CENTER").toDouble() * 1e6;
+    m_blockSamples = size_t(m_rate) * ProgressIntervalMs / 1000;
+
+    if (!FmDemodulator::supportsRate(m_rate)) {
+        qCWarning(vcRadioHAL) << "Unsupported IQ sample rate" << m_rate;
+    } else if (m_center <= 0.0) {
+        qCWarning(vcRadioHAL) << "NORDIC_SDR_CENTER not set";
+    } else {
+        m_file.setFileName(path);
+        if (m_file.open(QIODevice::ReadOnly)) {
+            qCInfo(vcRadioHAL) << "Replaying IQ capture" << path << m_rate << "sps around" << m_center / 1e6 << "MHz";
+        } else {
+            qCWarning(vcRadioHAL) << "Cannot open IQ capture" << path;
+        }
+    }
+
+    const QString audioOut = qEnvironmentVariable("NORDIC_SDR_AUDIO_OUT");
+    if (!audioOut.isEmpty()) {
+        m_audioOut.setFileName(audioOut);
+        if (!m_audioOut.open(QIODevice::WriteOnly)) qCWarning(vcRadioHAL) << "Cannot write audio to" << audioOut;
+    }
+
+    // Start on the raster channel nearest the capture centre
+    const int centre = int(std::lround(m_center / 1e5)) * 10;
+    m_frequency = qBound(m_plan.min, centre, m_plan.max);
+    m_iq.assign(m_blockSamples * 2, 0.0f);
+}
+
+// -----------------------------------------------------------------------------
+// Commands - queued onto the HAL thread
+// -----------------------------------------------------------------------------
+
+void SdrRadioHAL::setBand(Band band) {
+    QMetaObject::invokeMethod(this, [this, band]() { doSetBand(band); });
+}
+
+void SdrRadioHAL::tune(int frequency) {
+    QMetaObject::invokeMethod(this, [this, frequency]() { doTune(frequency); });
+}
+
+void SdrRadioHAL::seek(bool up) {
+    QMetaObject::invokeMethod(this, [this, up]() { doSeek(up); });
+}
+
+void SdrRadioHAL::startScan(Band band, int scanId) {
+    QMetaObject::invokeMethod(this, [this, band, scanId]() { doStartScan(band, scanId); });
+}
+
+void SdrRadioHAL::cancelScan() {
+    QMetaObject::invokeMethod(this, [this]() { m_scanTimer->stop(); });
+}
+
+void SdrRadioHAL::followAlternatives(int frequency, quint16 pi, const QVector<int> &afs) {
+    QMetaObject::invokeMethod(this, [this, frequency, pi, afs]() { doFollowAlternatives(frequency, pi, afs); });
+}
+
+void SdrRadioHAL::fetchData() {
+    QMetaObject::invokeMethod(this, [this]() {
+        startCapture();
+        retune();
+        emit tuned(m_frequency, measure(m_band, m_frequency).rssi);
+        qCInfo(vcRadioHAL) << "Radio HAL Synced. Band:" << m_band << "Frequency:" << m_frequency;
+    });
+}
+
+// -----------------------------------------------------------------------------
+// HAL thread
+// -----------------------------------------------------------------------------
+
+void SdrRadioHAL::doSetBand(Band band) {
+    m_seekTimer->stop();
+    stopFollowing();
+    m_band = band;
+    m_plan = bandPlan(band);
+    doTune(m_plan.min);
+}
+
+void SdrRadioHAL::doTune(int frequency) {
+    m_seekTimer->stop();
+    stopFollowing();
+    m_frequency = qBound(m_plan.min, frequency, m_plan.max);
+    startCapture();
+    retune();
+    emit tuned(m_frequency, measure(m_band, m_frequency).rssi);
+}
+
+void SdrRadioHAL::doSeek(bool up) {
+    m_seekDirection = up ? 1 : -1;
+    m_seekStart = m_frequency;
+    stopFollowing();
+    startCapture();
+    m_progressClock.start();
+    m_seekTimer->start();
+    qCInfo(vcRadioHAL) << "Seek" << (up ? "up" : "down") << "from" << m_frequency;
+}
+
+void SdrRadioHAL::seekStep() {
+    m_frequency = nextFrequency(m_frequency, m_seekDirection);
+
+    // Stop on a clean channel that is not the slope of a stronger neighbour
+    const ChannelQuality q = measure(m_band, m_frequency);
+    if (q.snr >= SeekMinSnr && q.rssi >= measure(m_band, nextFrequency(m_frequency, 1)).rssi
+        && q.rssi >= measure(m_band, nextFrequency(m_frequency, -1)).rssi) {
+        m_seekTimer->stop();
+        retune();
+        emit seekFinished(m_frequency, q.rssi, true);
+        return;
+    }
+    if (m_frequency == m_seekStart) {
+        m_seekTimer->stop();
+        retune();
+        emit seekFinished(m_frequency, q.rssi, false);
+        return;
+    }
+    if (m_progressClock.elapsed() >= ProgressIntervalMs) {
+        m_progressClock.restart();
+        emit seekProgress(m_frequency);
+    }
+}
+
+void SdrRadioHAL::doStartScan(Band band, int scanId) {
+    if (m_checkFrequency) {
+        // The scan takes the background tuner; the follower checks again later
+        m_af.checkResult(m_afClock.elapsed(), m_checkFrequency, -1, -1);
+        m_checkFrequency = 0;
+    }
+    m_scanBand = band;
+    m_scanId = scanId;
+    m_scanFrequency = bandPlan(band).min;
+    m_scanBatch.clear();
+    startCapture();
+    m_scanClock.start();
+    m_scanTimer->start();
+    qCInfo(vcRadioHAL) << "Background scan of band" << band;
+}
+
+void SdrRadioHAL::scanStep() {
+    const BandPlan plan = bandPlan(m_scanBand);
+    m_scanBatch.append(measure(m_scanBand, m_scanFrequency));
+    m_scanFrequency += plan.step;
+
+    const bool done = m_scanFrequency > plan.max;
+    if (done || m_scanClock.elapsed() >= ProgressIntervalMs) {
+        m_scanClock.restart();
+        emit scanMeasured(m_scanId, m_scanBatch);
+        m_scanBatch.clear();
+    }
+    if (done) {
+        m_scanTimer->stop();
+        emit scanFinished(m_scanId);
+    }
+}
+
+void SdrRadioHAL::dataStep() {
+    if (!readBlock() || m_seekTimer->isActive()) return; // muted while seeking
+    if (!inCapture(m_band, m_frequency)) return;
+
+    m_audio.clear();
+    m_rdsBits.clear();
+    m_demod.process(m_iq.data(), m_blockSamples, m_audio, m_rdsBits);
+    if (m_audioOut.isOpen()) {
+        m_audioOut.write(reinterpret_cast<const char *>(m_audio.data()), qint64(m_audio.size() * sizeof(float)));
+    }
+    QByteArray pcm(int(m_audio.size() * sizeof(qint16)), Qt::Uninitialized);
+    qint16 *samples = reinterpret_cast<qint16 *>(pcm.data());
+    for (size_t i = 0; i < m_audio.size(); ++i)
+        samples[i] = qint16(qBound(-32768.0f, m_audio[i] * 32768.0f, 32767.0f));
+    emit audioData(pcm);
+    if (!m_rdsBits.empty()) {
+        emit rdsData(QByteArray(reinterpret_cast<const char *>(m_rdsBits.data()), int(m_rdsBits.size())));
+    }
+    followStep(toChannelQuality(m_frequency, m_demod.quality()));
+}
+
+void SdrRadioHAL::startCapture() {
+    // Playback starts with the first command and then runs at real time
+    if (m_dataTimer->isActive()) return;
+    readBlock();
+    m_dataTimer->start();
+}
+
+bool SdrRadioHAL::readBlock() {
+    if (!m_file.isOpen()) return false;
+    const qint64 bytes = qint64(m_blockSamples * FmDemodulator::bytesPerSample(m_format));
+    m_raw = m_file.read(bytes);
+    if (m_raw.size() < bytes) {
+        // Loop the capture
+        m_file.seek(0);
+        m_raw += m_file.read(bytes - m_raw.size());
+        if (m_raw.size() < bytes) return false;
+    }
+    FmDemodulator::toFloat(m_format, reinterpret_cast<const uint8_t *>(m_raw.constData()), size_t(m_raw.size()), m_iq);
+    return true;
+}
+
+bool SdrRadioHAL::inCapture(Band band, int frequency) const {
+    // The whole channel (+-120 kHz) must be inside the captured band
+    return band == BandFM && m_file.isOpen() && std::abs(offsetOf(frequency)) <= m_rate / 2.0 - 120000.0;
+}
+
+double SdrRadioHAL::offsetOf(int frequency) const {
+    return frequency * 10000.0 - m_center;
+}
+
+IRadioHAL::ChannelQuality SdrRadioHAL::measure(Band band, int frequency) const {
+    if (!inCapture(band, frequency)) {
+        ChannelQuality q;
+        q.frequency = frequency;
+        return q;
+    }
+    const size_t samples = std::min(m_blockSamples, size_t(m_rate) * MeasureMs / 1000);
+    return toChannelQuality(frequency, FmDemodulator::measure(m_rate, offsetOf(frequency), m_iq.data(), samples));
+}
+
+IRadioHAL::ChannelQuality SdrRadioHAL::toChannelQuality(int frequency, const FmDemodulator::Quality &quality) const {
+    ChannelQuality q;
+    q.frequency = frequency;
+    // -60 dBFS .. -10 dBFS onto 0..100; an rtl-sdr front end at moderate gain
+    q.rssi = qBound(0, int(std::lround(2.0 * (quality.powerDb + 60.0))), 100);
+    q.snr = int(std::lround(quality.snrDb));
+    return q;
+}
+
+int SdrRadioHAL::nextFrequency(int frequency, int direction) const {
+    const int next = frequency + direction * m_plan.step;
+    if (next > m_plan.max) return m_plan.min;
+    if (next < m_plan.min) return m_plan.max;
+    return next;
+}
+
+void SdrRadioHAL::retune() {
+    m_demod.reset();
+    m_demod.setOffset(offsetOf(m_frequency));
+    m_reportedLevel = measure(m_band, m_frequency).rssi;
+}
+
+// -----------------------------------------------------------------------------
+// AF following
+// -----------------------------------------------------------------------------
+
+void SdrRadioHAL::doFollowAlternatives(int frequency, quint16 pi, const QVector<int> &afs) {
+    // Stale if the tuner has moved since the list was decoded
+    if (m_band != BandFM || frequency != m_frequency || m_seekTimer->isActive()) return;
+    if (pi == 0 || afs.isEmpty()) {
+        stopFollowing();
+        return;
+    }
+    m_af.setNetwork(frequency, pi, std::vector<int>(afs.begin(), afs.end()));
+}
+
+void SdrRadioHAL::stopFollowing() {
+    m_af.reset();
+    m_checkFrequency = 0;
+}
+
+void SdrRadioHAL::followStep(const ChannelQuality &tuned) {
+    if (qAbs(tuned.rssi - m_reportedLevel) >= SignalReportStep) {
+        m_reportedLevel = tuned.rssi;
+        emit signalMeasured(m_frequency, tuned.rssi);
+    }
+
+    if (m_checkFrequency) afCheckStep();
+    const qint64 now = m_afClock.elapsed();
+    const AfFollower::Decision decision = m_af.update(now, tuned.snr);
+    if (decision.action == AfFollower::Check) {
+        startAfCheck(decision.frequency);
+    } else if (decision.action == AfFollower::Switch) {
+        const int from = m_frequency;
+        m_checkFrequency = 0;
+        m_frequency = decision.frequency;
+        m_af.switched(now, m_frequency);
+        qCInfo(vcRadioHAL) << "AF switch" << from << "->" << m_frequency;
+        retune();
+        emit alternativeSwitched(from, m_frequency, m_reportedLevel);
+    }
+}
+
+void SdrRadioHAL::startAfCheck(int frequency) {
+    if (m_scanTimer->isActive()) {
+        // Background tuner busy with a band scan
+        m_af.checkResult(m_afClock.elapsed(), frequency, -1, -1);
+        return;
+    }
+    if (!inCapture(BandFM, frequency)) {
+        // Not receivable from this capture
+        m_af.checkResult(m_afClock.elapsed(), frequency, 0, -1);
+        return;
+    }
+    m_checkFrequency = frequency;
+    m_checkTicks = 0;
+    m_checkDemod.reset();
+    m_checkDemod.setOffset(offsetOf(frequency));
+    m_checkDecoder.reset();
+}
+
+void SdrRadioHAL::afCheckStep() {
+    // Demodulate the alternate from the same block until block A yields its PI
+    std::vector<float> audio;
+    std::vector<uint8_t> bits;
+    m_checkDemod.process(m_iq.data(), m_blockSamples, audio, bits);
+    m_checkDecoder.pushBits(bits.data(), bits.size());
+    ++m_checkTicks;
+    if (!m_checkDecoder.hasPi() && m_checkTicks < AfCheckTicks) return;
+    const int pi = m_checkDecoder.hasPi() ? int(m_checkDecoder.pi()) : -1;
+    const int snr = int(std::lround(m_checkDemod.quality().snrDb));
+    m_af.checkResult(m_afClock.elapsed(), m_checkFrequency, snr, pi);
+    m_checkFrequency = 0;
+}
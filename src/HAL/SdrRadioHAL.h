@@ -0,0 +1,131 @@
+#ifndef SDRRADIOHAL_H
+#define SDRRADIOHAL_H
+
+#include "IRadioHAL.h"
+#include "../Radio/FmDemodulator.h"
+#include "../Radio/RdsDecoder.h"
+#include "../Radio/AfFollower.h"
+#include <QFile>
+#include <QTimer>
+#include <QElapsedTimer>
+#include <QVector>
+
+/**
+ * @brief Radio HAL over a complex IQ capture (SDR front end).
+ *
+ * NORDIC_SDR_IQ names the recording (rtl_sdr style: .cu8, .cs16 or .cf32
+ * interleaved I/Q), NORDIC_SDR_CENTER its centre frequency in MHz and
+ * NORDIC_SDR_RATE its sample rate (default 2.4 Msps, any multiple of
+ * 240 kHz from 480 kHz). The file is played in a loop at real time, one
+ * ProgressIntervalMs block per data period, and every FM channel inside
+ * the captured bandwidth can be tuned:
+ *
+ * - The audible channel runs through FmDemodulator; its RDS bits are
+ *   delivered as from a hardware tuner, its level and SNR come from the
+ *   channel's envelope, its audio goes out as audioData().
+ *   NORDIC_SDR_AUDIO_OUT, if set, also receives the demodulated audio
+ *   (raw float stereo at 48 kHz).
+ * - Seek and the background scan measure channels on the latest block
+ *   without demodulating them; AF checks run a second demodulator on the
+ *   alternate until its PI decodes.
+ *
+ * AM and DAB are not in an FM capture: those bands tune to silence.
+ */
+class SdrRadioHAL : public IRadioHAL
+{
+    Q_OBJECT
+
+public:
+    explicit SdrRadioHAL(QObject *parent = nullptr);
+
+    static bool isConfigured() { return qEnvironmentVariableIsSet("NORDIC_SDR_IQ"); }
+
+    static constexpr int StepDwellMs = 20;
+    static constexpr int ScanDwellMs = 4;
+    static constexpr int SeekMinSnr = 12;     // dB to stop a seek
+    static constexpr int MeasureMs = 20;      // samples per channel measurement
+    static constexpr int AfCheckTicks = 3;    // PI must decode within this many data periods
+    static constexpr int SignalReportStep = 5;
+
+    // IRadioHAL Commands
+    void setBand(Band band) override;
+    void tune(int frequency) override;
+    void seek(bool up) override;
+    void startScan(Band band, int scanId) override;
+    void cancelScan() override;
+    void followAlternatives(int frequency, quint16 pi, const QVector<int> &afs) override;
+
+    // IRadioHAL Control
+    void fetchData() override;
+
+private slots:
+    void seekStep();
+    void scanStep();
+    void dataStep();
+
+private:
+    // HAL thread
+    void doSetBand(Band band);
+    void doTune(int frequency);
+    void doSeek(bool up);
+    void doStartScan(Band band, int scanId);
+    void doFollowAlternatives(int frequency, quint16 pi, const QVector<int> &afs);
+    void startCapture();
+    bool readBlock();
+    bool inCapture(Band band, int frequency) const;
+    double offsetOf(int frequency) const;
+    ChannelQuality measure(Band band, int frequency) const;
+    ChannelQuality toChannelQuality(int frequency, const FmDemodulator::Quality &quality) const;
+    int nextFrequency(int frequency, int direction) const;
+    void retune();
+    void followStep(const ChannelQuality &tuned);
+    void startAfCheck(int frequency);
+    void afCheckStep();
+    void stopFollowing();
+
+    QTimer *m_seekTimer;
+    QTimer *m_scanTimer;
+    QTimer *m_dataTimer; // one capture block per period
+    QElapsedTimer m_progressClock;
+    QElapsedTimer m_scanClock;
+
+    // Capture
+    QFile m_file;
+    QFile m_audioOut;
+    FmDemodulator::IqFormat m_format = FmDemodulator::IqFormat::U8;
+    int m_rate = 2400000;
+    double m_center = 0.0;                 // Hz
+    QByteArray m_raw;
+    std::vector<float> m_iq;               // latest block, interleaved
+    size_t m_blockSamples = 0;
+
+    Band m_band = BandFM;
+    BandPlan m_plan;
+    int m_frequency;
+
+    // Audible channel
+    FmDemodulator m_demod;
+    std::vector<float> m_audio;
+    std::vector<uint8_t> m_rdsBits;
+
+    // Seek in progress
+    int m_seekDirection = 0;
+    int m_seekStart = 0;
+
+    // Background scan in progress
+    Band m_scanBand = BandFM;
+    int m_scanId = 0;
+    int m_scanFrequency = 0;
+    QVector<ChannelQuality> m_scanBatch;
+
+    // AF following of the audible station
+    AfFollower m_af;
+    QElapsedTimer m_afClock;
+    int m_reportedLevel = -1;
+    int m_checkFrequency = 0; // AF being checked, 0 = none
+    int m_checkTicks = 0;
+    FmDemodulator m_checkDemod;
+    RdsDecoder m_checkDecoder;
+};
+
+#endif // SDRRADIOHAL_H
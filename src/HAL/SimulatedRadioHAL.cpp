@@ -0,0 +1,526 @@
+#include "SimulatedRadioHAL.h"
+#include <QDateTime>
+#include <QFile>
+#include <QDebug>
+#include <cmath>
+
+Q_LOGGING_CATEGORY(vcRadioHAL, "nordic.radio.hal")
+
+namespace {
+constexpr double kTwoPi = 6.283185307179586;
+}
+
+SimulatedRadioHAL::SimulatedRadioHAL(QObject *parent)
+    : IRadioHAL(parent)
+    , m_noise(0x5EED)
+    , m_plan(bandPlan(BandFM))
+    , m_frequency(m_plan.min)
+{
+    // Children of the HAL, so they follow moveToThread and fire on the HAL thread
+    m_seekTimer = new QTimer(this);
+    m_seekTimer->setInterval(StepDwellMs);
+    connect(m_seekTimer, &QTimer::timeout, this, &SimulatedRadioHAL::seekStep);
+
+    m_scanTimer = new QTimer(this);
+    m_scanTimer->setInterval(ScanDwellMs);
+    connect(m_scanTimer, &QTimer::timeout, this, &SimulatedRadioHAL::scanStep);
+
+    m_dataTimer = new QTimer(this);
+    m_dataTimer->setInterval(ProgressIntervalMs);
+    connect(m_dataTimer, &QTimer::timeout, this, &SimulatedRadioHAL::stationDataStep);
+    m_afClock.start();
+
+    const QString recording = qEnvironmentVariable("NORDIC_RDS_RECORDING");
+    if (!recording.isEmpty()) {
+        QFile file(recording);
+        if (file.open(QIODevice::ReadOnly)) {
+            const QByteArray packed = file.readAll();
+            m_rdsRecording.reserve(size_t(packed.size()) * 8);
+            for (char byte : packed) {
+                for (int b = 7; b >= 0; --b) m_rdsRecording.push_back(uint8_t((byte >> b) & 1));
+            }
+            qCInfo(vcRadioHAL) << "Replaying RDS recording" << recording << m_rdsRecording.size() << "bits";
+        } else {
+            qCWarning(vcRadioHAL) << "Cannot open RDS recording" << recording;
+        }
+    }
+
+    const QString ficRecording = qEnvironmentVariable("NORDIC_DAB_RECORDING");
+    if (!ficRecording.isEmpty()) {
+        QFile file(ficRecording);
+        if (file.open(QIODevice::ReadOnly)) {
+            m_ficRecording = file.readAll();
+            m_ficRecording.truncate(m_ficRecording.size() - m_ficRecording.size() % FicDecoder::FibSize);
+            qCInfo(vcRadioHAL) << "Replaying DAB FIC recording" << ficRecording << m_ficRecording.size() / FicDecoder::FibSize << "FIBs";
+        } else {
+            qCWarning(vcRadioHAL) << "Cannot open DAB FIC recording" << ficRecording;
+        }
+    }
+
+    for (Band band : {BandFM, BandAM, BandDAB}) m_fields[band] = buildStationField(band);
+    for (int i = 0; i < m_fields[BandDAB].size(); ++i) {
+        const int channel = m_fields[BandDAB][i].frequency;
+        m_ensembles.insert(channel, buildEnsemble(channel, i));
+    }
+}
+
+// -----------------------------------------------------------------------------
+// Commands - queued onto the HAL thread
+// -----------------------------------------------------------------------------
+
+void SimulatedRadioHAL::setBand(Band band) {
+    QMetaObject::invokeMethod(this, [this, band]() { doSetBand(band); });
+}
+
+void SimulatedRadioHAL::tune(int frequency) {
+    QMetaObject::invokeMethod(this, [this, frequency]() { doTune(frequency); });
+}
+
+void SimulatedRadioHAL::seek(bool up) {
+    QMetaObject::invokeMethod(this, [this, up]() { doSeek(up); });
+}
+
+void SimulatedRadioHAL::startScan(Band band, int scanId) {
+    QMetaObject::invokeMethod(this, [this, band, scanId]() { doStartScan(band, scanId); });
+}
+
+void SimulatedRadioHAL::cancelScan() {
+    QMetaObject::invokeMethod(this, [this]() { m_scanTimer->stop(); });
+}
+
+void SimulatedRadioHAL::followAlternatives(int frequency, quint16 pi, const QVector<int> &afs) {
+    QMetaObject::invokeMethod(this, [this, frequency, pi, afs]() { doFollowAlternatives(frequency, pi, afs); });
+}
+
+void SimulatedRadioHAL::fetchData() {
+    QMetaObject::invokeMethod(this, [this]() {
+        emit tuned(m_frequency, measure(m_band, m_frequency).rssi);
+        qCInfo(vcRadioHAL) << "Radio HAL Synced. Band:" << m_band << "Frequency:" << m_frequency;
+    });
+}
+
+// -----------------------------------------------------------------------------
+// HAL thread
+// -----------------------------------------------------------------------------
+
+void SimulatedRadioHAL::doSetBand(Band band) {
+    m_seekTimer->stop();
+    m_dataTimer->stop();
+    stopFollowing();
+    m_band = band;
+    m_plan = bandPlan(band);
+    doTune(m_plan.min);
+}
+
+void SimulatedRadioHAL::doTune(int frequency) {
+    m_seekTimer->stop();
+    stopFollowing();
+    m_frequency = qBound(m_plan.min, frequency, m_plan.max);
+    emit tuned(m_frequency, measure(m_band, m_frequency).rssi);
+    startStationData();
+}
+
+void SimulatedRadioHAL::doSeek(bool up) {
+    m_seekDirection = up ? 1 : -1;
+    m_seekStart = m_frequency;
+    m_dataTimer->stop(); // the receiver mutes while stepping
+    stopFollowing();
+    m_progressClock.start();
+    m_seekTimer->start();
+    qCInfo(vcRadioHAL) << "Seek" << (up ? "up" : "down") << "from" << m_frequency;
+}
+
+void SimulatedRadioHAL::seekStep() {
+    m_frequency = nextFrequency(m_frequency, m_seekDirection);
+
+    // Stop on a channel above threshold that is not the slope of a stronger
+    // neighbour (adjacent-channel ghosts of a strong station)
+    const int level = measure(m_band, m_frequency).rssi;
+    if (level >= SeekThreshold && level >= measure(m_band, nextFrequency(m_frequency, 1)).rssi
+        && level >= measure(m_band, nextFrequency(m_frequency, -1)).rssi) {
+        m_seekTimer->stop();
+        emit seekFinished(m_frequency, level, true);
+        startStationData();
+        return;
+    }
+    if (m_frequency == m_seekStart) {
+        // Full band without a station: stay where the seek started
+        m_seekTimer->stop();
+        emit seekFinished(m_frequency, level, false);
+        startStationData();
+        return;
+    }
+    if (m_progressClock.elapsed() >= ProgressIntervalMs) {
+        m_progressClock.restart();
+        emit seekProgress(m_frequency);
+    }
+}
+
+void SimulatedRadioHAL::doStartScan(Band band, int scanId) {
+    if (m_checkFrequency) {
+        // The scan takes the background tuner; the follower checks again later
+        m_af.checkResult(m_afClock.elapsed(), m_checkFrequency, -1, -1);
+        m_checkFrequency = 0;
+    }
+    m_scanBand = band;
+    m_scanId = scanId;
+    m_scanFrequency = bandPlan(band).min;
+    m_scanBatch.clear();
+    m_scanClock.start();
+    m_scanTimer->start();
+    qCInfo(vcRadioHAL) << "Background scan of band" << band;
+}
+
+void SimulatedRadioHAL::scanStep() {
+    const BandPlan plan = bandPlan(m_scanBand);
+    m_scanBatch.append(measure(m_scanBand, m_scanFrequency));
+    m_scanFrequency += plan.step;
+
+    const bool done = m_scanFrequency > plan.max;
+    if (done || m_scanClock.elapsed() >= ProgressIntervalMs) {
+        m_scanClock.restart();
+        emit scanMeasured(m_scanId, m_scanBatch);
+        m_scanBatch.clear();
+    }
+    if (done) {
+        m_scanTimer->stop();
+        emit scanFinished(m_scanId);
+    }
+}
+
+void SimulatedRadioHAL::startStationData() {
+    m_dataTimer->stop();
+    m_dataCredit = 0.0;
+    m_programmePhase = m_programmeSwell = 0.0;
+    if (m_band == BandAM) return;
+
+    const ChannelQuality q = measure(m_band, m_frequency);
+    m_dataSnr = q.snr;
+
+    if (m_band == BandDAB) {
+        if (q.snr < DataMinSnr) return;
+        if (m_ficRecording.isEmpty()) {
+            if (!m_ensembles.contains(m_frequency)) return;
+            m_ficEncoder.setEnsemble(m_ensembles.value(m_frequency));
+        }
+        m_dataTimer->start();
+        return;
+    }
+
+    // FM: the timer also paces signal monitoring and AF following
+    m_reportedLevel = q.rssi;
+    const Station *station = fmStation(m_frequency);
+    m_rdsOnAir = !m_rdsRecording.empty() || station;
+    if (m_rdsRecording.empty() && station) {
+        m_rdsEncoder = RdsEncoder();
+        m_rdsEncoder.setStation(station->pi, station->pty, station->ps, station->radioText, station->afs);
+        const QDateTime now = QDateTime::currentDateTimeUtc();
+        m_rdsEncoder.setClock(now.date().year(), now.date().month(), now.date().day(),
+                              now.time().hour(), now.time().minute(),
+                              QDateTime::currentDateTime().offsetFromUtc() / 1800);
+    }
+    m_dataTimer->start();
+}
+
+void SimulatedRadioHAL::stationDataStep() {
+    if (m_band == BandDAB) {
+        ficStep();
+        programmeStep();
+        return;
+    }
+
+    const ChannelQuality q = measure(BandFM, m_frequency);
+    m_dataSnr = q.snr;
+    programmeStep();
+    m_dataCredit += RdsEncoder::BitRate * ProgressIntervalMs / 1000.0;
+    const size_t count = size_t(m_dataCredit);
+    m_dataCredit -= double(count);
+
+    if (m_rdsOnAir) {
+        m_rdsBits.clear();
+        if (m_rdsRecording.empty()) {
+            m_rdsEncoder.generate(count, m_rdsBits);
+        } else {
+            for (size_t i = 0; i < count; ++i) {
+                m_rdsBits.push_back(m_rdsRecording[m_rdsRecordingPos]);
+                m_rdsRecordingPos = (m_rdsRecordingPos + 1) % m_rdsRecording.size();
+            }
+        }
+        if (m_dataSnr >= DataMinSnr) {
+            addBitErrors(m_rdsBits, m_dataSnr);
+            emit rdsData(QByteArray(reinterpret_cast<const char *>(m_rdsBits.data()), int(m_rdsBits.size())));
+        }
+    }
+    followStep(q);
+}
+
+void SimulatedRadioHAL::ficStep() {
+    // Transmission mode I: 12 FIBs per 96 ms frame
+    m_dataCredit += FibsPerSecond * ProgressIntervalMs / 1000.0;
+    const int count = int(m_dataCredit);
+    m_dataCredit -= count;
+
+    QByteArray fibs;
+    if (m_ficRecording.isEmpty()) {
+        m_ficEncoder.generate(count, fibs);
+    } else {
+        const int fibCount = int(m_ficRecording.size() / FicDecoder::FibSize);
+        for (int i = 0; i < count; ++i) {
+            fibs.append(m_ficRecording.mid(qsizetype(m_ficRecordingPos) * FicDecoder::FibSize, FicDecoder::FibSize));
+            m_ficRecordingPos = (m_ficRecordingPos + 1) % fibCount;
+        }
+    }
+
+    // A weak channel loses whole FIBs (the CRC rejects them downstream)
+    const double lossRate = qBound(0.0, (25 - m_dataSnr) / 50.0, 0.5);
+    for (int i = 0; i < count; ++i) {
+        if (m_noise.generateDouble() < lossRate) fibs[i * FicDecoder::FibSize + int(m_noise.bounded(30))] ^= 0x5A;
+    }
+    emit ficData(m_frequency, fibs);
+}
+
+void SimulatedRadioHAL::programmeStep() {
+    // Stand-in programme: a quiet tone of the channel's own pitch under a slow
+    // swell, with hiss as an FM signal fades (DAB plays clean or not at all)
+    constexpr int frames = AudioSampleRate * ProgressIntervalMs / 1000;
+    const double pitch = 220.0 * std::pow(2.0, (m_frequency % 24) / 12.0);
+    const double step = kTwoPi * pitch / AudioSampleRate;
+    const double swellStep = kTwoPi * ProgrammeSwellHz / AudioSampleRate;
+    const double hiss = m_band == BandFM ? 0.05 * qBound(0.0, (30 - m_dataSnr) / 30.0, 1.0) : 0.0;
+
+    QByteArray pcm(frames * 2 * int(sizeof(qint16)), Qt::Uninitialized);
+    qint16 *out = reinterpret_cast<qint16 *>(pcm.data());
+    for (int i = 0; i < frames; ++i) {
+        const double tone = 0.1 * (0.5 + 0.5 * std::sin(m_programmeSwell)) * std::sin(m_programmePhase);
+        m_programmePhase = std::fmod(m_programmePhase + step, kTwoPi);
+        m_programmeSwell = std::fmod(m_programmeSwell + swellStep, kTwoPi);
+        for (int c = 0; c < 2; ++c) {
+            const double noise = hiss > 0.0 ? hiss * (2.0 * m_noise.generateDouble() - 1.0) : 0.0;
+            out[2 * i + c] = qint16(qBound(-1.0, tone + noise, 1.0) * 32767.0);
+        }
+    }
+    emit audioData(pcm);
+}
+
+// -----------------------------------------------------------------------------
+// AF following
+// -----------------------------------------------------------------------------
+
+void SimulatedRadioHAL::doFollowAlternatives(int frequency, quint16 pi, const QVector<int> &afs) {
+    // Stale if the tuner has moved since the list was decoded
+    if (m_band != BandFM || frequency != m_frequency || m_seekTimer->isActive()) return;
+    if (pi == 0 || afs.isEmpty()) {
+        stopFollowing();
+        return;
+    }
+    m_af.setNetwork(frequency, pi, std::vector<int>(afs.begin(), afs.end()));
+}
+
+void SimulatedRadioHAL::stopFollowing() {
+    m_af.reset();
+    m_checkFrequency = 0;
+}
+
+void SimulatedRadioHAL::followStep(const ChannelQuality &tuned) {
+    if (qAbs(tuned.rssi - m_reportedLevel) >= SignalReportStep) {
+        m_reportedLevel = tuned.rssi;
+        emit signalMeasured(m_frequency, tuned.rssi);
+    }
+
+    if (m_checkFrequency) afCheckStep();
+    const qint64 now = m_afClock.elapsed();
+    const AfFollower::Decision decision = m_af.update(now, tuned.snr);
+    if (decision.action == AfFollower::Check) {
+        startAfCheck(decision.frequency);
+    } else if (decision.action == AfFollower::Switch) {
+        // Verified and clearly better: the audible tuner moves, nothing mutes
+        const int from = m_frequency;
+        m_checkFrequency = 0;
+        m_frequency = decision.frequency;
+        m_af.switched(now, m_frequency);
+        qCInfo(vcRadioHAL) << "AF switch" << from << "->" << m_frequency;
+        startStationData();
+        emit alternativeSwitched(from, m_frequency, m_reportedLevel);
+    }
+}
+
+void SimulatedRadioHAL::startAfCheck(int frequency) {
+    if (m_scanTimer->isActive()) {
+        // Background tuner busy with a band scan
+        m_af.checkResult(m_afClock.elapsed(), frequency, -1, -1);
+        return;
+    }
+    const ChannelQuality q = measure(BandFM, frequency);
+    const Station *station = fmStation(frequency);
+    m_checkFrequency = frequency;
+    m_checkSnr = q.snr;
+    m_checkTicks = 0;
+    m_checkDecoder.reset();
+    m_checkOnAir = station && q.snr >= DataMinSnr;
+    if (m_checkOnAir) {
+        m_checkEncoder = RdsEncoder();
+        m_checkEncoder.setStation(station->pi, station->pty, station->ps, station->radioText, station->afs);
+    }
+}
+
+void SimulatedRadioHAL::afCheckStep() {
+    // Decode the alternate's RDS until block A yields its PI
+    if (m_checkOnAir) {
+        std::vector<uint8_t> bits;
+        m_checkEncoder.generate(size_t(RdsEncoder::BitRate * ProgressIntervalMs / 1000.0), bits);
+        addBitErrors(bits, m_checkSnr);
+        m_checkDecoder.pushBits(bits.data(), bits.size());
+    }
+    ++m_checkTicks;
+    if (!m_checkDecoder.hasPi() && m_checkTicks < AfCheckTicks) return;
+    const int pi = m_checkDecoder.hasPi() ? int(m_checkDecoder.pi()) : -1;
+    m_af.checkResult(m_afClock.elapsed(), m_checkFrequency, m_checkSnr, pi);
+    m_checkFrequency = 0;
+}
+
+// -----------------------------------------------------------------------------
+// Simulation Logic
+// -----------------------------------------------------------------------------
+
+QVector<SimulatedRadioHAL::Station> SimulatedRadioHAL::buildStationField(Band band) {
+    QVector<Station> stations;
+    const BandPlan plan = bandPlan(band);
+    // Same field on every start; FM carries the default presets
+    QRandomGenerator layout(0xFA00 + int(band));
+    if (band == BandFM) {
+        for (int f : {9830, 10150, 10570}) stations.append({f, 85, 10});
+    }
+    const int channels = (plan.max - plan.min) / plan.step;
+    for (int ch = layout.bounded(2, 8); ch <= channels; ch += layout.bounded(4, 20)) {
+        const int f = plan.min + ch * plan.step;
+        bool clear = true;
+        for (const Station &s : stations) clear &= qAbs(s.frequency - f) > 2 * plan.step;
+        if (clear) stations.append({f, layout.bounded(55, 96), layout.bounded(0, 60)});
+    }
+    if (band != BandFM) return stations;
+
+    // RDS: the presets first, then local stations; every third local one
+    // relays "RADIO 1" so the network has alternative frequencies
+    static const char *const kNames[] = {"NRK P1", "P4 NORGE", "RADIO NR", "NRJ", "ROCK FM", "KISS", "P5 HITS", "NORSK PO", "RADIO RK", "VISIT"};
+    static const int kPty[] = {1, 10, 3, 10, 11, 10, 10, 15, 6, 7};
+    const struct { const char *ps; quint16 pi; int pty; const char *rt; } presets[] = {
+        {"CLASSIC", 0xF201, 14, "Classic FM - Sibelius: Finlandia, Op. 26"},
+        {"RADIO 1", 0xF202, 1, "Radio 1 - News and traffic every half hour"},
+        {"JAZZ", 0xF203, 12, "Jazz Radio - Miles Davis: So What"},
+    };
+    std::vector<int> network = {stations[1].frequency};
+    for (int i = 0; i < stations.size(); ++i) {
+        Station &s = stations[i];
+        if (i < 3) {
+            s.ps = presets[i].ps;
+            s.pi = presets[i].pi;
+            s.pty = presets[i].pty;
+            s.radioText = presets[i].rt;
+        } else if (i % 3 == 0) {
+            s.ps = presets[1].ps;
+            s.pi = presets[1].pi;
+            s.pty = presets[1].pty;
+            s.radioText = presets[1].rt;
+            network.push_back(s.frequency);
+        } else {
+            const int n = i % 10;
+            s.ps = kNames[n];
+            s.pi = quint16(0xF300 + i);
+            s.pty = kPty[n];
+            s.radioText = std::string(kNames[n]) + " - Local music and weather";
+        }
+    }
+    for (Station &s : stations) {
+        if (s.pi == presets[1].pi) s.afs = network;
+    }
+    return stations;
+}
+
+IRadioHAL::ChannelQuality SimulatedRadioHAL::measure(Band band, int frequency) {
+    const int step = bandPlan(band).step;
+    const int floor = 8 + m_noise.bounded(12);
+    ChannelQuality q;
+    q.frequency = frequency;
+    q.rssi = floor;
+    q.multipath = m_noise.bounded(10);
+    for (const Station &s : m_fields[band]) {
+        const int distance = qAbs(s.frequency - frequency) / step;
+        if (distance > 2) continue;
+        const int level = s.strength - 30 * distance + m_noise.bounded(-3, 4);
+        if (level > q.rssi) {
+            q.rssi = level;
+            q.multipath = qBound(0, s.multipath + m_noise.bounded(-5, 6), 100);
+        }
+    }
+    q.rssi = qBound(0, q.rssi, 100);
+    // Roughly 0.5 dB per level step above the noise floor, less what reflections smear
+    q.snr = qMax(0, (q.rssi - floor) / 2 - q.multipath / 10);
+    return q;
+}
+
+DabEnsemble SimulatedRadioHAL::buildEnsemble(int channel, int index) {
+    static const char *const kEnsembles[] = {"NRK Riks", "Riksblokk 2", "Lokal Oslo", "Lokal Viken", "Nordic Mux"};
+    static const char *const kServices[] = {
+        "NRK P1", "NRK P2", "NRK P3", "NRK Klassisk", "NRK Jazz", "NRK Nyheter", "NRK Sport", "NRK Folkemusikk",
+        "Radio Norge", "P4 Norge", "P5 Hits", "P7 Klem", "P10 Country", "NRJ", "Radio Rock", "Kiss",
+        "Radio Nova", "Radio Metro", "Radio 1", "Topp 40", "Vinyl", "Radio Vest", "Norsk Pop", "Jazz Radio"};
+    constexpr int kServiceCount = int(sizeof(kServices) / sizeof(kServices[0]));
+
+    // Deterministic per channel, like the station field
+    QRandomGenerator layout(0xDAB0 + channel);
+    DabEnsemble ensemble;
+    ensemble.channel = channel;
+    ensemble.ensembleId = quint16(0xF000 | (index + 1) << 4 | channel % 16);
+    ensemble.label = QString::fromLatin1(kEnsembles[index % 5]);
+    const int services = layout.bounded(5, 11);
+    for (int i = 0; i < services; ++i) {
+        DabService service;
+        service.serviceId = quint32(0xF200 + index * 0x20 + i);
+        service.label = QString::fromLatin1(kServices[(index * 7 + i) % kServiceCount]);
+        DabComponent audio;
+        audio.subChannelId = i + 1;
+        audio.primary = true;
+        audio.dabPlus = layout.bounded(10) > 0;
+        audio.bitrate = audio.dabPlus ? 48 + 16 * layout.bounded(4) : 128;
+        service.components.append(audio);
+        ensemble.services.append(service);
+    }
+    // One data service (programme guide) per ensemble
+    DabService epg;
+    epg.serviceId = 0xE0000000u | quint32(ensemble.ensembleId);
+    epg.label = QStringLiteral("EPG");
+    DabComponent data;
+    data.subChannelId = services + 1;
+    data.audio = false;
+    data.dabPlus = false;
+    data.primary = true;
+    data.bitrate = 16;
+    epg.components.append(data);
+    ensemble.services.append(epg);
+    return ensemble;
+}
+
+const SimulatedRadioHAL::Station *SimulatedRadioHAL::fmStation(int frequency) const {
+    for (const Station &s : m_fields[BandFM]) {
+        if (s.frequency == frequency) return &s;
+    }
+    return nullptr;
+}
+
+void SimulatedRadioHAL::addBitErrors(std::vector<uint8_t> &bits, int snr) {
+    // Short error bursts, more of them the weaker the channel
+    const double burstRate = qBound(0.0, (30 - snr) / 600.0, 0.05);
+    for (size_t i = 0; i < bits.size(); ++i) {
+        if (m_noise.generateDouble() >= burstRate) continue;
+        const size_t length = 1 + m_noise.bounded(3);
+        for (size_t k = i; k < qMin(i + length, bits.size()); ++k) bits[k] ^= 1;
+        i += length;
+    }
+}
+
+int SimulatedRadioHAL::nextFrequency(int frequency, int direction) const {
+    const int next = frequency + direction * m_plan.step;
+    if (next > m_plan.max) return m_plan.min;
+    if (next < m_plan.min) return m_plan.max;
+    return next;
+}
@@ -0,0 +1,154 @@
+#ifndef SIMULATEDRADIOHAL_H
+#define SIMULATEDRADIOHAL_H
+
+#include "IRadioHAL.h"
+#include "../Radio/RdsDecoder.h"
+#include "../Radio/DabFic.h"
+#include "../Radio/AfFollower.h"
+#include <QHash>
+#include <QTimer>
+#include <QElapsedTimer>
+#include <QRandomGenerator>
+#include <QVector>
+
+/**
+ * @brief Simulated Implementation of the Radio HAL.
+ *
+ * A fixed, seeded station field per band (the default presets included)
+ * with a measurable signal level: full strength on the station's channel,
+ * weaker ghosts on the adjacent ones, noise floor elsewhere. Seek steps one
+ * raster channel per dwell period on the HAL thread, like a real tuner
+ * waiting for its RSSI to settle. The background tuner sweeps a band one
+ * channel per ScanDwellMs (quality read only, no audio) on the same thread.
+ *
+ * FM stations carry RDS (PI, PTY, PS, RadioText, AF, clock); a few share
+ * a PI as one network on several frequencies. The bit stream gets errors
+ * in proportion to the channel's SNR. Setting NORDIC_RDS_RECORDING to a
+ * file of packed bits (MSB first) replays that recording instead.
+ * AF checks tune the background tuner to the alternate for up to
+ * AfCheckTicks data periods and decode its RDS until a PI appears; they
+ * wait while a band scan holds the background tuner.
+ *
+ * DAB channels carry an ensemble of 5-10 audio services and a data
+ * service, described by a generated FIC (FIBs lost at low SNR).
+ * NORDIC_DAB_RECORDING replays a file of raw 32-byte FIBs instead.
+ *
+ * The audio of a tuned FM or DAB station is a quiet tone per channel under
+ * a slow swell, with hiss on a weak FM signal; AM stays silent.
+ */
+class SimulatedRadioHAL : public IRadioHAL
+{
+    Q_OBJECT
+
+public:
+    explicit SimulatedRadioHAL(QObject *parent = nullptr);
+
+    static constexpr int StepDwellMs = 20;
+    static constexpr int ScanDwellMs = 4;
+    static constexpr int SeekThreshold = 50; // signal strength to stop a seek
+    static constexpr int DataMinSnr = 6;      // below this RDS / FIC are lost
+    static constexpr int FibsPerSecond = 125; // transmission mode I
+    static constexpr int AfCheckTicks = 3;    // PI must decode within this many data periods
+    static constexpr int SignalReportStep = 5;
+    static constexpr double ProgrammeSwellHz = 0.25;
+
+    // IRadioHAL Commands
+    void setBand(Band band) override;
+    void tune(int frequency) override;
+    void seek(bool up) override;
+    void startScan(Band band, int scanId) override;
+    void cancelScan() override;
+    void followAlternatives(int frequency, quint16 pi, const QVector<int> &afs) override;
+
+    // IRadioHAL Control
+    void fetchData() override;
+
+private slots:
+    void seekStep();
+    void scanStep();
+    void stationDataStep();
+
+private:
+    struct Station {
+        int frequency;
+        int strength;
+        int multipath; // terrain/reflection penalty at the receiver
+        // RDS (FM only)
+        quint16 pi = 0;
+        int pty = 0;
+        std::string ps;
+        std::string radioText;
+        std::vector<int> afs;
+    };
+
+    // HAL thread
+    void doSetBand(Band band);
+    void doTune(int frequency);
+    void doSeek(bool up);
+    void doStartScan(Band band, int scanId);
+    void doFollowAlternatives(int frequency, quint16 pi, const QVector<int> &afs);
+    static QVector<Station> buildStationField(Band band);
+    ChannelQuality measure(Band band, int frequency);
+    int nextFrequency(int frequency, int direction) const;
+    const Station *fmStation(int frequency) const;
+    void addBitErrors(std::vector<uint8_t> &bits, int snr);
+    void startStationData();
+    void ficStep();
+    void programmeStep();
+    void followStep(const ChannelQuality &tuned);
+    void startAfCheck(int frequency);
+    void afCheckStep();
+    void stopFollowing();
+    static DabEnsemble buildEnsemble(int channel, int index);
+
+
+    QTimer *m_seekTimer;
+    QTimer *m_scanTimer;
+    QTimer *m_dataTimer; // RDS or FIC of the audible station
+    QElapsedTimer m_progressClock;
+    QElapsedTimer m_scanClock;
+    QRandomGenerator m_noise;
+    QVector<Station> m_fields[3]; // per band
+
+    Band m_band = BandFM;
+    BandPlan m_plan;
+    int m_frequency;
+
+    // Seek in progress
+    int m_seekDirection = 0;
+    int m_seekStart = 0;
+
+    // Background scan in progress
+    Band m_scanBand = BandFM;
+    int m_scanId = 0;
+    int m_scanFrequency = 0;
+    QVector<ChannelQuality> m_scanBatch;
+
+    // RDS / FIC of the audible station
+    double m_dataCredit = 0.0; // bits or FIBs owed to the next batch
+    int m_dataSnr = 0;
+    RdsEncoder m_rdsEncoder;
+    std::vector<uint8_t> m_rdsRecording; // unpacked, replayed in a loop
+    size_t m_rdsRecordingPos = 0;
+    std::vector<uint8_t> m_rdsBits;
+    bool m_rdsOnAir = false;
+    QHash<int, DabEnsemble> m_ensembles; // by DAB channel
+    FicEncoder m_ficEncoder;
+    QByteArray m_ficRecording;
+    int m_ficRecordingPos = 0;
+    double m_programmePhase = 0.0;
+    double m_programmeSwell = 0.0;
+
+    // AF following of the audible FM station
+    AfFollower m_af;
+    QElapsedTimer m_afClock;
+    int m_reportedLevel = -1;
+    int m_checkFrequency = 0; // AF on the background tuner, 0 = none
+    int m_checkSnr = 0;
+    int m_checkTicks = 0;
+    RdsEncoder m_checkEncoder;
+    RdsDecoder m_checkDecoder;
+    bool m_checkOnAir = false;
+};
+
+#endif // SIMULATEDRADIOHAL_H
@@ -1,4 +1,5 @@
 #include "MediaLibrary.h"
+#include "Audio/SeekIndex.h"
 #include <QtConcurrent/QtConcurrent>
 #include <QStandardPaths>
 #include <QDir>
@@ -74,7 +75,9 @@ QList<Track> MediaLibrary::performScan() {
             t.album = "Unknown Album";
             t.sourceUrl = file.absoluteFilePath();
             t.coverUrl = "qrc:/qt/qml/NordicHeadunit/assets/icons/music.svg";
-            t.duration = 0; 
+            // Seek tables are built here, off the GUI thread, so first play can seek at once
+            const SeekIndex index = SeekIndex::supports(t.sourceUrl) ? SeekIndex::loadOrBuild(t.sourceUrl) : SeekIndex();
+            t.duration = int(index.durationMs() / 1000);
             tracks.append(t);
         }
     }
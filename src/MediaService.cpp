@@ -5,7 +5,13 @@
 #include <QDateTime>
 #include <QDebug>
 
-MediaService::MediaService(QObject *parent)
+#if QT_VERSION >= QT_VERSION_CHECK(6, 8, 0)
+#include <QtMultimedia/QAudioBufferOutput>
+#include <QtMultimedia/QAudioBuffer>
+#define NORDIC_HAS_PCM_TAP 1
+#endif
+
+MediaService::MediaService(IRadioHAL *radioHal, QObject *parent)
     : QObject(parent),
       m_currentSource("Bluetooth"),
       m_currentIndex(0),
@@ -13,7 +19,8 @@ MediaService::MediaService(QObject *parent)
       m_repeatEnabled(false),
       m_isSimulating(false),
       m_isConnected(true),
-      m_isLoading(false)
+      m_isLoading(false),
+      m_radioHal(radioHal)
 {
     // COMPONENTS
     m_player = new QMediaPlayer(this);
@@ -21,13 +28,20 @@ MediaService::MediaService(QObject *parent)
     m_player->setAudioOutput(m_audioOutput);
     m_audioOutput->setVolume(1.0);
     
-    m_radioTuner = new RadioTuner(this);
+    m_radioTuner = new RadioTuner(radioHal, this);
     m_mediaLibrary = new MediaLibrary(this);
+    // Children go in creation order: the stream, and the receiver thread
+    // feeding the analyzer, stop before the analyzer is freed
+    m_btStream = new StreamingPcmSource(this);
+    m_spectrum = new SpectrumAnalyzer(this);
+    m_timeStretch = new TimeStretchOutput(this);
+    m_seekIndex = new SeekIndexLoader(this);
 
     // SIGNALS - PLAYER
     connect(m_player, &QMediaPlayer::positionChanged, this, &MediaService::onMPlayerPositionChanged);
     connect(m_player, &QMediaPlayer::durationChanged, this, &MediaService::onMPlayerDurationChanged);
     connect(m_player, &QMediaPlayer::mediaStatusChanged, this, &MediaService::onMPlayerStatusChanged);
+    connect(m_seekIndex, &SeekIndexLoader::ready, this, &MediaService::onSeekIndexReady);
     connect(m_player, &QMediaPlayer::errorOccurred, this, [this](QMediaPlayer::Error, const QString &errorString){
         qWarning() << "Media Error:" << errorString;
         emit errorChanged();
@@ -41,6 +55,28 @@ MediaService::MediaService(QObject *parent)
     // SIGNALS - LIBRARY
     connect(m_mediaLibrary, &MediaLibrary::libraryUpdated, this, &MediaService::onLibraryUpdated);
 
+    // SIGNALS - SPECTRUM (analyzer only runs while a visualizer is on screen)
+    connect(m_spectrum, &SpectrumAnalyzer::activeChanged, this, &MediaService::onSpectrumActiveChanged);
+    connect(this, &MediaService::playingChanged, this, &MediaService::updateSpectrumSource);
+    connect(this, &MediaService::currentSourceChanged, this, &MediaService::updateSpectrumSource);
+
+    // SIGNALS - BLUETOOTH STREAM (local A2DP sink stand-in)
+    connect(m_btStream, &StreamingPcmSource::connectedChanged, this, &MediaService::onBluetoothStreamConnectedChanged);
+    connect(m_btStream, &StreamingPcmSource::metadataChanged, this, [this]() {
+        if (isStreaming()) emit trackChanged();
+    });
+    connect(m_btStream, &StreamingPcmSource::pausedChanged, this, [this]() {
+        if (isStreaming()) emit playingChanged(playing());
+    });
+    m_btStream->setSpectrumTap(m_spectrum);
+    m_btStream->setOutputActive(m_currentSource == "Bluetooth");
+    m_btStream->start();
+
+    // SIGNALS - OUTPUT PATH (mixer routing, focus, pitch-preserving playbackSpeed)
+    connect(this, &MediaService::playingChanged, this, &MediaService::updateMediaOutput);
+    connect(this, &MediaService::currentSourceChanged, this, &MediaService::updateMediaOutput);
+    connect(this, &MediaService::trackChanged, this, &MediaService::updateMediaOutput);
+
     // SIMULATION
     m_simTimer = new QTimer(this);
     m_simTimer->setInterval(100);
@@ -54,39 +90,53 @@ MediaService::MediaService(QObject *parent)
 // =============================================================================
 RadioTuner* MediaService::radio() const { return m_radioTuner; }
 MediaLibrary* MediaService::library() const { return m_mediaLibrary; }
+SpectrumAnalyzer* MediaService::spectrum() const { return m_spectrum; }
+StreamingPcmSource* MediaService::bluetoothStream() const { return m_btStream; }
+TimeshiftOutput* MediaService::timeshift() const { return m_timeshift; }
+bool MediaService::isStreaming() const { return m_currentSource == "Bluetooth" && m_btStream->isConnected(); }
 
 QString MediaService::title() const {
     if (isRadioMode()) return m_radioTuner->stationName().isEmpty() ? ("FM " + radioFrequency()) : m_radioTuner->stationName();
+    if (isStreaming()) return m_btStream->title().isEmpty() ? "Bluetooth Audio" : m_btStream->title();
     Track t = m_mediaLibrary->model()->getTrack(m_currentIndex);
     return t.title.isEmpty() ? "Not Playing" : t.title;
 }
 
 QString MediaService::artist() const {
     if (isRadioMode()) return radioFrequency() + " MHz";
+    if (isStreaming()) return m_btStream->artist();
     Track t = m_mediaLibrary->model()->getTrack(m_currentIndex);
     return t.artist.isEmpty() ? "" : t.artist;
 }
 
 QString MediaService::coverSource() const {
     if (isRadioMode()) return "qrc:/qt/qml/NordicHeadunit/assets/icons/radio-tower.svg";
+    if (isStreaming()) return "qrc:/qt/qml/NordicHeadunit/assets/icons/bluetooth.svg";
     return m_mediaLibrary->model()->getTrack(m_currentIndex).coverUrl;
 }
 
 bool MediaService::playing() const {
-    if (isRadioMode()) return true; // Radio always "playing" if active
+    if (isRadioMode()) return m_timeshift && !m_timeshift->isPaused(); // paused radio keeps recording
+    if (isStreaming()) return !m_btStream->isPaused();
     if (m_isSimulating) return m_simTimer->isActive();
     return m_player->playbackState() == QMediaPlayer::PlayingState;
 }
 
 qint64 MediaService::position() const {
-    if (isRadioMode()) return 0;
-    if (m_isSimulating) return m_simPos / 1000;
-    return m_player->position() / 1000;
+    return positionMs() / 1000;
+}
+
+qint64 MediaService::positionMs() const {
+    if (isRadioMode() || isStreaming()) return 0;
+    if (m_isSimulating) return m_simPos;
+    return m_positionOffsetMs + m_player->position();
 }
 
 qint64 MediaService::duration() const {
-    if (isRadioMode()) return 0;
+    if (isRadioMode() || isStreaming()) return 0;
     if (m_isSimulating) return m_simDur / 1000;
+    // After a frame-offset seek the player only sees the tail of the file
+    if (m_seekIndex->index().isValid()) return m_seekIndex->index().durationMs() / 1000;
     return m_player->duration() / 1000;
 }
 
@@ -107,7 +157,7 @@ QString MediaService::errorMessage() const { return m_player->errorString(); }
 QVariantList MediaService::sources() const {
     QVariantList list;
     list.append(QVariantMap{{"name", "Radio"}, {"icon", "qrc:/qt/qml/NordicHeadunit/assets/icons/signal.svg"}, {"active", m_currentSource == "Radio"}, {"lastPlayed", ""}});
-    list.append(QVariantMap{{"name", "Bluetooth"}, {"icon", "qrc:/qt/qml/NordicHeadunit/assets/icons/bluetooth.svg"}, {"active", m_currentSource == "Bluetooth"}, {"lastPlayed", ""}});
+    list.append(QVariantMap{{"name", "Bluetooth"}, {"icon", "qrc:/qt/qml/NordicHeadunit/assets/icons/bluetooth.svg"}, {"active", m_currentSource == "Bluetooth"}, {"lastPlayed", ""}, {"connected", m_btStream->isConnected()}});
     list.append(QVariantMap{{"name", "USB"}, {"icon", "qrc:/qt/qml/NordicHeadunit/assets/icons/music.svg"}, {"active", m_currentSource == "USB"}, {"lastPlayed", ""}});
     return list;
 }
@@ -156,18 +206,21 @@ void MediaService::setCurrentSource(const QString &source) {
 
     // Stop current
     if (isRadioMode()) stopRadio();
-    else {
+    else if (!isStreaming()) {
         m_player->stop();
         stopSimulation();
         m_lastIndex[m_currentSource] = m_currentIndex;
-        m_lastPos[m_currentSource] = position();
+        m_lastPos[m_currentSource] = positionMs();
     }
 
     m_currentSource = source;
+    m_btStream->setOutputActive(m_currentSource == "Bluetooth");
 
     // Restore new
     if (isRadioMode()) {
         playRadio();
+    } else if (isStreaming()) {
+        // Live stream owns the output; library playback stays parked
     } else {
         // Restore State
         m_currentIndex = m_lastIndex.value(source, 0);
@@ -175,6 +228,7 @@ void MediaService::setCurrentSource(const QString &source) {
         playTrack(m_currentIndex); // Logic needs to respect pause usage?
         // Actually, just loading the track don't auto play unless it was playing? 
         // For simplicity: auto play
+        if (pos > 0 && !m_isSimulating) seekToMs(pos);
     }
     
     emit currentSourceChanged();
@@ -185,7 +239,8 @@ void MediaService::setCurrentSource(const QString &source) {
 void MediaService::setBand(int band) { m_radioTuner->setBand(static_cast<RadioTuner::Band>(band)); }
 
 void MediaService::play() {
-    if (isRadioMode()) return; // Radio is "live"
+    if (isRadioMode()) { if (m_timeshift) m_timeshift->setPaused(false); return; } // resumes behind live
+    if (isStreaming()) { m_btStream->setPaused(false); return; }
     if (m_isSimulating) {
         m_simTimer->start();
         emit playingChanged(true);
@@ -195,7 +250,8 @@ void MediaService::play() {
 }
 
 void MediaService::pause() {
-    if (isRadioMode()) return;
+    if (isRadioMode()) { if (m_timeshift) m_timeshift->setPaused(true); return; }
+    if (isStreaming()) { m_btStream->setPaused(true); return; }
     if (m_isSimulating) {
         m_simTimer->stop();
         emit playingChanged(false);
@@ -205,11 +261,7 @@ void MediaService::pause() {
 }
 
 void MediaService::togglePlayPause() {
-    if (isRadioMode()) {
-        // Mute?
-    } else {
-        if (playing()) pause(); else play();
-    }
+    if (playing()) pause(); else play();
 }
 
 void MediaService::setPlaying(bool playing) { if (playing) play(); else pause(); }
@@ -217,6 +269,8 @@ void MediaService::setPlaying(bool playing) { if (playing) play(); else pause();
 void MediaService::next() {
     if (isRadioMode()) {
         tuneStep(0.1); // Basic implementation
+    } else if (isStreaming()) {
+        // Track control belongs to the phone (AVRCP)
     } else {
         int nextIndex = (m_currentIndex + 1) % m_mediaLibrary->model()->rowCount();
         playTrack(nextIndex);
@@ -226,6 +280,8 @@ void MediaService::next() {
 void MediaService::previous() {
     if (isRadioMode()) {
         tuneStep(-0.1);
+    } else if (isStreaming()) {
+        // Track control belongs to the phone (AVRCP)
     } else {
         int prevIndex = (m_currentIndex - 1 + m_mediaLibrary->model()->rowCount()) % m_mediaLibrary->model()->rowCount();
         playTrack(prevIndex);
@@ -233,7 +289,53 @@ void MediaService::previous() {
 }
 
 void MediaService::seek(qint64 position) {
-    if (!isRadioMode() && !m_isSimulating) m_player->setPosition(position * 1000);
+    if (!isRadioMode() && !isStreaming() && !m_isSimulating) seekToMs(position * 1000);
+}
+
+void MediaService::seekToMs(qint64 ms) {
+    // Resume targets wait for the index; a backend seek also needs loaded media
+    if (m_seekIndex->isLoading()) {
+        m_pendingSeekMs = ms;
+        return;
+    }
+    m_pendingSeekMs = -1;
+    m_timeStretch->flush();
+
+    const SeekIndex &index = m_seekIndex->index();
+    if (index.isValid() && index.format() == SeekIndex::Mp3 && index.isVbr()) {
+        // No trustworthy TOC for the backend: restart decoding at the exact
+        // frame the index found instead of letting it scan or estimate
+        QFile file(m_seekIndex->path());
+        if (file.open(QIODevice::ReadOnly)) {
+            const SeekIndex::Position target = index.locate(ms, &file);
+            auto *device = new FileRangeDevice(m_seekIndex->path(), target.offset, index.audioEnd(), this);
+            if (device->open(QIODevice::ReadOnly)) {
+                const bool resume = m_player->playbackState() == QMediaPlayer::PlayingState;
+                m_player->setSourceDevice(device, QUrl::fromLocalFile(m_seekIndex->path()));
+                delete m_rangeDevice;
+                m_rangeDevice = device;
+                m_positionOffsetMs = target.ms;
+                if (resume) m_player->play();
+                emit positionChanged();
+                return;
+            }
+            delete device;
+        }
+    }
+
+    // CBR MP3 and MP4 backends seek exactly by time; snap to the frame start
+    if (index.isValid()) ms = index.locate(ms).ms;
+    const QMediaPlayer::MediaStatus status = m_player->mediaStatus();
+    if (status == QMediaPlayer::NoMedia || status == QMediaPlayer::LoadingMedia) {
+        m_pendingSeekMs = ms;
+        return;
+    }
+    m_player->setPosition(qMax<qint64>(0, ms - m_positionOffsetMs));
+}
+
+void MediaService::onSeekIndexReady() {
+    emit trackChanged(); // duration from the index
+    if (m_pendingSeekMs >= 0) seekToMs(m_pendingSeekMs);
 }
 
 void MediaService::setSource(const QString &source) { setCurrentSource(source); }
@@ -260,8 +362,17 @@ void MediaService::playFile(const QString &url) {
         m_isSimulating = true;
     } else {
         m_isSimulating = false;
+        m_timeStretch->flush();
+        m_pendingSeekMs = -1;
+        m_positionOffsetMs = 0;
         m_player->setSource(QUrl::fromUserInput(url));
+        delete m_rangeDevice; // released by setSource
+        m_rangeDevice = nullptr;
         m_player->play();
+
+        // Cached on disk after the library scan; otherwise built once in the
+        // background, for the containers the index reads
+        m_seekIndex->load(QFile::exists(playUrl) ? playUrl : url);
     }
     emit trackChanged();
 }
@@ -308,10 +419,105 @@ void MediaService::onLibraryUpdated() {
     emit sourcesChanged(); // Maybe count changed?
 }
 
+void MediaService::updateSpectrumSource() {
+    // Decoded files and the Bluetooth stream produce PCM; the tuner and the simulation do not
+    m_spectrum->setSourceRunning(!isRadioMode() && (isStreaming() || !m_isSimulating) && playing());
+}
+
+void MediaService::onBluetoothStreamConnectedChanged() {
+    if (m_currentSource == "Bluetooth") {
+        if (m_btStream->isConnected()) {
+            // Producer arrived: park library playback, the stream takes over
+            m_player->stop();
+            if (m_isSimulating) stopSimulation();
+            m_lastIndex[m_currentSource] = m_currentIndex;
+        } else {
+            // Producer left: fall back to the local library
+            playTrack(m_lastIndex.value(m_currentSource, m_currentIndex));
+        }
+        emit trackChanged();
+        emit playingChanged(playing());
+        emit currentSourceChanged();
+    }
+    emit sourcesChanged();
+}
+
+void MediaService::onSpectrumActiveChanged(bool) {
+    updatePcmTap();
+}
+
+void MediaService::updatePcmTap() {
+#ifdef NORDIC_HAS_PCM_TAP
+    const bool needed = m_spectrum->isActive() || m_timeStretch->isEngaged();
+    if (needed && !m_bufferOutput) {
+        QAudioFormat format;
+        format.setSampleFormat(QAudioFormat::Float);
+        format.setChannelCount(2);
+        format.setSampleRate(48000);
+        m_bufferOutput = new QAudioBufferOutput(format, this);
+        // Direct: both consumers only copy into lock-free rings and ignore
+        // buffers while they are switched off
+        connect(m_bufferOutput, &QAudioBufferOutput::audioBufferReceived, this, [this](const QAudioBuffer &buffer) {
+            const QAudioFormat fmt = buffer.format();
+            const int frames = int(buffer.frameCount());
+            if (fmt.sampleFormat() == QAudioFormat::Float) {
+                m_spectrum->pushSamples(buffer.constData<float>(), frames, fmt.channelCount(), fmt.sampleRate());
+                m_timeStretch->pushSamples(buffer.constData<float>(), frames, fmt.channelCount(), fmt.sampleRate());
+            } else if (fmt.sampleFormat() == QAudioFormat::Int16) {
+                m_spectrum->pushSamples(buffer.constData<qint16>(), frames, fmt.channelCount(), fmt.sampleRate());
+                m_timeStretch->pushSamples(buffer.constData<qint16>(), frames, fmt.channelCount(), fmt.sampleRate());
+            }
+        }, Qt::DirectConnection);
+    }
+    m_player->setAudioBufferOutput(needed ? m_bufferOutput : nullptr);
+#else
+    // Qt < 6.8 has no decoded PCM tap; the bars stay at rest
+#endif
+}
+
+void MediaService::updateMediaOutput() {
+    if (!m_focus) return;
+#ifdef NORDIC_HAS_PCM_TAP
+    // Library files leave the backend output and reach the mixer through the
+    // PCM tap, so focus ducking is sample-accurate and playbackSpeed keeps
+    // its pitch (WSOLA); the player's rate then only paces decoding
+    const bool engage = !isRadioMode() && !isStreaming() && !m_isSimulating;
+    if (engage != m_timeStretch->isEngaged()) {
+        m_timeStretch->setEngaged(engage);
+        m_player->setAudioOutput(engage ? nullptr : m_audioOutput);
+        updatePcmTap();
+    }
+    m_timeStretch->setTempo(m_playbackSpeed);
+    m_timeStretch->setPaused(!playing());
+#endif
+
+    StreamPlaybackDevice *source = nullptr;
+    if (isRadioMode()) source = m_timeshift ? m_timeshift->playbackDevice() : nullptr;
+    else if (isStreaming()) source = m_btStream->playbackDevice();
+    else if (m_timeStretch->isEngaged()) source = m_timeStretch->playbackDevice();
+    if (source != m_mixerSource) {
+        m_mixerSource = source;
+        m_focus->mixer()->setMediaSource(source);
+    }
+
+    if (playing()) m_focus->request(AudioFocusManager::Media);
+    else m_focus->abandon(AudioFocusManager::Media);
+}
+
+void MediaService::setAudioFocus(AudioFocusManager *focus) {
+    m_focus = focus;
+    // Backend output (Qt < 6.8): block-rate volume steps are the best available
+    connect(m_focus, &AudioFocusManager::mediaGainChanged, this, [this](double gain) {
+        m_audioOutput->setVolume(gain);
+    });
+    updateMediaOutput();
+}
+
 void MediaService::onMPlayerPositionChanged(qint64) { emit positionChanged(); }
 void MediaService::onMPlayerDurationChanged(qint64) { emit trackChanged(); }
 void MediaService::onMPlayerStatusChanged(QMediaPlayer::MediaStatus status) {
     if (status == QMediaPlayer::EndOfMedia) next();
+    else if (status == QMediaPlayer::LoadedMedia && m_pendingSeekMs >= 0) seekToMs(m_pendingSeekMs);
     emit playingChanged(playing()); 
 }
 
@@ -340,12 +546,27 @@ void MediaService::updateSimulation() {
 }
 
 void MediaService::playRadio() {
-    // In real hardware, unmute tuner
-    // Here, just emit
+    ensureTimeshift();
+    // Live again, or where a pause left off
+    m_timeshift->setOutputActive(true);
 }
 
 void MediaService::stopRadio() {
-    // Mute tuner
+    // Recording goes on; only the output is released
+    if (m_timeshift) m_timeshift->setOutputActive(false);
+}
+
+void MediaService::ensureTimeshift() {
+    if (m_timeshift) return;
+    // The ring file is only mapped once the radio is first listened to; from
+    // then on the tuner is recorded whichever source is heard
+    m_timeshift = new TimeshiftOutput(QString(), TimeshiftOutput::DefaultSeconds, this);
+    if (m_radioHal) connect(m_radioHal, &IRadioHAL::audioData, m_timeshift, &TimeshiftOutput::pushPcm);
+    connect(m_radioTuner, &RadioTuner::programmeChanged, m_timeshift, &TimeshiftOutput::restart);
+    connect(m_timeshift, &TimeshiftOutput::stateChanged, this, [this]() {
+        if (isRadioMode()) emit playingChanged(playing());
+    });
+    emit timeshiftChanged();
 }
 
 // =============================================================================
@@ -355,7 +576,9 @@ void MediaService::stopRadio() {
 void MediaService::setPlaybackSpeed(double speed) {
     if (qFuzzyCompare(m_playbackSpeed, speed)) return;
     m_playbackSpeed = qBound(0.5, speed, 2.0);
+    // Without a PCM tap (Qt < 6.8) this is the whole story: backend rate, backend pitch
     m_player->setPlaybackRate(m_playbackSpeed);
+    updateMediaOutput();
     emit playbackSpeedChanged();
 }
 
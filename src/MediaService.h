@@ -7,6 +7,14 @@
 #include <QDateTime>
 #include "RadioTuner.h"
 #include "MediaLibrary.h"
+#include "Audio/SpectrumAnalyzer.h"
+#include "Audio/StreamingPcmSource.h"
+#include "Audio/TimeStretchOutput.h"
+#include "Audio/TimeshiftOutput.h"
+#include "Audio/AudioFocusManager.h"
+#include "Audio/SeekIndex.h"
+
+class QAudioBufferOutput;
 
 class MediaService : public QObject
 {
@@ -44,6 +52,10 @@ class MediaService : public QObject
     // Sub-components (Exposed to QML)
     Q_PROPERTY(RadioTuner* radio READ radio CONSTANT)
     Q_PROPERTY(MediaLibrary* library READ library CONSTANT)
+    Q_PROPERTY(SpectrumAnalyzer* spectrum READ spectrum CONSTANT)
+    Q_PROPERTY(StreamingPcmSource* bluetoothStream READ bluetoothStream CONSTANT)
+    Q_PROPERTY(TimeshiftOutput* timeshift READ timeshift NOTIFY timeshiftChanged) // null until the radio is first played
+    Q_PROPERTY(bool isStreaming READ isStreaming NOTIFY currentSourceChanged)
     
     // Legacy/Convenience properties for Radio View compatibility
     Q_PROPERTY(QString radioFrequency READ radioFrequency NOTIFY radioChanged) // Proxy
@@ -62,7 +74,11 @@ class MediaService : public QObject
     Q_PROPERTY(QString errorMessage READ errorMessage NOTIFY errorChanged)
 
 public:
-    explicit MediaService(QObject *parent = nullptr);
+    // The radio HAL runs on its own thread (see main.cpp)
+    explicit MediaService(IRadioHAL *radioHal, QObject *parent = nullptr);
+
+    // Output path: media plays through the focus manager's mixer
+    void setAudioFocus(AudioFocusManager *focus);
 
     // Getters
     QString title() const;
@@ -85,6 +101,10 @@ public:
 
     RadioTuner* radio() const;
     MediaLibrary* library() const;
+    SpectrumAnalyzer* spectrum() const;
+    StreamingPcmSource* bluetoothStream() const;
+    TimeshiftOutput* timeshift() const;
+    bool isStreaming() const; // Bluetooth selected and a producer is connected
 
     // Proxy Radio Getters
     QString radioFrequency() const;
@@ -166,6 +186,7 @@ signals:
     void gaplessEnabledChanged();
     void sleepTimerChanged();
     void eqChanged();
+    void timeshiftChanged();
 
 private slots:
     void onMPlayerPositionChanged(qint64 position);
@@ -175,6 +196,8 @@ private slots:
     // Handle sub-component signals
     void onRadioFrequencyChanged();
     void onLibraryUpdated();
+    void onSpectrumActiveChanged(bool active);
+    void onBluetoothStreamConnectedChanged();
 
 private:
     QMediaPlayer *m_player;
@@ -182,6 +205,13 @@ private:
     
     RadioTuner *m_radioTuner;
     MediaLibrary *m_mediaLibrary;
+    SpectrumAnalyzer *m_spectrum;
+    StreamingPcmSource *m_btStream;
+    TimeStretchOutput *m_timeStretch;
+    TimeshiftOutput *m_timeshift = nullptr;
+    AudioFocusManager *m_focus = nullptr;
+    StreamPlaybackDevice *m_mixerSource = nullptr;
+    QAudioBufferOutput *m_bufferOutput = nullptr; // PCM tap, only attached while the analyzer or the stretcher needs it
 
     // State
     QString m_currentSource;
@@ -198,12 +228,19 @@ private:
     void stopSimulation();
     void updateSimulation();
 
+    // Seek index of the current file (built by the library scan or on first play)
+    SeekIndexLoader *m_seekIndex;
+    FileRangeDevice *m_rangeDevice = nullptr; // player source after a frame-offset seek
+    qint64 m_positionOffsetMs = 0;            // start of m_rangeDevice in the track
+    qint64 m_pendingSeekMs = -1;              // resume target waiting for the index or the media
+
     // Source Memory
-    QMap<QString, qint64> m_lastPos;
+    QMap<QString, qint64> m_lastPos; // ms
     QMap<QString, int> m_lastIndex;
 
     bool m_isConnected;
     bool m_isLoading;
+    IRadioHAL *m_radioHal; // recorded into the timeshift ring once that exists
     
     // Advanced Playback State
     double m_playbackSpeed = 1.0;
@@ -220,7 +257,14 @@ private:
 
     void playRadio();
     void stopRadio();
+    void ensureTimeshift();
     void playFile(const QString &url);
+    qint64 positionMs() const;
+    void seekToMs(qint64 ms);
+    void onSeekIndexReady();
+    void updateSpectrumSource();
+    void updatePcmTap();
+    void updateMediaOutput();
 };
 
 #endif // MEDIASERVICE_H
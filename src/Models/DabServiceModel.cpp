@@ -0,0 +1,45 @@
+#include "DabServiceModel.h"
+
+DabServiceModel::DabServiceModel(QObject *parent) : QAbstractListModel(parent) {}
+
+int DabServiceModel::rowCount(const QModelIndex &parent) const {
+    if (parent.isValid()) return 0;
+    return m_services.count();
+}
+
+QVariant DabServiceModel::data(const QModelIndex &index, int role) const {
+    if (!index.isValid() || index.row() >= m_services.count()) return QVariant();
+
+    const DabServiceEntry &service = m_services[index.row()];
+    switch (role) {
+    case NameRole: return service.name;
+    case ShortNameRole: return service.shortName;
+    case EnsembleRole: return service.ensemble;
+    case ChannelRole: return service.channelLabel;
+    case BitrateRole: return service.bitrate;
+    case CodecRole: return service.dabPlus ? QStringLiteral("DAB+") : QStringLiteral("DAB");
+    default: return QVariant();
+    }
+}
+
+QHash<int, QByteArray> DabServiceModel::roleNames() const {
+    QHash<int, QByteArray> roles;
+    roles[NameRole] = "name";
+    roles[ShortNameRole] = "shortName";
+    roles[EnsembleRole] = "ensemble";
+    roles[ChannelRole] = "channel";
+    roles[BitrateRole] = "bitrate";
+    roles[CodecRole] = "codec";
+    return roles;
+}
+
+void DabServiceModel::setServices(const QList<DabServiceEntry> &services) {
+    beginResetModel();
+    m_services = services;
+    endResetModel();
+}
+
+DabServiceEntry DabServiceModel::getService(int index) const {
+    if (index < 0 || index >= m_services.count()) return DabServiceEntry();
+    return m_services[index];
+}
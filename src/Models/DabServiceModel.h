@@ -0,0 +1,40 @@
+#pragma once
+#include <QAbstractListModel>
+#include <QObject>
+#include <QList>
+
+struct DabServiceEntry {
+    quint32 serviceId = 0;
+    QString name;
+    QString shortName;
+    QString ensemble;
+    int channel = -1;      // Band III channel index
+    QString channelLabel;  // "12C"
+    int bitrate = 0;       // kbit/s of the primary component
+    bool dabPlus = true;
+};
+
+// Audio services of all known DAB ensembles, sorted by name
+class DabServiceModel : public QAbstractListModel {
+    Q_OBJECT
+public:
+    enum ServiceRoles {
+        NameRole = Qt::UserRole + 1,
+        ShortNameRole,
+        EnsembleRole,
+        ChannelRole,
+        BitrateRole,
+        CodecRole
+    };
+
+    explicit DabServiceModel(QObject *parent = nullptr);
+    int rowCount(const QModelIndex &parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const override;
+    QHash<int, QByteArray> roleNames() const override;
+
+    void setServices(const QList<DabServiceEntry> &services);
+    DabServiceEntry getService(int index) const;
+
+private:
+    QList<DabServiceEntry> m_services;
+};
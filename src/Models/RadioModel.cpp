@@ -32,32 +32,38 @@ QHash<int, QByteArray> RadioModel::roleNames() const {
 void RadioModel::addStation(const RadioStation &station) {
     beginInsertRows(QModelIndex(), m_stations.count(), m_stations.count());
     m_stations.append(station);
+    m_stations.last().active = false;
     endInsertRows();
+    if (station.active) setActive(m_stations.count() - 1);
 }
 
 void RadioModel::removeStation(int index) {
     if (index < 0 || index >= m_stations.count()) return;
     beginRemoveRows(QModelIndex(), index, index);
     m_stations.removeAt(index);
+    if (m_activeIndex == index) m_activeIndex = -1;
+    else if (m_activeIndex > index) --m_activeIndex;
     endRemoveRows();
 }
 
 void RadioModel::clear() {
     beginResetModel();
     m_stations.clear();
+    m_activeIndex = -1;
     endResetModel();
 }
 
 void RadioModel::setActive(int index) {
-    // Deactivate all
-    for (int i = 0; i < m_stations.count(); ++i) {
-        if (m_stations[i].active) {
-            m_stations[i].active = false;
-            emit dataChanged(this->index(i), this->index(i), {ActiveRole});
-        }
+    if (index < 0 || index >= m_stations.count()) index = -1;
+    if (index == m_activeIndex) return;
+
+    // Only the previous and the new row change
+    if (m_activeIndex >= 0) {
+        m_stations[m_activeIndex].active = false;
+        emit dataChanged(this->index(m_activeIndex), this->index(m_activeIndex), {ActiveRole});
     }
-    
-    if (index >= 0 && index < m_stations.count()) {
+    m_activeIndex = index;
+    if (index >= 0) {
         m_stations[index].active = true;
         emit dataChanged(this->index(index), this->index(index), {ActiveRole});
     }
@@ -68,13 +74,3 @@ RadioStation RadioModel::getStation(int index) const {
     return m_stations[index];
 }
 
-int RadioModel::activeStationIndex() const {
-    for (int i = 0; i < m_stations.count(); ++i) {
-        if (m_stations[i].active) return i;
-    }
-    return -1;
-}
-
-QList<RadioStation> RadioModel::getAll() const {
-    return m_stations;
-}
@@ -30,9 +30,10 @@ public:
     void clear();
     void setActive(int index);
     RadioStation getStation(int index) const;
-    int activeStationIndex() const;
-    QList<RadioStation> getAll() const;
+    int activeStationIndex() const { return m_activeIndex; }
+    const QList<RadioStation> &getAll() const { return m_stations; }
 
 private:
     QList<RadioStation> m_stations;
+    int m_activeIndex = -1;
 };
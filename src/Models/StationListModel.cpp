@@ -0,0 +1,56 @@
+#include "StationListModel.h"
+
+StationListModel::StationListModel(QObject *parent) : QAbstractListModel(parent) {}
+
+int StationListModel::rowCount(const QModelIndex &parent) const {
+    if (parent.isValid()) return 0;
+    return m_stations.count();
+}
+
+QVariant StationListModel::data(const QModelIndex &index, int role) const {
+    if (!index.isValid() || index.row() >= m_stations.count()) return QVariant();
+
+    const ScannedStation &station = m_stations[index.row()];
+    switch (role) {
+    case FrequencyRole: return station.frequency;
+    case BandRole: return station.band;
+    case RssiRole: return station.rssi;
+    case SnrRole: return station.snr;
+    case MultipathRole: return station.multipath;
+    default: return QVariant();
+    }
+}
+
+QHash<int, QByteArray> StationListModel::roleNames() const {
+    QHash<int, QByteArray> roles;
+    roles[FrequencyRole] = "frequency";
+    roles[BandRole] = "band";
+    roles[RssiRole] = "rssi";
+    roles[SnrRole] = "snr";
+    roles[MultipathRole] = "multipath";
+    return roles;
+}
+
+void StationListModel::addStation(const ScannedStation &station) {
+    // Scans report in ascending order, so this is an append in practice
+    int row = m_stations.count();
+    while (row > 0 && m_stations[row - 1].channel > station.channel) --row;
+    beginInsertRows(QModelIndex(), row, row);
+    m_stations.insert(row, station);
+    endInsertRows();
+}
+
+void StationListModel::clear() {
+    beginResetModel();
+    m_stations.clear();
+    endResetModel();
+}
+
+ScannedStation StationListModel::getStation(int index) const {
+    if (index < 0 || index >= m_stations.count()) return ScannedStation();
+    return m_stations[index];
+}
+
+QList<ScannedStation> StationListModel::getAll() const {
+    return m_stations;
+}
@@ -0,0 +1,39 @@
+#pragma once
+#include <QAbstractListModel>
+#include <QObject>
+#include <QList>
+
+struct ScannedStation {
+    int channel = 0;      // tuner units (see IRadioHAL)
+    QString frequency;    // display label
+    QString band;
+    int rssi = 0;
+    int snr = 0;
+    int multipath = 0;
+};
+
+// Stations found by the background band scan, in frequency order
+class StationListModel : public QAbstractListModel {
+    Q_OBJECT
+public:
+    enum StationRoles {
+        FrequencyRole = Qt::UserRole + 1,
+        BandRole,
+        RssiRole,
+        SnrRole,
+        MultipathRole
+    };
+
+    explicit StationListModel(QObject *parent = nullptr);
+    int rowCount(const QModelIndex &parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const override;
+    QHash<int, QByteArray> roleNames() const override;
+
+    void addStation(const ScannedStation &station);
+    void clear();
+    ScannedStation getStation(int index) const;
+    QList<ScannedStation> getAll() const;
+
+private:
+    QList<ScannedStation> m_stations;
+};
@@ -0,0 +1,34 @@
+#ifndef GEOMATH_H
+#define GEOMATH_H
+
+#include <algorithm>
+#include <cmath>
+
+/**
+ * @brief Distances on the earth shared by the route structures.
+ *
+ * Same sphere and formula as QGeoCoordinate::distanceTo, without building
+ * coordinates in the inner loops.
+ */
+namespace GeoMath {
+
+constexpr double EarthRadius = 6371008.8;
+constexpr double DegToRad = 3.14159265358979323846 / 180.0;
+constexpr double MetersPerDegree = EarthRadius * DegToRad; // of latitude
+
+// Haversine, in metres
+inline double meters(double lat1, double lon1, double lat2, double lon2) {
+    const double dLat = (lat2 - lat1) * DegToRad, dLon = (lon2 - lon1) * DegToRad;
+    const double a = std::sin(dLat / 2) * std::sin(dLat / 2)
+                     + std::cos(lat1 * DegToRad) * std::cos(lat2 * DegToRad) * std::sin(dLon / 2) * std::sin(dLon / 2);
+    return 2.0 * EarthRadius * std::asin(std::min(1.0, std::sqrt(a)));
+}
+
+// Metres per degree of longitude, kept off zero near the poles
+inline double metersPerLonDegree(double lat) {
+    return MetersPerDegree * std::max(std::cos(lat * DegToRad), 0.01);
+}
+
+} // namespace GeoMath
+
+#endif // GEOMATH_H
@@ -0,0 +1,125 @@
+#include "MapMatcher.h"
+#include "GeoMath.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+using GeoMath::meters;
+
+MapMatcher::MapMatcher(std::shared_ptr<const RouteIndex> route) : m_route(std::move(route)) {}
+
+void MapMatcher::reset() {
+    m_window.clear();
+    m_misses = 0;
+    m_match = Match();
+}
+
+std::vector<MapMatcher::Candidate> MapMatcher::findCandidates(const Fix &fix) const {
+    std::vector<Candidate> out;
+    for (const RouteIndex::Projection &p : m_route->near(fix.latitude, fix.longitude, SearchMeters)) {
+        // Emission: distance from the fix, no worse than for an outlier,
+        // and heading once moving
+        const double d = std::min(p.distance / SigmaMeters, OutlierSigmas);
+        double score = -0.5 * d * d;
+        if (fix.heading >= 0.0 && fix.speed >= HeadingMinSpeed) {
+            const double turn = std::remainder(fix.heading - p.bearing, 360.0) / HeadingSigmaDegrees;
+            score -= 0.5 * turn * turn;
+        }
+        out.push_back({p.segment, p.offset, p.latitude, p.longitude, p.bearing, score, -1});
+    }
+    return out;
+}
+
+MapMatcher::Match MapMatcher::push(const Fix &fix) {
+    if (isEmpty()) return m_match;
+    const std::vector<Candidate> found = findCandidates(fix);
+    Column column{fix.timestampMs, fix.latitude, fix.longitude, found};
+
+    // Viterbi step: the best path into each candidate, from those the car
+    // can have got there from since; candidates out of reach are dropped
+    if (!m_window.empty()) {
+        const Column &before = m_window.back();
+        const double seconds = std::max(0.0, (fix.timestampMs - before.timestampMs) / 1000.0);
+        const double reach = MaxSpeed * seconds + 3.0 * SigmaMeters;
+        const double straight = meters(before.latitude, before.longitude, fix.latitude, fix.longitude);
+        for (Candidate &c : column.candidates) {
+            double best = -std::numeric_limits<double>::infinity();
+            for (size_t i = 0; i < before.candidates.size(); ++i) {
+                const Candidate &p = before.candidates[i];
+                const double along = c.offset - p.offset;
+                if (std::abs(along) > reach) continue;
+                // Going back along the route costs twice over
+                const double back = std::max(0.0, -along - SigmaMeters);
+                const double score = p.score - (std::abs(along - straight) + back) / BetaMeters;
+                if (score > best) {
+                    best = score;
+                    c.previous = int(i);
+                }
+            }
+            c.score += best;
+        }
+        column.candidates.erase(std::remove_if(column.candidates.begin(), column.candidates.end(),
+                                               [](const Candidate &c) { return c.previous < 0; }),
+                                column.candidates.end());
+    }
+
+    // A fix only reached by paths far below the best is an outlier too
+    auto bestScore = [&column]() {
+        double top = -std::numeric_limits<double>::infinity();
+        for (const Candidate &c : column.candidates) top = std::max(top, c.score);
+        return top;
+    };
+    if (!m_window.empty() && bestScore() < -Beam) column.candidates.clear();
+
+    if (column.candidates.empty()) {
+        // An outlier, or off the route: the match holds for a while, then
+        // the chain starts over from wherever the fix is
+        m_match.distance = std::numeric_limits<double>::infinity();
+        if (!m_window.empty() && ++m_misses < Window) return m_match;
+        m_window.clear();
+        column.candidates = found;
+        if (column.candidates.empty()) {
+            m_match.onRoute = false;
+            return m_match;
+        }
+    }
+    m_misses = 0;
+
+    // Scores relative to the best, so they stay in range over a long drive;
+    // paths far behind it will not come back and are dropped
+    const double top = bestScore();
+    for (Candidate &c : column.candidates) c.score -= top;
+    column.candidates.erase(std::remove_if(column.candidates.begin(), column.candidates.end(),
+                                           [](const Candidate &c) { return c.score < -Beam; }),
+                            column.candidates.end());
+    const int bestIndex = int(std::find_if(column.candidates.begin(), column.candidates.end(),
+                                           [](const Candidate &c) { return c.score == 0.0; })
+                              - column.candidates.begin());
+
+    m_window.push_back(std::move(column));
+    if (int(m_window.size()) > Window) {
+        m_window.pop_front();
+        for (Candidate &c : m_window.front().candidates) c.previous = -1;
+    }
+
+    // Trace the best path back through the window for the speed along it
+    const Candidate &head = m_window.back().candidates[size_t(bestIndex)];
+    int index = bestIndex;
+    size_t at = m_window.size() - 1;
+    while (at > 0 && m_window[at].candidates[size_t(index)].previous >= 0) {
+        index = m_window[at].candidates[size_t(index)].previous;
+        --at;
+    }
+    const Candidate &tail = m_window[at].candidates[size_t(index)];
+    const double seconds = (m_window.back().timestampMs - m_window[at].timestampMs) / 1000.0;
+
+    m_match.onRoute = true;
+    m_match.segment = head.segment;
+    m_match.offset = head.offset;
+    m_match.latitude = head.latitude;
+    m_match.longitude = head.longitude;
+    m_match.bearing = head.bearing;
+    m_match.speed = seconds > 0.0 ? std::max(0.0, (head.offset - tail.offset) / seconds) : 0.0;
+    m_match.distance = meters(fix.latitude, fix.longitude, head.latitude, head.longitude);
+    return m_match;
+}
@@ -0,0 +1,99 @@
+#ifndef MAPMATCHER_H
+#define MAPMATCHER_H
+
+#include "RouteIndex.h"
+#include <deque>
+#include <memory>
+#include <vector>
+
+/**
+ * @brief Snaps a stream of GNSS fixes to the active route.
+ *
+ * A hidden Markov model over the route's segments: each fix makes the
+ * segments within SearchMeters its candidate states, scored by how far the
+ * fix lies from them (Gaussian, SigmaMeters) and by how well its heading
+ * agrees with theirs. Going from a candidate of one fix to a candidate of
+ * the next is scored by how much the distance along the route differs
+ * from the straight line between the fixes, so the match neither jumps to
+ * another stretch of the route that passes close by nor slides backwards.
+ *
+ * Decoding is online Viterbi: each fix extends the best path to each of
+ * its candidates by one step, and the match is the end of the best of
+ * them. Only the last Window fixes are kept to trace paths back, which
+ * bounds time and memory however long the drive; the traced window gives
+ * the speed along the route. Candidates come from the route's index and
+ * are kept if the car can have got there since the last fix; a fix
+ * without any is taken for an outlier and the match holds, until Window
+ * such fixes in a row break the chain and decoding starts over from
+ * wherever the fix is, or nothing when off the route.
+ */
+class MapMatcher
+{
+public:
+    static constexpr double SigmaMeters = 5.0;          // GNSS position noise
+    static constexpr double OutlierSigmas = 4.0;        // farther off, a fix scores as an outlier
+    static constexpr double SearchMeters = 50.0;        // farthest candidate from a fix
+    static constexpr double BetaMeters = 10.0;          // route against straight-line distance between fixes
+    static constexpr double HeadingSigmaDegrees = 30.0;
+    static constexpr double HeadingMinSpeed = 2.0;      // m/s; headings below are noise
+    static constexpr double MaxSpeed = 70.0;            // m/s; bounds the move from one fix to the next
+    static constexpr double Beam = 10.0;                // paths this far below the best (log) are dropped
+    static constexpr int Window = 10;                   // fixes kept, a second at 10 Hz
+
+    struct Fix {
+        double latitude = 0.0;
+        double longitude = 0.0;
+        double heading = -1.0; // degrees, negative if unknown
+        double speed = -1.0;   // m/s, negative if unknown
+        qint64 timestampMs = 0;
+    };
+
+    struct Match {
+        bool onRoute = false;
+        int segment = -1;     // between path points segment and segment + 1
+        double offset = 0.0;  // metres along the route
+        double latitude = 0.0;
+        double longitude = 0.0;
+        double bearing = 0.0; // of the segment, degrees
+        double speed = 0.0;   // along the route over the window, m/s
+        double distance = 0.0; // metres from the fix; infinite while the match holds over it
+    };
+
+    MapMatcher() = default;
+    explicit MapMatcher(std::shared_ptr<const RouteIndex> route);
+
+    bool isEmpty() const { return !m_route || m_route->isEmpty(); }
+
+    // Matches the next fix; fixes must come in time order
+    Match push(const Fix &fix);
+    const Match &match() const { return m_match; }
+    // Forgets the fixes so far, as when the route is restarted
+    void reset();
+
+private:
+    struct Candidate {
+        int segment;
+        double offset;
+        double latitude;
+        double longitude;
+        double bearing;
+        double score;  // log probability of the best path ending here
+        int previous;  // that path's candidate for the fix before, -1 at a break
+    };
+
+    struct Column {
+        qint64 timestampMs;
+        double latitude;
+        double longitude;
+        std::vector<Candidate> candidates;
+    };
+
+    std::vector<Candidate> findCandidates(const Fix &fix) const;
+
+    std::shared_ptr<const RouteIndex> m_route;
+    std::deque<Column> m_window;
+    int m_misses = 0; // fixes in a row without candidates near the match
+    Match m_match;
+};
+
+#endif // MAPMATCHER_H
@@ -0,0 +1,28 @@
+#include "OffRouteDetector.h"
+#include <cmath>
+#include <limits>
+
+void OffRouteDetector::reset() {
+    m_offRoute = false;
+    m_sinceMs = -1;
+}
+
+bool OffRouteDetector::update(const MapMatcher::Fix &fix, const MapMatcher::Match &match) {
+    const double distance = match.onRoute ? match.distance : std::numeric_limits<double>::infinity();
+    const bool moving = fix.heading >= 0.0 && fix.speed >= MinSpeed;
+    const double turn = moving && match.onRoute ? std::abs(std::remainder(fix.heading - match.bearing, 360.0)) : 0.0;
+
+    const bool against = m_offRoute
+        ? distance <= RejoinMeters && turn <= TurnedDegrees
+        : distance > LeaveMeters || (distance > TurnedMeters && turn > TurnedDegrees) || turn > WrongWayDegrees;
+    if (!against) {
+        m_sinceMs = -1;
+        return m_offRoute;
+    }
+    if (m_sinceMs < 0) m_sinceMs = fix.timestampMs;
+    if (fix.timestampMs - m_sinceMs >= (m_offRoute ? RejoinMs : LeaveMs)) {
+        m_offRoute = !m_offRoute;
+        m_sinceMs = -1;
+    }
+    return m_offRoute;
+}
@@ -0,0 +1,43 @@
+#ifndef OFFROUTEDETECTOR_H
+#define OFFROUTEDETECTOR_H
+
+#include "MapMatcher.h"
+
+/**
+ * @brief Decides from the matched fixes whether the car has left the route.
+ *
+ * A fix speaks against the route when it lies farther than LeaveMeters
+ * from its match, or has no match at all; when it lies farther than
+ * TurnedMeters while heading more than TurnedDegrees off the route's
+ * bearing, as at a turn taken early; or when it heads against the route,
+ * as after turning back. A single such fix is GNSS noise: the car is only
+ * taken off the route once they have lasted LeaveMs without a break, and
+ * back on once fixes within RejoinMeters, heading along the route, have
+ * lasted RejoinMs. Between the two thresholds the state holds, so a car
+ * driving at the edge of either does not flap between them.
+ */
+class OffRouteDetector
+{
+public:
+    static constexpr double LeaveMeters = 30.0;
+    static constexpr double TurnedMeters = 10.0;
+    static constexpr double TurnedDegrees = 45.0;
+    static constexpr double WrongWayDegrees = 135.0;
+    static constexpr double RejoinMeters = 15.0;
+    static constexpr double MinSpeed = 3.0;     // m/s; headings below are noise
+    static constexpr qint64 LeaveMs = 3000;
+    static constexpr qint64 RejoinMs = 2000;
+
+    bool isOffRoute() const { return m_offRoute; }
+
+    // Weighs the next fix and its match; returns whether off the route
+    bool update(const MapMatcher::Fix &fix, const MapMatcher::Match &match);
+    // Back on the route, as for a new one
+    void reset();
+
+private:
+    bool m_offRoute = false;
+    qint64 m_sinceMs = -1; // first of the fixes in a row against the state, -1 if none
+};
+
+#endif // OFFROUTEDETECTOR_H
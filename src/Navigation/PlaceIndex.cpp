@@ -0,0 +1,276 @@
+#include "PlaceIndex.h"
+#include "GeoMath.h"
+#include <QDebug>
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <string_view>
+
+namespace {
+constexpr double kSettlementWeight = 0.02; // a town 50 km away ranks with a street 1 km away
+constexpr double kPartialWordWeight = 3.0; // "stor" finds Storgatan, but Stor first
+constexpr double kNearMeters = 200.0;      // closer than this is all the same
+
+quint64 align(quint64 offset) { return (offset + 7) & ~quint64(7); }
+
+quint32 readVarint(const uchar *&p) {
+    quint32 value = 0;
+    for (int shift = 0;; shift += 7) {
+        const uchar byte = *p++;
+        value |= quint32(byte & 0x7F) << shift;
+        if (!(byte & 0x80)) return value;
+    }
+}
+
+// Equirectangular; exact enough to rank places around one position
+double approxMeters(const QGeoCoordinate &from, qint32 lat, qint32 lon) {
+    const double dLat = lat * 1e-7 - from.latitude();
+    const double dLon = (lon * 1e-7 - from.longitude()) * std::cos(lat * 1e-7 * GeoMath::DegToRad);
+    return GeoMath::MetersPerDegree * std::sqrt(dLat * dLat + dLon * dLon);
+}
+}
+
+PlaceIndex::~PlaceIndex() {
+    close();
+}
+
+PlaceIndex::Layout PlaceIndex::layout(const Header &h) {
+    Layout l;
+    quint64 at = align(sizeof(Header));
+    auto section = [&at](quint64 bytes) {
+        const quint64 start = at;
+        at = align(at + bytes);
+        return start;
+    };
+    l.places = section(quint64(h.placeCount) * sizeof(Place));
+    l.houses = section(quint64(h.houseCount) * sizeof(House));
+    l.blocks = section(quint64(h.blockCount) * sizeof(Block));
+    l.keys = section(h.keyBytes);
+    l.postings = section(quint64(h.postingCount) * sizeof(quint32));
+    l.strings = section(h.stringBytes);
+    l.size = at;
+    return l;
+}
+
+bool PlaceIndex::open(const QString &path) {
+    close();
+    m_file.setFileName(path);
+    if (!m_file.open(QIODevice::ReadOnly)) return false;
+    const qint64 size = m_file.size();
+    if (size < qint64(sizeof(Header))) {
+        qWarning() << "Place index: truncated file" << path;
+        m_file.close();
+        return false;
+    }
+    m_map = m_file.map(0, size);
+    if (!m_map) {
+        qWarning() << "Place index: cannot map" << path << m_file.errorString();
+        m_file.close();
+        return false;
+    }
+
+    const Header *header = reinterpret_cast<const Header *>(m_map);
+    const Layout l = layout(*header);
+    if (header->magic != Magic || header->version != Version || quint64(size) < l.size) {
+        qWarning() << "Place index: not a version" << Version << "index file" << path;
+        close();
+        return false;
+    }
+    m_header = header;
+    m_places = reinterpret_cast<const Place *>(m_map + l.places);
+    m_houses = reinterpret_cast<const House *>(m_map + l.houses);
+    m_blocks = reinterpret_cast<const Block *>(m_map + l.blocks);
+    m_keys = m_map + l.keys;
+    m_postings = reinterpret_cast<const quint32 *>(m_map + l.postings);
+    m_strings = reinterpret_cast<const char *>(m_map + l.strings);
+    return true;
+}
+
+void PlaceIndex::close() {
+    if (m_map) m_file.unmap(m_map);
+    m_map = nullptr;
+    m_header = nullptr;
+    m_file.close();
+}
+
+std::vector<std::string> PlaceIndex::words(const QString &text) {
+    std::vector<std::string> out;
+    std::string word;
+    auto flush = [&out, &word]() {
+        if (!word.empty()) out.push_back(word.substr(0, MaxKeyBytes));
+        word.clear();
+    };
+    // Compatibility decomposition splits off the accents (é -> e + ´)
+    const QString decomposed = text.toLower().normalized(QString::NormalizationForm_KD);
+    for (const QChar c : decomposed) {
+        if (c.category() == QChar::Mark_NonSpacing) continue;
+        switch (c.unicode()) {
+        case 0x00DF: word += "ss"; continue; // ß
+        case 0x00E6: word += "ae"; continue; // æ
+        case 0x00F8: word += 'o'; continue;  // ø
+        case 0x0153: word += "oe"; continue; // œ
+        case 0x00FE: word += "th"; continue; // þ
+        case 0x0111: word += 'd'; continue;  // đ
+        case 0x0142: word += 'l'; continue;  // ł
+        default: break;
+        }
+        if (c.isLetterOrNumber()) word += QString(c).toStdString();
+        else flush();
+    }
+    flush();
+    return out;
+}
+
+bool PlaceIndex::parseHouseNumber(const std::string &word, quint16 *number, char *suffix) {
+    size_t digits = 0;
+    unsigned value = 0;
+    while (digits < word.size() && digits < 5 && word[digits] >= '0' && word[digits] <= '9')
+        value = value * 10 + unsigned(word[digits++] - '0');
+    if (digits == 0 || value == 0 || value > 0xFFFF) return false;
+    *number = quint16(value);
+    *suffix = digits < word.size() && word[digits] >= 'a' && word[digits] <= 'z' ? word[digits] : 0;
+    return true;
+}
+
+void PlaceIndex::collect(const std::string &word, bool prefix, std::vector<Match> &out) const {
+    const std::string_view target(word);
+    auto blockKey = [this](quint32 block) {
+        const uchar *p = m_keys + m_blocks[block].keyOffset + 1; // shared length is 0
+        const quint8 length = *p++;
+        return std::string_view(reinterpret_cast<const char *>(p), length);
+    };
+    if (m_header->blockCount == 0) return;
+    // Last block starting at or before the word; its keys run on past the block's end
+    quint32 lo = 0, hi = m_header->blockCount;
+    while (lo < hi) {
+        const quint32 mid = (lo + hi) / 2;
+        if (blockKey(mid) <= target) lo = mid + 1;
+        else hi = mid;
+    }
+    const quint32 block = lo ? lo - 1 : 0;
+
+    std::string key;
+    const uchar *p = m_keys + m_blocks[block].keyOffset;
+    quint32 posting = m_blocks[block].postingFirst;
+    for (quint32 k = block * KeysPerBlock; k < m_header->keyCount; ++k) {
+        const quint8 shared = *p++;
+        const quint8 length = *p++;
+        key.resize(shared);
+        key.append(reinterpret_cast<const char *>(p), length);
+        p += length;
+        const quint32 count = readVarint(p);
+
+        const std::string_view current(key);
+        const bool equal = current == target;
+        if (equal || (prefix && current.substr(0, target.size()) == target)) {
+            for (quint32 i = posting; i < posting + count; ++i) out.push_back({m_postings[i], equal});
+            if (int(out.size()) >= MaxWordPlaces) break;
+        } else if (current > target) {
+            break;
+        }
+        posting += count;
+    }
+}
+
+QGeoCoordinate PlaceIndex::housePosition(const Place &street, quint16 number, char suffix) const {
+    const House *begin = m_houses + street.houseFirst;
+    const House *end = begin + street.houseCount;
+    const House *exact = nullptr;
+    for (const House *h = begin; h != end; ++h) {
+        if (h->number != number) continue;
+        if (!exact || h->suffix == suffix) exact = h;
+    }
+    if (exact) return QGeoCoordinate(exact->lat * 1e-7, exact->lon * 1e-7);
+
+    // Nearest known numbers either side, on the same side of the street if any
+    const House *lower = nullptr, *higher = nullptr;
+    for (int sameSide = 1; sameSide >= 0 && !lower && !higher; --sameSide) {
+        for (const House *h = begin; h != end; ++h) {
+            if (sameSide && (h->number - number) % 2 != 0) continue;
+            if (h->number < number && (!lower || h->number > lower->number)) lower = h;
+            if (h->number > number && (!higher || h->number < higher->number)) higher = h;
+        }
+    }
+    if (lower && higher) {
+        const double t = double(number - lower->number) / (higher->number - lower->number);
+        return QGeoCoordinate((lower->lat + t * (higher->lat - lower->lat)) * 1e-7,
+                              (lower->lon + t * (higher->lon - lower->lon)) * 1e-7);
+    }
+    const House *nearest = lower ? lower : higher;
+    if (nearest) return QGeoCoordinate(nearest->lat * 1e-7, nearest->lon * 1e-7);
+    return QGeoCoordinate(street.lat * 1e-7, street.lon * 1e-7);
+}
+
+QVariantList PlaceIndex::search(const QString &query, const QGeoCoordinate &near, int limit) const {
+    QVariantList results;
+    if (!m_header) return results;
+    std::vector<std::string> terms = words(query);
+
+    // A number after the first word is a house number ("Storgatan 12")
+    quint16 houseNumber = 0;
+    char houseSuffix = 0;
+    for (size_t i = 1; i < terms.size(); ++i) {
+        if (parseHouseNumber(terms[i], &houseNumber, &houseSuffix)) {
+            terms.erase(terms.begin() + qsizetype(i));
+            break;
+        }
+    }
+    if (terms.empty()) return results;
+
+    // Places holding every word, the last one as a prefix
+    std::vector<Match> candidates, matches;
+    for (size_t i = 0; i < terms.size(); ++i) {
+        const bool last = i + 1 == terms.size();
+        matches.clear();
+        collect(terms[i], last, matches);
+        std::sort(matches.begin(), matches.end(), [](const Match &a, const Match &b) {
+            return a.place < b.place || (a.place == b.place && a.wholeWord > b.wholeWord);
+        });
+        matches.erase(std::unique(matches.begin(), matches.end(),
+                                  [](const Match &a, const Match &b) { return a.place == b.place; }),
+                      matches.end());
+        if (i == 0) {
+            candidates.swap(matches);
+            continue;
+        }
+        // Keep the later word's whole-word flag: only the last one can be partial
+        std::vector<Match> kept;
+        std::set_intersection(matches.begin(), matches.end(), candidates.begin(), candidates.end(),
+                              std::back_inserter(kept),
+                              [](const Match &a, const Match &b) { return a.place < b.place; });
+        candidates.swap(kept);
+        if (candidates.empty()) return results;
+    }
+
+    std::vector<std::pair<double, quint32>> ranked;
+    ranked.reserve(candidates.size());
+    for (const Match &m : candidates) {
+        const Place &place = m_places[m.place];
+        double weight = m.wholeWord ? 1.0 : kPartialWordWeight;
+        if (place.kind == Settlement) weight *= kSettlementWeight;
+        ranked.push_back({(approxMeters(near, place.lat, place.lon) + kNearMeters) * weight, m.place});
+    }
+    const size_t count = std::min(ranked.size(), size_t(std::max(limit, 0)));
+    std::partial_sort(ranked.begin(), ranked.begin() + qsizetype(count), ranked.end());
+
+    for (size_t i = 0; i < count; ++i) {
+        const Place &place = m_places[ranked[i].second];
+        QString name = QString::fromUtf8(string(place.name));
+        QGeoCoordinate position(place.lat * 1e-7, place.lon * 1e-7);
+        if (houseNumber && place.kind == Street) {
+            position = housePosition(place, houseNumber, houseSuffix);
+            name += " " + QString::number(houseNumber);
+            if (houseSuffix) name += QChar::fromLatin1(houseSuffix).toUpper();
+        }
+        QString address = name;
+        if (place.settlement != NoString) address += ", " + QString::fromUtf8(string(place.settlement));
+
+        QVariantMap map;
+        map["name"] = name;
+        map["address"] = address;
+        map["lat"] = position.latitude();
+        map["lon"] = position.longitude();
+        results.append(map);
+    }
+    return results;
+}
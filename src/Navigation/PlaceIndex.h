@@ -0,0 +1,126 @@
+#ifndef PLACEINDEX_H
+#define PLACEINDEX_H
+
+#include <QFile>
+#include <QGeoCoordinate>
+#include <QString>
+#include <QVariantList>
+#include <string>
+#include <vector>
+
+/**
+ * @brief Offline address and POI search, memory-mapped from an index file.
+ *
+ * Built by PlaceIndexBuilder from an OSM extract. A place is a street, a
+ * point of interest or a settlement, with its display name, the settlement
+ * it belongs to and, for streets, the known house numbers with their
+ * positions.
+ *
+ * Every word of a place's name and settlement is a key of a sorted word
+ * index, normalized to lowercase without diacritics. Keys are front-coded
+ * in blocks of 16: each stores only the bytes that differ from the key
+ * before it, and the first key of a block is stored whole so the block can
+ * be found by binary search. A key lists the places it occurs in.
+ *
+ * A query matches the places holding all of its words, the last one as a
+ * prefix so results follow each keystroke. They are ranked by distance
+ * from the given position, settlements and whole-word matches first. A
+ * house number in the query is placed on its street, interpolated between
+ * the nearest known numbers on the same side when it is not in the data.
+ */
+class PlaceIndex
+{
+public:
+    static constexpr quint32 Magic = 0x3149504E; // "NPI1"
+    static constexpr quint32 Version = 1;
+    static constexpr quint32 NoString = 0xFFFFFFFFu;
+    static constexpr int KeysPerBlock = 16;
+    static constexpr int MaxKeyBytes = 255;
+    static constexpr int MaxWordPlaces = 50000; // places gathered per query word (short prefixes)
+
+    enum Kind : quint8 { Settlement, Street, Poi };
+
+    struct Place {
+        qint32 lat; // 1e-7 degrees
+        qint32 lon;
+        quint32 name;       // string table offsets
+        quint32 settlement; // or NoString
+        quint32 houseFirst;
+        quint16 houseCount;
+        quint8 kind;
+        quint8 reserved;
+    };
+
+    struct House {
+        qint32 lat;
+        qint32 lon;
+        quint16 number;
+        char suffix; // 'a' in 12a, or 0
+        quint8 reserved;
+    };
+
+    struct Block {
+        quint32 keyOffset;    // first key, stored whole
+        quint32 postingFirst; // its places
+    };
+
+    struct Header {
+        quint32 magic;
+        quint32 version;
+        quint32 placeCount;
+        quint32 houseCount;
+        quint32 keyCount;
+        quint32 blockCount;
+        quint32 keyBytes;
+        quint32 postingCount;
+        quint32 stringBytes;
+        quint32 reserved[3];
+    };
+
+    // Section layout shared with the writer (PlaceIndexBuilder)
+    struct Layout {
+        quint64 places, houses, blocks, keys, postings, strings, size;
+    };
+    static Layout layout(const Header &header);
+
+    PlaceIndex() = default;
+    ~PlaceIndex();
+    PlaceIndex(const PlaceIndex &) = delete;
+    PlaceIndex &operator=(const PlaceIndex &) = delete;
+
+    bool open(const QString &path);
+    void close();
+    bool isOpen() const { return m_map != nullptr; }
+    quint32 placeCount() const { return m_header ? m_header->placeCount : 0; }
+
+    // Best matches near `near`, as maps with name, address, lat and lon
+    QVariantList search(const QString &query, const QGeoCoordinate &near, int limit) const;
+
+    // Lowercase words without diacritics or punctuation
+    static std::vector<std::string> words(const QString &text);
+    // "12", "12a", "12-14" -> 12 and 'a'; false if it does not start with digits
+    static bool parseHouseNumber(const std::string &word, quint16 *number, char *suffix);
+
+private:
+    struct Match {
+        quint32 place;
+        bool wholeWord;
+    };
+
+    // Places under keys equal to `word`, or starting with it
+    void collect(const std::string &word, bool prefix, std::vector<Match> &out) const;
+    const char *string(quint32 offset) const { return m_strings + offset; }
+    QGeoCoordinate housePosition(const Place &street, quint16 number, char suffix) const;
+
+    QFile m_file;
+    uchar *m_map = nullptr;
+    const Header *m_header = nullptr;
+    const Place *m_places = nullptr;
+    const House *m_houses = nullptr;
+    const Block *m_blocks = nullptr;
+    const uchar *m_keys = nullptr;
+    const quint32 *m_postings = nullptr;
+    const char *m_strings = nullptr;
+};
+
+#endif // PLACEINDEX_H
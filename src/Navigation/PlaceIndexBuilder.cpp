@@ -0,0 +1,332 @@
+#include "PlaceIndexBuilder.h"
+#include <QSaveFile>
+#include <QXmlStreamReader>
+#include <QDebug>
+#include <algorithm>
+#include <cmath>
+#include <map>
+
+namespace {
+
+constexpr double kCellDegrees = 0.2; // settlement lookup grid
+constexpr double kMetersPerDegree = 111195.0;
+
+qint32 toE7(double degrees) { return qint32(std::lround(degrees * 1e7)); }
+
+double metersBetween(qint32 lat1, qint32 lon1, qint32 lat2, qint32 lon2) {
+    const double dLat = (lat2 - lat1) * 1e-7;
+    const double dLon = (lon2 - lon1) * 1e-7 * std::cos(lat1 * 1e-7 * 3.14159265358979323846 / 180.0);
+    return kMetersPerDegree * std::sqrt(dLat * dLat + dLon * dLon);
+}
+
+// Normalized words joined, so "Storgatan" and "STORGATAN" are one street
+std::string matchKey(const std::string &name) {
+    std::string key;
+    for (const std::string &word : PlaceIndex::words(QString::fromStdString(name))) {
+        if (!key.empty()) key += ' ';
+        key += word;
+    }
+    return key;
+}
+
+void appendVarint(std::string &out, quint32 value) {
+    while (value >= 0x80) {
+        out += char(0x80 | (value & 0x7F));
+        value >>= 7;
+    }
+    out += char(value);
+}
+
+// Nearest settlement to a point, bucketed on a degree grid
+class SettlementGrid
+{
+public:
+    SettlementGrid(const std::vector<const std::string *> &names, const std::vector<std::pair<qint32, qint32>> &points)
+        : m_names(names), m_points(points)
+    {
+        for (size_t i = 0; i < points.size(); ++i) m_cells[cell(cellOf(points[i].first), cellOf(points[i].second))].push_back(i);
+    }
+
+    const std::string *nearest(qint32 lat, qint32 lon, double maxMeters) const {
+        const int latCells = int(std::ceil(maxMeters / (kCellDegrees * kMetersPerDegree)));
+        const double cosLat = std::max(0.1, std::cos(lat * 1e-7 * 3.14159265358979323846 / 180.0));
+        const int lonCells = int(std::ceil(maxMeters / (kCellDegrees * kMetersPerDegree * cosLat)));
+        const int row = cellOf(lat), col = cellOf(lon);
+        const std::string *best = nullptr;
+        double bestMeters = maxMeters;
+        for (int r = row - latCells; r <= row + latCells; ++r) {
+            for (int c = col - lonCells; c <= col + lonCells; ++c) {
+                const auto found = m_cells.find(cell(r, c));
+                if (found == m_cells.end()) continue;
+                for (size_t i : found->second) {
+                    const double d = metersBetween(lat, lon, m_points[i].first, m_points[i].second);
+                    if (d <= bestMeters) {
+                        bestMeters = d;
+                        best = m_names[i];
+                    }
+                }
+            }
+        }
+        return best;
+    }
+
+private:
+    static int cellOf(qint32 e7) { return int(std::floor(e7 * 1e-7 / kCellDegrees)); }
+    static qint64 cell(int row, int col) { return (qint64(row) << 32) ^ quint32(col); }
+
+    const std::vector<const std::string *> &m_names;
+    const std::vector<std::pair<qint32, qint32>> &m_points;
+    std::unordered_map<qint64, std::vector<size_t>> m_cells;
+};
+
+} // namespace
+
+void PlaceIndexBuilder::addSettlement(const std::string &name, double lat, double lon) {
+    if (!name.empty()) m_entries.push_back({name, name, toE7(lat), toE7(lon), PlaceIndex::Settlement});
+}
+
+void PlaceIndexBuilder::addPoi(const std::string &name, double lat, double lon, const std::string &settlement) {
+    if (!name.empty()) m_entries.push_back({name, settlement, toE7(lat), toE7(lon), PlaceIndex::Poi});
+}
+
+void PlaceIndexBuilder::addStreet(const std::string &name, double lat, double lon, const std::string &settlement) {
+    if (!name.empty()) m_entries.push_back({name, settlement, toE7(lat), toE7(lon), PlaceIndex::Street});
+}
+
+void PlaceIndexBuilder::addHouse(const std::string &street, const std::string &number, double lat, double lon,
+                                 const std::string &settlement) {
+    if (!street.empty() && !number.empty()) m_houses.push_back({street, number, settlement, toE7(lat), toE7(lon)});
+}
+
+bool PlaceIndexBuilder::readOsmXml(QIODevice *device) {
+    QXmlStreamReader xml(device);
+    std::unordered_map<qint64, std::pair<double, double>> nodes;
+    std::vector<qint64> refs;
+    QString name, highway, place, poi, street, number, city;
+    double lat = 0, lon = 0;
+    bool inElement = false;
+
+    while (!xml.atEnd()) {
+        const QXmlStreamReader::TokenType token = xml.readNext();
+        if (token == QXmlStreamReader::StartElement) {
+            const QStringView element = xml.name();
+            const QXmlStreamAttributes attributes = xml.attributes();
+            if (element == u"node" || element == u"way") {
+                inElement = true;
+                refs.clear();
+                name.clear(); highway.clear(); place.clear(); poi.clear(); street.clear(); number.clear(); city.clear();
+                if (element == u"node") {
+                    lat = attributes.value(u"lat").toDouble();
+                    lon = attributes.value(u"lon").toDouble();
+                    nodes[attributes.value(u"id").toLongLong()] = {lat, lon};
+                }
+            } else if (inElement && element == u"nd") {
+                refs.push_back(attributes.value(u"ref").toLongLong());
+            } else if (inElement && element == u"tag") {
+                const QStringView k = attributes.value(u"k");
+                const QString v = attributes.value(u"v").toString();
+                if (k == u"name") name = v;
+                else if (k == u"highway") highway = v;
+                else if (k == u"place") place = v;
+                else if (k == u"amenity" || k == u"shop" || k == u"tourism" || k == u"leisure") poi = v;
+                else if (k == u"addr:street") street = v;
+                else if (k == u"addr:housenumber") number = v;
+                else if (k == u"addr:city") city = v;
+            }
+        } else if (token == QXmlStreamReader::EndElement && (xml.name() == u"node" || xml.name() == u"way")) {
+            inElement = false;
+            if (xml.name() == u"way") {
+                // Ways are placed at their middle node
+                const auto found = refs.empty() ? nodes.end() : nodes.find(refs[refs.size() / 2]);
+                if (found == nodes.end()) continue;
+                lat = found->second.first;
+                lon = found->second.second;
+                if (!highway.isEmpty() && !name.isEmpty()) addStreet(name.toStdString(), lat, lon, city.toStdString());
+            } else if (place == u"city" || place == u"town" || place == u"village") {
+                addSettlement(name.toStdString(), lat, lon);
+            }
+            if (!poi.isEmpty() && !name.isEmpty()) addPoi(name.toStdString(), lat, lon, city.toStdString());
+            if (!street.isEmpty() && !number.isEmpty())
+                addHouse(street.toStdString(), number.toStdString(), lat, lon, city.toStdString());
+        }
+    }
+    if (xml.hasError()) {
+        qWarning() << "Place index: OSM XML error" << xml.errorString() << "at line" << xml.lineNumber();
+        return false;
+    }
+    return true;
+}
+
+bool PlaceIndexBuilder::write(const QString &path) {
+    m_stats = Stats();
+
+    // Settlements for the places and addresses that do not name one
+    std::vector<const std::string *> settlementNames;
+    std::vector<std::pair<qint32, qint32>> settlementPoints;
+    for (const Entry &e : m_entries) {
+        if (e.kind != PlaceIndex::Settlement) continue;
+        settlementNames.push_back(&e.name);
+        settlementPoints.push_back({e.lat, e.lon});
+    }
+    const SettlementGrid grid(settlementNames, settlementPoints);
+    auto settle = [&grid](std::string &settlement, qint32 lat, qint32 lon) {
+        if (!settlement.empty()) return;
+        if (const std::string *nearest = grid.nearest(lat, lon, SettlementRadiusMeters)) settlement = *nearest;
+    };
+    for (Entry &e : m_entries) settle(e.settlement, e.lat, e.lon);
+    for (HouseEntry &h : m_houses) settle(h.settlement, h.lat, h.lon);
+
+    // Merge the ways of one street: placed at the way nearest their centre
+    std::vector<Entry> places;
+    std::unordered_map<std::string, std::vector<size_t>> streetWays;
+    std::vector<std::string> streetOrder;
+    for (size_t i = 0; i < m_entries.size(); ++i) {
+        const Entry &e = m_entries[i];
+        if (e.kind != PlaceIndex::Street) {
+            places.push_back(e);
+            continue;
+        }
+        const std::string key = matchKey(e.name) + '\x1f' + matchKey(e.settlement);
+        auto &ways = streetWays[key];
+        if (ways.empty()) streetOrder.push_back(key);
+        ways.push_back(i);
+    }
+    std::unordered_map<std::string, quint32> streetIndex;
+    for (const std::string &key : streetOrder) {
+        const std::vector<size_t> &ways = streetWays[key];
+        double lat = 0, lon = 0;
+        for (size_t i : ways) {
+            lat += m_entries[i].lat;
+            lon += m_entries[i].lon;
+        }
+        lat /= ways.size();
+        lon /= ways.size();
+        size_t best = ways.front();
+        double bestMeters = -1;
+        for (size_t i : ways) {
+            const double d = metersBetween(qint32(lat), qint32(lon), m_entries[i].lat, m_entries[i].lon);
+            if (bestMeters < 0 || d < bestMeters) {
+                bestMeters = d;
+                best = i;
+            }
+        }
+        streetIndex.emplace(key, quint32(places.size()));
+        places.push_back(m_entries[best]);
+    }
+    m_stats.streets = quint32(streetOrder.size());
+
+    // House numbers per street, ascending
+    std::vector<std::vector<PlaceIndex::House>> streetHouses(places.size());
+    for (const HouseEntry &h : m_houses) {
+        const auto street = streetIndex.find(matchKey(h.street) + '\x1f' + matchKey(h.settlement));
+        const std::vector<std::string> words = PlaceIndex::words(QString::fromStdString(h.number));
+        PlaceIndex::House house{h.lat, h.lon, 0, 0, 0};
+        if (street == streetIndex.end() || words.empty()
+            || !PlaceIndex::parseHouseNumber(words.front(), &house.number, &house.suffix)) {
+            ++m_stats.unmatchedHouses;
+            continue;
+        }
+        std::vector<PlaceIndex::House> &list = streetHouses[street->second];
+        if (list.size() < 0xFFFF) list.push_back(house);
+    }
+    std::vector<PlaceIndex::House> houses;
+
+    // Strings, each stored once
+    std::string strings;
+    std::unordered_map<std::string, quint32> stringOffsets;
+    auto intern = [&strings, &stringOffsets](const std::string &s) {
+        const auto found = stringOffsets.find(s);
+        if (found != stringOffsets.end()) return found->second;
+        const quint32 offset = quint32(strings.size());
+        strings.append(s).push_back('\0');
+        stringOffsets.emplace(s, offset);
+        return offset;
+    };
+
+    std::vector<PlaceIndex::Place> records;
+    std::map<std::string, std::vector<quint32>> postings; // sorted keys, ascending places
+    for (quint32 i = 0; i < places.size(); ++i) {
+        const Entry &e = places[i];
+        std::vector<PlaceIndex::House> &list = streetHouses[i];
+        std::sort(list.begin(), list.end(), [](const PlaceIndex::House &a, const PlaceIndex::House &b) {
+            return a.number < b.number || (a.number == b.number && a.suffix < b.suffix);
+        });
+        PlaceIndex::Place place{};
+        place.lat = e.lat;
+        place.lon = e.lon;
+        place.name = intern(e.name);
+        place.settlement = e.settlement.empty() || e.kind == PlaceIndex::Settlement ? PlaceIndex::NoString
+                                                                                      : intern(e.settlement);
+        place.houseFirst = quint32(houses.size());
+        place.houseCount = quint16(list.size());
+        place.kind = e.kind;
+        houses.insert(houses.end(), list.begin(), list.end());
+        records.push_back(place);
+        m_stats.houses += quint32(list.size());
+
+        std::vector<std::string> words = PlaceIndex::words(QString::fromStdString(e.name));
+        const std::vector<std::string> settlementWords = PlaceIndex::words(QString::fromStdString(e.settlement));
+        words.insert(words.end(), settlementWords.begin(), settlementWords.end());
+        std::sort(words.begin(), words.end());
+        words.erase(std::unique(words.begin(), words.end()), words.end());
+        for (const std::string &word : words) postings[word].push_back(i);
+    }
+    m_stats.places = quint32(records.size());
+
+    // Front-coded keys, a block head every KeysPerBlock
+    std::string keys;
+    std::vector<PlaceIndex::Block> blocks;
+    std::vector<quint32> postingList;
+    const std::string *previous = nullptr;
+    quint32 keyCount = 0;
+    for (const auto &[key, list] : postings) {
+        size_t shared = 0;
+        if (keyCount % PlaceIndex::KeysPerBlock == 0) {
+            blocks.push_back({quint32(keys.size()), quint32(postingList.size())});
+        } else {
+            while (shared < key.size() && shared < previous->size() && key[shared] == (*previous)[shared]) ++shared;
+        }
+        keys += char(shared);
+        keys += char(key.size() - shared);
+        keys.append(key, shared, std::string::npos);
+        appendVarint(keys, quint32(list.size()));
+        postingList.insert(postingList.end(), list.begin(), list.end());
+        previous = &key;
+        ++keyCount;
+    }
+    m_stats.keys = keyCount;
+    m_stats.keyBytes = quint32(keys.size());
+
+    PlaceIndex::Header header{};
+    header.magic = PlaceIndex::Magic;
+    header.version = PlaceIndex::Version;
+    header.placeCount = quint32(records.size());
+    header.houseCount = quint32(houses.size());
+    header.keyCount = keyCount;
+    header.blockCount = quint32(blocks.size());
+    header.keyBytes = quint32(keys.size());
+    header.postingCount = quint32(postingList.size());
+    header.stringBytes = quint32(strings.size());
+
+    QSaveFile file(path);
+    if (!file.open(QIODevice::WriteOnly)) {
+        qWarning() << "Place index: cannot write" << path << file.errorString();
+        return false;
+    }
+    const PlaceIndex::Layout layout = PlaceIndex::layout(header);
+    auto put = [&file](quint64 offset, const void *data, quint64 bytes) {
+        // Zero padding up to the section start
+        const QByteArray padding(int(offset - quint64(file.pos())), '\0');
+        file.write(padding);
+        file.write(static_cast<const char *>(data), qint64(bytes));
+    };
+    put(0, &header, sizeof(header));
+    put(layout.places, records.data(), records.size() * sizeof(PlaceIndex::Place));
+    put(layout.houses, houses.data(), houses.size() * sizeof(PlaceIndex::House));
+    put(layout.blocks, blocks.data(), blocks.size() * sizeof(PlaceIndex::Block));
+    put(layout.keys, keys.data(), keys.size());
+    put(layout.postings, postingList.data(), postingList.size() * sizeof(quint32));
+    put(layout.strings, strings.data(), strings.size());
+    put(layout.size, nullptr, 0);
+    return file.commit();
+}
@@ -0,0 +1,66 @@
+#ifndef PLACEINDEXBUILDER_H
+#define PLACEINDEXBUILDER_H
+
+#include "PlaceIndex.h"
+#include <QIODevice>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+/**
+ * @brief Turns OSM names and addresses into a PlaceIndex file.
+ *
+ * Places without a settlement get the nearest one within
+ * SettlementRadiusMeters. Named ways of the same street in the same
+ * settlement are merged into one street, placed at the way nearest their
+ * centre. Address points are attached to the street they name in their
+ * settlement, or dropped when there is none.
+ */
+class PlaceIndexBuilder
+{
+public:
+    static constexpr double SettlementRadiusMeters = 20000.0;
+
+    struct Stats {
+        quint32 places = 0;
+        quint32 streets = 0;
+        quint32 houses = 0;
+        quint32 unmatchedHouses = 0; // no street of that name in their settlement
+        quint32 keys = 0;
+        quint32 keyBytes = 0;        // front-coded
+    };
+
+    void addSettlement(const std::string &name, double lat, double lon);
+    void addPoi(const std::string &name, double lat, double lon, const std::string &settlement = {});
+    void addStreet(const std::string &name, double lat, double lon, const std::string &settlement = {});
+    void addHouse(const std::string &street, const std::string &number, double lat, double lon,
+                  const std::string &settlement = {});
+    // Settlements (place=city/town/village), named streets, named POIs and
+    // address points of an .osm (XML) extract
+    bool readOsmXml(QIODevice *device);
+
+    bool write(const QString &path);
+    const Stats &stats() const { return m_stats; }
+
+private:
+    struct Entry {
+        std::string name;
+        std::string settlement;
+        qint32 lat;
+        qint32 lon;
+        PlaceIndex::Kind kind;
+    };
+    struct HouseEntry {
+        std::string street;
+        std::string number;
+        std::string settlement;
+        qint32 lat;
+        qint32 lon;
+    };
+
+    std::vector<Entry> m_entries;
+    std::vector<HouseEntry> m_houses;
+    Stats m_stats;
+};
+
+#endif // PLACEINDEXBUILDER_H
@@ -0,0 +1,129 @@
+#include "RoadGraph.h"
+#include "GeoMath.h"
+#include <QDebug>
+#include <algorithm>
+#include <cmath>
+
+namespace {
+quint64 align(quint64 offset) { return (offset + 7) & ~quint64(7); }
+}
+
+RoadGraph::~RoadGraph() {
+    close();
+}
+
+RoadGraph::Layout RoadGraph::layout(const Header &h) {
+    // Sections follow the header in this order, each 8-byte aligned
+    Layout l;
+    quint64 at = align(sizeof(Header));
+    auto section = [&at](quint64 bytes) {
+        const quint64 start = at;
+        at = align(at + bytes);
+        return start;
+    };
+    l.nodes = section(quint64(h.nodeCount) * sizeof(Point));
+    l.upFirst = section((quint64(h.nodeCount) + 1) * sizeof(quint32));
+    l.upEdges = section(quint64(h.upEdgeCount) * sizeof(Edge));
+    l.downFirst = section((quint64(h.nodeCount) + 1) * sizeof(quint32));
+    l.downEdges = section(quint64(h.downEdgeCount) * sizeof(Edge));
+    l.segments = section(quint64(h.segmentCount) * sizeof(Segment));
+    l.shapes = section(quint64(h.shapeCount) * sizeof(Point));
+    l.nameFirst = section((quint64(h.nameCount) + 1) * sizeof(quint32));
+    l.names = section(h.nameBytes);
+    l.cellFirst = section((quint64(h.gridRows) * h.gridCols + 1) * sizeof(quint32));
+    l.cellNodes = section(quint64(h.nodeCount) * sizeof(quint32));
+    l.size = at;
+    return l;
+}
+
+bool RoadGraph::open(const QString &path) {
+    close();
+    m_file.setFileName(path);
+    if (!m_file.open(QIODevice::ReadOnly)) return false;
+    const qint64 size = m_file.size();
+    if (size < qint64(sizeof(Header))) {
+        qWarning() << "Road graph: truncated file" << path;
+        m_file.close();
+        return false;
+    }
+    m_map = m_file.map(0, size);
+    if (!m_map) {
+        qWarning() << "Road graph: cannot map" << path << m_file.errorString();
+        m_file.close();
+        return false;
+    }
+
+    const Header *header = reinterpret_cast<const Header *>(m_map);
+    const Layout l = layout(*header);
+    if (header->magic != Magic || header->version != Version || quint64(size) < l.size) {
+        qWarning() << "Road graph: not a version" << Version << "graph file" << path;
+        close();
+        return false;
+    }
+    m_header = header;
+    m_nodes = reinterpret_cast<const Point *>(m_map + l.nodes);
+    m_upFirst = reinterpret_cast<const quint32 *>(m_map + l.upFirst);
+    m_upEdges = reinterpret_cast<const Edge *>(m_map + l.upEdges);
+    m_downFirst = reinterpret_cast<const quint32 *>(m_map + l.downFirst);
+    m_downEdges = reinterpret_cast<const Edge *>(m_map + l.downEdges);
+    m_segments = reinterpret_cast<const Segment *>(m_map + l.segments);
+    m_shapes = reinterpret_cast<const Point *>(m_map + l.shapes);
+    m_nameFirst = reinterpret_cast<const quint32 *>(m_map + l.nameFirst);
+    m_names = reinterpret_cast<const char *>(m_map + l.names);
+    m_cellFirst = reinterpret_cast<const quint32 *>(m_map + l.cellFirst);
+    m_cellNodes = reinterpret_cast<const quint32 *>(m_map + l.cellNodes);
+    return true;
+}
+
+void RoadGraph::close() {
+    if (m_map) m_file.unmap(m_map);
+    m_map = nullptr;
+    m_header = nullptr;
+    m_file.close();
+}
+
+QString RoadGraph::name(quint32 index) const {
+    if (!m_header || index >= m_header->nameCount) return QString();
+    return QString::fromUtf8(m_names + m_nameFirst[index], int(m_nameFirst[index + 1] - m_nameFirst[index]));
+}
+
+double RoadGraph::distanceMeters(const Point &a, const Point &b) {
+    return GeoMath::meters(a.lat * 1e-7, a.lon * 1e-7, b.lat * 1e-7, b.lon * 1e-7);
+}
+
+qint64 RoadGraph::nearestNode(double lat, double lon, double maxMeters) const {
+    if (!m_header || m_header->nodeCount == 0) return -1;
+    const Header &h = *m_header;
+    const Point target{qint32(std::lround(lat * 1e7)), qint32(std::lround(lon * 1e7))};
+    const int row = int(std::floor(double(target.lat - h.gridLat) / h.gridCell));
+    const int col = int(std::floor(double(target.lon - h.gridLon) / h.gridCell));
+
+    // Rings of cells around the target; a ring can only hold a closer node
+    // while its inner edge is nearer than the best so far
+    const double cellMeters = h.gridCell * 1e-7 * GeoMath::MetersPerDegree
+                              * std::max(0.1, std::cos(target.lat * 1e-7 * GeoMath::DegToRad)); // narrower east-west side
+    const int maxRing = int(maxMeters / cellMeters) + 1;
+    qint64 best = -1;
+    double bestMeters = maxMeters;
+    for (int ring = 0; ring <= maxRing; ++ring) {
+        if (best >= 0 && (ring - 1) * cellMeters > bestMeters) break;
+        for (int r = row - ring; r <= row + ring; ++r) {
+            if (r < 0 || r >= int(h.gridRows)) continue;
+            const bool edgeRow = r == row - ring || r == row + ring;
+            for (int c = col - ring; c <= col + ring; c += edgeRow ? 1 : 2 * ring) {
+                if (c >= 0 && c < int(h.gridCols)) {
+                    const quint32 cell = quint32(r) * h.gridCols + quint32(c);
+                    for (quint32 i = m_cellFirst[cell]; i < m_cellFirst[cell + 1]; ++i) {
+                        const quint32 n = m_cellNodes[i];
+                        const double d = distanceMeters(target, m_nodes[n]);
+                        if (d <= bestMeters) {
+                            bestMeters = d;
+                            best = n;
+                        }
+                    }
+                }
+            }
+        }
+    }
+    return best;
+}
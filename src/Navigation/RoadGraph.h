@@ -0,0 +1,135 @@
+#ifndef ROADGRAPH_H
+#define ROADGRAPH_H
+
+#include <QFile>
+#include <QString>
+#include <cstdint>
+
+/**
+ * @brief Preprocessed road network, memory-mapped from a graph file.
+ *
+ * Built offline by RoadGraphBuilder from an OSM extract. Nodes are the
+ * junctions and dead ends of the routable ways; a segment is the directed
+ * stretch of road between two nodes, with its shape, name, class and
+ * travel time. Two-way roads are two segments sharing one shape.
+ *
+ * Routing data is a contraction hierarchy: every node carries the edges
+ * to higher-ranked nodes, split into the forward (up) and reverse (down)
+ * directions, so a query settles only a few hundred nodes even on a
+ * country. An edge is either an original segment or a shortcut over the
+ * lower-ranked middle node it bypasses.
+ *
+ * A uniform grid over the node coordinates answers nearest-node lookups.
+ * All arrays are read in place from the mapping; nothing is loaded up
+ * front, so opening a country-sized file costs no time and only the pages
+ * a query touches are read from the flash.
+ */
+class RoadGraph
+{
+public:
+    static constexpr quint32 Magic = 0x3147524E; // "NRG1"
+    static constexpr quint32 Version = 1;
+    static constexpr quint32 ShortcutFlag = 0x80000000u;
+    static constexpr quint32 NoName = 0xFFFFFFFFu;
+
+    enum RoadClass : quint8 { Motorway, Trunk, Primary, Secondary, Tertiary, Residential, Service };
+
+    // Coordinates in 1e-7 degrees
+    struct Point {
+        qint32 lat;
+        qint32 lon;
+    };
+
+    struct Edge {
+        quint32 target;
+        quint32 weight;  // deciseconds
+        quint32 data;    // segment index, or ShortcutFlag | middle node
+    };
+
+    struct Segment {
+        enum Flags : quint8 { Reversed = 1 }; // shape is stored in the other direction
+        quint32 from;
+        quint32 to;
+        quint32 shapeFirst;
+        quint32 name;       // NoName or an index into the name table
+        quint32 lengthDm;
+        quint32 weight;     // deciseconds
+        quint16 shapeCount; // points between from and to
+        quint8 roadClass;
+        quint8 speedKmh;
+        quint8 flags;
+        quint8 reserved[3];
+    };
+
+    struct Header {
+        quint32 magic;
+        quint32 version;
+        quint32 nodeCount;
+        quint32 upEdgeCount;
+        quint32 downEdgeCount;
+        quint32 segmentCount;
+        quint32 shapeCount;
+        quint32 nameCount;
+        quint32 nameBytes;
+        quint32 gridRows;
+        quint32 gridCols;
+        qint32 gridLat;  // south-west corner
+        qint32 gridLon;
+        qint32 gridCell; // cell edge, 1e-7 degrees
+        quint32 reserved[2];
+    };
+
+    RoadGraph() = default;
+    ~RoadGraph();
+    RoadGraph(const RoadGraph &) = delete;
+    RoadGraph &operator=(const RoadGraph &) = delete;
+
+    bool open(const QString &path);
+    void close();
+    bool isOpen() const { return m_map != nullptr; }
+
+    quint32 nodeCount() const { return m_header ? m_header->nodeCount : 0; }
+    quint32 segmentCount() const { return m_header ? m_header->segmentCount : 0; }
+    quint32 upEdgeCount() const { return m_header ? m_header->upEdgeCount : 0; }
+    quint32 downEdgeCount() const { return m_header ? m_header->downEdgeCount : 0; }
+
+    const Point &node(quint32 n) const { return m_nodes[n]; }
+    const Segment &segment(quint32 s) const { return m_segments[s]; }
+    const Point &shape(quint32 i) const { return m_shapes[i]; }
+    // Edges to higher-ranked nodes: leaving n (up), and entering n (down, target is the source)
+    const Edge *upBegin(quint32 n) const { return m_upEdges + m_upFirst[n]; }
+    const Edge *upEnd(quint32 n) const { return m_upEdges + m_upFirst[n + 1]; }
+    const Edge *downBegin(quint32 n) const { return m_downEdges + m_downFirst[n]; }
+    const Edge *downEnd(quint32 n) const { return m_downEdges + m_downFirst[n + 1]; }
+    QString name(quint32 index) const;
+
+    // Nearest node within maxMeters, or -1
+    qint64 nearestNode(double lat, double lon, double maxMeters) const;
+
+    // Section layout shared with the writer (RoadGraphBuilder)
+    struct Layout {
+        quint64 nodes, upFirst, upEdges, downFirst, downEdges, segments, shapes, nameFirst, names,
+            cellFirst, cellNodes, size;
+    };
+    static Layout layout(const Header &header);
+
+    static double distanceMeters(const Point &a, const Point &b);
+
+private:
+    QFile m_file;
+    uchar *m_map = nullptr;
+    const Header *m_header = nullptr;
+    const Point *m_nodes = nullptr;
+    const quint32 *m_upFirst = nullptr;
+    const Edge *m_upEdges = nullptr;
+    const quint32 *m_downFirst = nullptr;
+    const Edge *m_downEdges = nullptr;
+    const Segment *m_segments = nullptr;
+    const Point *m_shapes = nullptr;
+    const quint32 *m_nameFirst = nullptr;
+    const char *m_names = nullptr;
+    const quint32 *m_cellFirst = nullptr;
+    const quint32 *m_cellNodes = nullptr;
+};
+
+#endif // ROADGRAPH_H
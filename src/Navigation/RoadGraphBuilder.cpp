@@ -0,0 +1,560 @@
+#include "RoadGraphBuilder.h"
+#include <QSaveFile>
+#include <QXmlStreamReader>
+#include <QElapsedTimer>
+#include <QDebug>
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <queue>
+
+namespace {
+
+constexpr quint32 kInfinity = std::numeric_limits<quint32>::max();
+constexpr quint32 kNone = std::numeric_limits<quint32>::max();
+constexpr int kTargetNodesPerCell = 4;
+constexpr double kMinCellDegrees = 0.002;
+constexpr double kMaxCellDegrees = 0.05;
+
+// Directed graph being contracted: per node, the edges to and from the
+// nodes still in play. Contracting a node records its remaining edges as
+// its hierarchy edges, removes it from its neighbours and links every
+// in-neighbour to every out-neighbour whose shortest path ran through it.
+class Contractor
+{
+public:
+    Contractor(quint32 nodeCount, int settleLimit)
+        : m_out(nodeCount), m_in(nodeCount), m_contracted(nodeCount, 0), m_deleted(nodeCount, 0),
+          m_level(nodeCount, 0), m_dist(nodeCount, kInfinity), m_target(nodeCount, 0), m_settleLimit(settleLimit)
+    {
+    }
+
+    void addEdge(quint32 from, quint32 to, quint32 weight, quint32 data) {
+        if (from == to) return;
+        for (RoadGraph::Edge &e : m_out[from]) {
+            if (e.target != to) continue;
+            if (weight < e.weight) {
+                // Parallel roads: only the faster one can be on a shortest path
+                e.weight = weight;
+                e.data = data;
+                for (RoadGraph::Edge &r : m_in[to]) {
+                    if (r.target == from) {
+                        r.weight = weight;
+                        r.data = data;
+                    }
+                }
+            }
+            return;
+        }
+        m_out[from].push_back({to, weight, data});
+        m_in[to].push_back({from, weight, data});
+    }
+
+    quint32 run(std::vector<std::vector<RoadGraph::Edge>> &up, std::vector<std::vector<RoadGraph::Edge>> &down) {
+        const quint32 n = quint32(m_out.size());
+        up.assign(n, {});
+        down.assign(n, {});
+        std::vector<int> priority(n);
+        using Entry = std::pair<int, quint32>;
+        std::priority_queue<Entry, std::vector<Entry>, std::greater<Entry>> queue;
+        for (quint32 v = 0; v < n; ++v) {
+            priority[v] = computePriority(v);
+            queue.push({priority[v], v});
+        }
+
+        quint32 shortcuts = 0;
+        std::vector<Shortcut> added;
+        while (!queue.empty()) {
+            const Entry top = queue.top();
+            queue.pop();
+            const quint32 v = top.second;
+            if (m_contracted[v] || top.first != priority[v]) continue; // stale entry
+            // Lazy update: contract only if still the cheapest
+            priority[v] = computePriority(v);
+            if (!queue.empty() && priority[v] > queue.top().first) {
+                queue.push({priority[v], v});
+                continue;
+            }
+
+            added.clear();
+            findShortcuts(v, &added);
+            for (const RoadGraph::Edge &e : m_out[v]) up[v].push_back(e);
+            for (const RoadGraph::Edge &e : m_in[v]) down[v].push_back(e);
+            m_contracted[v] = 1;
+            for (const RoadGraph::Edge &e : m_out[v]) removeEdge(m_in[e.target], v);
+            for (const RoadGraph::Edge &e : m_in[v]) removeEdge(m_out[e.target], v);
+            for (const Shortcut &s : added) addEdge(s.from, s.to, s.weight, RoadGraph::ShortcutFlag | v);
+            shortcuts += quint32(added.size());
+
+            // Neighbours: one more contracted neighbour, one level deeper
+            auto touch = [&](quint32 u) {
+                ++m_deleted[u];
+                m_level[u] = std::max(m_level[u], m_level[v] + 1);
+                priority[u] = computePriority(u);
+                queue.push({priority[u], u});
+            };
+            for (const RoadGraph::Edge &e : m_out[v]) touch(e.target);
+            for (const RoadGraph::Edge &e : m_in[v]) touch(e.target);
+            std::vector<RoadGraph::Edge>().swap(m_out[v]);
+            std::vector<RoadGraph::Edge>().swap(m_in[v]);
+        }
+        return shortcuts;
+    }
+
+private:
+    using Entry = std::pair<quint32, quint32>;
+    struct Shortcut {
+        quint32 from;
+        quint32 to;
+        quint32 weight;
+    };
+
+    static void removeEdge(std::vector<RoadGraph::Edge> &edges, quint32 target) {
+        edges.erase(std::remove_if(edges.begin(), edges.end(),
+                                   [target](const RoadGraph::Edge &e) { return e.target == target; }),
+                    edges.end());
+    }
+
+    int computePriority(quint32 v) {
+        const int shortcuts = findShortcuts(v, nullptr);
+        const int edgeDifference = shortcuts - int(m_out[v].size() + m_in[v].size());
+        return 4 * edgeDifference + 2 * m_deleted[v] + m_level[v];
+    }
+
+    // Shortcuts needed to contract v; collected into `out` when given
+    int findShortcuts(quint32 v, std::vector<Shortcut> *out) {
+        int count = 0;
+        quint32 maxOut = 0;
+        for (const RoadGraph::Edge &e : m_out[v]) {
+            maxOut = std::max(maxOut, e.weight);
+            m_target[e.target] = 1;
+        }
+        for (const RoadGraph::Edge &in : m_in[v]) {
+            const quint32 u = in.target;
+            witnessSearch(u, v, in.weight + maxOut, int(m_out[v].size()));
+            for (const RoadGraph::Edge &e : m_out[v]) {
+                if (e.target == u) continue;
+                const quint32 via = in.weight + e.weight;
+                if (m_dist[e.target] > via) {
+                    ++count;
+                    if (out) out->push_back({u, e.target, via});
+                }
+            }
+            for (quint32 t : m_touched) m_dist[t] = kInfinity;
+            m_touched.clear();
+        }
+        for (const RoadGraph::Edge &e : m_out[v]) m_target[e.target] = 0;
+        return count;
+    }
+
+    // Dijkstra from `source` around `skip`, until the `targets` out-neighbours
+    // of `skip` are settled, or up to `limit` or the settle limit
+    void witnessSearch(quint32 source, quint32 skip, quint32 limit, int targets) {
+        // The heap's storage is reused across searches
+        std::vector<Entry> &heap = m_heap;
+        heap.clear();
+        m_dist[source] = 0;
+        m_touched.push_back(source);
+        heap.push_back({0, source});
+        int settled = 0;
+        while (!heap.empty() && settled < m_settleLimit) {
+            std::pop_heap(heap.begin(), heap.end(), std::greater<Entry>());
+            const auto [d, u] = heap.back();
+            heap.pop_back();
+            if (d > m_dist[u]) continue;
+            if (d > limit) break;
+            if (m_target[u] && --targets == 0) break;
+            ++settled;
+            for (const RoadGraph::Edge &e : m_out[u]) {
+                if (e.target == skip) continue;
+                const quint32 nd = d + e.weight;
+                if (nd < m_dist[e.target]) {
+                    if (m_dist[e.target] == kInfinity) m_touched.push_back(e.target);
+                    m_dist[e.target] = nd;
+                    heap.push_back({nd, e.target});
+                    std::push_heap(heap.begin(), heap.end(), std::greater<Entry>());
+                }
+            }
+        }
+    }
+
+    std::vector<std::vector<RoadGraph::Edge>> m_out;
+    std::vector<std::vector<RoadGraph::Edge>> m_in;
+    std::vector<char> m_contracted;
+    std::vector<int> m_deleted;
+    std::vector<int> m_level;
+    std::vector<quint32> m_dist;
+    std::vector<quint32> m_touched;
+    std::vector<char> m_target; // out-neighbours of the node being tested
+    std::vector<Entry> m_heap;
+    int m_settleLimit;
+};
+
+// Largest strongly connected component (iterative Kosaraju); true per node inside it
+std::vector<char> largestComponent(quint32 nodeCount, const std::vector<RoadGraph::Segment> &segments) {
+    std::vector<std::vector<quint32>> out(nodeCount), in(nodeCount);
+    for (const RoadGraph::Segment &s : segments) {
+        out[s.from].push_back(s.to);
+        in[s.to].push_back(s.from);
+    }
+    // Finishing order on the forward graph
+    std::vector<quint32> order;
+    order.reserve(nodeCount);
+    std::vector<char> seen(nodeCount, 0);
+    std::vector<std::pair<quint32, size_t>> stack;
+    for (quint32 root = 0; root < nodeCount; ++root) {
+        if (seen[root]) continue;
+        seen[root] = 1;
+        stack.push_back({root, 0});
+        while (!stack.empty()) {
+            auto &[node, next] = stack.back();
+            if (next < out[node].size()) {
+                const quint32 t = out[node][next++];
+                if (!seen[t]) {
+                    seen[t] = 1;
+                    stack.push_back({t, 0});
+                }
+            } else {
+                order.push_back(node);
+                stack.pop_back();
+            }
+        }
+    }
+    // Components on the reverse graph, in reverse finishing order
+    std::vector<quint32> component(nodeCount, kNone);
+    std::vector<quint32> sizes;
+    std::vector<quint32> pending;
+    for (auto it = order.rbegin(); it != order.rend(); ++it) {
+        if (component[*it] != kNone) continue;
+        const quint32 id = quint32(sizes.size());
+        sizes.push_back(0);
+        component[*it] = id;
+        pending.push_back(*it);
+        while (!pending.empty()) {
+            const quint32 node = pending.back();
+            pending.pop_back();
+            ++sizes[id];
+            for (quint32 s : in[node]) {
+                if (component[s] == kNone) {
+                    component[s] = id;
+                    pending.push_back(s);
+                }
+            }
+        }
+    }
+    const quint32 largest = quint32(std::max_element(sizes.begin(), sizes.end()) - sizes.begin());
+    std::vector<char> keep(nodeCount, 0);
+    for (quint32 n = 0; n < nodeCount; ++n) keep[n] = component[n] == largest;
+    return keep;
+}
+
+RoadGraph::RoadClass highwayClass(QStringView highway, bool *routable) {
+    *routable = true;
+    if (highway.startsWith(u"motorway")) return RoadGraph::Motorway;
+    if (highway.startsWith(u"trunk")) return RoadGraph::Trunk;
+    if (highway.startsWith(u"primary")) return RoadGraph::Primary;
+    if (highway.startsWith(u"secondary")) return RoadGraph::Secondary;
+    if (highway.startsWith(u"tertiary")) return RoadGraph::Tertiary;
+    if (highway == u"residential" || highway == u"unclassified" || highway == u"living_street") return RoadGraph::Residential;
+    if (highway == u"service") return RoadGraph::Service;
+    *routable = false;
+    return RoadGraph::Service;
+}
+
+} // namespace
+
+int RoadGraphBuilder::defaultSpeed(RoadGraph::RoadClass roadClass) {
+    switch (roadClass) {
+    case RoadGraph::Motorway: return 110;
+    case RoadGraph::Trunk: return 90;
+    case RoadGraph::Primary: return 70;
+    case RoadGraph::Secondary: return 60;
+    case RoadGraph::Tertiary: return 50;
+    case RoadGraph::Residential: return 30;
+    case RoadGraph::Service: break;
+    }
+    return 15;
+}
+
+void RoadGraphBuilder::addNode(qint64 id, double lat, double lon) {
+    m_osmNodes[id] = {qint32(std::lround(lat * 1e7)), qint32(std::lround(lon * 1e7))};
+}
+
+void RoadGraphBuilder::addWay(const std::vector<qint64> &nodes, RoadGraph::RoadClass roadClass, int speedKmh,
+                              int oneway, const std::string &name) {
+    if (nodes.size() < 2) return;
+    quint32 nameId = RoadGraph::NoName;
+    if (!name.empty()) {
+        const auto found = m_nameIndex.find(name);
+        if (found != m_nameIndex.end()) {
+            nameId = found->second;
+        } else {
+            nameId = quint32(m_names.size());
+            m_names.push_back(name);
+            m_nameIndex.emplace(name, nameId);
+        }
+    }
+    m_ways.push_back({nodes, roadClass, speedKmh > 0 ? speedKmh : defaultSpeed(roadClass), oneway, nameId});
+}
+
+bool RoadGraphBuilder::readOsmXml(QIODevice *device) {
+    QXmlStreamReader xml(device);
+    std::vector<qint64> refs;
+    QString highway, name, ref, maxspeed, oneway, junction;
+    bool inWay = false;
+    while (!xml.atEnd()) {
+        const QXmlStreamReader::TokenType token = xml.readNext();
+        if (token == QXmlStreamReader::StartElement) {
+            const QStringView element = xml.name();
+            const QXmlStreamAttributes attributes = xml.attributes();
+            if (element == u"node") {
+                addNode(attributes.value(u"id").toLongLong(), attributes.value(u"lat").toDouble(),
+                        attributes.value(u"lon").toDouble());
+            } else if (element == u"way") {
+                inWay = true;
+                refs.clear();
+                highway.clear(); name.clear(); ref.clear(); maxspeed.clear(); oneway.clear(); junction.clear();
+            } else if (inWay && element == u"nd") {
+                refs.push_back(attributes.value(u"ref").toLongLong());
+            } else if (inWay && element == u"tag") {
+                const QStringView k = attributes.value(u"k");
+                const QString v = attributes.value(u"v").toString();
+                if (k == u"highway") highway = v;
+                else if (k == u"name") name = v;
+                else if (k == u"ref") ref = v;
+                else if (k == u"maxspeed") maxspeed = v;
+                else if (k == u"oneway") oneway = v;
+                else if (k == u"junction") junction = v;
+            }
+        } else if (token == QXmlStreamReader::EndElement && xml.name() == u"way") {
+            inWay = false;
+            bool routable = false;
+            const RoadGraph::RoadClass roadClass = highwayClass(highway, &routable);
+            if (!routable) continue;
+            int direction = 0;
+            if (oneway == u"yes" || oneway == u"1" || oneway == u"true") direction = 1;
+            else if (oneway == u"-1" || oneway == u"reverse") direction = -1;
+            else if (oneway != u"no" && (highway == u"motorway" || junction == u"roundabout")) direction = 1;
+            // "50", "50 mph"; anything else (signals, none) keeps the class default
+            int speed = maxspeed.section(' ', 0, 0).toInt();
+            if (maxspeed.endsWith(u"mph")) speed = int(speed * 1.609);
+            addWay(refs, roadClass, speed, direction, (name.isEmpty() ? ref : name).toStdString());
+        }
+    }
+    if (xml.hasError()) {
+        qWarning() << "Road graph: OSM XML error" << xml.errorString() << "at line" << xml.lineNumber();
+        return false;
+    }
+    return true;
+}
+
+bool RoadGraphBuilder::write(const QString &path) {
+    m_stats = Stats();
+
+    // Junctions and way ends become graph nodes; other points are shape
+    std::unordered_map<qint64, quint32> uses;
+    for (const Way &way : m_ways) {
+        for (qint64 id : way.nodes) ++uses[id];
+        uses[way.nodes.front()] += 2;
+        uses[way.nodes.back()] += 2;
+    }
+
+    std::unordered_map<qint64, quint32> nodeIndex;
+    std::vector<RoadGraph::Point> nodes;
+    std::vector<RoadGraph::Segment> segments;
+    std::vector<RoadGraph::Point> shapes;
+    auto graphNode = [&](qint64 id, const RoadGraph::Point &p) {
+        const auto found = nodeIndex.find(id);
+        if (found != nodeIndex.end()) return found->second;
+        nodeIndex.emplace(id, quint32(nodes.size()));
+        nodes.push_back(p);
+        return quint32(nodes.size() - 1);
+    };
+
+    for (const Way &way : m_ways) {
+        const bool complete = std::all_of(way.nodes.begin(), way.nodes.end(),
+                                          [this](qint64 id) { return m_osmNodes.count(id) > 0; });
+        if (!complete) {
+            ++m_stats.incompleteWays;
+            continue;
+        }
+        RoadGraph::Point previous = m_osmNodes[way.nodes.front()];
+        quint32 from = graphNode(way.nodes.front(), previous);
+        quint32 shapeFirst = quint32(shapes.size());
+        double meters = 0.0;
+        for (size_t i = 1; i < way.nodes.size(); ++i) {
+            const RoadGraph::Point p = m_osmNodes[way.nodes[i]];
+            meters += RoadGraph::distanceMeters(previous, p);
+            previous = p;
+            const bool junction = uses[way.nodes[i]] > 1 || shapes.size() - shapeFirst == 0xFFFF;
+            if (!junction) {
+                shapes.push_back(p);
+                continue;
+            }
+            const quint32 to = graphNode(way.nodes[i], p);
+            RoadGraph::Segment s{};
+            s.shapeFirst = shapeFirst;
+            s.shapeCount = quint16(shapes.size() - shapeFirst);
+            s.name = way.name;
+            s.lengthDm = quint32(std::lround(meters * 10.0));
+            s.weight = std::max<quint32>(1, quint32(std::lround(meters / (way.speedKmh / 3.6) * 10.0)));
+            s.roadClass = way.roadClass;
+            s.speedKmh = quint8(std::min(way.speedKmh, 255));
+            if (from != to || s.shapeCount > 0) {
+                if (way.oneway >= 0) {
+                    s.from = from;
+                    s.to = to;
+                    segments.push_back(s);
+                }
+                if (way.oneway <= 0) {
+                    s.from = to;
+                    s.to = from;
+                    s.flags = RoadGraph::Segment::Reversed;
+                    segments.push_back(s);
+                }
+            }
+            from = to;
+            shapeFirst = quint32(shapes.size());
+            meters = 0.0;
+        }
+    }
+    if (nodes.empty()) {
+        qWarning() << "Road graph: no routable ways";
+        return false;
+    }
+
+    // Keep the largest strongly connected part, renumbered, with its shapes packed
+    const std::vector<char> keep = largestComponent(quint32(nodes.size()), segments);
+    std::vector<quint32> renumber(nodes.size(), kNone);
+    std::vector<RoadGraph::Point> keptNodes;
+    for (quint32 n = 0; n < nodes.size(); ++n) {
+        if (!keep[n]) continue;
+        renumber[n] = quint32(keptNodes.size());
+        keptNodes.push_back(nodes[n]);
+    }
+    m_stats.droppedNodes = quint32(nodes.size() - keptNodes.size());
+    std::vector<RoadGraph::Segment> keptSegments;
+    std::vector<RoadGraph::Point> keptShapes;
+    std::unordered_map<quint32, quint32> shapeMoves; // both directions share one shape
+    for (RoadGraph::Segment s : segments) {
+        if (!keep[s.from] || !keep[s.to]) continue;
+        s.from = renumber[s.from];
+        s.to = renumber[s.to];
+        if (s.shapeCount > 0) {
+            const auto moved = shapeMoves.find(s.shapeFirst);
+            if (moved != shapeMoves.end()) {
+                s.shapeFirst = moved->second;
+            } else {
+                const quint32 first = quint32(keptShapes.size());
+                keptShapes.insert(keptShapes.end(), shapes.begin() + s.shapeFirst,
+                                  shapes.begin() + s.shapeFirst + s.shapeCount);
+                shapeMoves.emplace(s.shapeFirst, first);
+                s.shapeFirst = first;
+            }
+        } else {
+            s.shapeFirst = quint32(keptShapes.size());
+        }
+        keptSegments.push_back(s);
+    }
+    nodes.swap(keptNodes);
+    segments.swap(keptSegments);
+    shapes.swap(keptShapes);
+    const quint32 nodeCount = quint32(nodes.size());
+
+    // Contraction hierarchy
+    QElapsedTimer clock;
+    clock.start();
+    Contractor contractor(nodeCount, m_config.witnessSettleLimit);
+    for (quint32 i = 0; i < segments.size(); ++i)
+        contractor.addEdge(segments[i].from, segments[i].to, segments[i].weight, i);
+    std::vector<std::vector<RoadGraph::Edge>> up, down;
+    m_stats.shortcuts = contractor.run(up, down);
+    m_stats.contractMs = clock.elapsed();
+    m_stats.nodes = nodeCount;
+    m_stats.segments = quint32(segments.size());
+
+    // Nearest-node grid over the bounding box
+    qint32 minLat = nodes[0].lat, maxLat = nodes[0].lat, minLon = nodes[0].lon, maxLon = nodes[0].lon;
+    for (const RoadGraph::Point &p : nodes) {
+        minLat = std::min(minLat, p.lat);
+        maxLat = std::max(maxLat, p.lat);
+        minLon = std::min(minLon, p.lon);
+        maxLon = std::max(maxLon, p.lon);
+    }
+    const double area = double(maxLat - minLat + 1) * double(maxLon - minLon + 1);
+    const double cell = std::clamp(std::sqrt(area * kTargetNodesPerCell / nodeCount), kMinCellDegrees * 1e7,
+                                   kMaxCellDegrees * 1e7);
+    RoadGraph::Header header{};
+    header.magic = RoadGraph::Magic;
+    header.version = RoadGraph::Version;
+    header.nodeCount = nodeCount;
+    header.segmentCount = quint32(segments.size());
+    header.shapeCount = quint32(shapes.size());
+    header.nameCount = quint32(m_names.size());
+    header.gridCell = qint32(cell);
+    header.gridLat = minLat;
+    header.gridLon = minLon;
+    header.gridRows = quint32((maxLat - minLat) / header.gridCell + 1);
+    header.gridCols = quint32((maxLon - minLon) / header.gridCell + 1);
+
+    // CSR arrays
+    std::vector<quint32> upFirst(nodeCount + 1, 0), downFirst(nodeCount + 1, 0);
+    std::vector<RoadGraph::Edge> upEdges, downEdges;
+    for (quint32 n = 0; n < nodeCount; ++n) {
+        upFirst[n] = quint32(upEdges.size());
+        upEdges.insert(upEdges.end(), up[n].begin(), up[n].end());
+        downFirst[n] = quint32(downEdges.size());
+        downEdges.insert(downEdges.end(), down[n].begin(), down[n].end());
+    }
+    upFirst[nodeCount] = quint32(upEdges.size());
+    downFirst[nodeCount] = quint32(downEdges.size());
+    header.upEdgeCount = quint32(upEdges.size());
+    header.downEdgeCount = quint32(downEdges.size());
+
+    std::vector<quint32> nameFirst(m_names.size() + 1, 0);
+    std::string nameBytes;
+    for (size_t i = 0; i < m_names.size(); ++i) {
+        nameFirst[i] = quint32(nameBytes.size());
+        nameBytes += m_names[i];
+    }
+    nameFirst[m_names.size()] = quint32(nameBytes.size());
+    header.nameBytes = quint32(nameBytes.size());
+
+    const size_t cells = size_t(header.gridRows) * header.gridCols;
+    std::vector<quint32> cellFirst(cells + 1, 0), cellNodes(nodeCount);
+    auto cellOf = [&header](const RoadGraph::Point &p) {
+        return size_t((p.lat - header.gridLat) / header.gridCell) * header.gridCols
+               + size_t((p.lon - header.gridLon) / header.gridCell);
+    };
+    for (const RoadGraph::Point &p : nodes) ++cellFirst[cellOf(p) + 1];
+    for (size_t c = 0; c < cells; ++c) cellFirst[c + 1] += cellFirst[c];
+    std::vector<quint32> fill(cellFirst.begin(), cellFirst.end() - 1);
+    for (quint32 n = 0; n < nodeCount; ++n) cellNodes[fill[cellOf(nodes[n])]++] = n;
+
+    QSaveFile file(path);
+    if (!file.open(QIODevice::WriteOnly)) {
+        qWarning() << "Road graph: cannot write" << path << file.errorString();
+        return false;
+    }
+    const RoadGraph::Layout layout = RoadGraph::layout(header);
+    auto put = [&file](quint64 offset, const void *data, quint64 bytes) {
+        // Zero padding up to the section start
+        const QByteArray padding(int(offset - quint64(file.pos())), '\0');
+        file.write(padding);
+        file.write(static_cast<const char *>(data), qint64(bytes));
+    };
+    put(0, &header, sizeof(header));
+    put(layout.nodes, nodes.data(), nodes.size() * sizeof(RoadGraph::Point));
+    put(layout.upFirst, upFirst.data(), upFirst.size() * sizeof(quint32));
+    put(layout.upEdges, upEdges.data(), upEdges.size() * sizeof(RoadGraph::Edge));
+    put(layout.downFirst, downFirst.data(), downFirst.size() * sizeof(quint32));
+    put(layout.downEdges, downEdges.data(), downEdges.size() * sizeof(RoadGraph::Edge));
+    put(layout.segments, segments.data(), segments.size() * sizeof(RoadGraph::Segment));
+    put(layout.shapes, shapes.data(), shapes.size() * sizeof(RoadGraph::Point));
+    put(layout.nameFirst, nameFirst.data(), nameFirst.size() * sizeof(quint32));
+    put(layout.names, nameBytes.data(), nameBytes.size());
+    put(layout.cellFirst, cellFirst.data(), cellFirst.size() * sizeof(quint32));
+    put(layout.cellNodes, cellNodes.data(), cellNodes.size() * sizeof(quint32));
+    put(layout.size, nullptr, 0);
+    return file.commit();
+}
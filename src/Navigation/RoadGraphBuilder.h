@@ -0,0 +1,74 @@
+#ifndef ROADGRAPHBUILDER_H
+#define ROADGRAPHBUILDER_H
+
+#include "RoadGraph.h"
+#include <QIODevice>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+/**
+ * @brief Turns OSM road data into a RoadGraph file (offline preprocessing).
+ *
+ * Ways are split at junctions into segments, then only the largest
+ * strongly connected part of the network is kept, so that any node a
+ * position snaps to can reach and be reached from every other one.
+ * Segments are weighted by travel time at the way's maxspeed, or at a
+ * default per road class.
+ *
+ * The contraction hierarchy orders nodes by edge difference (shortcuts
+ * added minus edges removed), contracted neighbours and depth, updated
+ * lazily. Witness searches are bounded by witnessSettleLimit: a search
+ * cut short only adds a redundant shortcut, never a wrong route.
+ */
+class RoadGraphBuilder
+{
+public:
+    struct Config {
+        int witnessSettleLimit = 500;
+    };
+
+    struct Stats {
+        quint32 nodes = 0;
+        quint32 segments = 0;
+        quint32 shortcuts = 0;
+        quint32 droppedNodes = 0;  // outside the largest strongly connected part
+        quint32 incompleteWays = 0; // referencing nodes missing from the input
+        qint64 contractMs = 0;
+    };
+
+    RoadGraphBuilder() = default;
+    explicit RoadGraphBuilder(const Config &config) : m_config(config) {}
+
+    static int defaultSpeed(RoadGraph::RoadClass roadClass);
+
+    void addNode(qint64 id, double lat, double lon);
+    // oneway: 0 both directions, 1 along the node order, -1 against it.
+    // speedKmh 0 takes the class default.
+    void addWay(const std::vector<qint64> &nodes, RoadGraph::RoadClass roadClass, int speedKmh, int oneway,
+                const std::string &name);
+    // Nodes and highway ways of an .osm (XML) extract
+    bool readOsmXml(QIODevice *device);
+
+    // Builds the hierarchy and writes the graph file
+    bool write(const QString &path);
+    const Stats &stats() const { return m_stats; }
+
+private:
+    struct Way {
+        std::vector<qint64> nodes;
+        RoadGraph::RoadClass roadClass;
+        int speedKmh;
+        int oneway;
+        quint32 name;
+    };
+
+    Config m_config;
+    std::unordered_map<qint64, RoadGraph::Point> m_osmNodes;
+    std::vector<Way> m_ways;
+    std::vector<std::string> m_names;
+    std::unordered_map<std::string, quint32> m_nameIndex;
+    Stats m_stats;
+};
+
+#endif // ROADGRAPHBUILDER_H
@@ -0,0 +1,250 @@
+#include "RoadRouter.h"
+#include "GeoMath.h"
+#include <QMutexLocker>
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <queue>
+#include <tuple>
+
+namespace {
+
+constexpr quint32 kInfinity = std::numeric_limits<quint32>::max();
+
+QGeoCoordinate toCoordinate(const RoadGraph::Point &p) {
+    return QGeoCoordinate(p.lat * 1e-7, p.lon * 1e-7);
+}
+
+void appendPoint(RoutePath &path, const RoadGraph::Point &p) {
+    path.append(p.lat * 1e-7, p.lon * 1e-7);
+}
+
+double bearing(const RoadGraph::Point &a, const RoadGraph::Point &b) {
+    const double dLon = double(b.lon - a.lon) * std::cos(a.lat * 1e-7 * GeoMath::DegToRad);
+    return std::atan2(dLon, double(b.lat - a.lat)) / GeoMath::DegToRad;
+}
+
+// Shape point i (0 = first after `from`) in the direction of travel
+const RoadGraph::Point &shapePoint(const RoadGraph &graph, const RoadGraph::Segment &s, quint32 i) {
+    const bool reversed = s.flags & RoadGraph::Segment::Reversed;
+    return graph.shape(s.shapeFirst + (reversed ? s.shapeCount - 1 - i : i));
+}
+
+// Heading leaving `from` and arriving at `to`
+double departBearing(const RoadGraph &graph, const RoadGraph::Segment &s) {
+    return bearing(graph.node(s.from), s.shapeCount ? shapePoint(graph, s, 0) : graph.node(s.to));
+}
+
+double arriveBearing(const RoadGraph &graph, const RoadGraph::Segment &s) {
+    return bearing(s.shapeCount ? shapePoint(graph, s, s.shapeCount - 1u) : graph.node(s.from), graph.node(s.to));
+}
+
+QString turnModifier(double turn) {
+    const double angle = std::abs(turn);
+    const QString side = turn < 0 ? "left" : "right";
+    if (angle < 15) return "straight";
+    if (angle < 45) return "slight " + side;
+    if (angle < 135) return side;
+    return "sharp " + side;
+}
+
+} // namespace
+
+RoadRouter::RoadRouter(const RoadGraph *graph)
+    : m_graph(graph)
+{
+}
+
+quint32 RoadRouter::Search::dist(quint32 node) const {
+    const auto it = labels.find(node);
+    return it == labels.end() ? kInfinity : it->second.dist;
+}
+
+void RoadRouter::reset(Search &search) {
+    for (quint32 n : search.touched) search.labels.erase(n);
+    search.touched.clear();
+}
+
+bool RoadRouter::findPath(quint32 from, quint32 to, std::vector<quint32> &segments, quint32 *weight) {
+    segments.clear();
+    m_settled = 0;
+    if (from == to) {
+        if (weight) *weight = 0;
+        return true;
+    }
+    reset(m_forward);
+    reset(m_backward);
+
+    using Entry = std::pair<quint32, quint32>;
+    using Queue = std::priority_queue<Entry, std::vector<Entry>, std::greater<Entry>>;
+    Queue forwardQueue, backwardQueue;
+    auto start = [](Search &search, Queue &queue, quint32 node) {
+        search.labels[node] = {0, node, 0};
+        search.touched.push_back(node);
+        queue.push({0, node});
+    };
+    start(m_forward, forwardQueue, from);
+    start(m_backward, backwardQueue, to);
+
+    quint32 best = kInfinity;
+    quint32 meeting = 0;
+    while (!forwardQueue.empty() || !backwardQueue.empty()) {
+        const quint32 forwardTop = forwardQueue.empty() ? kInfinity : forwardQueue.top().first;
+        const quint32 backwardTop = backwardQueue.empty() ? kInfinity : backwardQueue.top().first;
+        if (std::min(forwardTop, backwardTop) >= best) break;
+
+        // Forward climbs up edges from the start, backward down edges from the destination
+        const bool forward = forwardTop <= backwardTop;
+        Search &self = forward ? m_forward : m_backward;
+        const Search &other = forward ? m_backward : m_forward;
+        Queue &queue = forward ? forwardQueue : backwardQueue;
+        const auto [d, v] = queue.top();
+        queue.pop();
+        if (d > self.dist(v)) continue;
+        ++m_settled;
+        const quint32 otherDist = other.dist(v);
+        if (otherDist != kInfinity && d + otherDist < best) {
+            best = d + otherDist;
+            meeting = v;
+        }
+
+        // Stall on demand: v is reached more cheaply through a higher node
+        const RoadGraph::Edge *stallBegin = forward ? m_graph->downBegin(v) : m_graph->upBegin(v);
+        const RoadGraph::Edge *stallEnd = forward ? m_graph->downEnd(v) : m_graph->upEnd(v);
+        const bool stalled = std::any_of(stallBegin, stallEnd, [&self, d](const RoadGraph::Edge &e) {
+            const quint32 dist = self.dist(e.target);
+            return dist != kInfinity && dist + e.weight < d;
+        });
+        if (stalled) continue;
+
+        const RoadGraph::Edge *begin = forward ? m_graph->upBegin(v) : m_graph->downBegin(v);
+        const RoadGraph::Edge *end = forward ? m_graph->upEnd(v) : m_graph->downEnd(v);
+        for (const RoadGraph::Edge *e = begin; e != end; ++e) {
+            const quint32 nd = d + e->weight;
+            const auto [it, added] = self.labels.try_emplace(e->target, Label{kInfinity, 0, 0});
+            if (nd >= it->second.dist) continue;
+            if (added) self.touched.push_back(e->target);
+            it->second = {nd, v, e->data};
+            queue.push({nd, e->target});
+        }
+    }
+    if (best == kInfinity) return false;
+
+    // Hierarchy edges start -> meeting -> destination, then their original segments
+    std::vector<std::tuple<quint32, quint32, quint32>> edges;
+    for (quint32 v = meeting; v != from;) {
+        const Label &label = m_forward.labels.at(v);
+        edges.emplace_back(label.parent, v, label.parentData);
+        v = label.parent;
+    }
+    std::reverse(edges.begin(), edges.end());
+    for (quint32 v = meeting; v != to;) {
+        const Label &label = m_backward.labels.at(v);
+        edges.emplace_back(v, label.parent, label.parentData);
+        v = label.parent;
+    }
+    for (const auto &[a, b, data] : edges) unpack(a, b, data, segments);
+    if (weight) *weight = best;
+    return true;
+}
+
+void RoadRouter::unpack(quint32 from, quint32 to, quint32 data, std::vector<quint32> &segments) const {
+    std::vector<std::tuple<quint32, quint32, quint32>> stack{{from, to, data}};
+    while (!stack.empty()) {
+        const auto [a, b, d] = stack.back();
+        stack.pop_back();
+        if (!(d & RoadGraph::ShortcutFlag)) {
+            segments.push_back(d);
+            continue;
+        }
+        // The middle node ranks below both ends: a -> m is one of its down
+        // edges, m -> b one of its up edges
+        const quint32 m = d & ~RoadGraph::ShortcutFlag;
+        const RoadGraph::Edge *first = std::find_if(m_graph->downBegin(m), m_graph->downEnd(m),
+                                                    [a = a](const RoadGraph::Edge &e) { return e.target == a; });
+        const RoadGraph::Edge *second = std::find_if(m_graph->upBegin(m), m_graph->upEnd(m),
+                                                     [b = b](const RoadGraph::Edge &e) { return e.target == b; });
+        stack.emplace_back(m, b, second->data);
+        stack.emplace_back(a, m, first->data);
+    }
+}
+
+RouteResult RoadRouter::route(const QGeoCoordinate &from, const QGeoCoordinate &to) {
+    QMutexLocker locker(&m_lock);
+    RouteResult result;
+    const qint64 start = m_graph->nearestNode(from.latitude(), from.longitude(), SnapMeters);
+    const qint64 destination = m_graph->nearestNode(to.latitude(), to.longitude(), SnapMeters);
+    if (start < 0 || destination < 0) {
+        result.errorString = OutsideMapError;
+        return result;
+    }
+    std::vector<quint32> segments;
+    quint32 weight = 0;
+    if (!findPath(quint32(start), quint32(destination), segments, &weight)) {
+        result.errorString = "No route found";
+        return result;
+    }
+
+    quint64 lengthDm = 0;
+    int points = 1;
+    for (quint32 index : segments) points += int(m_graph->segment(index).shapeCount) + 1;
+    RoutePath &path = result.currentRoutePath;
+    path.reserve(points);
+    result.speedLimits.reserve(points - 1);
+    appendPoint(path, m_graph->node(quint32(start)));
+    for (quint32 index : segments) {
+        const RoadGraph::Segment &s = m_graph->segment(index);
+        for (quint32 i = 0; i < s.shapeCount; ++i) appendPoint(path, shapePoint(*m_graph, s, i));
+        appendPoint(path, m_graph->node(s.to));
+        result.speedLimits.insert(result.speedLimits.size(), qsizetype(s.shapeCount) + 1, s.speedKmh);
+        lengthDm += s.lengthDm;
+    }
+    buildSteps(quint32(start), segments, result);
+
+    result.distanceMeters = int(lengthDm / 10);
+    result.routeData["duration"] = weight / 10.0;
+    result.routeData["distance"] = lengthDm / 10.0;
+    result.success = true;
+    return result;
+}
+
+void RoadRouter::buildSteps(quint32 origin, const std::vector<quint32> &segments, RouteResult &result) const {
+    auto roadName = [this](const RoadGraph::Segment &s) { return m_graph->name(s.name); };
+    RouteStep step;
+    step.maneuverCoordinate = toCoordinate(m_graph->node(origin));
+    step.distance = 0;
+    step.roadName = segments.empty() ? QString() : roadName(m_graph->segment(segments.front()));
+    step.instruction = segments.empty() ? QString("Head to destination") : "Head to " + step.roadName;
+    double meters = 0.0;
+    for (size_t i = 0; i < segments.size(); ++i) {
+        const RoadGraph::Segment &s = m_graph->segment(segments[i]);
+        if (i > 0) {
+            const RoadGraph::Segment &previous = m_graph->segment(segments[i - 1]);
+            double turn = departBearing(*m_graph, s) - arriveBearing(*m_graph, previous);
+            turn = std::remainder(turn, 360.0);
+            const bool renamed = s.name != previous.name;
+            if (renamed || std::abs(turn) >= TurnDegrees) {
+                step.distance = int(std::lround(meters));
+                result.routeSteps.append(step);
+                meters = 0.0;
+
+                const bool turning = std::abs(turn) >= TurnDegrees;
+                step.roadName = roadName(s);
+                step.modifier = turnModifier(turn);
+                step.maneuverCoordinate = toCoordinate(m_graph->node(s.from));
+                step.instruction = (turning ? "turn " : "continue ") + step.modifier;
+                if (!step.roadName.isEmpty()) step.instruction += " on " + step.roadName;
+                step.instruction = step.instruction.left(1).toUpper() + step.instruction.mid(1);
+            }
+        }
+        meters += s.lengthDm / 10.0;
+    }
+    step.distance = int(std::lround(meters));
+    result.routeSteps.append(step);
+
+    RouteStep arrive;
+    arrive.instruction = "Arrive at destination";
+    arrive.distance = 0;
+    arrive.maneuverCoordinate = result.currentRoutePath.last();
+    result.routeSteps.append(arrive);
+}
@@ -0,0 +1,66 @@
+#ifndef ROADROUTER_H
+#define ROADROUTER_H
+
+#include "RoadGraph.h"
+#include "RouteResult.h"
+#include <QMutex>
+#include <unordered_map>
+#include <vector>
+
+/**
+ * @brief Fastest-route queries on a RoadGraph, without a network.
+ *
+ * Bidirectional Dijkstra on the contraction hierarchy: the forward search
+ * from the start only climbs up edges, the backward search from the
+ * destination only down edges, and the route runs through the best node
+ * where they meet. Both searches stall nodes that are reached more cheaply
+ * from above. Shortcuts are then unpacked into the original segments,
+ * whose shapes give the geometry. Steps are derived at the junctions where
+ * the road name changes or the route turns, phrased like the online
+ * router's, so the rest of the guidance is the same for both.
+ *
+ * The search state is only kept for the nodes a query reaches, in hash
+ * maps cleared by their touched lists, so a query costs only the nodes it
+ * settles whatever the size of the graph. Queries are serialized; route()
+ * may be called from any thread.
+ */
+class RoadRouter
+{
+public:
+    static constexpr double SnapMeters = 2000.0; // start or destination off the map beyond this
+    static constexpr int TurnDegrees = 40;       // smaller bends at a junction are not a step
+    static constexpr const char *OutsideMapError = "Outside the offline map";
+
+    explicit RoadRouter(const RoadGraph *graph);
+
+    RouteResult route(const QGeoCoordinate &from, const QGeoCoordinate &to);
+
+    // Segments of the fastest path between two nodes; false if unreachable
+    bool findPath(quint32 from, quint32 to, std::vector<quint32> &segments, quint32 *weight = nullptr);
+    quint32 lastSettled() const { return m_settled; }
+
+private:
+    struct Label {
+        quint32 dist;
+        quint32 parent;     // previous node towards the search origin
+        quint32 parentData; // edge data from there
+    };
+    struct Search {
+        std::unordered_map<quint32, Label> labels;
+        std::vector<quint32> touched;
+
+        quint32 dist(quint32 node) const;
+    };
+
+    void reset(Search &search);
+    void unpack(quint32 from, quint32 to, quint32 data, std::vector<quint32> &segments) const;
+    void buildSteps(quint32 origin, const std::vector<quint32> &segments, RouteResult &result) const;
+
+    const RoadGraph *m_graph;
+    QMutex m_lock;
+    Search m_forward;
+    Search m_backward;
+    quint32 m_settled = 0;
+};
+
+#endif // ROADROUTER_H
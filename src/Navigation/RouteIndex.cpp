@@ -0,0 +1,143 @@
+#include "RouteIndex.h"
+#include "GeoMath.h"
+#include <algorithm>
+#include <cmath>
+
+using GeoMath::DegToRad;
+using GeoMath::MetersPerDegree;
+using GeoMath::meters;
+using GeoMath::metersPerLonDegree;
+
+RouteIndex::RouteIndex(const RoutePath &path) : m_path(path) {
+    const int n = path.size();
+    m_offsets.reserve(n);
+    double along = 0.0;
+    double north = -90.0, east = -180.0;
+    m_south = 90.0;
+    m_west = 180.0;
+    for (int i = 0; i < n; ++i) {
+        if (i > 0) along += meters(path.latitude(i - 1), path.longitude(i - 1), path.latitude(i), path.longitude(i));
+        m_offsets.append(along);
+        m_south = std::min(m_south, path.latitude(i));
+        north = std::max(north, path.latitude(i));
+        m_west = std::min(m_west, path.longitude(i));
+        east = std::max(east, path.longitude(i));
+    }
+    if (n < 2) return;
+
+    // Cells at least CellMeters wide all over the route
+    m_cellLat = CellMeters / MetersPerDegree;
+    m_cellLon = CellMeters / metersPerLonDegree(std::max(std::abs(m_south), std::abs(north)));
+    // Each segment is listed in the cells it passes through, walked from
+    // one boundary it crosses to the next, so a long one costs its length
+    // in cells rather than its bounding box
+    for (int s = 0; s + 1 < n; ++s) {
+        const double x0 = (path.longitude(s) - m_west) / m_cellLon, x1 = (path.longitude(s + 1) - m_west) / m_cellLon;
+        const double y0 = (path.latitude(s) - m_south) / m_cellLat, y1 = (path.latitude(s + 1) - m_south) / m_cellLat;
+        int col = int(x0), row = int(y0);
+        const int lastCol = int(x1), lastRow = int(y1);
+        const int colStep = lastCol > col ? 1 : -1, rowStep = lastRow > row ? 1 : -1;
+        // Fraction of the segment at which it crosses into the next column and row
+        const double dx = std::abs(x1 - x0), dy = std::abs(y1 - y0);
+        double colAt = dx > 0.0 ? (colStep > 0 ? col + 1 - x0 : x0 - col) / dx : 2.0;
+        double rowAt = dy > 0.0 ? (rowStep > 0 ? row + 1 - y0 : y0 - row) / dy : 2.0;
+        m_cells.push_back({cellKey(row, col), s});
+        for (int steps = std::abs(lastCol - col) + std::abs(lastRow - row); steps > 0; --steps) {
+            if (row == lastRow || (col != lastCol && colAt < rowAt)) {
+                col += colStep;
+                colAt += 1.0 / dx;
+            } else {
+                row += rowStep;
+                rowAt += 1.0 / dy;
+            }
+            m_cells.push_back({cellKey(row, col), s});
+        }
+    }
+    std::sort(m_cells.begin(), m_cells.end(), [](const Entry &a, const Entry &b) {
+        return a.cell != b.cell ? a.cell < b.cell : a.segment < b.segment;
+    });
+}
+
+quint64 RouteIndex::cellKey(int row, int column) {
+    return (quint64(quint32(row)) << 32) | quint32(column);
+}
+
+int RouteIndex::segmentAt(double meters) const {
+    if (isEmpty()) return -1;
+    const int after = int(std::upper_bound(m_offsets.cbegin(), m_offsets.cend(), meters) - m_offsets.cbegin());
+    return std::clamp(after - 1, 0, int(m_offsets.size()) - 2);
+}
+
+QGeoCoordinate RouteIndex::coordinateAt(double meters) const {
+    if (isEmpty()) return m_path.isEmpty() ? QGeoCoordinate() : m_path.first();
+    const int s = segmentAt(meters);
+    const double length = m_offsets[s + 1] - m_offsets[s];
+    const double t = length > 0.0 ? std::clamp((meters - m_offsets[s]) / length, 0.0, 1.0) : 0.0;
+    return QGeoCoordinate(m_path.latitude(s) + t * (m_path.latitude(s + 1) - m_path.latitude(s)),
+                          m_path.longitude(s) + t * (m_path.longitude(s + 1) - m_path.longitude(s)));
+}
+
+double RouteIndex::bearingAt(double meters) const {
+    if (isEmpty()) return 0.0;
+    const int s = segmentAt(meters);
+    const double dx = (m_path.longitude(s + 1) - m_path.longitude(s)) * metersPerLonDegree(m_path.latitude(s));
+    const double dy = (m_path.latitude(s + 1) - m_path.latitude(s)) * MetersPerDegree;
+    return std::fmod(std::atan2(dx, dy) / DegToRad + 360.0, 360.0);
+}
+
+RouteIndex::Projection RouteIndex::project(int segment, double latitude, double longitude) const {
+    // Metres east and north of the position; flat at this scale
+    const double kx = metersPerLonDegree(latitude);
+    const double ax = (m_path.longitude(segment) - longitude) * kx;
+    const double ay = (m_path.latitude(segment) - latitude) * MetersPerDegree;
+    const double dx = (m_path.longitude(segment + 1) - longitude) * kx - ax;
+    const double dy = (m_path.latitude(segment + 1) - latitude) * MetersPerDegree - ay;
+    const double length2 = dx * dx + dy * dy;
+    const double t = length2 > 0.0 ? std::clamp(-(ax * dx + ay * dy) / length2, 0.0, 1.0) : 0.0;
+    const double px = ax + t * dx, py = ay + t * dy;
+    Projection p;
+    p.segment = segment;
+    p.offset = m_offsets[segment] + t * (m_offsets[segment + 1] - m_offsets[segment]);
+    p.distance = std::sqrt(px * px + py * py);
+    p.latitude = latitude + py / MetersPerDegree;
+    p.longitude = longitude + px / kx;
+    p.bearing = std::fmod(std::atan2(dx, dy) / DegToRad + 360.0, 360.0);
+    return p;
+}
+
+std::vector<RouteIndex::Projection> RouteIndex::near(double latitude, double longitude, double radius) const {
+    std::vector<Projection> out;
+    if (isEmpty()) return out;
+    const double dLat = radius / MetersPerDegree, dLon = radius / metersPerLonDegree(latitude);
+    const int row0 = int(std::floor((latitude - dLat - m_south) / m_cellLat));
+    const int row1 = int(std::floor((latitude + dLat - m_south) / m_cellLat));
+    const int col0 = int(std::floor((longitude - dLon - m_west) / m_cellLon));
+    const int col1 = int(std::floor((longitude + dLon - m_west) / m_cellLon));
+
+    // A segment is listed in every cell it crosses
+    std::vector<int> segments;
+    for (int row = std::max(row0, 0); row <= row1; ++row) {
+        for (int col = std::max(col0, 0); col <= col1; ++col) {
+            const quint64 key = cellKey(row, col);
+            auto it = std::lower_bound(m_cells.begin(), m_cells.end(), key,
+                                       [](const Entry &e, quint64 k) { return e.cell < k; });
+            for (; it != m_cells.end() && it->cell == key; ++it) segments.push_back(it->segment);
+        }
+    }
+    std::sort(segments.begin(), segments.end());
+    segments.erase(std::unique(segments.begin(), segments.end()), segments.end());
+
+    for (int s : segments) {
+        const Projection p = project(s, latitude, longitude);
+        if (p.distance <= radius) out.push_back(p);
+    }
+    return out;
+}
+
+RouteIndex::Projection RouteIndex::nearest(double latitude, double longitude, double radius, double fromMeters) const {
+    Projection best;
+    for (const Projection &p : near(latitude, longitude, radius)) {
+        if (p.offset >= fromMeters && (best.segment < 0 || p.distance < best.distance)) best = p;
+    }
+    return best;
+}
@@ -0,0 +1,73 @@
+#ifndef ROUTEINDEX_H
+#define ROUTEINDEX_H
+
+#include "RoutePath.h"
+#include <QGeoCoordinate>
+#include <QList>
+#include <vector>
+
+/**
+ * @brief Where on a route a position is, and where a distance along it is.
+ *
+ * Two structures built once when the route arrives and shared by
+ * everything that follows it. The distance along the route at every point
+ * (a prefix sum of its segments) turns a segment and a fraction into
+ * metres and, by binary search, metres back into a segment. A uniform
+ * grid of CellMeters cells lists the segments crossing each cell, sorted
+ * by cell, so the segments near a position are found by a binary search
+ * per cell around it rather than a walk over the whole route.
+ */
+class RouteIndex
+{
+public:
+    static constexpr double CellMeters = 100.0;
+
+    // A position's foot on one segment of the route
+    struct Projection {
+        int segment = -1;       // between points segment and segment + 1; -1 if none
+        double offset = 0.0;    // metres along the route
+        double distance = 0.0;  // metres from the position
+        double latitude = 0.0;
+        double longitude = 0.0;
+        double bearing = 0.0;   // of the segment, degrees
+    };
+
+    RouteIndex() = default;
+    explicit RouteIndex(const RoutePath &path);
+
+    bool isEmpty() const { return m_offsets.size() < 2; }
+    const RoutePath &path() const { return m_path; }
+    double length() const { return m_offsets.isEmpty() ? 0.0 : m_offsets.last(); }
+    // Metres along the route at every point, shared between copies
+    const QList<double> &offsets() const { return m_offsets; }
+    double offset(int index) const { return m_offsets[index]; }
+
+    // The segment holding `meters`, and the position there
+    int segmentAt(double meters) const;
+    QGeoCoordinate coordinateAt(double meters) const;
+    double bearingAt(double meters) const; // of that segment, degrees
+
+    // Every segment within `radius` metres of the position, projected
+    std::vector<Projection> near(double latitude, double longitude, double radius) const;
+    // The nearest of them at or beyond `fromMeters` along the route
+    Projection nearest(double latitude, double longitude, double radius, double fromMeters = 0.0) const;
+
+private:
+    struct Entry {
+        quint64 cell;
+        int segment;
+    };
+
+    static quint64 cellKey(int row, int column);
+    Projection project(int segment, double latitude, double longitude) const;
+
+    RoutePath m_path;
+    QList<double> m_offsets;
+    std::vector<Entry> m_cells; // sorted by cell, then segment
+    double m_south = 0.0;       // grid origin
+    double m_west = 0.0;
+    double m_cellLat = 0.0;     // cell size in degrees
+    double m_cellLon = 0.0;
+};
+
+#endif // ROUTEINDEX_H
@@ -0,0 +1,141 @@
+#include "RouteLod.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace {
+constexpr double kPi = 3.14159265358979323846;
+constexpr double kTileSize = 256.0;     // map units are pixels at zoom 0
+constexpr double kMaxMercatorLat = 85.0511;
+
+struct MapPoint {
+    double x, y;
+};
+
+MapPoint project(double lat, double lon) {
+    const double s = std::sin(std::clamp(lat, -kMaxMercatorLat, kMaxMercatorLat) * kPi / 180.0);
+    return {(lon + 180.0) / 360.0 * kTileSize, (0.5 - std::log((1.0 + s) / (1.0 - s)) / (4.0 * kPi)) * kTileSize};
+}
+
+double distanceToSegment(const MapPoint &p, const MapPoint &a, const MapPoint &b) {
+    const double dx = b.x - a.x, dy = b.y - a.y;
+    const double length2 = dx * dx + dy * dy;
+    double t = length2 > 0.0 ? ((p.x - a.x) * dx + (p.y - a.y) * dy) / length2 : 0.0;
+    t = std::clamp(t, 0.0, 1.0);
+    const double ex = a.x + t * dx - p.x, ey = a.y + t * dy - p.y;
+    return std::sqrt(ex * ex + ey * ey);
+}
+}
+
+RouteLod::RouteLod(const RoutePath &path) : m_path(path) {
+    const int n = path.size();
+    if (n < 2) return;
+    std::vector<MapPoint> points(static_cast<size_t>(n));
+    for (int i = 0; i < n; ++i) points[size_t(i)] = project(path.latitude(i), path.longitude(i));
+
+    // Largest tolerance each point survives: its distance from the chord it
+    // was split off, but no more than that of any split above it
+    constexpr double kAlways = std::numeric_limits<double>::infinity();
+    std::vector<double> kept(static_cast<size_t>(n), 0.0);
+    kept.front() = kept.back() = kAlways;
+    struct Span {
+        int from, to;
+        double cap;
+    };
+    std::vector<Span> spans{{0, n - 1, kAlways}};
+    while (!spans.empty()) {
+        const Span span = spans.back();
+        spans.pop_back();
+        if (span.to - span.from < 2) continue;
+        double farthest = -1.0;
+        int at = span.from + 1;
+        for (int i = span.from + 1; i < span.to; ++i) {
+            const double d = distanceToSegment(points[size_t(i)], points[size_t(span.from)], points[size_t(span.to)]);
+            if (d > farthest) {
+                farthest = d;
+                at = i;
+            }
+        }
+        kept[size_t(at)] = std::min(farthest, span.cap);
+        spans.push_back({span.from, at, kept[size_t(at)]});
+        spans.push_back({at, span.to, kept[size_t(at)]});
+    }
+
+    m_levels.resize(MaxZoom - MinZoom + 1);
+    for (int zoom = MinZoom; zoom <= MaxZoom; ++zoom) {
+        const double tolerance = TolerancePixels / std::ldexp(1.0, zoom);
+        std::vector<int> &level = m_levels[size_t(zoom - MinZoom)];
+        for (int i = 0; i < n; ++i)
+            if (kept[size_t(i)] > tolerance) level.push_back(i);
+        level.shrink_to_fit();
+    }
+}
+
+int RouteLod::level(double zoomLevel) {
+    return std::clamp(int(std::ceil(zoomLevel)), MinZoom, MaxZoom);
+}
+
+int RouteLod::pointCount(int level) const {
+    return m_levels.empty() ? 0 : int(m_levels[size_t(std::clamp(level, MinZoom, MaxZoom) - MinZoom)].size());
+}
+
+std::vector<std::vector<int>> RouteLod::stretches(int level, const QGeoRectangle &area, int first, int last) const {
+    std::vector<std::vector<int>> out;
+    if (isEmpty()) return out;
+    const int n = m_path.size();
+    if (last < 0 || last >= n) last = n - 1;
+    first = std::clamp(first, 0, last);
+    if (first == last) return out;
+
+    // The level's points in the range, with the range's own ends
+    const std::vector<int> &kept = m_levels[size_t(std::clamp(level, MinZoom, MaxZoom) - MinZoom)];
+    std::vector<int> indices{first};
+    for (auto it = std::upper_bound(kept.begin(), kept.end(), first); it != kept.end() && *it < last; ++it)
+        indices.push_back(*it);
+    indices.push_back(last);
+    if (!area.isValid()) {
+        out.push_back(std::move(indices));
+        return out;
+    }
+
+    // Segments whose bounds miss the area break the line
+    const double north = area.topLeft().latitude(), south = area.bottomRight().latitude();
+    const double west = area.topLeft().longitude(), east = area.bottomRight().longitude();
+    std::vector<int> current;
+    for (size_t j = 0; j + 1 < indices.size(); ++j) {
+        const int a = indices[j], b = indices[j + 1];
+        const double latA = m_path.latitude(a), latB = m_path.latitude(b);
+        const double lonA = m_path.longitude(a), lonB = m_path.longitude(b);
+        const bool inside = std::max(latA, latB) >= south && std::min(latA, latB) <= north
+                            && std::max(lonA, lonB) >= west && std::min(lonA, lonB) <= east;
+        if (!inside) {
+            if (!current.empty()) out.push_back(std::move(current));
+            current.clear();
+            continue;
+        }
+        if (current.empty()) current.push_back(a);
+        current.push_back(b);
+    }
+    if (!current.empty()) out.push_back(std::move(current));
+    return out;
+}
+
+QVariantList RouteLod::lines(double zoomLevel, const QGeoRectangle &area, int first, int last) const {
+    QVariantList out;
+    int zoom = level(zoomLevel);
+    std::vector<std::vector<int>> pieces = stretches(zoom, area, first, last);
+    for (;;) {
+        size_t points = 0;
+        for (const std::vector<int> &piece : pieces) points += piece.size();
+        if (points <= size_t(MaxLinePoints) || zoom == MinZoom) break;
+        pieces = stretches(--zoom, area, first, last);
+    }
+
+    for (const std::vector<int> &piece : pieces) {
+        QVariantList line;
+        line.reserve(qsizetype(piece.size()));
+        for (int i : piece) line.append(QVariant::fromValue(m_path.at(i)));
+        out.append(QVariant(line));
+    }
+    return out;
+}
@@ -0,0 +1,51 @@
+#ifndef ROUTELOD_H
+#define ROUTELOD_H
+
+#include "RoutePath.h"
+#include <QGeoRectangle>
+#include <QVariantList>
+#include <vector>
+
+/**
+ * @brief Route geometry simplified per map zoom level, for drawing.
+ *
+ * Douglas-Peucker runs once over the whole route in Web Mercator map
+ * units, recording for every point the largest tolerance at which it is
+ * still kept. A zoom level keeps the points that stray more than
+ * TolerancePixels from the simplified line on screen there, so the drawn
+ * shape is the same with a fraction of the vertices. The levels are
+ * precomputed as index lists for every whole zoom level.
+ *
+ * lines() also cuts a level to an area around the view, keeping only the
+ * stretches that pass through it, so the vertices handed to the map are
+ * bounded by what is on screen rather than by the length of the route.
+ * The path is shared with the route, not copied.
+ */
+class RouteLod
+{
+public:
+    static constexpr int MinZoom = 0;
+    static constexpr int MaxZoom = 21;
+    static constexpr double TolerancePixels = 1.0;
+    static constexpr int MaxLinePoints = 4000; // beyond this a coarser level is drawn
+
+    RouteLod() = default;
+    explicit RouteLod(const RoutePath &path);
+
+    bool isEmpty() const { return m_path.size() < 2; }
+    // Zoom level whose points are drawn at `zoomLevel`
+    static int level(double zoomLevel);
+    int pointCount(int level) const;
+
+    // Stretches of points `first` to `last` (the whole route by default)
+    // through `area`, each a list of coordinates for a polyline
+    QVariantList lines(double zoomLevel, const QGeoRectangle &area, int first = 0, int last = -1) const;
+    // The same as point indices, one vector per stretch
+    std::vector<std::vector<int>> stretches(int level, const QGeoRectangle &area, int first, int last) const;
+
+private:
+    RoutePath m_path;
+    std::vector<std::vector<int>> m_levels; // kept points, MinZoom first
+};
+
+#endif // ROUTELOD_H
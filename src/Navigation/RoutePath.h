@@ -0,0 +1,33 @@
+#ifndef ROUTEPATH_H
+#define ROUTEPATH_H
+
+#include <QGeoCoordinate>
+#include <QList>
+
+// Route geometry as packed latitude/longitude pairs in degrees. Unlike a
+// list of QGeoCoordinate there is no allocation per point, and copies
+// share the data until written.
+class RoutePath
+{
+public:
+    int size() const { return int(m_latLon.size() / 2); }
+    bool isEmpty() const { return m_latLon.isEmpty(); }
+    void reserve(int points) { m_latLon.reserve(qsizetype(points) * 2); }
+    void clear() { m_latLon.clear(); }
+    void append(double lat, double lon) {
+        m_latLon.append(lat);
+        m_latLon.append(lon);
+    }
+
+    double latitude(int i) const { return m_latLon[qsizetype(i) * 2]; }
+    double longitude(int i) const { return m_latLon[qsizetype(i) * 2 + 1]; }
+    QGeoCoordinate at(int i) const { return QGeoCoordinate(latitude(i), longitude(i)); }
+    QGeoCoordinate first() const { return at(0); }
+    QGeoCoordinate last() const { return at(size() - 1); }
+    const double *data() const { return m_latLon.constData(); }
+
+private:
+    QList<double> m_latLon;
+};
+
+#endif // ROUTEPATH_H
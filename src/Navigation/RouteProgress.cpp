@@ -0,0 +1,58 @@
+#include "RouteProgress.h"
+#include <cmath>
+
+RouteProgress::RouteProgress(const RouteIndex &route, const QList<quint8> &speedLimits, double seconds)
+    : m_offsets(route.offsets())
+{
+    if (isEmpty()) return;
+    m_seconds.reserve(m_offsets.size());
+    m_seconds.append(0.0);
+    for (int i = 0; i + 1 < m_offsets.size(); ++i) {
+        const double kmh = i < speedLimits.size() && speedLimits[i] ? speedLimits[i] : DefaultKmh;
+        m_seconds.append(m_seconds.last() + (m_offsets[i + 1] - m_offsets[i]) * 3.6 / kmh);
+    }
+    // The limits say where the route is slow; the router, how slow overall
+    if (seconds > 0.0 && m_seconds.last() > 0.0) {
+        const double scale = seconds / m_seconds.last();
+        for (double &at : m_seconds) at *= scale;
+    }
+}
+
+double RouteProgress::secondsAt(int segment, double offset) const {
+    if (isEmpty()) return 0.0;
+    segment = std::clamp(segment, 0, int(m_offsets.size()) - 2);
+    const double from = m_offsets[segment], to = m_offsets[segment + 1];
+    const double t = to > from ? std::clamp((offset - from) / (to - from), 0.0, 1.0) : 0.0;
+    return m_seconds[segment] + t * (m_seconds[segment + 1] - m_seconds[segment]);
+}
+
+void RouteProgress::update(int segment, double offset, qint64 timestampMs) {
+    if (isEmpty()) return;
+    const double at = secondsAt(segment, offset);
+    if (m_timestampMs >= 0 && timestampMs > m_timestampMs) {
+        const double taken = (timestampMs - m_timestampMs) / 1000.0;
+        const double fade = std::exp(-taken / PaceSeconds);
+        m_taken = m_taken * fade + taken;
+        // A match falling back a little is noise, not time given back
+        m_expected = m_expected * fade + std::max(0.0, at - m_at);
+    }
+    m_offset = offset;
+    m_at = at;
+    m_timestampMs = timestampMs;
+}
+
+void RouteProgress::continueFrom(const RouteProgress &previous) {
+    m_taken = previous.m_taken;
+    m_expected = previous.m_expected;
+}
+
+double RouteProgress::pace() const {
+    if (m_taken < MinObservedSeconds) return 1.0;
+    if (m_expected <= 0.0) return MaxPace;
+    return std::clamp(m_taken / m_expected, MinPace, MaxPace);
+}
+
+double RouteProgress::remainingSeconds() const {
+    const double ahead = std::max(0.0, duration() - m_at);
+    return ahead + (pace() - 1.0) * std::min(ahead, HorizonSeconds);
+}
@@ -0,0 +1,65 @@
+#ifndef ROUTEPROGRESS_H
+#define ROUTEPROGRESS_H
+
+#include "RouteIndex.h"
+#include <QList>
+#include <algorithm>
+
+/**
+ * @brief How far and how long it is to the end of the route.
+ *
+ * Built once per route, next to RouteIndex's distances: the time expected
+ * to reach every point of the route, from the speed limits of its segments
+ * scaled to the router's duration. A matched position then gives the
+ * distance and time left by a lookup and an interpolation on its segment,
+ * whatever the length of the route.
+ *
+ * The expected time is what the router thought; the drive so far tells
+ * how it goes. The time the car took against the time expected for the
+ * same stretch, both forgotten over PaceSeconds, is its pace, and the next
+ * HorizonSeconds of the time left are scaled by it. A jam or a clear road
+ * shows in the arrival time within a minute or so, but is not taken to
+ * last the whole way, and a fix or two of noise moves it by little.
+ */
+class RouteProgress
+{
+public:
+    static constexpr double DefaultKmh = 50.0;        // where the limit is unknown
+    static constexpr double PaceSeconds = 120.0;
+    static constexpr double HorizonSeconds = 300.0;
+    static constexpr double MinObservedSeconds = 10.0; // before the pace is taken
+    static constexpr double MinPace = 0.5;
+    static constexpr double MaxPace = 3.0;
+
+    RouteProgress() = default;
+    // `seconds` is the router's duration; 0 keeps the limits' own
+    RouteProgress(const RouteIndex &route, const QList<quint8> &speedLimits, double seconds);
+
+    bool isEmpty() const { return m_offsets.size() < 2; }
+
+    // The matched position at `timestampMs`
+    void update(int segment, double offset, qint64 timestampMs);
+    // The pace so far carries over to a route that replaces this one
+    void continueFrom(const RouteProgress &previous);
+
+    double length() const { return m_offsets.isEmpty() ? 0.0 : m_offsets.last(); }
+    double duration() const { return m_seconds.isEmpty() ? 0.0 : m_seconds.last(); }
+    // Expected seconds from the start to `offset` on `segment`
+    double secondsAt(int segment, double offset) const;
+
+    double remainingMeters() const { return std::max(0.0, length() - m_offset); }
+    double remainingSeconds() const; // at the pace so far
+    double pace() const;             // time taken over time expected
+
+private:
+    QList<double> m_offsets; // shared with the RouteIndex
+    QList<double> m_seconds; // expected at each point
+
+    double m_offset = 0.0;
+    double m_at = 0.0;       // expected seconds at m_offset
+    qint64 m_timestampMs = -1;
+    double m_taken = 0.0;    // seconds, fading over PaceSeconds
+    double m_expected = 0.0;
+};
+
+#endif // ROUTEPROGRESS_H
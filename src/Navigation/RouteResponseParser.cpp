@@ -0,0 +1,358 @@
+#include "RouteResponseParser.h"
+#include <algorithm>
+#include <cmath>
+
+namespace {
+// A mantissa below 2^53 scaled by one of these is rounded once, so exact
+const double kPow10[] = {1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,  1e8,  1e9,  1e10, 1e11,
+                         1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22};
+constexpr int kMaxScale = 22;
+constexpr quint64 kMaxExactMantissa = quint64(1) << 53;
+constexpr double kKmPerMile = 1.609344;
+
+bool isDigit(char c) { return c >= '0' && c <= '9'; }
+
+void appendUtf8(std::string &out, unsigned code) {
+    if (code < 0x80) {
+        out += char(code);
+    } else if (code < 0x800) {
+        out += char(0xC0 | (code >> 6));
+        out += char(0x80 | (code & 0x3F));
+    } else if (code < 0x10000) {
+        out += char(0xE0 | (code >> 12));
+        out += char(0x80 | ((code >> 6) & 0x3F));
+        out += char(0x80 | (code & 0x3F));
+    } else {
+        out += char(0xF0 | (code >> 18));
+        out += char(0x80 | ((code >> 12) & 0x3F));
+        out += char(0x80 | ((code >> 6) & 0x3F));
+        out += char(0x80 | (code & 0x3F));
+    }
+}
+
+bool readHex4(const char *&p, const char *end, unsigned *out) {
+    if (end - p < 4) return false;
+    unsigned value = 0;
+    for (int i = 0; i < 4; ++i) {
+        const char c = *p++;
+        value <<= 4;
+        if (c >= '0' && c <= '9') value |= unsigned(c - '0');
+        else if (c >= 'a' && c <= 'f') value |= unsigned(c - 'a' + 10);
+        else if (c >= 'A' && c <= 'F') value |= unsigned(c - 'A' + 10);
+        else return false;
+    }
+    *out = value;
+    return true;
+}
+
+QString toQString(std::string_view s) {
+    return QString::fromUtf8(s.data(), qsizetype(s.size()));
+}
+}
+
+template <typename Member>
+bool RouteResponseParser::readObject(Member &&member) {
+    if (!consume('{')) return false;
+    if (consume('}')) return true;
+    do {
+        // The key is only looked at before its value is read
+        std::string_view key;
+        if (!readString(&key) || !consume(':') || !member(key)) return false;
+    } while (consume(','));
+    return consume('}');
+}
+
+template <typename Element>
+bool RouteResponseParser::readArray(Element &&element) {
+    if (!consume('[')) return false;
+    if (consume(']')) return true;
+    int index = 0;
+    do {
+        if (!element(index++)) return false;
+    } while (consume(','));
+    return consume(']');
+}
+
+RouteResult RouteResponseParser::parse(const QByteArray &json) {
+    RouteResponseParser parser(json.constData(), json.constData() + json.size());
+    RouteResult result;
+    if (!parser.readRoot(result)) {
+        result = RouteResult();
+        result.errorString = InvalidResponseError;
+    }
+    return result;
+}
+
+bool RouteResponseParser::readRoot(RouteResult &result) {
+    return readObject([this, &result](std::string_view key) {
+        if (key != "routes") return skipValue();
+        return readArray([this, &result](int index) {
+            if (index > 0) return skipValue();
+            result.success = readRoute(result);
+            return result.success;
+        });
+    });
+}
+
+bool RouteResponseParser::readRoute(RouteResult &result) {
+    double distance = 0.0, duration = 0.0;
+    const bool ok = readObject([&](std::string_view key) {
+        if (key == "geometry") return readGeometry(result.currentRoutePath);
+        if (key == "distance") return readNumber(&distance);
+        if (key == "duration") return readNumber(&duration);
+        if (key != "legs") return skipValue();
+        return readArray([this, &result](int) {
+            return readObject([this, &result](std::string_view legKey) {
+                if (legKey == "annotation") return readAnnotation(result);
+                if (legKey != "steps") return skipValue();
+                return readArray([this, &result](int) {
+                    RouteStep step;
+                    if (!readStep(step)) return false;
+                    result.routeSteps.append(step);
+                    return true;
+                });
+            });
+        });
+    });
+    if (!ok) return false;
+    result.routeData["duration"] = duration;
+    result.routeData["distance"] = distance;
+    result.distanceMeters = int(std::lround(distance));
+    return true;
+}
+
+bool RouteResponseParser::readGeometry(RoutePath &path) {
+    return readObject([this, &path](std::string_view key) {
+        if (key != "coordinates") return skipValue();
+        return readArray([this, &path](int) {
+            double lon, lat;
+            if (!readPoint(&lon, &lat)) return false;
+            path.append(lat, lon);
+            return true;
+        });
+    });
+}
+
+bool RouteResponseParser::readAnnotation(RouteResult &result) {
+    return readObject([this, &result](std::string_view key) {
+        if (key != "maxspeed") return skipValue();
+        // {"speed":50,"unit":"km/h"}, or {"unknown":true} / {"none":true}
+        return readArray([this, &result](int) {
+            double speed = 0.0;
+            bool mph = false;
+            std::string_view text;
+            const bool ok = readObject([&](std::string_view speedKey) {
+                if (speedKey == "speed") return readNumber(&speed);
+                if (speedKey != "unit") return skipValue();
+                if (!readString(&text)) return false;
+                mph = text == "mph";
+                return true;
+            });
+            if (mph) speed *= kKmPerMile;
+            result.speedLimits.append(quint8(std::clamp(std::lround(speed), 0L, 255L)));
+            return ok;
+        });
+    });
+}
+
+bool RouteResponseParser::readStep(RouteStep &step) {
+    double distance = 0.0;
+    QString name, type, modifier;
+    double lon = 0.0, lat = 0.0;
+    std::string_view text;
+    const bool ok = readObject([&](std::string_view key) {
+        if (key == "distance") return readNumber(&distance);
+        if (key == "name") {
+            if (!readString(&text)) return false;
+            name = toQString(text);
+            return true;
+        }
+        if (key != "maneuver") return skipValue();
+        return readObject([&](std::string_view maneuverKey) {
+            if (maneuverKey == "location") return readPoint(&lon, &lat);
+            if (maneuverKey != "type" && maneuverKey != "modifier") return skipValue();
+            QString &target = maneuverKey == "type" ? type : modifier;
+            if (!readString(&text)) return false;
+            target = toQString(text);
+            return true;
+        });
+    });
+    if (!ok) return false;
+
+    step.distance = int(std::lround(distance));
+    step.maneuverCoordinate = QGeoCoordinate(lat, lon);
+    step.modifier = modifier;
+    step.roadName = name;
+    if (type == "depart") step.instruction = "Head to " + name;
+    else if (type == "arrive") step.instruction = "Arrive at destination";
+    else if (name.isEmpty()) step.instruction = type + " " + modifier;
+    else step.instruction = type + " " + modifier + " on " + name;
+    step.instruction = step.instruction.left(1).toUpper() + step.instruction.mid(1);
+    return true;
+}
+
+void RouteResponseParser::skipSpace() {
+    while (m_p < m_end && (*m_p == ' ' || *m_p == '\n' || *m_p == '\r' || *m_p == '\t')) ++m_p;
+}
+
+bool RouteResponseParser::consume(char c) {
+    skipSpace();
+    if (m_p == m_end || *m_p != c) return false;
+    ++m_p;
+    return true;
+}
+
+bool RouteResponseParser::readString(std::string_view *out) {
+    if (!consume('"')) return false;
+    const char *start = m_p;
+    while (m_p < m_end && *m_p != '"' && *m_p != '\\') ++m_p;
+    if (m_p == m_end) return false;
+    if (*m_p == '"') {
+        *out = std::string_view(start, size_t(m_p++ - start));
+        return true;
+    }
+
+    m_scratch.assign(start, m_p);
+    while (m_p < m_end) {
+        const char c = *m_p++;
+        if (c == '"') {
+            *out = m_scratch;
+            return true;
+        }
+        if (c != '\\') {
+            m_scratch += c;
+            continue;
+        }
+        if (m_p == m_end) return false;
+        switch (*m_p++) {
+        case '"': m_scratch += '"'; break;
+        case '\\': m_scratch += '\\'; break;
+        case '/': m_scratch += '/'; break;
+        case 'b': m_scratch += '\b'; break;
+        case 'f': m_scratch += '\f'; break;
+        case 'n': m_scratch += '\n'; break;
+        case 'r': m_scratch += '\r'; break;
+        case 't': m_scratch += '\t'; break;
+        case 'u': {
+            unsigned code;
+            if (!readHex4(m_p, m_end, &code)) return false;
+            // A character beyond the BMP comes as a surrogate pair
+            if (code >= 0xD800 && code < 0xDC00 && m_end - m_p >= 6 && m_p[0] == '\\' && m_p[1] == 'u') {
+                m_p += 2;
+                unsigned low;
+                if (!readHex4(m_p, m_end, &low)) return false;
+                code = low >= 0xDC00 && low < 0xE000 ? 0x10000 + ((code - 0xD800) << 10) + (low - 0xDC00) : 0xFFFD;
+            } else if (code >= 0xD800 && code < 0xE000) {
+                code = 0xFFFD;
+            }
+            appendUtf8(m_scratch, code);
+            break;
+        }
+        default:
+            return false;
+        }
+    }
+    return false;
+}
+
+bool RouteResponseParser::readNumber(double *out) {
+    skipSpace();
+    const char *start = m_p;
+    const bool negative = m_p < m_end && *m_p == '-';
+    if (negative) ++m_p;
+    quint64 mantissa = 0;
+    int scale = 0;
+    bool exact = true;
+    const char *digits = m_p;
+    for (; m_p < m_end && isDigit(*m_p); ++m_p) {
+        if (mantissa < kMaxExactMantissa) {
+            mantissa = mantissa * 10 + quint64(*m_p - '0');
+        } else {
+            exact = false;
+            ++scale;
+        }
+    }
+    if (m_p == digits) return false;
+    if (m_p < m_end && *m_p == '.') {
+        ++m_p;
+        for (; m_p < m_end && isDigit(*m_p); ++m_p) {
+            if (mantissa >= kMaxExactMantissa) {
+                exact = false;
+                continue;
+            }
+            mantissa = mantissa * 10 + quint64(*m_p - '0');
+            --scale;
+        }
+    }
+    if (m_p < m_end && (*m_p == 'e' || *m_p == 'E')) {
+        exact = false;
+        ++m_p;
+        if (m_p < m_end && (*m_p == '+' || *m_p == '-')) ++m_p;
+        while (m_p < m_end && isDigit(*m_p)) ++m_p;
+    }
+
+    if (exact && mantissa < kMaxExactMantissa && scale >= -kMaxScale && scale <= kMaxScale) {
+        const double value = scale < 0 ? double(mantissa) / kPow10[-scale] : double(mantissa) * kPow10[scale];
+        *out = negative ? -value : value;
+        return true;
+    }
+    // Correctly rounded, whatever the C locale
+    bool ok = false;
+    *out = QByteArray::fromRawData(start, qsizetype(m_p - start)).toDouble(&ok);
+    return ok;
+}
+
+bool RouteResponseParser::readPoint(double *lon, double *lat) {
+    return readArray([this, lon, lat](int index) {
+        if (index == 0) return readNumber(lon);
+        if (index == 1) return readNumber(lat);
+        return skipValue(); // elevation
+    });
+}
+
+bool RouteResponseParser::skipString() {
+    if (!consume('"')) return false;
+    while (m_p < m_end) {
+        const char c = *m_p++;
+        if (c == '"') return true;
+        if (c == '\\' && m_p < m_end) ++m_p;
+    }
+    return false;
+}
+
+bool RouteResponseParser::skipValue() {
+    skipSpace();
+    if (m_p == m_end) return false;
+    if (*m_p == '"') return skipString();
+    if (*m_p != '{' && *m_p != '[') {
+        // Number, true, false or null
+        const char *start = m_p;
+        while (m_p < m_end && *m_p != ',' && *m_p != '}' && *m_p != ']' && *m_p != ' ' && *m_p != '\n'
+               && *m_p != '\r' && *m_p != '\t')
+            ++m_p;
+        return m_p != start;
+    }
+    int depth = 0;
+    while (m_p < m_end) {
+        switch (*m_p) {
+        case '"':
+            if (!skipString()) return false;
+            continue;
+        case '{':
+        case '[':
+            ++depth;
+            break;
+        case '}':
+        case ']':
+            if (--depth == 0) {
+                ++m_p;
+                return true;
+            }
+            break;
+        default:
+            break;
+        }
+        ++m_p;
+    }
+    return false;
+}
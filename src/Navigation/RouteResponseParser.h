@@ -0,0 +1,55 @@
+#ifndef ROUTERESPONSEPARSER_H
+#define ROUTERESPONSEPARSER_H
+
+#include "RouteResult.h"
+#include <QByteArray>
+#include <string>
+#include <string_view>
+
+/**
+ * @brief Reads an OSRM route response without building a JSON document.
+ *
+ * One pass over the bytes, acting on members as they are reached: the
+ * coordinates of the route's overview geometry go straight into its
+ * RoutePath, the legs' maxspeed annotations into a speed limit per
+ * segment, and each step is phrased when its object closes. Everything
+ * else (step geometries, intersections, waypoints, further routes) is
+ * skipped by bracket counting without being decoded. Strings are only
+ * copied when they hold escapes, numbers only go through the locale-free
+ * slow path when they have an exponent or more than 15 digits.
+ */
+class RouteResponseParser
+{
+public:
+    static constexpr const char *InvalidResponseError = "Invalid route response";
+
+    // The first route of the response; not successful without one
+    static RouteResult parse(const QByteArray &json);
+
+private:
+    RouteResponseParser(const char *begin, const char *end) : m_p(begin), m_end(end) {}
+
+    bool readRoot(RouteResult &result);
+    bool readRoute(RouteResult &result);
+    bool readGeometry(RoutePath &path);
+    bool readAnnotation(RouteResult &result); // speed limits per segment
+    bool readStep(RouteStep &step);
+
+    // Tokens; each skips the whitespace before it and returns false on
+    // malformed input
+    void skipSpace();
+    bool consume(char c);
+    bool readString(std::string_view *out); // valid until the next string
+    bool readNumber(double *out);
+    bool readPoint(double *lon, double *lat); // [lon, lat, ...]
+    bool skipString();
+    bool skipValue();
+    template <typename Member> bool readObject(Member &&member);    // member(key) reads the value
+    template <typename Element> bool readArray(Element &&element); // element(index) reads it
+
+    const char *m_p;
+    const char *m_end;
+    std::string m_scratch; // strings with escapes, decoded
+};
+
+#endif // ROUTERESPONSEPARSER_H
@@ -0,0 +1,44 @@
+#ifndef ROUTERESULT_H
+#define ROUTERESULT_H
+
+#include "MapMatcher.h"
+#include "RoutePath.h"
+#include "RouteProgress.h"
+#include "TrafficModel.h"
+#include "VoiceGuidance.h"
+#include <QGeoCoordinate>
+#include <QList>
+#include <QString>
+#include <QVariant>
+#include <memory>
+
+class RouteLod;
+
+struct RouteStep {
+    QString instruction;
+    QString modifier; // left, right, slight right
+    int distance;     // meters
+    QGeoCoordinate maneuverCoordinate;
+    QString roadName;     // the road driven after the maneuver
+    double offset = 0.0;  // metres along the route to the maneuver
+};
+
+// A computed route, filled off the GUI thread by the online response
+// parser or the offline router
+struct RouteResult {
+    RoutePath currentRoutePath;
+    QList<RouteStep> routeSteps;
+    QList<quint8> speedLimits; // km/h per path segment, 0 if unknown
+    TrafficModel traffic;
+    std::shared_ptr<const RouteIndex> index; // positions and distances along it
+    MapMatcher matcher;
+    RouteProgress progress; // distance and time left along it
+    VoiceGuidance voice;    // when each maneuver is announced
+    std::shared_ptr<const RouteLod> lod; // geometry levels for the map
+    int distanceMeters = 0;
+    QVariantMap routeData;
+    bool success = false;
+    QString errorString;
+};
+
+#endif // ROUTERESULT_H
@@ -0,0 +1,68 @@
+#include "RouteSuffix.h"
+#include <algorithm>
+
+RouteSuffix::RouteSuffix(const RouteIndex &route, const QList<RouteStep> &steps, const QList<quint8> &speedLimits,
+                         const TrafficModel &traffic, double seconds, double leftAt) {
+    const QList<double> &offsets = route.offsets();
+    if (route.isEmpty()) return;
+
+    // The first point past a maneuver far enough ahead, short of the next
+    int point = -1, step = -1;
+    for (int i = 0; i + 1 < steps.size() && point < 0; ++i) {
+        if (steps[i].offset < leftAt + RejoinAheadMeters) continue;
+        const int at = int(std::lower_bound(offsets.begin(), offsets.end(), steps[i].offset + PastManeuverMeters)
+                           - offsets.begin());
+        if (at + 1 < offsets.size() && offsets[at] < steps[i + 1].offset) {
+            point = at;
+            step = i + 1;
+        }
+    }
+    if (point < 0) return;
+
+    const RoutePath &path = route.path();
+    m_path.reserve(path.size() - point);
+    for (int i = point; i < path.size(); ++i) m_path.append(path.latitude(i), path.longitude(i));
+    m_steps = steps.mid(step);
+    m_speedLimits = speedLimits.mid(point, m_path.size() - 1);
+    m_speedLimits.insert(m_speedLimits.size(), m_path.size() - 1 - m_speedLimits.size(), 0);
+
+    const double cut = offsets[point];
+    m_length = route.length() - cut;
+    m_seconds = route.length() > 0.0 ? seconds * m_length / route.length() : 0.0;
+    for (const TrafficModel::Run &run : traffic.runs()) {
+        if (run.to <= cut) continue;
+        m_traffic.push_back({std::max(run.from, cut) - cut, run.to - cut, run.congestion});
+    }
+}
+
+void RouteSuffix::appendTo(RouteResult &prefix) const {
+    if (isEmpty() || !prefix.success || prefix.currentRoutePath.isEmpty()) return;
+
+    // The prefix's last point gives way to the rejoin point, its segment
+    // keeping its limit
+    const RoutePath &head = prefix.currentRoutePath;
+    RoutePath path;
+    path.reserve(head.size() - 1 + m_path.size());
+    for (int i = 0; i + 1 < head.size(); ++i) path.append(head.latitude(i), head.longitude(i));
+    for (int i = 0; i < m_path.size(); ++i) path.append(m_path.latitude(i), m_path.longitude(i));
+    const int segments = head.size() - 1;
+    prefix.currentRoutePath = path;
+
+    prefix.speedLimits.resize(std::min<qsizetype>(prefix.speedLimits.size(), segments));
+    prefix.speedLimits.insert(prefix.speedLimits.size(), segments - prefix.speedLimits.size(), 0);
+    prefix.speedLimits += m_speedLimits;
+
+    // Both routers end on the arrival
+    if (!prefix.routeSteps.isEmpty()) prefix.routeSteps.removeLast();
+    prefix.routeSteps += m_steps;
+
+    prefix.distanceMeters += int(m_length);
+    prefix.routeData["distance"] = prefix.routeData.value("distance").toDouble() + m_length;
+    prefix.routeData["duration"] = prefix.routeData.value("duration").toDouble() + m_seconds;
+}
+
+void RouteSuffix::restoreTraffic(TrafficModel &traffic) const {
+    if (isEmpty() || traffic.isEmpty()) return;
+    const double cut = traffic.length() - m_length;
+    for (const TrafficModel::Run &run : m_traffic) traffic.update(cut + run.from, cut + run.to, run.congestion);
+}
@@ -0,0 +1,52 @@
+#ifndef ROUTESUFFIX_H
+#define ROUTESUFFIX_H
+
+#include "RouteResult.h"
+#include <vector>
+
+/**
+ * @brief The part of a route kept when rerouting.
+ *
+ * A car that has left the route rarely needs a new one all the way to the
+ * destination: the route ahead is still good once it gets back to it.
+ * The suffix is the route from a rejoin point on, with its maneuvers,
+ * speed limits and traffic, so only the way from the car to the rejoin
+ * point has to be routed. The rejoin point lies RejoinAheadMeters beyond
+ * where the car left, leaving room to turn back towards the route, and
+ * just past a maneuver, so the new prefix makes that maneuver itself,
+ * from whichever direction it comes.
+ */
+class RouteSuffix
+{
+public:
+    static constexpr double RejoinAheadMeters = 1000.0;
+    static constexpr double PastManeuverMeters = 50.0;
+
+    RouteSuffix() = default;
+    // The route beyond its first maneuver RejoinAheadMeters past `leftAt`
+    // metres along it; empty if there is none before the destination.
+    // `seconds` is the duration of the whole route.
+    RouteSuffix(const RouteIndex &route, const QList<RouteStep> &steps, const QList<quint8> &speedLimits,
+                const TrafficModel &traffic, double seconds, double leftAt);
+
+    bool isEmpty() const { return m_path.isEmpty(); }
+    // Where the route to join on must end
+    QGeoCoordinate start() const { return m_path.first(); }
+    double length() const { return m_length; }
+
+    // Joins the suffix on to a route ending at start(), whose arrival there
+    // is dropped; before the route is prepared
+    void appendTo(RouteResult &prefix) const;
+    // Rates the joined route's end as the old one was; after it is prepared
+    void restoreTraffic(TrafficModel &traffic) const;
+
+private:
+    RoutePath m_path;
+    QList<RouteStep> m_steps;
+    QList<quint8> m_speedLimits;             // per segment of m_path
+    std::vector<TrafficModel::Run> m_traffic; // metres from the rejoin point
+    double m_length = 0.0;
+    double m_seconds = 0.0;
+};
+
+#endif // ROUTESUFFIX_H
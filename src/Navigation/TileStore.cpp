@@ -0,0 +1,290 @@
+#include "TileStore.h"
+#include "GeoMath.h"
+#include <QDebug>
+#include <QSaveFile>
+#include <algorithm>
+#include <cmath>
+#include <unordered_set>
+
+using GeoMath::DegToRad;
+using GeoMath::MetersPerDegree;
+using GeoMath::metersPerLonDegree;
+
+namespace {
+constexpr double kPi = 3.14159265358979323846;
+constexpr double kEquatorMeters = 40075016.686;
+constexpr double kMaxLatitude = 85.05112878; // edge of the web map grid
+constexpr quint64 kNoKey = ~quint64(0);      // zoom 255: never a stored tile
+constexpr qint64 kRecordBytes = sizeof(TileStore::Record);
+
+double tileLongitude(double x, int zoom) { return x / double(1 << zoom) * 360.0 - 180.0; }
+double tileLatitude(double y, int zoom) {
+    return std::atan(std::sinh(kPi * (1.0 - 2.0 * y / double(1 << zoom)))) / DegToRad;
+}
+}
+
+quint64 TileStore::key(int style, int zoom, int x, int y) {
+    return quint64(quint8(style)) << 56 | quint64(quint8(zoom)) << 48 | quint64(x & 0xFFFFFF) << 24 | quint64(y & 0xFFFFFF);
+}
+
+TileStore::Tile TileStore::tile(quint64 key) {
+    return {int(key >> 56), int((key >> 48) & 0xFF), int((key >> 24) & 0xFFFFFF), int(key & 0xFFFFFF)};
+}
+
+int TileStore::tileX(double longitude, int zoom) {
+    const int n = 1 << zoom;
+    return std::clamp(int(std::floor((longitude + 180.0) / 360.0 * n)), 0, n - 1);
+}
+
+int TileStore::tileY(double latitude, int zoom) {
+    const int n = 1 << zoom;
+    const double lat = std::clamp(latitude, -kMaxLatitude, kMaxLatitude) * DegToRad;
+    return std::clamp(int(std::floor((1.0 - std::asinh(std::tan(lat)) / kPi) / 2.0 * n)), 0, n - 1);
+}
+
+std::vector<quint64> TileStore::corridor(const RoutePath &path, int style, int zoom, double meters) {
+    std::vector<quint64> tiles;
+    std::unordered_set<quint64> seen;
+    // The tiles of a box `meters` around each point sampled along the path,
+    // sampled at most half a tile apart so none between samples is missed
+    auto cover = [&](double lat, double lon) {
+        const double dLat = meters / MetersPerDegree;
+        const double dLon = meters / metersPerLonDegree(lat);
+        for (int y = tileY(lat + dLat, zoom); y <= tileY(lat - dLat, zoom); ++y) {
+            for (int x = tileX(lon - dLon, zoom); x <= tileX(lon + dLon, zoom); ++x) {
+                const quint64 k = key(style, zoom, x, y);
+                if (seen.insert(k).second) tiles.push_back(k);
+            }
+        }
+    };
+    if (path.isEmpty()) return tiles;
+    cover(path.latitude(0), path.longitude(0));
+    for (int i = 1; i < path.size(); ++i) {
+        const double lat0 = path.latitude(i - 1), lon0 = path.longitude(i - 1);
+        const double lat1 = path.latitude(i), lon1 = path.longitude(i);
+        const double cosLat = std::cos(lat0 * DegToRad);
+        const double length = std::hypot((lon1 - lon0) * MetersPerDegree * cosLat, (lat1 - lat0) * MetersPerDegree);
+        const double spacing = std::min(meters, kEquatorMeters * cosLat / double(1 << zoom) / 2.0);
+        const int samples = std::max(1, int(std::ceil(length / spacing)));
+        for (int s = 1; s <= samples; ++s) {
+            const double t = double(s) / samples;
+            cover(lat0 + t * (lat1 - lat0), lon0 + t * (lon1 - lon0));
+        }
+    }
+    return tiles;
+}
+
+std::vector<quint64> TileStore::around(const QGeoCoordinate &center, int style, int zoom, double meters) {
+    const double lat = center.latitude(), lon = center.longitude();
+    const double dLat = meters / MetersPerDegree;
+    const double dLon = meters / metersPerLonDegree(lat);
+    std::vector<std::pair<double, quint64>> byDistance;
+    for (int y = tileY(lat + dLat, zoom); y <= tileY(lat - dLat, zoom); ++y) {
+        for (int x = tileX(lon - dLon, zoom); x <= tileX(lon + dLon, zoom); ++x) {
+            const double dy = (tileLatitude(y + 0.5, zoom) - lat) / dLat;
+            const double dx = (tileLongitude(x + 0.5, zoom) - lon) / dLon;
+            byDistance.push_back({dx * dx + dy * dy, key(style, zoom, x, y)});
+        }
+    }
+    std::sort(byDistance.begin(), byDistance.end());
+    std::vector<quint64> tiles;
+    tiles.reserve(byDistance.size());
+    for (const auto &entry : byDistance) tiles.push_back(entry.second);
+    return tiles;
+}
+
+bool TileStore::open(const QString &path, qint64 budgetBytes) {
+    close();
+    m_budget = budgetBytes;
+    m_file.setFileName(path);
+    if (!m_file.open(QIODevice::ReadWrite)) {
+        qWarning() << "Tile store: cannot open" << path << m_file.errorString();
+        return false;
+    }
+    Header header = {};
+    if (m_file.read(reinterpret_cast<char *>(&header), sizeof(header)) != qint64(sizeof(header))
+        || header.magic != Magic || header.version != Version) {
+        // Only a cache: anything else there is started over
+        if (m_file.size() > 0) qWarning() << "Tile store: not a version" << Version << "store, starting over" << path;
+        header = {Magic, Version, {0, 0}};
+        if (!m_file.resize(0) || !m_file.seek(0)
+            || m_file.write(reinterpret_cast<const char *>(&header), sizeof(header)) != qint64(sizeof(header))) {
+            qWarning() << "Tile store: cannot write" << path << m_file.errorString();
+            close();
+            return false;
+        }
+    }
+    if (!load()) {
+        close();
+        return false;
+    }
+    evict(kNoKey);
+    if (m_dead > m_bytes) compact();
+    return true;
+}
+
+bool TileStore::load() {
+    const qint64 size = m_file.size();
+    qint64 at = sizeof(Header);
+    Record record;
+    while (at < size) {
+        if (!m_file.seek(at)
+            || m_file.read(reinterpret_cast<char *>(&record), kRecordBytes) != kRecordBytes
+            || record.size > MaxTileBytes || at + kRecordBytes + record.size > size
+            || tile(record.key).zoom > MaxZoom) {
+            qWarning() << "Tile store: cut off a damaged record at" << at << "of" << size << "bytes";
+            if (!m_file.resize(at)) return false;
+            break;
+        }
+        auto found = m_entries.find(record.key);
+        if (found != m_entries.end()) {
+            m_bytes -= found->second.size;
+            m_dead += kRecordBytes + found->second.size;
+            if (record.size == 0) {
+                m_dead += kRecordBytes;
+                m_uses.erase(found->second.use);
+                m_entries.erase(found);
+            } else {
+                m_uses.splice(m_uses.begin(), m_uses, found->second.use);
+                found->second.offset = at + kRecordBytes;
+                found->second.size = record.size;
+                m_bytes += record.size;
+            }
+        } else if (record.size == 0) {
+            m_dead += kRecordBytes;
+        } else {
+            m_uses.push_front(record.key);
+            m_entries.emplace(record.key, Entry{at + kRecordBytes, record.size, m_uses.begin()});
+            m_bytes += record.size;
+        }
+        at += kRecordBytes + record.size;
+    }
+    m_end = at;
+    return true;
+}
+
+void TileStore::close() {
+    m_file.close();
+    m_entries.clear();
+    m_uses.clear();
+    m_bytes = 0;
+    m_dead = 0;
+    m_end = 0;
+}
+
+QByteArray TileStore::read(quint64 key) {
+    auto found = m_entries.find(key);
+    if (found == m_entries.end()) return QByteArray();
+    const Entry &entry = found->second;
+    if (!m_file.seek(entry.offset)) return QByteArray();
+    QByteArray image = m_file.read(entry.size);
+    if (image.size() != qsizetype(entry.size)) {
+        qWarning() << "Tile store: short read" << m_file.errorString();
+        return QByteArray();
+    }
+    m_uses.splice(m_uses.begin(), m_uses, entry.use);
+    return image;
+}
+
+bool TileStore::insert(quint64 key, const QByteArray &image) {
+    if (!isOpen() || image.isEmpty() || quint64(image.size()) > MaxTileBytes || tile(key).zoom > MaxZoom) return false;
+    const Record record = {key, quint32(image.size()), 0};
+    if (!m_file.seek(m_end) || m_file.write(reinterpret_cast<const char *>(&record), kRecordBytes) != kRecordBytes
+        || m_file.write(image) != image.size() || !m_file.flush()) {
+        qWarning() << "Tile store: cannot write" << m_file.errorString();
+        m_file.resize(m_end);
+        return false;
+    }
+
+    auto found = m_entries.find(key);
+    if (found != m_entries.end()) {
+        m_bytes -= found->second.size;
+        m_dead += kRecordBytes + found->second.size;
+        m_uses.splice(m_uses.begin(), m_uses, found->second.use);
+        found->second.offset = m_end + kRecordBytes;
+        found->second.size = record.size;
+    } else {
+        m_uses.push_front(key);
+        m_entries.emplace(key, Entry{m_end + kRecordBytes, record.size, m_uses.begin()});
+    }
+    m_bytes += record.size;
+    m_end += kRecordBytes + record.size;
+
+    evict(key);
+    if (m_dead > m_bytes) compact();
+    return true;
+}
+
+void TileStore::setBudget(qint64 bytes) {
+    m_budget = bytes;
+    if (!isOpen()) return;
+    evict(kNoKey);
+    if (m_dead > m_bytes) compact();
+}
+
+void TileStore::evict(quint64 keep) {
+    // The dropped tiles' records, appended in one write
+    QByteArray dropped;
+    while (m_bytes > m_budget && !m_uses.empty() && m_uses.back() != keep) {
+        const quint64 victim = m_uses.back();
+        auto found = m_entries.find(victim);
+        const Record record = {victim, 0, 0};
+        dropped.append(reinterpret_cast<const char *>(&record), kRecordBytes);
+        m_bytes -= found->second.size;
+        m_dead += 2 * kRecordBytes + found->second.size;
+        m_entries.erase(found);
+        m_uses.pop_back();
+    }
+    if (dropped.isEmpty()) return;
+    if (!m_file.seek(m_end) || m_file.write(dropped) != dropped.size() || !m_file.flush()) {
+        // Dropped here all the same; a reopened store may hold them again
+        qWarning() << "Tile store: cannot write" << m_file.errorString();
+        m_file.resize(m_end);
+        return;
+    }
+    m_end += dropped.size();
+}
+
+bool TileStore::compact() {
+    const QString path = m_file.fileName();
+    QSaveFile file(path);
+    if (!file.open(QIODevice::WriteOnly)) {
+        qWarning() << "Tile store: cannot write" << path << file.errorString();
+        return false;
+    }
+    const Header header = {Magic, Version, {0, 0}};
+    file.write(reinterpret_cast<const char *>(&header), sizeof(header));
+
+    // Least recently used first, as a reopened store takes the order
+    std::vector<std::pair<quint64, qint64>> offsets;
+    offsets.reserve(m_entries.size());
+    qint64 at = sizeof(Header);
+    for (auto use = m_uses.rbegin(); use != m_uses.rend(); ++use) {
+        const Entry &entry = m_entries.at(*use);
+        const Record record = {*use, entry.size, 0};
+        if (!m_file.seek(entry.offset)) break;
+        const QByteArray image = m_file.read(entry.size);
+        if (image.size() != qsizetype(entry.size)) break;
+        file.write(reinterpret_cast<const char *>(&record), kRecordBytes);
+        file.write(image);
+        offsets.push_back({*use, at + kRecordBytes});
+        at += kRecordBytes + entry.size;
+    }
+    if (offsets.size() != m_entries.size() || !file.commit()) {
+        qWarning() << "Tile store: cannot compact" << path << file.errorString();
+        file.cancelWriting();
+        return false;
+    }
+
+    // The new file replaced the one still open
+    m_file.close();
+    if (!m_file.open(QIODevice::ReadWrite)) {
+        qWarning() << "Tile store: cannot reopen" << path << m_file.errorString();
+        close();
+        return false;
+    }
+    for (const auto &entry : offsets) m_entries.at(entry.first).offset = entry.second;
+    m_dead = 0;
+    m_end = at;
+    return true;
+}
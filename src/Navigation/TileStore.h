@@ -0,0 +1,111 @@
+#ifndef TILESTORE_H
+#define TILESTORE_H
+
+#include "RoutePath.h"
+#include <QByteArray>
+#include <QFile>
+#include <QGeoCoordinate>
+#include <QString>
+#include <list>
+#include <unordered_map>
+#include <vector>
+
+/**
+ * @brief Map tiles kept on the flash, least recently used dropped first.
+ *
+ * A tile is the image of one map style at a zoom level and x/y position in
+ * the usual web map grid. All tiles live in one file: a header, then one
+ * record per stored tile, each its key and size followed by the image as
+ * the tile server sent it. Records are only ever appended; storing a tile
+ * again leaves the older record dead, and dropping one appends a record
+ * of size zero. Opening the file reads the record headers once to build
+ * the index in memory, so a tile costs one seek and one read. A record cut
+ * short by a power loss ends the file and is cut off.
+ *
+ * The tiles held stay within a byte budget: storing a tile drops the least
+ * recently read or stored ones until it fits. Recency is kept in memory;
+ * after opening the file it is the order the tiles were stored in. Once
+ * the dead records take more room than the live ones, the file is written
+ * anew with only the live tiles, least recently used first.
+ */
+class TileStore
+{
+public:
+    static constexpr quint32 Magic = 0x3153544E; // "NTS1"
+    static constexpr quint32 Version = 1;
+    static constexpr int MaxZoom = 20;
+    static constexpr quint32 MaxTileBytes = 1 << 20;
+
+    struct Header {
+        quint32 magic;
+        quint32 version;
+        quint32 reserved[2];
+    };
+
+    struct Record {
+        quint64 key;
+        quint32 size;   // image bytes that follow; zero: the tile was dropped
+        quint32 reserved;
+    };
+
+    struct Tile {
+        int style;
+        int zoom;
+        int x;
+        int y;
+    };
+
+    static quint64 key(int style, int zoom, int x, int y);
+    static Tile tile(quint64 key);
+    // The tile holding a position at `zoom`
+    static int tileX(double longitude, int zoom);
+    static int tileY(double latitude, int zoom);
+
+    // Tiles within `meters` of the path at `zoom`, in the order the path
+    // reaches them
+    static std::vector<quint64> corridor(const RoutePath &path, int style, int zoom, double meters);
+    // Tiles within `meters` of `center` at `zoom`, nearest first
+    static std::vector<quint64> around(const QGeoCoordinate &center, int style, int zoom, double meters);
+
+    TileStore() = default;
+    TileStore(const TileStore &) = delete;
+    TileStore &operator=(const TileStore &) = delete;
+
+    // Opens the store at `path`, creating it if missing
+    bool open(const QString &path, qint64 budgetBytes);
+    void close();
+    bool isOpen() const { return m_file.isOpen(); }
+
+    bool contains(quint64 key) const { return m_entries.count(key) != 0; }
+    // The tile's image, empty if it is not stored; counts as a use
+    QByteArray read(quint64 key);
+    // Stores the image, dropping the least recently used tiles to fit
+    bool insert(quint64 key, const QByteArray &image);
+
+    void setBudget(qint64 bytes);
+    qint64 budget() const { return m_budget; }
+    int count() const { return int(m_entries.size()); }
+    qint64 bytes() const { return m_bytes; }     // images held
+    qint64 fileBytes() const { return m_end; }
+
+private:
+    struct Entry {
+        qint64 offset; // of the image
+        quint32 size;
+        std::list<quint64>::iterator use;
+    };
+
+    bool load();
+    void evict(quint64 keep);
+    bool compact();
+
+    QFile m_file;
+    std::unordered_map<quint64, Entry> m_entries;
+    std::list<quint64> m_uses; // most recently used first
+    qint64 m_budget = 0;
+    qint64 m_bytes = 0;
+    qint64 m_dead = 0;         // file bytes of dead records
+    qint64 m_end = 0;          // where the next record goes
+};
+
+#endif // TILESTORE_H
@@ -0,0 +1,54 @@
+#include "TrafficModel.h"
+#include <algorithm>
+
+TrafficModel::TrafficModel(const RouteIndex &route) : m_offsets(route.offsets()) {
+    m_starts.emplace(0.0, Unknown);
+}
+
+TrafficModel::Congestion TrafficModel::at(double meters) const {
+    if (m_starts.empty()) return Unknown;
+    auto it = m_starts.upper_bound(meters);
+    return it == m_starts.begin() ? it->second : std::prev(it)->second;
+}
+
+void TrafficModel::update(double from, double to, Congestion congestion) {
+    if (m_starts.empty()) return;
+    from = std::max(from, 0.0);
+    to = std::min(to, length());
+    if (!(to > from)) return;
+
+    // Whatever ran through `to` carries on after the new run
+    const Congestion after = at(to);
+    m_starts.erase(m_starts.lower_bound(from), m_starts.upper_bound(to));
+    auto run = m_starts.emplace(from, congestion).first;
+    if (to < length() && after != congestion) m_starts.emplace(to, after);
+    if (run != m_starts.begin() && std::prev(run)->second == congestion) m_starts.erase(run);
+}
+
+std::vector<TrafficModel::Run> TrafficModel::runs() const {
+    std::vector<Run> out;
+    out.reserve(m_starts.size());
+    for (auto it = m_starts.begin(); it != m_starts.end(); ++it) {
+        const auto next = std::next(it);
+        out.push_back({it->first, next == m_starts.end() ? length() : next->first, it->second});
+    }
+    return out;
+}
+
+int TrafficModel::pointAt(double meters) const {
+    if (m_offsets.isEmpty()) return 0;
+    const auto it = std::lower_bound(m_offsets.begin(), m_offsets.end(), meters);
+    if (it == m_offsets.end()) return int(m_offsets.size()) - 1;
+    const int i = int(it - m_offsets.begin());
+    return i > 0 && meters - m_offsets[i - 1] < *it - meters ? i - 1 : i;
+}
+
+const char *TrafficModel::color(Congestion congestion) {
+    switch (congestion) {
+    case Free: return "#4CAF50";
+    case Slow: return "#FF9800";
+    case Jammed: return "#F44336";
+    case Unknown: break;
+    }
+    return "";
+}
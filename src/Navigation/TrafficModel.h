@@ -0,0 +1,56 @@
+#ifndef TRAFFICMODEL_H
+#define TRAFFICMODEL_H
+
+#include "RouteIndex.h"
+#include <QList>
+#include <map>
+#include <vector>
+
+/**
+ * @brief Congestion along a route, as runs over the distance driven.
+ *
+ * A run starts at a distance along the route and lasts until the next one,
+ * the last until the end; runs next to each other always differ, so a
+ * route is a handful of them however long it is. update() rates a stretch
+ * of the route as a traffic feed reports it, splitting the runs it cuts
+ * and merging with equal neighbours, without touching the rest.
+ *
+ * Distances map to the route's points through the offsets of its
+ * RouteIndex, so each run is drawn as one polyline over the points it
+ * covers.
+ */
+class TrafficModel
+{
+public:
+    enum Congestion : quint8 { Unknown, Free, Slow, Jammed };
+
+    struct Run {
+        double from; // metres along the route
+        double to;
+        Congestion congestion;
+    };
+
+    TrafficModel() = default;
+    explicit TrafficModel(const RouteIndex &route); // all Unknown
+
+    bool isEmpty() const { return m_offsets.size() < 2; }
+    double length() const { return m_offsets.isEmpty() ? 0.0 : m_offsets.last(); }
+    int runCount() const { return int(m_starts.size()); }
+
+    // Rates [from, to) metres along the route
+    void update(double from, double to, Congestion congestion);
+    Congestion at(double meters) const;
+    std::vector<Run> runs() const;
+
+    // Metres along the route at point `index`, and the point nearest `meters`
+    double offset(int index) const { return m_offsets[index]; }
+    int pointAt(double meters) const;
+
+    static const char *color(Congestion congestion);
+
+private:
+    QList<double> m_offsets;              // per point, shared with the RouteIndex
+    std::map<double, Congestion> m_starts; // run start -> congestion; always one at 0
+};
+
+#endif // TRAFFICMODEL_H
@@ -0,0 +1,88 @@
+#include "VehicleMotion.h"
+#include "GeoMath.h"
+#include <algorithm>
+#include <cmath>
+
+namespace {
+// Flat at the distances between a pose and its prediction
+double meters(const VehicleMotion::Pose &a, const VehicleMotion::Pose &b) {
+    const double dx = (b.longitude - a.longitude) * GeoMath::metersPerLonDegree(a.latitude);
+    const double dy = (b.latitude - a.latitude) * GeoMath::MetersPerDegree;
+    return std::hypot(dx, dy);
+}
+}
+
+void VehicleMotion::reset() {
+    m_keyframes.clear();
+    m_publishedMs = 0;
+    m_route = nullptr;
+}
+
+VehicleMotion::Pose VehicleMotion::poseAt(qint64 ms) const {
+    if (m_keyframes.empty()) return Pose();
+    auto after = std::upper_bound(m_keyframes.begin(), m_keyframes.end(), ms,
+                                  [](qint64 t, const Pose &p) { return t < p.timestampMs; });
+    Pose pose = after == m_keyframes.begin() ? m_keyframes.front()
+              : after == m_keyframes.end()   ? m_keyframes.back()
+                                             : *std::prev(after);
+    if (after != m_keyframes.begin() && after != m_keyframes.end()) {
+        const Pose &a = *std::prev(after), &b = *after;
+        const double t = double(ms - a.timestampMs) / double(b.timestampMs - a.timestampMs);
+        pose.latitude = a.latitude + t * (b.latitude - a.latitude);
+        pose.longitude = a.longitude + t * (b.longitude - a.longitude);
+        pose.bearing = std::fmod(a.bearing + t * std::remainder(b.bearing - a.bearing, 360.0) + 360.0, 360.0);
+    }
+    pose.timestampMs = ms;
+    return pose;
+}
+
+template <class Predict>
+bool VehicleMotion::publish(qint64 nowMs, Predict at) {
+    const Pose actual = at(0);
+    const Pose shown = poseAt(nowMs);
+    if (!m_keyframes.empty() && nowMs - m_publishedMs < IntervalMs && meters(shown, actual) <= DriftMeters)
+        return false;
+
+    // On from where the vehicle is shown, unless that is far off
+    std::vector<Pose> next;
+    next.reserve(Steps + 1);
+    next.push_back(m_keyframes.empty() || meters(shown, actual) > SnapMeters ? actual : shown);
+    for (int step = 1; step <= Steps; ++step) next.push_back(at(step));
+    m_keyframes = std::move(next);
+    m_publishedMs = nowMs;
+    return true;
+}
+
+bool VehicleMotion::follow(const RouteIndex &route, const MapMatcher::Match &match, qint64 nowMs) {
+    // Predicted on from the last match and corrected by a share of the
+    // difference; started over on another route or far off the prediction
+    const double seconds = (nowMs - m_filteredMs) / 1000.0;
+    const double predicted = m_offset + m_speed * seconds;
+    if (m_route != &route || seconds <= 0.0 || std::abs(match.offset - predicted) > SnapMeters) {
+        m_route = &route;
+        m_offset = match.offset;
+        m_speed = match.speed;
+    } else {
+        const double residual = match.offset - predicted;
+        m_offset = predicted + Alpha * residual;
+        m_speed = std::max(0.0, m_speed + Beta * residual / seconds);
+    }
+    m_filteredMs = nowMs;
+
+    return publish(nowMs, [&](int step) {
+        const double along = m_offset + m_speed * step * StepMs / 1000.0;
+        const QGeoCoordinate at = route.coordinateAt(along);
+        return Pose{nowMs + step * StepMs, at.latitude(), at.longitude(), route.bearingAt(along)};
+    });
+}
+
+bool VehicleMotion::follow(const MapMatcher::Fix &fix, qint64 nowMs) {
+    m_route = nullptr;
+    const double bearing = fix.heading >= 0.0 ? fix.heading : poseAt(nowMs).bearing;
+    const double speed = std::max(fix.speed, 0.0);
+    const QGeoCoordinate from(fix.latitude, fix.longitude);
+    return publish(nowMs, [&](int step) {
+        const QGeoCoordinate at = from.atDistanceAndAzimuth(speed * step * StepMs / 1000.0, bearing);
+        return Pose{nowMs + step * StepMs, at.latitude(), at.longitude(), bearing};
+    });
+}
@@ -0,0 +1,67 @@
+#ifndef VEHICLEMOTION_H
+#define VEHICLEMOTION_H
+
+#include "MapMatcher.h"
+#include <vector>
+
+/**
+ * @brief Where the vehicle will be over the next second or so, as keyframes.
+ *
+ * Fixes come ten times a second, but redrawing the map for each one moves
+ * the marker in steps and wakes every binding on the position. Instead,
+ * each fix is compared with the motion last published, and only about once
+ * per IntervalMs, or when the car has strayed DriftMeters from it, a new
+ * one is published. It is a few timestamped poses, StepMs apart, predicted
+ * along the route, or straight on off it. The map interpolates them at
+ * display rate. Along the route an alpha-beta filter tracks the distance
+ * and speed, so the few metres matched positions jitter by neither bend
+ * the prediction nor publish a new one.
+ *
+ * The first keyframe of a motion is where the last one puts the vehicle at
+ * that moment, so the marker never jumps, only corrects its course over
+ * the next step; a vehicle more than SnapMeters off is moved there at once.
+ */
+class VehicleMotion
+{
+public:
+    static constexpr qint64 IntervalMs = 1000;
+    static constexpr qint64 StepMs = 500;
+    static constexpr int Steps = 3;            // keyframes after the first, 1.5 s ahead
+    static constexpr double DriftMeters = 10.0;
+    static constexpr double SnapMeters = 100.0;
+    static constexpr double Alpha = 0.2;       // share of a match's distance taken
+    static constexpr double Beta = 0.02;       // and of its speed
+
+    struct Pose {
+        qint64 timestampMs = 0; // milliseconds since the epoch, as the display clock
+        double latitude = 0.0;
+        double longitude = 0.0;
+        double bearing = 0.0;   // degrees
+    };
+
+    // A fix matched to the route, at `nowMs`; returns whether a new motion is published
+    bool follow(const RouteIndex &route, const MapMatcher::Match &match, qint64 nowMs);
+    // A fix off the route
+    bool follow(const MapMatcher::Fix &fix, qint64 nowMs);
+    // Forgets the motion, as when the vehicle is placed somewhere
+    void reset();
+
+    const std::vector<Pose> &keyframes() const { return m_keyframes; }
+    // The motion's pose at `ms`, held at either end
+    Pose poseAt(qint64 ms) const;
+
+private:
+    template <class Predict>
+    bool publish(qint64 nowMs, Predict at);
+
+    std::vector<Pose> m_keyframes;
+    qint64 m_publishedMs = 0;
+
+    // Filtered along the route followed, if any
+    const RouteIndex *m_route = nullptr;
+    double m_offset = 0.0;
+    double m_speed = 0.0;
+    qint64 m_filteredMs = 0;
+};
+
+#endif // VEHICLEMOTION_H
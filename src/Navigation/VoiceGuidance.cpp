@@ -0,0 +1,77 @@
+#include "VoiceGuidance.h"
+#include <algorithm>
+
+namespace {
+// Early and ahead distances by the limit leading into a maneuver
+struct RoadClass {
+    int minKmh;
+    int early;
+    int ahead;
+};
+constexpr RoadClass kRoadClasses[] = {
+    {90, 2000, 800}, // motorway
+    {60, 1000, 400}, // rural
+    {0, 400, 150},   // urban, or the limit unknown
+};
+}
+
+VoiceGuidance::VoiceGuidance(const RouteIndex &route, const QList<double> &maneuvers, const QList<quint8> &speedLimits)
+{
+    if (route.isEmpty()) return;
+    m_triggers.reserve(size_t(maneuvers.size()) * 3);
+    double previous = 0.0;
+    for (int step = 0; step < maneuvers.size(); ++step) {
+        const double maneuver = maneuvers[step];
+        const int segment = route.segmentAt(std::max(0.0, maneuver - 1.0));
+        const int kmh = segment < speedLimits.size() ? speedLimits[segment] : 0;
+        const RoadClass &road = *std::find_if(std::begin(kRoadClasses), std::end(kRoadClasses),
+                                              [kmh](const RoadClass &c) { return kmh >= c.minKmh; });
+        const bool then = step + 1 < maneuvers.size() && maneuvers[step + 1] - maneuver <= ThenMeters;
+
+        const int first = count();
+        auto add = [&](Kind kind, double meters, double seconds) {
+            // Heard before the previous maneuver, it would be taken for that one
+            if (maneuver - meters < previous) return;
+            m_triggers.push_back({maneuver, meters, seconds, 0, {step, kind, kind == Now ? 0 : int(meters), kind == Now && then}});
+        };
+        add(Early, road.early, 0.0);
+        add(Ahead, road.ahead, 0.0);
+        add(Now, NowMinMeters, NowSeconds);
+        for (int i = first; i < count(); ++i) m_triggers[size_t(i)].last = count() - 1;
+        previous = maneuver;
+    }
+}
+
+const VoiceGuidance::Prompt *VoiceGuidance::update(double offset, double speed, qint64 timestampMs) {
+    // A trigger falls half a fix interval past a fix on average
+    double lead = m_leadSeconds;
+    if (m_timestampMs >= 0 && timestampMs > m_timestampMs)
+        lead += std::min((timestampMs - m_timestampMs) / 1000.0, MaxFixIntervalSeconds) / 2.0;
+    m_timestampMs = timestampMs;
+
+    // Prompts of maneuvers already passed are too late to give
+    const int size = count();
+    while (m_next < size && m_triggers[size_t(m_next)].maneuver <= offset) ++m_next;
+    if (m_next == size) return nullptr;
+
+    speed = std::max(speed, 0.0);
+    auto due = [&](const Trigger &trigger) {
+        return trigger.maneuver - offset - speed * lead <= std::max(trigger.meters, speed * trigger.seconds);
+    };
+    // At speed the last prompt can come due before the one ahead of it
+    const int last = m_triggers[size_t(m_next)].last;
+    int next = m_next;
+    if (due(m_triggers[size_t(last)])) {
+        next = last;
+    } else {
+        if (!due(m_triggers[size_t(next)])) return nullptr;
+        while (next < last && due(m_triggers[size_t(next) + 1])) ++next;
+    }
+    m_next = next + 1;
+    return &m_triggers[size_t(next)].prompt;
+}
+
+void VoiceGuidance::reset() {
+    m_next = 0;
+    m_timestampMs = -1;
+}
@@ -0,0 +1,77 @@
+#ifndef VOICEGUIDANCE_H
+#define VOICEGUIDANCE_H
+
+#include "RouteIndex.h"
+#include <QList>
+#include <vector>
+
+/**
+ * @brief When to announce each maneuver of the route.
+ *
+ * Built once per route from where along it the maneuvers lie. Each gets up
+ * to three prompts: an early and an ahead one at distances set by the road
+ * class leading into it, taken from its speed limit (further out on faster
+ * roads), and one as it comes up, NowSeconds before it at the current
+ * speed or NowMinMeters, whichever is further. A prompt that would be
+ * heard before the previous maneuver is dropped; one that comes up within
+ * ThenMeters of the previous is chained to it instead ("turn left, then
+ * turn right").
+ *
+ * The trigger offsets are laid out in route order, so each matched position
+ * only checks the next prompt and the nearest one of its maneuver. A
+ * prompt is handed over LeadSeconds plus half a fix interval before its
+ * trigger, the time the audio path and speech take to make it heard, so
+ * it is heard at the distance it announces at any speed. Of the prompts
+ * due at once only the one nearest its maneuver is given, and those of
+ * maneuvers already passed are dropped unsaid.
+ */
+class VoiceGuidance
+{
+public:
+    enum Kind { Early, Ahead, Now };
+
+    struct Prompt {
+        int step = -1;
+        Kind kind = Now;
+        int meters = 0;    // announced distance, 0 for Now
+        bool then = false; // the next maneuver follows within ThenMeters
+    };
+
+    static constexpr double NowSeconds = 5.0;    // before the maneuver
+    static constexpr double NowMinMeters = 30.0; // however slow
+    static constexpr double ThenMeters = 150.0;
+    static constexpr double MaxFixIntervalSeconds = 1.0;
+
+    VoiceGuidance() = default;
+    // `maneuvers` are the steps' offsets, in order; `speedLimits` km/h per segment
+    VoiceGuidance(const RouteIndex &route, const QList<double> &maneuvers, const QList<quint8> &speedLimits);
+
+    bool isEmpty() const { return m_triggers.empty(); }
+    int count() const { return int(m_triggers.size()); }
+
+    // From handing a prompt over to it being heard
+    void setLeadSeconds(double seconds) { m_leadSeconds = seconds; }
+    double leadSeconds() const { return m_leadSeconds; }
+
+    // The prompt to hand over at the matched `offset`, moving at `speed`
+    // m/s, or null if none is due
+    const Prompt *update(double offset, double speed, qint64 timestampMs);
+    // Announces the route from its start again
+    void reset();
+
+private:
+    struct Trigger {
+        double maneuver;  // offset of the maneuver
+        double meters;    // before it, the prompt is to be heard
+        double seconds;   // or this long before it at the current speed, if further
+        int last;         // index of its maneuver's last prompt
+        Prompt prompt;
+    };
+
+    std::vector<Trigger> m_triggers;
+    int m_next = 0;
+    double m_leadSeconds = 0.0;
+    qint64 m_timestampMs = -1;
+};
+
+#endif // VOICEGUIDANCE_H
@@ -1,9 +1,104 @@
 #include "NavigationService.h"
+#include "Navigation/RoadRouter.h"
+#include "Navigation/RouteIndex.h"
+#include "Navigation/RouteLod.h"
+#include "Navigation/RouteResponseParser.h"
+#include "Navigation/RouteSuffix.h"
 #include <QUrlQuery>
+#include <QDateTime>
 #include <QDebug>
+#include <QFile>
+#include <QGeoPositionInfoSource>
+#include <QLocale>
 #include <QRandomGenerator>
+#include <QStandardPaths>
+#include <QtMath>
 #include <QtConcurrent>
 #include <QFutureWatcher>
+#include <cmath>
+#include <random>
+
+Q_LOGGING_CATEGORY(vcNavigation, "nordic.navigation")
+
+namespace {
+
+constexpr int kSearchResults = 5;
+
+constexpr double kTrafficSpanMeters = 500.0;   // resolution of the mock feed
+constexpr int kTrafficFeedIntervalMs = 30000;
+constexpr double kTrafficFeedAheadMeters = 2000.0;
+
+constexpr int kFixIntervalMs = 100;            // GNSS at 10 Hz
+constexpr int kSimulationSpeedKmh = 50;        // where the limit is unknown
+constexpr double kSimulationNoiseMeters = 4.0; // a receiver's typical error
+constexpr double kSimulationHeadingNoise = 5.0; // degrees
+constexpr double kManeuverSnapMeters = 50.0;
+constexpr double kArrivalSlackMinutes = 0.6;   // an arrival time shown moves by more than this
+
+// Distances as shown: to 10 m under a kilometre, to 100 m above
+int shownMeters(int meters) {
+    return meters >= 1000 ? (meters + 50) / 100 * 100 : (meters + 5) / 10 * 10;
+}
+
+QString formatDistance(int meters) {
+    meters = shownMeters(meters);
+    if (meters >= 1000) return QString::number(meters / 1000.0, 'f', 1) + " km";
+    return QString::number(meters) + " m";
+}
+
+// Mock traffic feed: a rating per span, changing now and then
+TrafficModel::Congestion mockCongestion() {
+    // Random Traffic Color (Thread-safe global access)
+    int rand = QRandomGenerator::global()->bounded(100);
+    if (rand > 80) return TrafficModel::Jammed;
+    if (rand > 60) return TrafficModel::Slow;
+    return TrafficModel::Free;
+}
+
+QString iconForModifier(const QString &modifier) {
+    if (modifier.contains("left")) return "turn_left.svg";
+    if (modifier.contains("right")) return "turn_right.svg";
+    if (modifier.contains("u-turn")) return "u_turn.svg";
+    return "navigation-arrow.svg";
+}
+
+// What guidance needs of a computed route: its index, the matcher for its
+// fixes and where along it each maneuver is; then the map overlays, the simplified
+// levels of its geometry and its traffic, from the feed as it stands. A
+// reroute first joins on the suffix kept of the route before, with its traffic.
+void prepareRoute(RouteResult &res, const RouteSuffix *suffix = nullptr) {
+    if (suffix) suffix->appendTo(res);
+    const RoutePath &path = res.currentRoutePath;
+    res.index = std::make_shared<const RouteIndex>(path);
+    res.matcher = MapMatcher(res.index);
+    res.progress = RouteProgress(*res.index, res.speedLimits, res.routeData.value("duration").toDouble());
+    // Maneuvers lie on the route, in order
+    double from = 0.0;
+    for (RouteStep &step : res.routeSteps) {
+        const RouteIndex::Projection at = res.index->nearest(step.maneuverCoordinate.latitude(),
+                                                             step.maneuverCoordinate.longitude(), kManeuverSnapMeters, from);
+        if (at.segment >= 0) from = at.offset;
+        step.offset = from;
+    }
+    QList<double> maneuvers;
+    maneuvers.reserve(res.routeSteps.size());
+    for (const RouteStep &step : res.routeSteps) maneuvers.append(step.offset);
+    res.voice = VoiceGuidance(*res.index, maneuvers, res.speedLimits);
+
+    res.lod = std::make_shared<const RouteLod>(path);
+    res.traffic = TrafficModel(*res.index);
+    if (res.traffic.isEmpty()) return;
+
+    // Congestion persists over a few spans; the model merges equal ones
+    TrafficModel::Congestion congestion = mockCongestion();
+    for (double from = 0.0; from < res.traffic.length(); from += kTrafficSpanMeters) {
+        if (QRandomGenerator::global()->bounded(100) < 20) congestion = mockCongestion();
+        res.traffic.update(from, from + kTrafficSpanMeters, congestion);
+    }
+    if (suffix) suffix->restoreTraffic(res.traffic);
+}
+
+} // namespace
 
 NavigationService::NavigationService(QObject *parent)
     : QObject(parent),
@@ -19,7 +114,7 @@ NavigationService::NavigationService(QObject *parent)
     // Simulation Logic
     m_searchDebounceTimer = new QTimer(this);
     m_searchDebounceTimer->setSingleShot(true);
-    m_searchDebounceTimer->setInterval(600); // 600ms debounce
+    m_searchDebounceTimer->setInterval(600); // 600ms debounce (online geocoder only)
     
     connect(m_searchDebounceTimer, &QTimer::timeout, this, [this]() {
         // Perform the actual search
@@ -29,25 +124,68 @@ NavigationService::NavigationService(QObject *parent)
         queryData.addQueryItem("q", m_pendingSearchQuery);
         queryData.addQueryItem("format", "json");
         queryData.addQueryItem("addressdetails", "1");
-        queryData.addQueryItem("limit", "5");
+        queryData.addQueryItem("limit", QString::number(kSearchResults));
         url.setQuery(queryData);
 
         QNetworkRequest request(url);
         request.setRawHeader("User-Agent", "NordicHeadunit/1.0");
 
         QNetworkReply *reply = m_networkManager->get(request);
+        reply->setProperty("query", m_pendingSearchQuery);
         connect(reply, &QNetworkReply::finished, this, &NavigationService::onSearchFinished);
     });
 
     // Simulation Logic
-    m_simulationTimer->setInterval(100); // 100ms update rate for smoothness (10fps)
+    m_simulationTimer->setInterval(kFixIntervalMs); // simulated fixes at the receiver's rate
     connect(m_simulationTimer, &QTimer::timeout, this, &NavigationService::updateSimulation);
+
+    // A real receiver, when one is configured; the simulation stands in otherwise
+    const QString positionSource = qEnvironmentVariable("NORDIC_POSITION_SOURCE");
+    if (!positionSource.isEmpty()) {
+        m_positionSource = QGeoPositionInfoSource::createSource(positionSource, this);
+        if (m_positionSource) {
+            m_positionSource->setUpdateInterval(kFixIntervalMs);
+            connect(m_positionSource, &QGeoPositionInfoSource::positionUpdated, this, &NavigationService::updatePosition);
+            qCInfo(vcNavigation) << "Position source:" << positionSource;
+        } else {
+            qWarning() << "No position source" << positionSource << "- simulating fixes";
+        }
+    }
+
+    // Mock traffic feed: re-rates the road ahead now and then
+    m_trafficFeedTimer = new QTimer(this);
+    m_trafficFeedTimer->setInterval(kTrafficFeedIntervalMs);
+    connect(m_trafficFeedTimer, &QTimer::timeout, this, [this]() {
+        if (m_traffic.isEmpty()) return;
+        const double ahead = m_matcher.match().offset;
+        updateTraffic(ahead, ahead + kTrafficFeedAheadMeters, mockCongestion());
+    });
     
     // Default Position (Stockholm)
     m_vehiclePosition = QGeoCoordinate(59.3293, 18.0686);
     m_vehicleBearing = 0;
+
+    // Offline place index (built by place_index_build); without one every
+    // search goes to the online geocoder
+    QString placesPath = qEnvironmentVariable("NORDIC_PLACE_INDEX");
+    if (placesPath.isEmpty())
+        placesPath = QStandardPaths::writableLocation(QStandardPaths::AppDataLocation) + "/routing/places.npi";
+    if (QFile::exists(placesPath) && m_places.open(placesPath))
+        qCInfo(vcNavigation) << "Offline place index:" << placesPath << m_places.placeCount() << "places";
+
+    // Offline routing graph (built by road_graph_build); without one every
+    // route goes to the online router
+    QString graphPath = qEnvironmentVariable("NORDIC_ROUTING_GRAPH");
+    if (graphPath.isEmpty())
+        graphPath = QStandardPaths::writableLocation(QStandardPaths::AppDataLocation) + "/routing/graph.nrg";
+    if (QFile::exists(graphPath) && m_roadGraph.open(graphPath)) {
+        m_router = std::make_unique<RoadRouter>(&m_roadGraph);
+        qCInfo(vcNavigation) << "Offline routing graph:" << graphPath << m_roadGraph.nodeCount() << "nodes";
+    }
 }
 
+NavigationService::~NavigationService() = default;
+
 bool NavigationService::isNavigating() const { return m_isNavigating; }
 QString NavigationService::destination() const { return m_destination; }
 QString NavigationService::nextManeuver() const { return m_nextManeuver; }
@@ -57,14 +195,31 @@ int NavigationService::distanceMeters() const { return m_distanceMeters; }
 QGeoCoordinate NavigationService::vehiclePosition() const { return m_vehiclePosition; }
 qreal NavigationService::vehicleBearing() const { return m_vehicleBearing; }
 
-QString NavigationService::distanceToManeuver() const {
-    if (m_distanceMeters >= 1000) return QString::number(m_distanceMeters / 1000.0, 'f', 1) + " km";
-    return QString::number(m_distanceMeters) + " m";
+QVariantList NavigationService::vehicleMotion() const {
+    QVariantList frames;
+    for (const VehicleMotion::Pose &pose : m_motion.keyframes()) {
+        QVariantMap frame;
+        frame["time"] = pose.timestampMs;
+        frame["latitude"] = pose.latitude;
+        frame["longitude"] = pose.longitude;
+        frame["bearing"] = pose.bearing;
+        frames.append(frame);
+    }
+    return frames;
+}
+
+// Built when a binding reads them, which is when what they show changed
+QString NavigationService::distanceToManeuver() const { return formatDistance(m_maneuverMeters); }
+QString NavigationService::distanceToDestination() const { return formatDistance(m_distanceMeters); }
+
+QString NavigationService::timeToDestination() const {
+    if (m_remainingMinutes < 60) return QString::number(m_remainingMinutes) + " min";
+    return QString("%1 h %2 min").arg(m_remainingMinutes / 60).arg(m_remainingMinutes % 60, 2, 10, QChar('0'));
 }
 
-QString NavigationService::distanceToDestination() const {
-    if (m_distanceMeters >= 1000) return QString::number(m_distanceMeters / 1000.0, 'f', 1) + " km";
-    return QString::number(m_distanceMeters) + " m";
+QString NavigationService::arrivalTime() const {
+    if (!m_isNavigating) return QString();
+    return QLocale().toString(QDateTime::fromMSecsSinceEpoch(m_arrivalMinute * 60000).time(), QLocale::ShortFormat);
 }
 
 QVariantList NavigationService::routeSteps() const {
@@ -95,7 +250,46 @@ int NavigationService::speedLimit() const {
 }
 
 QVariantList NavigationService::trafficSegments() const {
-    return m_trafficSegments;
+    QVariantList segments;
+    for (const TrafficModel::Run &run : m_traffic.runs()) {
+        if (run.congestion == TrafficModel::Unknown) continue;
+        QVariantMap segment;
+        segment["from"] = run.from;
+        segment["to"] = run.to;
+        segment["color"] = TrafficModel::color(run.congestion);
+        segments.append(segment);
+    }
+    return segments;
+}
+
+void NavigationService::updateTraffic(qreal fromMeters, qreal toMeters, TrafficModel::Congestion congestion) {
+    if (m_traffic.isEmpty()) return;
+    m_traffic.update(fromMeters, toMeters, congestion);
+    emit trafficChanged();
+}
+
+QVariantList NavigationService::routeLines(qreal zoomLevel, const QGeoRectangle &area) const {
+    if (!m_routeLod) return {};
+    return m_routeLod->lines(zoomLevel, area);
+}
+
+QVariantList NavigationService::trafficLines(qreal zoomLevel, const QGeoRectangle &area) const {
+    QVariantList lines;
+    if (!m_routeLod) return lines;
+    // One polyline per run, ending on the route point nearest its ends
+    for (const TrafficModel::Run &run : m_traffic.runs()) {
+        if (run.congestion == TrafficModel::Unknown) continue;
+        const QString color = TrafficModel::color(run.congestion);
+        const QVariantList paths =
+            m_routeLod->lines(zoomLevel, area, m_traffic.pointAt(run.from), m_traffic.pointAt(run.to));
+        for (const QVariant &path : paths) {
+            QVariantMap line;
+            line["path"] = path;
+            line["color"] = color;
+            lines.append(line);
+        }
+    }
+    return lines;
 }
 
 // Placeholder for search logic
@@ -103,7 +297,16 @@ void NavigationService::searchPlaces(const QString &query) {
     if (query.isEmpty()) return;
     qDebug() << "Searching Places:" << query;
     m_pendingSearchQuery = query;
-    m_searchDebounceTimer->start(); // Resets timer
+    // The offline index answers every keystroke; the online geocoder only
+    // once typing pauses, and only for what the index does not know
+    const QVariantList local = m_places.isOpen() ? m_places.search(query, m_vehiclePosition, kSearchResults)
+                                                 : QVariantList();
+    if (!local.isEmpty()) {
+        m_searchDebounceTimer->stop();
+        emit searchResultReceived(local);
+    } else {
+        m_searchDebounceTimer->start(); // Resets timer
+    }
     
     // Add to Recents immediately for UX responsiveness
     bool exists = false;
@@ -126,6 +329,12 @@ void NavigationService::onSearchFinished()
     QNetworkReply *reply = qobject_cast<QNetworkReply*>(sender());
     if (!reply) return;
 
+    // Typing went on and the offline index answered since
+    if (reply->property("query").toString() != m_pendingSearchQuery) {
+        reply->deleteLater();
+        return;
+    }
+
     if (reply->error() != QNetworkReply::NoError) {
         emit errorOccurred("Search failed: " + reply->errorString());
         reply->deleteLater();
@@ -175,8 +384,11 @@ void NavigationService::startNavigation(const QString &dest)
 
     m_isNavigating = true;
     m_destination = dest;
-    m_currentRoutePathIndex = 0;
     m_currentStepIndex = 0;
+    m_simulatedOffset = 0.0;
+    m_matcher.reset();
+    m_offRoute.reset();
+    m_motion.reset();
     
     // Snap to start
     if (!m_currentRoutePath.isEmpty()) {
@@ -198,7 +410,8 @@ void NavigationService::startNavigation(const QString &dest)
     
     emit navigationStateChanged();
     emit guidanceChanged();
-    m_simulationTimer->start(1000);
+    if (m_positionSource) m_positionSource->startUpdates();
+    else m_simulationTimer->start();
 }
 
 // -----------------------------------------------------------------------------
@@ -265,10 +478,25 @@ void NavigationService::stopNavigation()
 {
     m_isNavigating = false;
     m_destination = "";
+    ++m_routeRequests; // a route still being calculated is dropped on arrival
     m_simulationTimer->stop();
+    if (m_positionSource) m_positionSource->stopUpdates();
     m_currentRoutePath.clear();
     m_routeSteps.clear();
+    m_speedLimits.clear();
+    m_routeIndex.reset();
+    m_matcher = MapMatcher();
+    m_progress = RouteProgress();
+    m_voice = VoiceGuidance();
+    m_offRoute.reset();
+    m_rerouting = false;
+    m_motion.reset();
+    m_routeLod.reset();
+    m_traffic = TrafficModel();
+    m_trafficFeedTimer->stop();
     emit navigationStateChanged();
+    emit trafficChanged();
+    emit vehiclePositionChanged();
 }
 
 void NavigationService::calculateRoute(const QGeoCoordinate &start, const QGeoCoordinate &end)
@@ -277,38 +505,63 @@ void NavigationService::calculateRoute(const QGeoCoordinate &start, const QGeoCo
     m_speedLimit = 90;
     emit guidanceChanged();
 
+    requestRoute(start, end);
+}
+
+void NavigationService::requestRoute(const QGeoCoordinate &start, const QGeoCoordinate &end,
+                                     std::shared_ptr<const RouteSuffix> suffix)
+{
+    const quint64 request = ++m_routeRequests;
+    if (!m_router) {
+        requestOnlineRoute(start, end, request, suffix);
+        return;
+    }
+
+    // Offline route off the GUI thread; the router serializes its queries
+    RoadRouter *router = m_router.get();
+    auto *watcher = new QFutureWatcher<RouteResult>();
+    connect(watcher, &QFutureWatcher<RouteResult>::finished, this, [this, watcher, start, end, request, suffix]() {
+        const RouteResult result = watcher->result();
+        watcher->deleteLater();
+        // Beyond the installed map the online router may still know the way
+        if (!result.success && result.errorString == RoadRouter::OutsideMapError) {
+            requestOnlineRoute(start, end, request, suffix);
+            return;
+        }
+        routeReady(result, request, suffix);
+    });
+    watcher->setFuture(QtConcurrent::run([router, start, end, suffix]() {
+        RouteResult res = router->route(start, end);
+        if (res.success) prepareRoute(res, suffix.get());
+        return res;
+    }));
+}
+
+void NavigationService::requestOnlineRoute(const QGeoCoordinate &start, const QGeoCoordinate &end, quint64 request,
+                                           std::shared_ptr<const RouteSuffix> suffix)
+{
     // OSRM Demo API
-    QString urlStr = QString("http://router.project-osrm.org/route/v1/driving/%1,%2;%3,%4?overview=full&geometries=geojson&steps=true")
+    QString urlStr = QString("http://router.project-osrm.org/route/v1/driving/%1,%2;%3,%4?overview=full&geometries=geojson&steps=true&annotations=maxspeed")
                      .arg(start.longitude())
                      .arg(start.latitude())
                      .arg(end.longitude())
                      .arg(end.latitude());
     
     QUrl url(urlStr);
-    QNetworkRequest request(url);
-    QNetworkReply *reply = m_networkManager->get(request);
-    connect(reply, &QNetworkReply::finished, this, &NavigationService::onRouteFinished);
-}
-
-// Helper struct for background processing
-struct RouteResult {
-    QList<QGeoCoordinate> currentRoutePath;
-    QList<NavigationService::RouteStep> routeSteps;
-    QVariantList trafficSegments;
-    int distanceMeters;
-    QVariantMap routeData;
-    bool success = false;
-    QString errorString;
-};
-
-void NavigationService::onRouteFinished()
-{
-    QNetworkReply *reply = qobject_cast<QNetworkReply*>(sender());
-    if (!reply) return;
+    QNetworkRequest httpRequest(url);
+    QNetworkReply *reply = m_networkManager->get(httpRequest);
+    connect(reply, &QNetworkReply::finished, this, [this, reply, request, suffix]() {
+        onRouteFinished(reply, request, suffix);
+    });
+}
 
+void NavigationService::onRouteFinished(QNetworkReply *reply, quint64 request, std::shared_ptr<const RouteSuffix> suffix)
+{
     if (reply->error() != QNetworkReply::NoError) {
-        emit errorOccurred("Routing failed: " + reply->errorString());
+        RouteResult failed;
+        failed.errorString = "Routing failed: " + reply->errorString();
         reply->deleteLater();
+        routeReady(failed, request, suffix);
         return;
     }
 
@@ -318,180 +571,258 @@ void NavigationService::onRouteFinished()
 
     // Watcher to handle completion on main thread
     auto *watcher = new QFutureWatcher<RouteResult>();
-    connect(watcher, &QFutureWatcher<RouteResult>::finished, this, [this, watcher]() {
-        RouteResult result = watcher->result();
-        
-        if (!result.success) {
-             // Handle empty route case
-             emit errorOccurred(result.errorString.isEmpty() ? "No route found" : result.errorString);
-        } else {
-            m_currentRoutePath = result.currentRoutePath;
-            m_routeSteps = result.routeSteps;
-            m_trafficSegments = result.trafficSegments;
-            m_distanceMeters = result.distanceMeters;
-            
-            // Reset navigation state
-            m_currentRoutePathIndex = 0;
-            m_currentStepIndex = 0;
-            m_isNavigating = true;
-            m_maneuverIcon = "navigation-arrow.svg";
-            m_nextManeuver = "Follow route";
-            
-            checkManeuvers(); // Initial check
-            
-            emit routeCalculated(result.routeData);
-            emit navigationStateChanged();
-            
-            if (m_simulationTimer) m_simulationTimer->start(1000);
-        }
-        
+    connect(watcher, &QFutureWatcher<RouteResult>::finished, this, [this, watcher, request, suffix]() {
+        routeReady(watcher->result(), request, suffix);
         watcher->deleteLater();
     });
 
-    // Run parsing in background
-    QFuture<RouteResult> future = QtConcurrent::run([data]() -> RouteResult {
-        RouteResult res;
-        QJsonDocument doc = QJsonDocument::fromJson(data);
-        QJsonObject root = doc.object();
-        
-        if (root.contains("routes") && !root["routes"].toArray().isEmpty()) {
-            QJsonObject route = root["routes"].toArray().first().toObject();
-            QJsonObject geometry = route["geometry"].toObject();
-            QJsonArray coords = geometry["coordinates"].toArray();
-            
-            // Extract Path
-            QVariantList pathViz;
-            for (const QJsonValue &pt : coords) {
-                QJsonArray point = pt.toArray();
-                double lon = point[0].toDouble();
-                double lat = point[1].toDouble();
-                QGeoCoordinate coord(lat, lon);
-                
-                res.currentRoutePath.append(coord);
-                pathViz.append(QVariant::fromValue(coord));
-            }
-            
-            // Generate Traffic Segments
-            if (res.currentRoutePath.size() > 2) {
-                int chunkSize = 20; 
-                for (int i = 0; i < res.currentRoutePath.size(); i += chunkSize) {
-                    QVariantList segmentPath;
-                    int end = qMin(i + chunkSize + 1, (int)res.currentRoutePath.size());
-                    for (int j = i; j < end; j++) {
-                        segmentPath.append(QVariant::fromValue(res.currentRoutePath[j]));
-                    }
-                    
-                    // Random Traffic Color (Thread-safe global access)
-                    QString color = "#4CAF50"; 
-                    int rand = QRandomGenerator::global()->bounded(100);
-                    if (rand > 80) color = "#F44336"; 
-                    else if (rand > 60) color = "#FF9800"; 
-                    
-                    QVariantMap segment;
-                    segment["path"] = segmentPath;
-                    segment["color"] = color;
-                    res.trafficSegments.append(segment);
-                }
-            }
-            
-            // Extract Steps
-            if (route.contains("legs")) {
-                 QJsonArray legs = route["legs"].toArray();
-                 if (!legs.isEmpty()) {
-                    QJsonArray steps = legs.first().toObject()["steps"].toArray();
-                    for (const QJsonValue &s : steps) {
-                        QJsonObject stepObj = s.toObject();
-                        QJsonObject maneuver = stepObj["maneuver"].toObject();
-                        QJsonArray loc = maneuver["location"].toArray(); 
-                        
-                        NavigationService::RouteStep step;
-                        step.distance = stepObj["distance"].toInt();
-                        step.maneuverCoordinate = QGeoCoordinate(loc[1].toDouble(), loc[0].toDouble());
-                        
-                        QString type = maneuver["type"].toString(); 
-                        QString modifier = maneuver["modifier"].toString(); 
-                        QString name = stepObj["name"].toString();
-                        
-                        step.modifier = modifier;
-                        
-                        if (type == "depart") step.instruction = "Head to " + name;
-                        else if (type == "arrive") step.instruction = "Arrive at destination";
-                        else if (name.isEmpty()) step.instruction = type + " " + modifier;
-                        else step.instruction = type + " " + modifier + " on " + name;
-                        
-                        step.instruction = step.instruction.left(1).toUpper() + step.instruction.mid(1);
-                        
-                        res.routeSteps.append(step);
-                    }
-                 }
-            }
-            
-            res.routeData["path"] = pathViz;
-            res.routeData["duration"] = route["duration"].toDouble();
-            res.routeData["distance"] = route["distance"].toDouble();
-            res.distanceMeters = route["distance"].toInt();
-            res.success = true;
-        } else {
-            res.success = false;
-        }
-        
+    // Run parsing in background, straight from the bytes
+    QFuture<RouteResult> future = QtConcurrent::run([data, suffix]() -> RouteResult {
+        RouteResult res = RouteResponseParser::parse(data);
+        if (res.success) prepareRoute(res, suffix.get());
         return res;
     });
 
     watcher->setFuture(future);
 }
 
-void NavigationService::updateSimulation()
+void NavigationService::routeReady(const RouteResult &result, quint64 request,
+                                   const std::shared_ptr<const RouteSuffix> &suffix)
+{
+    // A later request supersedes this one
+    if (request != m_routeRequests) return;
+    if (!suffix) {
+        applyRoute(result);
+        return;
+    }
+
+    // Back on the route meanwhile, the route stands; without a way back it
+    // stands too, until the car is found off it again
+    m_rerouting = false;
+    if (!m_isNavigating || !m_offRoute.isOffRoute()) return;
+    if (!result.success) {
+        qWarning() << "Reroute failed:" << result.errorString;
+        m_offRoute.reset();
+        return;
+    }
+    swapRoute(result);
+}
+
+void NavigationService::applyRoute(const RouteResult &result)
 {
-    if (!m_isNavigating || m_currentRoutePath.isEmpty()) return;
+    if (!result.success) {
+         // Handle empty route case
+         emit errorOccurred(result.errorString.isEmpty() ? "No route found" : result.errorString);
+         return;
+    }
+    m_currentRoutePath = result.currentRoutePath;
+    m_routeSteps = result.routeSteps;
+    m_speedLimits = result.speedLimits;
+    m_routeIndex = result.index;
+    m_matcher = result.matcher;
+    m_traffic = result.traffic;
+    m_routeLod = result.lod;
+    m_routeSeconds = result.routeData.value("duration").toDouble();
+    m_progress = result.progress;
+    m_voice = result.voice;
+    m_voice.setLeadSeconds(m_promptLatencyMs / 1000.0);
+    m_offRoute.reset();
+    m_rerouting = false;
+    m_trafficFeedTimer->start();
     
-    // Move along path
-    if (m_currentRoutePathIndex < m_currentRoutePath.size() - 1) {
-        QGeoCoordinate current = m_currentRoutePath[m_currentRoutePathIndex];
-        QGeoCoordinate next = m_currentRoutePath[m_currentRoutePathIndex + 1];
-        
-        m_vehicleBearing = current.azimuthTo(next);
-        m_vehiclePosition = next;
-        m_currentRoutePathIndex++;
-        
-        // Update distance
-        if (m_distanceMeters > 0) m_distanceMeters -= current.distanceTo(next);
-        
-        // Maneuver Logic
-        checkManeuvers();
-        
-        emit vehiclePositionChanged();
-        emit guidanceChanged(); 
-        
-    } else {
+    // Reset navigation state
+    m_currentStepIndex = 0;
+    m_simulatedOffset = 0.0;
+    m_isNavigating = true;
+    updateEstimates(0.0, QDateTime::currentMSecsSinceEpoch());
+    m_maneuverIcon = "navigation-arrow.svg";
+    m_nextManeuver = "Follow route";
+    
+    emit routeCalculated(result.routeData);
+    emit trafficChanged();
+    emit navigationStateChanged();
+    
+    if (m_positionSource) m_positionSource->startUpdates();
+    else m_simulationTimer->start();
+}
+
+void NavigationService::updateSimulation()
+{
+    if (!m_isNavigating || !m_routeIndex || m_routeIndex->isEmpty()) return;
+    if (m_simulatedOffset >= m_routeIndex->length()) {
         stopNavigation();
         m_nextManeuver = "Arrived";
         emit voiceInstruction("You have arrived.");
         emit guidanceChanged();
+        return;
     }
+
+    // Drive along the route at the limit
+    int segment = m_routeIndex->segmentAt(m_simulatedOffset);
+    const int limit = segment < m_speedLimits.size() && m_speedLimits[segment] ? m_speedLimits[segment] : kSimulationSpeedKmh;
+    m_simulatedOffset = std::min(m_simulatedOffset + limit / 3.6 * kFixIntervalMs / 1000.0, m_routeIndex->length());
+    segment = m_routeIndex->segmentAt(m_simulatedOffset);
+    const QGeoCoordinate from = m_currentRoutePath.at(segment), to = m_currentRoutePath.at(segment + 1);
+    const QGeoCoordinate truth = m_routeIndex->coordinateAt(m_simulatedOffset);
+
+    // Reported as a receiver would, a few metres off
+    std::normal_distribution<double> noise(0.0, 1.0);
+    QRandomGenerator *rng = QRandomGenerator::global();
+    const double north = noise(*rng) * kSimulationNoiseMeters, east = noise(*rng) * kSimulationNoiseMeters;
+    QGeoPositionInfo fix(truth.atDistanceAndAzimuth(std::hypot(north, east), qRadiansToDegrees(std::atan2(east, north))),
+                         QDateTime::currentDateTimeUtc());
+    fix.setAttribute(QGeoPositionInfo::Direction,
+                     std::fmod(from.azimuthTo(to) + noise(*rng) * kSimulationHeadingNoise + 360.0, 360.0));
+    fix.setAttribute(QGeoPositionInfo::GroundSpeed, limit / 3.6);
+    updatePosition(fix);
 }
 
-void NavigationService::checkManeuvers() {
-    if (m_currentStepIndex >= m_routeSteps.size()) return;
-    
-    RouteStep currentStep = m_routeSteps[m_currentStepIndex];
-    double distToManeuver = m_vehiclePosition.distanceTo(currentStep.maneuverCoordinate);
-    
-    // If we are very close to the maneuver point (<30m), assume we made the turn and switch to next
-    if (distToManeuver < 30) {
+void NavigationService::updatePosition(const QGeoPositionInfo &info)
+{
+    if (!m_isNavigating || !info.isValid()) return;
+    MapMatcher::Fix fix;
+    fix.latitude = info.coordinate().latitude();
+    fix.longitude = info.coordinate().longitude();
+    if (info.hasAttribute(QGeoPositionInfo::Direction)) fix.heading = info.attribute(QGeoPositionInfo::Direction);
+    if (info.hasAttribute(QGeoPositionInfo::GroundSpeed)) fix.speed = info.attribute(QGeoPositionInfo::GroundSpeed);
+    fix.timestampMs = info.timestamp().toMSecsSinceEpoch();
+
+    const MapMatcher::Match match = m_matcher.push(fix);
+    const bool wasOffRoute = m_offRoute.isOffRoute();
+    const bool offRoute = m_offRoute.update(fix, match);
+    // The map hears of the position only when the motion it draws changes
+    const qint64 now = QDateTime::currentMSecsSinceEpoch();
+    bool moved;
+    if (match.onRoute && !offRoute) {
+        m_vehiclePosition = QGeoCoordinate(match.latitude, match.longitude);
+        m_vehicleBearing = match.bearing;
+        moved = m_motion.follow(*m_routeIndex, match, now);
+        advanceGuidance(match, fix.timestampMs);
+    } else {
+        // Away from the route: shown where the receiver puts it
+        m_vehiclePosition = info.coordinate();
+        if (fix.heading >= 0.0) m_vehicleBearing = fix.heading;
+        moved = m_motion.follow(fix, now);
+    }
+    if (moved) emit vehiclePositionChanged();
+    if (offRoute && !wasOffRoute) reroute(info.coordinate());
+}
+
+void NavigationService::reroute(const QGeoCoordinate &from)
+{
+    if (m_rerouting || !m_routeIndex || m_routeIndex->isEmpty()) return;
+    m_rerouting = true;
+
+    // Only the way back to the route is new, unless it has no rejoin point left
+    auto suffix = std::make_shared<const RouteSuffix>(*m_routeIndex, m_routeSteps, m_speedLimits, m_traffic,
+                                                      m_routeSeconds, m_matcher.match().offset);
+    const QGeoCoordinate to = suffix->isEmpty() ? m_currentRoutePath.last() : suffix->start();
+    qCInfo(vcNavigation) << "Off route, rerouting"
+                         << (suffix->isEmpty() ? QString("to the destination")
+                                               : QString("to rejoin %1 km before the destination")
+                                                     .arg(suffix->length() / 1000.0, 0, 'f', 1));
+    emit voiceInstruction("Recalculating route.");
+    requestRoute(from, to, suffix);
+}
+
+void NavigationService::swapRoute(const RouteResult &result)
+{
+    // All of the route changes before anything is told: the map redraws
+    // once, guidance is read once, and nothing sees half of each route
+    m_currentRoutePath = result.currentRoutePath;
+    m_routeSteps = result.routeSteps;
+    m_speedLimits = result.speedLimits;
+    m_routeIndex = result.index;
+    m_matcher = result.matcher;
+    m_traffic = result.traffic;
+    m_routeLod = result.lod;
+    m_routeSeconds = result.routeData.value("duration").toDouble();
+    // The pace so far holds on the way back
+    RouteProgress progress = result.progress;
+    progress.continueFrom(m_progress);
+    m_progress = progress;
+    m_voice = result.voice;
+    m_voice.setLeadSeconds(m_promptLatencyMs / 1000.0);
+    m_offRoute.reset();
+    m_currentStepIndex = 0;
+    m_simulatedOffset = 0.0;
+    updateEstimates(0.0, QDateTime::currentMSecsSinceEpoch());
+    if (!m_routeSteps.isEmpty()) {
+        m_nextManeuver = m_routeSteps[0].instruction;
+        m_maneuverIcon = iconForModifier(m_routeSteps[0].modifier);
+    }
+
+    emit routeCalculated(result.routeData);
+    emit trafficChanged();
+    emit guidanceChanged();
+    emit voiceInstruction(m_nextManeuver);
+}
+
+void NavigationService::advanceGuidance(const MapMatcher::Match &match, qint64 timestampMs)
+{
+    const int step = m_currentStepIndex;
+    const int limit = m_speedLimit;
+    const QString road = m_currentRoadName;
+
+    // Maneuvers the matched position has passed are done
+    while (m_currentStepIndex < m_routeSteps.size() && m_routeSteps[m_currentStepIndex].offset <= match.offset) {
+        m_currentRoadName = m_routeSteps[m_currentStepIndex].roadName;
         m_currentStepIndex++;
-        if (m_currentStepIndex < m_routeSteps.size()) {
-             m_nextManeuver = m_routeSteps[m_currentStepIndex].instruction;
-             QString mod = m_routeSteps[m_currentStepIndex].modifier;
-             if (mod.contains("left")) m_maneuverIcon = "turn_left.svg";
-             else if (mod.contains("right")) m_maneuverIcon = "turn_right.svg";
-             else if (mod.contains("u-turn")) m_maneuverIcon = "u_turn.svg"; 
-             else m_maneuverIcon = "navigation-arrow.svg";
-             
-             emit voiceInstruction(m_nextManeuver + " in " + QString::number(m_routeSteps[m_currentStepIndex].distance) + " meters");
-        }
     }
-    
-    // Voice Triggers for approaching turn
-    // (This required tracking 'state' of voice to avoid spamming, for this MVP we just trigger on index change above)
+    if (m_currentStepIndex != step && m_currentStepIndex < m_routeSteps.size()) {
+        const RouteStep &next = m_routeSteps[m_currentStepIndex];
+        m_nextManeuver = next.instruction;
+        m_maneuverIcon = iconForModifier(next.modifier);
+    }
+    if (const VoiceGuidance::Prompt *prompt = m_voice.update(match.offset, match.speed, timestampMs))
+        emit voiceInstruction(promptText(*prompt));
+    if (match.segment < m_speedLimits.size()) m_speedLimit = m_speedLimits[match.segment];
+    m_progress.update(match.segment, match.offset, timestampMs);
+    const bool estimates = updateEstimates(match.offset, timestampMs);
+
+    // Guidance bindings only re-evaluate when what they show changes
+    if (estimates || m_currentStepIndex != step || m_speedLimit != limit || m_currentRoadName != road)
+        emit guidanceChanged();
+}
+
+void NavigationService::setPromptLatency(int ms)
+{
+    m_promptLatencyMs = ms;
+    m_voice.setLeadSeconds(ms / 1000.0);
+}
+
+QString NavigationService::promptText(const VoiceGuidance::Prompt &prompt) const
+{
+    auto lowered = [](const QString &text) { return text.left(1).toLower() + text.mid(1); };
+    const QString &instruction = m_routeSteps[prompt.step].instruction;
+    QString text = instruction;
+    if (prompt.kind != VoiceGuidance::Now) {
+        const QString distance = prompt.meters == 1000 ? QString("1 kilometer")
+                                 : prompt.meters > 1000 ? QString::number(prompt.meters / 1000.0) + " kilometers"
+                                                        : QString::number(prompt.meters) + " meters";
+        text = "In " + distance + ", " + lowered(instruction);
+    }
+    if (prompt.then && prompt.step + 1 < m_routeSteps.size())
+        text += ", then " + lowered(m_routeSteps[prompt.step + 1].instruction);
+    return text;
+}
+
+bool NavigationService::updateEstimates(double offset, qint64 timestampMs)
+{
+    const int maneuver = m_maneuverMeters, remaining = m_distanceMeters, minutes = m_remainingMinutes;
+    const qint64 arrival = m_arrivalMinute;
+
+    m_distanceMeters = qRound(m_progress.remainingMeters());
+    m_maneuverMeters = m_currentStepIndex < m_routeSteps.size()
+                           ? qRound(std::max(0.0, m_routeSteps[m_currentStepIndex].offset - offset))
+                           : m_distanceMeters;
+    const double seconds = m_progress.remainingSeconds();
+    m_remainingMinutes = int(std::ceil(seconds / 60.0));
+    // Held unless it moves by more than the slack, so an estimate about
+    // the turn of a minute does not flick between the two
+    const double estimate = (timestampMs + seconds * 1000.0) / 60000.0;
+    if (std::abs(estimate - m_arrivalMinute) > kArrivalSlackMinutes) m_arrivalMinute = qRound64(estimate);
+
+    return shownMeters(m_maneuverMeters) != shownMeters(maneuver) || shownMeters(m_distanceMeters) != shownMeters(remaining)
+           || m_remainingMinutes != minutes || m_arrivalMinute != arrival;
 }
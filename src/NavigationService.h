@@ -8,26 +8,44 @@
 #include <QJsonObject>
 #include <QJsonArray>
 #include <QGeoCoordinate>
+#include <QGeoPositionInfo>
+#include <QGeoRectangle>
+#include <QLoggingCategory>
 #include <QTimer>
+#include <memory>
+#include "Navigation/OffRouteDetector.h"
+#include "Navigation/PlaceIndex.h"
+#include "Navigation/RoadGraph.h"
+#include "Navigation/RouteResult.h"
+#include "Navigation/VehicleMotion.h"
+
+class QGeoPositionInfoSource;
+class RoadRouter;
+class RouteLod;
+class RouteSuffix;
 
 class NavigationService : public QObject
 {
     Q_OBJECT
     Q_PROPERTY(QGeoCoordinate vehiclePosition READ vehiclePosition NOTIFY vehiclePositionChanged)
     Q_PROPERTY(qreal vehicleBearing READ vehicleBearing NOTIFY vehiclePositionChanged)
+    Q_PROPERTY(QVariantList vehicleMotion READ vehicleMotion NOTIFY vehiclePositionChanged)
     Q_PROPERTY(bool isNavigating READ isNavigating NOTIFY navigationStateChanged)
     Q_PROPERTY(QString nextManeuver READ nextManeuver NOTIFY guidanceChanged)
     Q_PROPERTY(QString distanceToManeuver READ distanceToManeuver NOTIFY guidanceChanged)
     Q_PROPERTY(QString destination READ destination NOTIFY navigationStateChanged)
     Q_PROPERTY(QString currentRoadName READ currentRoadName NOTIFY guidanceChanged)
     Q_PROPERTY(int speedLimit READ speedLimit NOTIFY guidanceChanged)
-    Q_PROPERTY(QVariantList trafficSegments READ trafficSegments NOTIFY routeCalculated)
+    Q_PROPERTY(QVariantList trafficSegments READ trafficSegments NOTIFY trafficChanged)
     Q_PROPERTY(QString distanceToDestination READ distanceToDestination NOTIFY guidanceChanged)
+    Q_PROPERTY(QString timeToDestination READ timeToDestination NOTIFY guidanceChanged)
+    Q_PROPERTY(QString arrivalTime READ arrivalTime NOTIFY guidanceChanged)
     Q_PROPERTY(QString maneuverIcon READ maneuverIcon NOTIFY guidanceChanged)
     Q_PROPERTY(QVariantList routeSteps READ routeSteps NOTIFY routeCalculated)
 
 public:
     explicit NavigationService(QObject *parent = nullptr);
+    ~NavigationService() override;
 
     bool isNavigating() const;
     QString destination() const;
@@ -37,12 +55,18 @@ public:
     int speedLimit() const;
     QVariantList trafficSegments() const;
     QString distanceToDestination() const;
+    QString timeToDestination() const;
+    QString arrivalTime() const; // local time, empty when not navigating
     QString maneuverIcon() const;
     QVariantList routeSteps() const;
     int distanceMeters() const;
+    const RoutePath &routePath() const { return m_currentRoutePath; }
     
     QGeoCoordinate vehiclePosition() const;
     qreal vehicleBearing() const;
+    // Keyframes {time, latitude, longitude, bearing} for the map to
+    // interpolate; empty when the vehicle stands where vehiclePosition is
+    QVariantList vehicleMotion() const;
 
     Q_INVOKABLE void startNavigation(const QString &dest);
     Q_INVOKABLE void stopNavigation();
@@ -56,14 +80,19 @@ public:
     Q_INVOKABLE void searchCategory(const QString &category); // "Gas", "Food"
     Q_INVOKABLE void clearMapPins();
     Q_INVOKABLE void calculateRoute(const QGeoCoordinate &start, const QGeoCoordinate &end);
+
+    // Route and traffic polylines simplified for the zoom level, cut to the
+    // stretches through `area` (the whole route if invalid)
+    Q_INVOKABLE QVariantList routeLines(qreal zoomLevel, const QGeoRectangle &area) const;
+    Q_INVOKABLE QVariantList trafficLines(qreal zoomLevel, const QGeoRectangle &area) const;
+    // Traffic feed: rates metres `fromMeters` to `toMeters` of the route
+    void updateTraffic(qreal fromMeters, qreal toMeters, TrafficModel::Congestion congestion);
+    // From voiceInstruction to the prompt being heard, so it is heard at
+    // the distance it announces
+    void setPromptLatency(int ms);
     
-    // Route Data Type
-    struct RouteStep {
-        QString instruction;
-        QString modifier; // left, right, slight right
-        int distance; // meters
-        QGeoCoordinate maneuverCoordinate;
-    };
+    // Route Data Type (shared with the offline router)
+    using RouteStep = ::RouteStep;
 
     QVariantList recentSearches() const;
     QVariantList mapPins() const;
@@ -71,27 +100,34 @@ public:
 signals:
     void navigationStateChanged();
     void guidanceChanged();
-    void vehiclePositionChanged(); // New signal for simulation
-    void voiceInstruction(const QString &text); // TTS signal
+    void vehiclePositionChanged(); // with each published motion, about once a second
+    void voiceInstruction(const QString &text); // TTS signal, ahead of the point it is to be heard
     void searchResultReceived(const QVariantList &results);
     void recentSearchesChanged();
     void mapPinsChanged();
     void routeCalculated(const QVariantMap &routeData);
+    void trafficChanged();
     void errorOccurred(const QString &message);
 
 private slots:
     void onSearchFinished();
-    void onRouteFinished();
+    void updatePosition(const QGeoPositionInfo &info); // a GNSS fix, real or simulated
 
 private:
     bool m_isNavigating;
     QString m_destination;
     QString m_nextManeuver;
     QString m_maneuverIcon;
-    int m_distanceMeters;
+    int m_distanceMeters;           // to the destination
+    int m_maneuverMeters = 200;     // to the next maneuver
+    int m_remainingMinutes = 0;
+    qint64 m_arrivalMinute = 0;     // minutes since the epoch
     QString m_currentRoadName;
 
     QNetworkAccessManager *m_networkManager;
+    PlaceIndex m_places;                  // offline geocoder, when installed
+    RoadGraph m_roadGraph;                // offline routing graph, when installed
+    std::unique_ptr<RoadRouter> m_router; // null without a graph: online routing only
     QTimer *m_simulationTimer;
     QTimer *m_searchDebounceTimer;
     QString m_pendingSearchQuery;
@@ -104,18 +140,46 @@ private:
     QGeoCoordinate m_vehiclePosition;
     qreal m_vehicleBearing;
     
-    QList<QGeoCoordinate> m_currentRoutePath;
+    RoutePath m_currentRoutePath;
+    QList<quint8> m_speedLimits; // km/h per path segment
+    std::shared_ptr<const RouteIndex> m_routeIndex; // shared with the matcher
+    MapMatcher m_matcher;
+    RouteProgress m_progress;
+    VoiceGuidance m_voice;
+    int m_promptLatencyMs = 0;
+    VehicleMotion m_motion;
+    QGeoPositionInfoSource *m_positionSource = nullptr; // null: simulated fixes
+    double m_simulatedOffset = 0.0; // metres along the route driven by the simulation
+    double m_routeSeconds = 0.0;    // expected duration of the route
+    OffRouteDetector m_offRoute;
+    bool m_rerouting = false;       // a reroute is being computed
+    quint64 m_routeRequests = 0;    // only the latest request's route is taken
     
     // Search Data
     QVariantList m_recentSearches;
     QVariantList m_mapPins;
     
     int m_speedLimit = 90; // Default
-    int m_currentRoutePathIndex; // Replaces m_currentRouteIndex to avoid confusion
-    QVariantList m_trafficSegments;
+    TrafficModel m_traffic;
+    QTimer *m_trafficFeedTimer;
+    std::shared_ptr<const RouteLod> m_routeLod;
     
+    // A route from `start` to `end`; with a suffix, a reroute that joins it
+    void requestRoute(const QGeoCoordinate &start, const QGeoCoordinate &end,
+                      std::shared_ptr<const RouteSuffix> suffix = nullptr);
+    void requestOnlineRoute(const QGeoCoordinate &start, const QGeoCoordinate &end, quint64 request,
+                            std::shared_ptr<const RouteSuffix> suffix);
+    void onRouteFinished(QNetworkReply *reply, quint64 request, std::shared_ptr<const RouteSuffix> suffix);
+    void routeReady(const RouteResult &result, quint64 request, const std::shared_ptr<const RouteSuffix> &suffix);
+    void applyRoute(const RouteResult &result);
+    void reroute(const QGeoCoordinate &from); // off the route: back to it, or to the destination
+    void swapRoute(const RouteResult &result); // the reroute in place of the route, in one update
     void updateSimulation(); // Tick method
-    void checkManeuvers(); // Check if passed a maneuver
+    void advanceGuidance(const MapMatcher::Match &match, qint64 timestampMs); // steps, road and limit at the matched position
+    bool updateEstimates(double offset, qint64 timestampMs); // distances and times left; whether what is shown changed
+    QString promptText(const VoiceGuidance::Prompt &prompt) const;
 };
 
+Q_DECLARE_LOGGING_CATEGORY(vcNavigation)
+
 #endif // NAVIGATIONSERVICE_H
@@ -0,0 +1,155 @@
+#include "AfFollower.h"
+#include <algorithm>
+
+namespace {
+
+constexpr double kSmoothing = 0.2; // per reading; ~0.5 s at 100 ms readings
+
+} // namespace
+
+// =============================================================================
+// FOLLOWER
+// =============================================================================
+
+void AfFollower::reset()
+{
+    m_frequency = 0;
+    m_pi = 0;
+    m_alternatives.clear();
+    m_hasReading = false;
+    m_smoothed = 0.0;
+    m_weak = false;
+    m_weakSince = 0;
+    m_lastSwitch = INT64_MIN / 2;
+    m_lastCheck = INT64_MIN / 2;
+    m_checking = false;
+}
+
+void AfFollower::setNetwork(int frequency, uint16_t pi, const std::vector<int> &afs)
+{
+    if (frequency != m_frequency || pi != m_pi) {
+        reset();
+        m_frequency = frequency;
+        m_pi = pi;
+    }
+
+    // Keep what is known about AFs that stay in the list
+    std::vector<Alternative> next;
+    next.reserve(afs.size());
+    for (int f : afs) {
+        if (f == m_frequency) continue;
+        if (std::any_of(next.begin(), next.end(), [f](const Alternative &a) { return a.frequency == f; })) continue;
+        const Alternative *known = find(f);
+        if (known) {
+            next.push_back(*known);
+        } else {
+            Alternative a;
+            a.frequency = f;
+            next.push_back(a);
+        }
+    }
+    m_alternatives.swap(next);
+}
+
+AfFollower::Decision AfFollower::update(int64_t nowMs, int snr)
+{
+    if (!m_hasReading) {
+        m_smoothed = snr;
+        m_hasReading = true;
+    } else {
+        m_smoothed += (snr - m_smoothed) * kSmoothing;
+    }
+    if (!m_weak && m_smoothed < m_config.weakSnr) {
+        m_weak = true;
+        m_weakSince = nowMs;
+    } else if (m_weak && m_smoothed >= m_config.recoverSnr) {
+        m_weak = false;
+    }
+
+    Decision decision;
+    if (!isActive()) return decision;
+
+    if (m_weak && nowMs - m_weakSince >= m_config.weakHoldMs && nowMs - m_lastSwitch >= m_config.dwellMs) {
+        const Alternative *best = nullptr;
+        for (const Alternative &a : m_alternatives) {
+            // Quality and PI must both be recent: a fading network transmitter
+            // can be overtaken by another station on the same frequency
+            if (a.verifiedAt < 0 || nowMs - a.verifiedAt > m_config.freshMs) continue;
+            if (a.snr < m_smoothed + m_config.switchMargin || a.snr < m_config.weakSnr) continue;
+            if (!best || a.snr > best->snr) best = &a;
+        }
+        if (best) {
+            decision.action = Switch;
+            decision.frequency = best->frequency;
+            return decision;
+        }
+    }
+
+    // One check at a time on the background tuner
+    if (m_checking) return decision;
+    if (nowMs - m_lastCheck < (m_weak ? 0 : m_config.idleCheckMs)) return decision;
+    Alternative *next = nullptr;
+    for (Alternative &a : m_alternatives) {
+        if (a.blockedUntil > nowMs) continue;
+        if (!next || a.checkedAt < next->checkedAt) next = &a;
+    }
+    if (!next) return decision;
+
+    next->checkedAt = nowMs;
+    m_lastCheck = nowMs;
+    m_checking = true;
+    ++m_stats.checks;
+    decision.action = Check;
+    decision.frequency = next->frequency;
+    return decision;
+}
+
+void AfFollower::checkResult(int64_t nowMs, int frequency, int snr, int pi)
+{
+    m_checking = false;
+    Alternative *a = find(frequency);
+    if (!a || snr < 0) return;
+
+    // Two checks close together are averaged against fast fading
+    const bool recent = a->measuredAt >= 0 && nowMs - a->measuredAt <= 2 * m_config.freshMs;
+    a->snr = recent ? (a->snr + snr) / 2.0 : snr;
+    a->measuredAt = nowMs;
+    if (pi == m_pi) {
+        a->verifiedAt = nowMs;
+    } else if (pi >= 0) {
+        a->verifiedAt = -1;
+        a->blockedUntil = nowMs + m_config.blockMs;
+        ++m_stats.piMismatches;
+    }
+}
+
+void AfFollower::switched(int64_t nowMs, int frequency)
+{
+    const int from = m_frequency;
+    Alternative *a = find(frequency);
+    const double snr = a ? a->snr : m_smoothed;
+
+    // The frequency left behind becomes an alternate with what is known of it
+    if (a) {
+        *a = Alternative();
+        a->frequency = from;
+        a->snr = m_smoothed;
+        a->measuredAt = nowMs;
+        a->verifiedAt = nowMs;
+        a->checkedAt = nowMs;
+    }
+    m_frequency = frequency;
+    m_smoothed = snr;
+    m_weak = false;
+    m_lastSwitch = nowMs;
+    m_checking = false;
+    ++m_stats.switches;
+}
+
+AfFollower::Alternative *AfFollower::find(int frequency)
+{
+    for (Alternative &a : m_alternatives) {
+        if (a.frequency == frequency) return &a;
+    }
+    return nullptr;
+}
@@ -0,0 +1,108 @@
+#ifndef AFFOLLOWER_H
+#define AFFOLLOWER_H
+
+#include <cstdint>
+#include <vector>
+
+/**
+ * @brief RDS alternative-frequency following policy.
+ *
+ * Fed with the quality of the tuned frequency at a steady rate (the HAL's
+ * ProgressIntervalMs) and with the results of AF checks made on the
+ * background tuner, so checking never interrupts the audio. Decides which
+ * alternate to check next and when to switch:
+ *
+ * - The tuned SNR is smoothed; it counts as fading below weakSnr and as
+ *   recovered only above recoverSnr.
+ * - While the station is fine the AFs are checked slowly, round robin, so
+ *   fresh measurements exist when it starts to fade; while fading, one per
+ *   reading.
+ * - A switch needs the fade to have lasted weakHoldMs, an alternate whose
+ *   PI was verified and whose quality was measured within freshMs, and
+ *   that alternate to beat the tuned SNR by switchMargin. No switch follows
+ *   another within dwellMs.
+ * - An AF found carrying a different PI (frequency reuse elsewhere) is not
+ *   checked again for blockMs.
+ *
+ * Time is passed in by the caller (milliseconds, any epoch), which lets
+ * the benchmark replay drive traces faster than real time.
+ */
+class AfFollower
+{
+public:
+    struct Config {
+        int weakSnr = 14;        // dB, smoothed
+        int recoverSnr = 18;     // dB, smoothed
+        int switchMargin = 6;    // dB
+        int weakHoldMs = 1000;
+        int dwellMs = 12000;
+        int freshMs = 1500;
+        int idleCheckMs = 3000;
+        int blockMs = 60000;
+    };
+
+    enum Action { None, Check, Switch };
+
+    struct Decision {
+        Action action = None;
+        int frequency = 0;
+    };
+
+    struct Stats {
+        uint64_t checks = 0;
+        uint64_t piMismatches = 0;
+        uint64_t switches = 0;
+    };
+
+    AfFollower() = default;
+    explicit AfFollower(const Config &config) : m_config(config) {}
+
+    void reset();
+    // Network of the tuned station (RDS PI and AF list, which may include
+    // the tuned frequency itself). Keeps the gathered measurements while
+    // frequency and PI stay the same.
+    void setNetwork(int frequency, uint16_t pi, const std::vector<int> &afs);
+    bool isActive() const { return m_pi != 0 && !m_alternatives.empty(); }
+    int frequency() const { return m_frequency; }
+    bool isFading() const { return m_weak; }
+    double smoothedSnr() const { return m_smoothed; }
+
+    // Quality of the tuned frequency; returns the next step to take
+    Decision update(int64_t nowMs, int snr);
+    // An AF check ended: SNR there and the PI decoded (-1: none in time).
+    // An SNR of -1 means the check could not run (background tuner busy).
+    void checkResult(int64_t nowMs, int frequency, int snr, int pi);
+    // The tuner moved to `frequency` after a Switch decision
+    void switched(int64_t nowMs, int frequency);
+
+    const Stats &stats() const { return m_stats; }
+
+private:
+    struct Alternative {
+        int frequency = 0;
+        double snr = 0.0;
+        int64_t measuredAt = -1;
+        int64_t verifiedAt = -1;   // PI matched
+        int64_t blockedUntil = -1; // PI mismatched
+        int64_t checkedAt = -1;
+    };
+
+    Alternative *find(int frequency);
+
+    Config m_config;
+    int m_frequency = 0;
+    uint16_t m_pi = 0;
+    std::vector<Alternative> m_alternatives;
+
+    bool m_hasReading = false;
+    double m_smoothed = 0.0;
+    bool m_weak = false;
+    int64_t m_weakSince = 0;
+    int64_t m_lastSwitch = INT64_MIN / 2;
+    int64_t m_lastCheck = INT64_MIN / 2;
+    bool m_checking = false;
+
+    Stats m_stats;
+};
+
+#endif // AFFOLLOWER_H
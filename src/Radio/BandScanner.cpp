@@ -0,0 +1,117 @@
+#include "BandScanner.h"
+#include <QDebug>
+
+BandScanner::BandScanner(IRadioHAL *hal, QObject *parent)
+    : QObject(parent),
+      m_hal(hal)
+{
+    m_model = new StationListModel(this);
+    if (m_hal) {
+        connect(m_hal, &IRadioHAL::scanMeasured, this, &BandScanner::onMeasured);
+        connect(m_hal, &IRadioHAL::scanFinished, this, &BandScanner::onFinished);
+    }
+}
+
+double BandScanner::progress() const {
+    const IRadioHAL::BandPlan plan = IRadioHAL::bandPlan(m_band);
+    const int channels = (plan.max - plan.min) / plan.step + 1;
+    return double(m_maps[m_band].size()) / channels;
+}
+
+void BandScanner::start(IRadioHAL::Band band) {
+    if (!m_hal) return;
+    m_band = band;
+    m_maps[band].clear();
+    m_decided = 0;
+    m_model->clear();
+    m_hal->startScan(band, ++m_scanId);
+    if (!m_running) {
+        m_running = true;
+        emit runningChanged();
+    }
+    emit progressChanged();
+}
+
+void BandScanner::cancel() {
+    if (!m_running) return;
+    m_hal->cancelScan();
+    finish(false);
+}
+
+QVariantList BandScanner::qualityMapList() const {
+    QVariantList list;
+    for (const IRadioHAL::ChannelQuality &q : m_maps[m_band]) {
+        list.append(QVariantMap{{"frequency", IRadioHAL::channelLabel(m_band, q.frequency)},
+                                {"rssi", q.rssi}, {"snr", q.snr}, {"multipath", q.multipath}});
+    }
+    return list;
+}
+
+// =============================================================================
+// DETECTION
+// =============================================================================
+
+bool BandScanner::isStation(const QVector<IRadioHAL::ChannelQuality> &map, int index) {
+    const IRadioHAL::ChannelQuality &q = map[index];
+    if (q.rssi < MinRssi || q.snr < MinSnr) return false;
+    // Strongest in the window; on a tie the lower channel keeps it
+    const int from = qMax(0, index - GhostSpan);
+    const int to = qMin(int(map.size()) - 1, index + GhostSpan);
+    for (int j = from; j <= to; ++j) {
+        if (j == index) continue;
+        if (map[j].rssi > q.rssi || (map[j].rssi == q.rssi && j < index)) return false;
+    }
+    return true;
+}
+
+QVector<int> BandScanner::detectStations(const QVector<IRadioHAL::ChannelQuality> &map) {
+    QVector<int> found;
+    for (int i = 0; i < map.size(); ++i) {
+        if (isStation(map, i)) found.append(map[i].frequency);
+    }
+    return found;
+}
+
+void BandScanner::decide(int end) {
+    const QVector<IRadioHAL::ChannelQuality> &map = m_maps[m_band];
+    const QString band = m_band == IRadioHAL::BandFM ? "FM" : m_band == IRadioHAL::BandAM ? "AM" : "DAB";
+    for (; m_decided < end; ++m_decided) {
+        if (!isStation(map, m_decided)) continue;
+        const IRadioHAL::ChannelQuality &q = map[m_decided];
+        ScannedStation station;
+        station.channel = q.frequency;
+        station.frequency = IRadioHAL::channelLabel(m_band, q.frequency);
+        station.band = band;
+        station.rssi = q.rssi;
+        station.snr = q.snr;
+        station.multipath = q.multipath;
+        m_model->addStation(station);
+        emit stationFound(station.frequency);
+    }
+}
+
+void BandScanner::onMeasured(int scanId, const QVector<IRadioHAL::ChannelQuality> &channels) {
+    // Batches of a replaced or cancelled sweep may still be queued
+    if (!m_running || scanId != m_scanId) return;
+    m_maps[m_band] += channels;
+    // A channel is final once the window after it is measured
+    decide(qMax(0, int(m_maps[m_band].size()) - GhostSpan));
+    emit progressChanged();
+}
+
+void BandScanner::onFinished(int scanId) {
+    if (!m_running || scanId != m_scanId) return;
+    finish(true);
+}
+
+void BandScanner::finish(bool completed) {
+    // The band edge has no channels after it; a cut-off sweep does, unmeasured
+    const int measured = int(m_maps[m_band].size());
+    decide(completed ? measured : qMax(0, measured - GhostSpan));
+    m_running = false;
+    qCInfo(vcRadioHAL) << "Band scan:" << m_model->rowCount() << "stations in" << m_maps[m_band].size() << "channels"
+                       << (completed ? "" : "(cancelled)");
+    emit runningChanged();
+    emit progressChanged();
+    emit finished(completed);
+}
@@ -0,0 +1,73 @@
+#ifndef BANDSCANNER_H
+#define BANDSCANNER_H
+
+#include <QObject>
+#include <QVariantList>
+#include "../HAL/IRadioHAL.h"
+#include "../Models/StationListModel.h"
+
+/**
+ * @brief Full-band background scan: per-channel quality map plus the list
+ * of available stations.
+ *
+ * The HAL's background tuner sweeps the band and reports batches of
+ * measurements. A channel becomes a station once its neighbours within
+ * GhostSpan are measured: it must clear the RSSI and SNR floors and be the
+ * strongest channel in that window, which drops the adjacent-channel ghosts
+ * of strong transmitters. Stations are appended to the model as they are
+ * decided, so the list fills while the sweep runs and tuning is never held.
+ */
+class BandScanner : public QObject
+{
+    Q_OBJECT
+    Q_PROPERTY(bool running READ isRunning NOTIFY runningChanged)
+    Q_PROPERTY(double progress READ progress NOTIFY progressChanged)
+    Q_PROPERTY(StationListModel* stations READ stations CONSTANT)
+
+public:
+    static constexpr int MinRssi = 45;
+    static constexpr int MinSnr = 10;   // dB
+    static constexpr int GhostSpan = 2; // channels either side
+
+    explicit BandScanner(IRadioHAL *hal, QObject *parent = nullptr);
+
+    bool isRunning() const { return m_running; }
+    double progress() const;
+    StationListModel *stations() const { return m_model; }
+    IRadioHAL::Band band() const { return m_band; }
+
+    void start(IRadioHAL::Band band);
+    void cancel();
+
+    // Last sweep of `band`, one entry per raster channel measured so far
+    const QVector<IRadioHAL::ChannelQuality> &qualityMap(IRadioHAL::Band band) const { return m_maps[band]; }
+    Q_INVOKABLE QVariantList qualityMapList() const; // current band, for the signal strip
+
+    // Station channels of a complete map (same rules as the incremental pass)
+    static QVector<int> detectStations(const QVector<IRadioHAL::ChannelQuality> &map);
+
+signals:
+    void runningChanged();
+    void progressChanged();
+    void stationFound(const QString &frequency);
+    void finished(bool completed);
+
+private slots:
+    void onMeasured(int scanId, const QVector<IRadioHAL::ChannelQuality> &channels);
+    void onFinished(int scanId);
+
+private:
+    static bool isStation(const QVector<IRadioHAL::ChannelQuality> &map, int index);
+    void decide(int end);
+    void finish(bool completed);
+
+    IRadioHAL *m_hal;
+    StationListModel *m_model;
+    QVector<IRadioHAL::ChannelQuality> m_maps[3];
+    IRadioHAL::Band m_band = IRadioHAL::BandFM;
+    bool m_running = false;
+    int m_scanId = 0;
+    int m_decided = 0; // channels of the current map already classified
+};
+
+#endif // BANDSCANNER_H
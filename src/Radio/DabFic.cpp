@@ -0,0 +1,418 @@
+#include "DabFic.h"
+#include <algorithm>
+#include <cstring>
+
+namespace {
+
+constexpr int kFibData = 30;
+
+// Programme services use 16-bit SIds, data services 32-bit (P/D flag)
+bool isProgrammeId(quint32 serviceId) { return serviceId <= 0xFFFF; }
+
+} // namespace
+
+// =============================================================================
+// ENSEMBLE
+// =============================================================================
+
+bool DabService::isAudio() const {
+    for (const DabComponent &c : components) {
+        if (c.audio) return true;
+    }
+    return false;
+}
+
+const DabComponent *DabService::primaryComponent() const {
+    for (const DabComponent &c : components) {
+        if (c.primary) return &c;
+    }
+    return components.isEmpty() ? nullptr : &components.first();
+}
+
+const DabService *DabEnsemble::service(quint32 serviceId) const {
+    for (const DabService &s : services) {
+        if (s.serviceId == serviceId) return &s;
+    }
+    return nullptr;
+}
+
+QDataStream &operator<<(QDataStream &out, const DabEnsemble &ensemble) {
+    out << qint32(ensemble.channel) << ensemble.ensembleId << ensemble.label << qint32(ensemble.services.size());
+    for (const DabService &s : ensemble.services) {
+        out << s.serviceId << s.label << s.shortLabel << qint32(s.components.size());
+        for (const DabComponent &c : s.components)
+            out << qint32(c.subChannelId) << c.audio << c.dabPlus << c.primary << qint32(c.bitrate);
+    }
+    return out;
+}
+
+QDataStream &operator>>(QDataStream &in, DabEnsemble &ensemble) {
+    qint32 channel = -1, serviceCount = 0;
+    in >> channel >> ensemble.ensembleId >> ensemble.label >> serviceCount;
+    ensemble.channel = channel;
+    ensemble.services.clear();
+    if (in.status() != QDataStream::Ok || serviceCount < 0 || serviceCount > 256) {
+        in.setStatus(QDataStream::ReadCorruptData);
+        return in;
+    }
+    ensemble.services.resize(serviceCount);
+    for (DabService &s : ensemble.services) {
+        qint32 componentCount = 0;
+        in >> s.serviceId >> s.label >> s.shortLabel >> componentCount;
+        if (in.status() != QDataStream::Ok || componentCount < 0 || componentCount > 16) {
+            in.setStatus(QDataStream::ReadCorruptData);
+            return in;
+        }
+        s.components.resize(componentCount);
+        for (DabComponent &c : s.components) {
+            qint32 subChannelId = -1, bitrate = 0;
+            in >> subChannelId >> c.audio >> c.dabPlus >> c.primary >> bitrate;
+            c.subChannelId = subChannelId;
+            c.bitrate = bitrate;
+        }
+    }
+    return in;
+}
+
+// =============================================================================
+// DECODER
+// =============================================================================
+
+quint16 FicDecoder::crc16(const uint8_t *data, int size) {
+    quint16 crc = 0xFFFF;
+    for (int i = 0; i < size; ++i) {
+        crc ^= quint16(data[i]) << 8;
+        for (int b = 0; b < 8; ++b) crc = (crc & 0x8000) ? quint16((crc << 1) ^ 0x1021) : quint16(crc << 1);
+    }
+    return quint16(~crc);
+}
+
+void FicDecoder::reset() {
+    m_hasEnsembleId = false;
+    m_ensembleId = 0;
+    m_ensembleLabel.clear();
+    m_subChannelRates.clear();
+    m_services.clear();
+    m_serviceIndex.clear();
+    m_labels.clear();
+    m_lastNewService = 0;
+    m_changed = false;
+    m_stats = Stats();
+}
+
+void FicDecoder::pushFibs(const QByteArray &data) {
+    const auto *bytes = reinterpret_cast<const uint8_t *>(data.constData());
+    for (int pos = 0; pos + FibSize <= data.size(); pos += FibSize) pushFib(bytes + pos);
+}
+
+bool FicDecoder::pushFib(const uint8_t *fib) {
+    ++m_stats.fibs;
+    if (crc16(fib, kFibData) != quint16(fib[30] << 8 | fib[31])) {
+        ++m_stats.crcErrors;
+        return false;
+    }
+
+    int pos = 0;
+    while (pos < kFibData) {
+        const uint8_t header = fib[pos];
+        if (header == 0xFF) break; // end marker, padding follows
+        const int type = header >> 5;
+        const int length = header & 0x1F;
+        if (length == 0 || pos + 1 + length > kFibData) break;
+        if (type == 0) handleFig0(fib + pos + 1, length);
+        else if (type == 1) handleFig1(fib + pos + 1, length);
+        pos += 1 + length;
+    }
+    return true;
+}
+
+void FicDecoder::handleFig0(const uint8_t *d, int length) {
+    const bool nextConfig = d[0] & 0x80;
+    const bool otherEnsemble = d[0] & 0x40;
+    const bool dataIds = d[0] & 0x20;
+    const int extension = d[0] & 0x1F;
+    if (nextConfig || otherEnsemble) return;
+
+    switch (extension) {
+    case 0: // ensemble information
+        if (length >= 3) {
+            const quint16 id = quint16(d[1] << 8 | d[2]);
+            if (!m_hasEnsembleId || id != m_ensembleId) m_changed = true;
+            m_hasEnsembleId = true;
+            m_ensembleId = id;
+        }
+        break;
+    case 1: // sub-channel organisation
+        for (int i = 1; i + 3 <= length;) {
+            const int subChannel = d[i] >> 2;
+            int bitrate = 0;
+            if (d[i + 2] & 0x80) {
+                if (i + 4 > length) break;
+                const int option = (d[i + 2] >> 4) & 7;
+                const int level = (d[i + 2] >> 2) & 3;
+                const int size = (d[i + 2] & 3) << 8 | d[i + 3];
+                bitrate = eepBitrate(option, level, size);
+                i += 4;
+            } else {
+                bitrate = uepBitrate(d[i + 2] & 0x3F);
+                i += 3;
+            }
+            if (m_subChannelRates.value(subChannel, -1) != bitrate) {
+                m_subChannelRates.insert(subChannel, bitrate);
+                m_changed = true;
+            }
+        }
+        break;
+    case 2: // service organisation
+        for (int i = 1; i < length;) {
+            const int idBytes = dataIds ? 4 : 2;
+            if (i + idBytes + 1 > length) break;
+            quint32 serviceId = 0;
+            for (int k = 0; k < idBytes; ++k) serviceId = serviceId << 8 | d[i + k];
+            i += idBytes;
+            const int componentCount = d[i++] & 0x0F;
+            if (i + 2 * componentCount > length) break;
+
+            DabService service;
+            service.serviceId = serviceId;
+            for (int c = 0; c < componentCount; ++c, i += 2) {
+                DabComponent component;
+                const int tmId = d[i] >> 6;
+                component.audio = tmId == 0;
+                component.dabPlus = (d[i] & 0x3F) == 63;
+                component.primary = (d[i + 1] >> 1) & 1;
+                // Packet mode (TMId 3) addresses a service component, not a sub-channel
+                if (tmId != 3) component.subChannelId = d[i + 1] >> 2;
+                service.components.append(component);
+            }
+
+            const auto it = m_serviceIndex.constFind(serviceId);
+            if (it == m_serviceIndex.constEnd()) {
+                m_serviceIndex.insert(serviceId, int(m_services.size()));
+                m_services.append(service);
+                m_lastNewService = m_stats.fibs;
+                m_changed = true;
+            } else if (!(m_services[*it].components == service.components)) {
+                m_services[*it].components = service.components;
+                m_changed = true;
+            }
+        }
+        break;
+    default:
+        break;
+    }
+}
+
+void FicDecoder::handleFig1(const uint8_t *d, int length) {
+    const bool otherEnsemble = d[0] & 0x08;
+    const int extension = d[0] & 0x07;
+    if (otherEnsemble) return;
+
+    const int idBytes = extension == 5 ? 4 : 2;
+    if ((extension != 0 && extension != 1 && extension != 5) || length < 1 + idBytes + 18) return;
+    quint32 id = 0;
+    for (int k = 0; k < idBytes; ++k) id = id << 8 | d[1 + k];
+    const uint8_t *chars = d + 1 + idBytes;
+    const quint16 flags = quint16(chars[16] << 8 | chars[17]);
+
+    Labels labels;
+    labels.label = decodeLabel(chars, flags, &labels.shortLabel);
+    if (extension == 0) {
+        if (labels.label != m_ensembleLabel) {
+            m_ensembleLabel = labels.label;
+            m_changed = true;
+        }
+        return;
+    }
+    const auto it = m_labels.constFind(id);
+    if (it == m_labels.constEnd() || it->label != labels.label || it->shortLabel != labels.shortLabel) {
+        m_labels.insert(id, labels);
+        m_changed = true;
+    }
+}
+
+QString FicDecoder::decodeLabel(const uint8_t *chars, quint16 flags, QString *shortLabel) {
+    // Charset 0 (EBU Latin) matches Latin-1 for the printable ASCII range
+    QString label = QString::fromLatin1(reinterpret_cast<const char *>(chars), 16);
+    shortLabel->clear();
+    for (int i = 0; i < 16; ++i) {
+        if (flags & (0x8000 >> i)) shortLabel->append(label.at(i));
+    }
+    *shortLabel = shortLabel->trimmed();
+    return label.trimmed();
+}
+
+int FicDecoder::eepBitrate(int option, int level, int size) {
+    // Capacity units per 8 kbit/s (EEP-A) or per 32 kbit/s (EEP-B), by protection level
+    static const int kFactorA[4] = {12, 8, 6, 4};
+    static const int kFactorB[4] = {27, 21, 18, 15};
+    if (option == 0) return size / kFactorA[level] * 8;
+    if (option == 1) return size / kFactorB[level] * 32;
+    return 0;
+}
+
+int FicDecoder::uepBitrate(int tableIndex) {
+    // UEP table: first index of each bit rate (protection levels 5..1 follow)
+    static const struct { int first; int bitrate; } kRanges[] = {
+        {0, 32}, {5, 48}, {10, 56}, {14, 64}, {19, 80}, {24, 96}, {29, 112},
+        {33, 128}, {38, 160}, {42, 192}, {47, 224}, {52, 256}, {57, 320}, {60, 384}};
+    int bitrate = 0;
+    for (const auto &r : kRanges) {
+        if (tableIndex >= r.first) bitrate = r.bitrate;
+    }
+    return bitrate;
+}
+
+bool FicDecoder::isComplete() const {
+    if (m_ensembleLabel.isEmpty() || m_services.isEmpty()) return false;
+    if (m_stats.fibs - m_lastNewService < quint64(StableFibs)) return false;
+    for (const DabService &s : m_services) {
+        if (!m_labels.contains(s.serviceId)) return false;
+        for (const DabComponent &c : s.components) {
+            if (c.subChannelId >= 0 && !m_subChannelRates.contains(c.subChannelId)) return false;
+        }
+    }
+    return true;
+}
+
+bool FicDecoder::takeChanged() {
+    const bool changed = m_changed;
+    m_changed = false;
+    return changed;
+}
+
+DabEnsemble FicDecoder::ensemble(int channel) const {
+    DabEnsemble ensemble;
+    ensemble.channel = channel;
+    ensemble.ensembleId = m_ensembleId;
+    ensemble.label = m_ensembleLabel;
+    ensemble.services = m_services;
+    for (DabService &s : ensemble.services) {
+        const Labels labels = m_labels.value(s.serviceId);
+        s.label = labels.label;
+        s.shortLabel = labels.shortLabel;
+        for (DabComponent &c : s.components) c.bitrate = m_subChannelRates.value(c.subChannelId, 0);
+    }
+    // Arrival order depends on where reception started; keep snapshots comparable
+    std::sort(ensemble.services.begin(), ensemble.services.end(),
+              [](const DabService &a, const DabService &b) { return a.serviceId < b.serviceId; });
+    return ensemble;
+}
+
+// =============================================================================
+// ENCODER
+// =============================================================================
+
+namespace {
+
+QByteArray makeFig(int type, const QByteArray &data) {
+    return char(type << 5 | data.size()) + data;
+}
+
+QByteArray labelField(const QString &label, const QString &shortLabel) {
+    QByteArray chars = label.left(16).toLatin1();
+    chars.append(QByteArray(16 - chars.size(), ' '));
+    // Flag the short label's characters in order, falling back to the first eight
+    quint16 flags = 0;
+    int matched = 0;
+    for (int i = 0; i < 16 && matched < shortLabel.size(); ++i) {
+        if (chars[i] == shortLabel.at(matched).toLatin1()) {
+            flags |= 0x8000 >> i;
+            ++matched;
+        }
+    }
+    if (matched != shortLabel.size() || shortLabel.isEmpty()) flags = quint16(0xFF00);
+    chars.append(char(flags >> 8));
+    chars.append(char(flags & 0xFF));
+    return chars;
+}
+
+} // namespace
+
+void FicEncoder::setEnsemble(const DabEnsemble &ensemble) {
+    m_figs.clear();
+    m_next = 0;
+
+    // FIG 0/0: EId, no change pending, CIF count 0
+    QByteArray fig00;
+    fig00.append(char(0x00));
+    fig00.append(char(ensemble.ensembleId >> 8));
+    fig00.append(char(ensemble.ensembleId & 0xFF));
+    fig00.append(char(0));
+    fig00.append(char(0));
+    m_figs.append(makeFig(0, fig00));
+
+    // FIG 0/1: one long-form (EEP 3-A) entry per sub-channel
+    int startAddress = 0;
+    QHash<int, bool> organised;
+    for (const DabService &s : ensemble.services) {
+        for (const DabComponent &c : s.components) {
+            if (c.subChannelId < 0 || organised.contains(c.subChannelId)) continue;
+            organised.insert(c.subChannelId, true);
+            const int size = c.bitrate / 8 * 6;
+            QByteArray entry;
+            entry.append(char(0x01));
+            entry.append(char(c.subChannelId << 2 | startAddress >> 8));
+            entry.append(char(startAddress & 0xFF));
+            entry.append(char(0x80 | 2 << 2 | size >> 8));
+            entry.append(char(size & 0xFF));
+            m_figs.append(makeFig(0, entry));
+            startAddress += size;
+        }
+    }
+
+    // FIG 0/2 and FIG 1/1 (programme) or 1/5 (data) per service
+    for (const DabService &s : ensemble.services) {
+        const bool programme = isProgrammeId(s.serviceId);
+        QByteArray entry;
+        entry.append(char(programme ? 0x02 : 0x22));
+        for (int k = programme ? 1 : 3; k >= 0; --k) entry.append(char((s.serviceId >> (8 * k)) & 0xFF));
+        entry.append(char(s.components.size() & 0x0F));
+        for (const DabComponent &c : s.components) {
+            entry.append(char((c.audio ? 0 : 1) << 6 | (c.audio && c.dabPlus ? 63 : 0)));
+            entry.append(char(qMax(0, c.subChannelId) << 2 | (c.primary ? 2 : 0)));
+        }
+        m_figs.append(makeFig(0, entry));
+
+        QByteArray label;
+        label.append(char(programme ? 0x01 : 0x05));
+        for (int k = programme ? 1 : 3; k >= 0; --k) label.append(char((s.serviceId >> (8 * k)) & 0xFF));
+        label.append(labelField(s.label, s.shortLabel));
+        m_figs.append(makeFig(1, label));
+    }
+
+    // FIG 1/0: ensemble label
+    QByteArray label;
+    label.append(char(0x00));
+    label.append(char(ensemble.ensembleId >> 8));
+    label.append(char(ensemble.ensembleId & 0xFF));
+    label.append(labelField(ensemble.label, QString()));
+    m_figs.append(makeFig(1, label));
+}
+
+void FicEncoder::nextFib(uint8_t *fib) {
+    int pos = 0;
+    if (!m_figs.isEmpty()) {
+        // At least one FIG per FIB, then as many as fit
+        for (int taken = 0; taken < m_figs.size(); ++taken) {
+            const QByteArray &fig = m_figs[m_next];
+            if (pos + fig.size() > kFibData) break;
+            std::memcpy(fib + pos, fig.constData(), size_t(fig.size()));
+            pos += int(fig.size());
+            m_next = (m_next + 1) % int(m_figs.size());
+        }
+    }
+    if (pos < kFibData) {
+        fib[pos++] = 0xFF;
+        std::memset(fib + pos, 0, size_t(kFibData - pos));
+    }
+    const quint16 crc = FicDecoder::crc16(fib, kFibData);
+    fib[30] = uint8_t(crc >> 8);
+    fib[31] = uint8_t(crc & 0xFF);
+}
+
+void FicEncoder::generate(int count, QByteArray &out) {
+    const int start = int(out.size());
+    out.resize(start + count * FicDecoder::FibSize);
+    for (int i = 0; i < count; ++i) nextFib(reinterpret_cast<uint8_t *>(out.data()) + start + i * FicDecoder::FibSize);
+}
@@ -0,0 +1,136 @@
+#ifndef DABFIC_H
+#define DABFIC_H
+
+#include <QByteArray>
+#include <QDataStream>
+#include <QHash>
+#include <QString>
+#include <QVector>
+
+/**
+ * @brief DAB ensemble structure (EN 300 401): ensemble -> services ->
+ * service components, each component carried in one MSC sub-channel.
+ */
+struct DabComponent {
+    int subChannelId = -1;
+    bool audio = true;     // stream audio (TMId 0); otherwise data
+    bool dabPlus = true;   // ASCTy 63 (HE-AAC v2) vs 0 (MPEG Layer II)
+    bool primary = false;
+    int bitrate = 0;       // kbit/s, from the sub-channel organisation
+
+    bool operator==(const DabComponent &o) const {
+        return subChannelId == o.subChannelId && audio == o.audio && dabPlus == o.dabPlus
+            && primary == o.primary && bitrate == o.bitrate;
+    }
+};
+
+struct DabService {
+    quint32 serviceId = 0;
+    QString label;         // up to 16 characters
+    QString shortLabel;    // up to 8, selected by the character flag field
+    QVector<DabComponent> components;
+
+    bool isAudio() const;
+    const DabComponent *primaryComponent() const;
+    bool operator==(const DabService &o) const {
+        return serviceId == o.serviceId && label == o.label && shortLabel == o.shortLabel && components == o.components;
+    }
+};
+
+struct DabEnsemble {
+    int channel = -1;      // Band III channel index (IRadioHAL)
+    quint16 ensembleId = 0;
+    QString label;
+    QVector<DabService> services; // by SId
+
+    bool isValid() const { return channel >= 0 && !services.isEmpty(); }
+    const DabService *service(quint32 serviceId) const;
+    bool operator==(const DabEnsemble &o) const {
+        return channel == o.channel && ensembleId == o.ensembleId && label == o.label && services == o.services;
+    }
+    bool operator!=(const DabEnsemble &o) const { return !(*this == o); }
+};
+
+QDataStream &operator<<(QDataStream &out, const DabEnsemble &ensemble);
+QDataStream &operator>>(QDataStream &in, DabEnsemble &ensemble);
+
+/**
+ * @brief Fast Information Channel decoder.
+ *
+ * Takes 32-byte FIBs (30 bytes of FIGs + CRC-16), drops those failing the
+ * CRC and assembles the multiplex configuration from FIG 0/0 (ensemble),
+ * 0/1 (sub-channel organisation), 0/2 (service organisation), 1/0
+ * (ensemble label) and 1/1, 1/5 (service labels). Information for other
+ * ensembles (OE) and the next configuration (C/N) is ignored.
+ *
+ * The ensemble counts as complete once every service has a label and a
+ * known sub-channel and no new service has appeared for StableFibs FIBs,
+ * about one FIG 0/2 repetition cycle.
+ */
+class FicDecoder
+{
+public:
+    static constexpr int FibSize = 32;
+    static constexpr int StableFibs = 120; // ~1 s at 12 FIBs per 96 ms frame
+
+    struct Stats {
+        quint64 fibs = 0;
+        quint64 crcErrors = 0;
+    };
+
+    void reset();
+    bool pushFib(const uint8_t *fib); // false on CRC failure
+    void pushFibs(const QByteArray &data);
+
+    bool isComplete() const;
+    // Configuration changed since the last call
+    bool takeChanged();
+    DabEnsemble ensemble(int channel) const;
+    const Stats &stats() const { return m_stats; }
+
+    // CRC-16/CCITT over the FIG data, as transmitted (inverted)
+    static quint16 crc16(const uint8_t *data, int size);
+
+private:
+    void handleFig0(const uint8_t *d, int length);
+    void handleFig1(const uint8_t *d, int length);
+    static int eepBitrate(int option, int level, int size);
+    static int uepBitrate(int tableIndex);
+    static QString decodeLabel(const uint8_t *chars, quint16 flags, QString *shortLabel);
+
+    struct Labels {
+        QString label;
+        QString shortLabel;
+    };
+
+    bool m_hasEnsembleId = false;
+    quint16 m_ensembleId = 0;
+    QString m_ensembleLabel;
+    QHash<int, int> m_subChannelRates; // SubChId -> kbit/s
+    QVector<DabService> m_services;
+    QHash<quint32, int> m_serviceIndex;
+    QHash<quint32, Labels> m_labels;   // may arrive before FIG 0/2
+    quint64 m_lastNewService = 0;      // FIB count when a service was last added
+    bool m_changed = false;
+    Stats m_stats;
+};
+
+/**
+ * @brief FIC generator for the simulated tuner and tests: cycles the FIGs
+ * describing `ensemble` and packs them into FIBs with CRC.
+ */
+class FicEncoder
+{
+public:
+    void setEnsemble(const DabEnsemble &ensemble);
+    // Appends `count` FIBs
+    void generate(int count, QByteArray &out);
+
+private:
+    void nextFib(uint8_t *fib);
+
+    QVector<QByteArray> m_figs; // header + data, one cycle
+    int m_next = 0;
+};
+
+#endif // DABFIC_H
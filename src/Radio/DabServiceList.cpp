@@ -0,0 +1,135 @@
+#include "DabServiceList.h"
+#include "../HAL/IRadioHAL.h"
+#include <QDir>
+#include <QFile>
+#include <QStandardPaths>
+#include <QDebug>
+#include <algorithm>
+
+namespace {
+
+constexpr quint32 kCacheMagic = 0x4241444E; // "NDAB"
+constexpr quint16 kCacheVersion = 1;
+
+} // namespace
+
+DabServiceList::DabServiceList(const QString &cacheDirectory, QObject *parent)
+    : QObject(parent),
+      m_cacheDirectory(cacheDirectory.isEmpty()
+                           ? QStandardPaths::writableLocation(QStandardPaths::CacheLocation) + "/dab"
+                           : cacheDirectory),
+      m_model(new DabServiceModel(this))
+{
+    loadCache();
+}
+
+const DabEnsemble *DabServiceList::ensemble(int channel) const {
+    const auto it = m_ensembles.constFind(channel);
+    return it == m_ensembles.constEnd() ? nullptr : &it.value();
+}
+
+QString DabServiceList::serviceLabel(int channel, quint32 serviceId) const {
+    const DabEnsemble *e = ensemble(channel);
+    if (!e) return QString();
+    if (serviceId) {
+        const DabService *s = e->service(serviceId);
+        return s ? s->label : QString();
+    }
+    for (const DabService &s : e->services) {
+        if (s.isAudio()) return s.label;
+    }
+    return e->label;
+}
+
+// =============================================================================
+// RECEIVER
+// =============================================================================
+
+void DabServiceList::startChannel(int channel) {
+    m_decoder.reset();
+    m_channel = channel;
+    m_dirty = false;
+}
+
+void DabServiceList::pushFic(int channel, const QByteArray &fibs) {
+    if (channel != m_channel) startChannel(channel);
+    m_decoder.pushFibs(fibs);
+    m_dirty |= m_decoder.takeChanged();
+    if (!m_dirty || !m_decoder.isComplete()) return;
+    m_dirty = false;
+
+    const DabEnsemble decoded = m_decoder.ensemble(channel);
+    const DabEnsemble *known = ensemble(channel);
+    if (known && *known == decoded) return; // cache confirmed, nothing to write
+
+    m_ensembles.insert(channel, decoded);
+    if (!store(decoded)) qWarning() << "DabServiceList: cannot write cache" << cacheFile(channel);
+    qInfo() << "DAB ensemble" << decoded.label << "on" << IRadioHAL::channelLabel(IRadioHAL::BandDAB, channel)
+            << decoded.services.size() << "services";
+    rebuildModel();
+    emit ensemblesChanged();
+    emit ensembleUpdated(channel);
+}
+
+// =============================================================================
+// CACHE
+// =============================================================================
+
+QString DabServiceList::cacheFile(int channel) const {
+    return m_cacheDirectory + "/" + IRadioHAL::channelLabel(IRadioHAL::BandDAB, channel) + ".ens";
+}
+
+void DabServiceList::loadCache() {
+    const QDir dir(m_cacheDirectory);
+    for (const QString &name : dir.entryList({"*.ens"}, QDir::Files)) {
+        QFile file(dir.filePath(name));
+        if (!file.open(QIODevice::ReadOnly)) continue;
+        QDataStream in(&file);
+        quint32 magic = 0;
+        quint16 version = 0;
+        DabEnsemble ensemble;
+        in >> magic >> version;
+        if (magic != kCacheMagic || version != kCacheVersion) continue;
+        in >> ensemble;
+        if (in.status() != QDataStream::Ok || !ensemble.isValid()) {
+            qWarning() << "DabServiceList: dropping unreadable cache" << file.fileName();
+            continue;
+        }
+        m_ensembles.insert(ensemble.channel, ensemble);
+    }
+    rebuildModel();
+}
+
+bool DabServiceList::store(const DabEnsemble &ensemble) const {
+    QDir().mkpath(m_cacheDirectory);
+    QFile file(cacheFile(ensemble.channel));
+    if (!file.open(QIODevice::WriteOnly)) return false;
+    QDataStream out(&file);
+    out << kCacheMagic << kCacheVersion << ensemble;
+    return out.status() == QDataStream::Ok;
+}
+
+void DabServiceList::rebuildModel() {
+    QList<DabServiceEntry> entries;
+    for (const DabEnsemble &e : m_ensembles) {
+        for (const DabService &s : e.services) {
+            if (!s.isAudio()) continue;
+            DabServiceEntry entry;
+            entry.serviceId = s.serviceId;
+            entry.name = s.label;
+            entry.shortName = s.shortLabel;
+            entry.ensemble = e.label;
+            entry.channel = e.channel;
+            entry.channelLabel = IRadioHAL::channelLabel(IRadioHAL::BandDAB, e.channel);
+            if (const DabComponent *c = s.primaryComponent()) {
+                entry.bitrate = c->bitrate;
+                entry.dabPlus = c->dabPlus;
+            }
+            entries.append(entry);
+        }
+    }
+    std::stable_sort(entries.begin(), entries.end(), [](const DabServiceEntry &a, const DabServiceEntry &b) {
+        return QString::compare(a.name, b.name, Qt::CaseInsensitive) < 0;
+    });
+    m_model->setServices(entries);
+}
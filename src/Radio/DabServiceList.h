@@ -0,0 +1,56 @@
+#ifndef DABSERVICELIST_H
+#define DABSERVICELIST_H
+
+#include <QObject>
+#include <QMap>
+#include "DabFic.h"
+#include "../Models/DabServiceModel.h"
+
+/**
+ * @brief Known DAB ensembles and their services, persisted per ensemble.
+ *
+ * The FIC of the tuned channel is decoded as it arrives; once the ensemble
+ * is complete and differs from what is known (new, reconfigured or
+ * relabelled) it replaces the cached copy and is written to disk. The
+ * cache is read on construction, so the service list is available at cold
+ * boot and after band switches without tuning through Band III again.
+ */
+class DabServiceList : public QObject
+{
+    Q_OBJECT
+    Q_PROPERTY(DabServiceModel* services READ services CONSTANT)
+    Q_PROPERTY(int ensembleCount READ ensembleCount NOTIFY ensemblesChanged)
+
+public:
+    // Empty directory: the application cache location
+    explicit DabServiceList(const QString &cacheDirectory = QString(), QObject *parent = nullptr);
+
+    DabServiceModel *services() const { return m_model; }
+    int ensembleCount() const { return int(m_ensembles.size()); }
+    const DabEnsemble *ensemble(int channel) const;
+    // Display label; serviceId 0 selects the first audio service of the channel
+    QString serviceLabel(int channel, quint32 serviceId) const;
+
+    // Receiver side: FIC bytes (whole FIBs) of the tuned channel
+    void startChannel(int channel);
+    void pushFic(int channel, const QByteArray &fibs);
+
+signals:
+    void ensemblesChanged();
+    void ensembleUpdated(int channel);
+
+private:
+    void loadCache();
+    bool store(const DabEnsemble &ensemble) const;
+    QString cacheFile(int channel) const;
+    void rebuildModel();
+
+    QString m_cacheDirectory;
+    DabServiceModel *m_model;
+    QMap<int, DabEnsemble> m_ensembles; // by channel, band order
+    FicDecoder m_decoder;
+    int m_channel = -1;
+    bool m_dirty = false; // decoder state not yet compared with the cache
+};
+
+#endif // DABSERVICELIST_H
@@ -0,0 +1,452 @@
+#include "FmDemodulator.h"
+#include "RdsDecoder.h"
+#include "../Audio/SimdOps.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+namespace {
+
+constexpr double kPi = 3.14159265358979323846;
+constexpr double kPhaseUnits = 4294967296.0; // 2^32 per cycle
+
+// 2^14-entry sine, indexed by the top bits of a 32-bit phase
+constexpr int kSineBits = 14;
+struct SineTable {
+    float values[1 << kSineBits];
+    SineTable() {
+        for (int i = 0; i < (1 << kSineBits); ++i) values[i] = float(std::sin(2.0 * kPi * i / (1 << kSineBits)));
+    }
+};
+
+const float *sineTable() {
+    static const SineTable table;
+    return table.values;
+}
+
+inline float sinAt(const float *table, uint32_t phase) { return table[phase >> (32 - kSineBits)]; }
+inline float cosAt(const float *table, uint32_t phase) { return table[(phase + 0x40000000u) >> (32 - kSineBits)]; }
+
+// atan2 to ~1e-5 rad: odd polynomial on [0, 1] plus octant folding
+inline float fastAtan2(float y, float x) {
+    const float ax = std::fabs(x), ay = std::fabs(y);
+    const float hi = std::max(ax, ay);
+    if (hi == 0.0f) return 0.0f;
+    const float z = std::min(ax, ay) / hi;
+    const float z2 = z * z;
+    float a = z * (0.9998660f + z2 * (-0.3302995f + z2 * (0.1801410f + z2 * (-0.0851330f + z2 * 0.0208351f))));
+    if (ay > ax) a = float(kPi / 2) - a;
+    if (x < 0.0f) a = float(kPi) - a;
+    return y < 0.0f ? -a : a;
+}
+
+// Pilot PLL: ~25 Hz natural frequency, critically damped, for a pilot at
+// 9% of the deviation (detector gain = half its amplitude)
+constexpr double kPilotGain = 0.045;
+constexpr double kLoopOmega = 2.0 * kPi * 25.0 / FmDemodulator::MpxRate;
+constexpr double kLoopP = 2.0 * 0.707 * kLoopOmega / kPilotGain * kPhaseUnits / (2.0 * kPi);
+constexpr double kLoopI = kLoopOmega * kLoopOmega / kPilotGain * kPhaseUnits / (2.0 * kPi);
+constexpr double kPilotStep = 19000.0 / FmDemodulator::MpxRate * kPhaseUnits;
+constexpr double kMaxPull = 100.0 / FmDemodulator::MpxRate * kPhaseUnits; // +-100 Hz
+constexpr double kLevelAlpha = 1.0 / 2400.0;                             // 10 ms
+constexpr double kFreeRunAlpha = 1.0 / 24000.0;                          // 100 ms
+constexpr double kLockLevel = 0.02;
+constexpr double kUnlockLevel = 0.012;
+constexpr float kBlendStep = 1.0f / (FmDemodulator::AudioRate / 10); // mono <-> stereo in 100 ms
+constexpr float kRdsEnergyAlpha = 0.05f;                            // ~20 bits
+
+FmDemodulator::Quality envelopeQuality(const std::vector<float> &i, const std::vector<float> &q)
+{
+    FmDemodulator::Quality quality;
+    if (i.empty()) return quality;
+    // Constant envelope: whatever spreads |x|^2 is noise. With noise power
+    // N on a carrier S, E|x|^2 = S + N and Var|x|^2 ~ 2SN.
+    double sum = 0.0, sumSquares = 0.0;
+    for (size_t k = 0; k < i.size(); ++k) {
+        const double p = double(i[k]) * i[k] + double(q[k]) * q[k];
+        sum += p;
+        sumSquares += p * p;
+    }
+    const double mean = sum / i.size();
+    const double variance = std::max(0.0, sumSquares / i.size() - mean * mean);
+    quality.powerDb = float(10.0 * std::log10(std::max(mean, 1e-10)));
+    quality.snrDb = variance > 0.0 ? float(std::clamp(10.0 * std::log10(2.0 * mean * mean / variance), 0.0, 60.0)) : 60.0f;
+    return quality;
+}
+
+int channelTaps(int inputRate) {
+    // +-100 kHz pass, 180 kHz stop (what folds back above the MPX band at 240 kHz)
+    return int(std::ceil(3.3 * inputRate / 80000.0));
+}
+
+} // namespace
+
+// =============================================================================
+// FIR DECIMATOR
+// =============================================================================
+
+FirDecimator::FirDecimator(int factor, int taps, double cutoff)
+    : m_factor(std::max(1, factor))
+{
+    taps = (std::max(8, taps) + 7) / 8 * 8;
+    m_taps.resize(size_t(taps));
+    const double centre = (taps - 1) / 2.0;
+    double sum = 0.0;
+    for (int k = 0; k < taps; ++k) {
+        const double x = k - centre;
+        const double sinc = x == 0.0 ? 2.0 * cutoff : std::sin(2.0 * kPi * cutoff * x) / (kPi * x);
+        const double window = 0.54 - 0.46 * std::cos(2.0 * kPi * k / (taps - 1));
+        m_taps[size_t(k)] = float(sinc * window);
+        sum += sinc * window;
+    }
+    for (float &t : m_taps) t = float(t / sum);
+    reset();
+}
+
+void FirDecimator::reset()
+{
+    m_history.assign(m_taps.empty() ? 0 : m_taps.size() - 1, 0.0f);
+    m_next = m_history.size();
+}
+
+void FirDecimator::process(const float *in, size_t count, std::vector<float> &out)
+{
+    const size_t n = m_taps.size();
+    m_history.insert(m_history.end(), in, in + count);
+    size_t pos = m_next;
+    while (pos < m_history.size()) {
+        out.push_back(simd::dot(m_taps.data(), m_history.data() + pos + 1 - n, int(n)));
+        pos += size_t(m_factor);
+    }
+    // Keep the context for the next block
+    const size_t drop = m_history.size() - (n - 1);
+    m_history.erase(m_history.begin(), m_history.begin() + std::ptrdiff_t(drop));
+    m_next = pos - drop;
+}
+
+// =============================================================================
+// DEMODULATOR
+// =============================================================================
+
+FmDemodulator::FmDemodulator(int inputRate)
+    : m_inputRate(inputRate)
+    , m_decimation(std::max(1, inputRate / MpxRate))
+    , m_channelI(m_decimation, channelTaps(inputRate), 140000.0 / inputRate)
+    , m_channelQ(m_decimation, channelTaps(inputRate), 140000.0 / inputRate)
+    // 15 kHz pass, pilot (19 kHz) stopped
+    , m_audioSum(MpxRate / AudioRate, 200, 17000.0 / MpxRate)
+    , m_audioDiff(MpxRate / AudioRate, 200, 17000.0 / MpxRate)
+{
+    setDeemphasis(50.0);
+    reset();
+}
+
+void FmDemodulator::reset()
+{
+    m_channelI.reset();
+    m_channelQ.reset();
+    m_audioSum.reset();
+    m_audioDiff.reset();
+    m_rotRe = 1.0;
+    m_rotIm = 0.0;
+    m_lastI = m_lastQ = 0.0f;
+    m_quality = Quality();
+
+    m_pllPhase = 0;
+    m_pllStep = kPilotStep;
+    m_pilotLevel = 0.0;
+    m_pilotLocked = false;
+    m_blend = 0.0f;
+    m_deemL = m_deemR = 0.0f;
+
+    m_cycleI = m_cycleQ = 0.0f;
+    std::memset(m_ringI, 0, sizeof(m_ringI));
+    std::memset(m_ringQ, 0, sizeof(m_ringQ));
+    m_cycles = 0;
+    std::memset(m_energy, 0, sizeof(m_energy));
+    std::memset(m_lastSymbol, 0, sizeof(m_lastSymbol));
+    m_bestAlignment = 0;
+    m_bestComponent = 0;
+}
+
+void FmDemodulator::setOffset(double hz)
+{
+    m_offset = hz;
+    const double w = -2.0 * kPi * hz / m_inputRate;
+    m_stepRe = std::cos(w);
+    m_stepIm = std::sin(w);
+}
+
+void FmDemodulator::setDeemphasis(double tauUs)
+{
+    m_deemphasis = tauUs > 0.0 ? float(1.0 - std::exp(-1e6 / (AudioRate * tauUs))) : 1.0f;
+}
+
+double FmDemodulator::pilotFrequency() const
+{
+    return m_pllStep / kPhaseUnits * MpxRate;
+}
+
+void FmDemodulator::process(const float *iq, size_t count, std::vector<float> &audio, std::vector<uint8_t> &rdsBits)
+{
+    mix(iq, count);
+    m_baseI.clear();
+    m_baseQ.clear();
+    m_channelI.process(m_mixI.data(), count, m_baseI);
+    m_channelQ.process(m_mixQ.data(), count, m_baseQ);
+    m_quality = envelopeQuality(m_baseI, m_baseQ);
+
+    demodulate(rdsBits);
+
+    m_sumAudio.clear();
+    m_diffAudio.clear();
+    m_audioSum.process(m_sum.data(), m_sum.size(), m_sumAudio);
+    m_audioDiff.process(m_diff.data(), m_diff.size(), m_diffAudio);
+
+    const float target = m_pilotLocked ? 1.0f : 0.0f;
+    audio.reserve(audio.size() + m_sumAudio.size() * 2);
+    for (size_t i = 0; i < m_sumAudio.size(); ++i) {
+        m_blend += std::clamp(target - m_blend, -kBlendStep, kBlendStep);
+        const float sum = m_sumAudio[i];
+        const float diff = m_diffAudio[i] * m_blend;
+        m_deemL += (sum + diff - m_deemL) * m_deemphasis;
+        m_deemR += (sum - diff - m_deemR) * m_deemphasis;
+        audio.push_back(m_deemL);
+        audio.push_back(m_deemR);
+    }
+}
+
+void FmDemodulator::mix(const float *iq, size_t count)
+{
+    m_mixI.resize(count);
+    m_mixQ.resize(count);
+    if (m_offset == 0.0) {
+        for (size_t k = 0; k < count; ++k) {
+            m_mixI[k] = iq[2 * k];
+            m_mixQ[k] = iq[2 * k + 1];
+        }
+        return;
+    }
+    double re = m_rotRe, im = m_rotIm;
+    for (size_t k = 0; k < count; ++k) {
+        const double i = iq[2 * k], q = iq[2 * k + 1];
+        m_mixI[k] = float(i * re - q * im);
+        m_mixQ[k] = float(i * im + q * re);
+        const double nextRe = re * m_stepRe - im * m_stepIm;
+        im = re * m_stepIm + im * m_stepRe;
+        re = nextRe;
+    }
+    // Keep the rotator on the unit circle
+    const double norm = 1.0 / std::sqrt(re * re + im * im);
+    m_rotRe = re * norm;
+    m_rotIm = im * norm;
+}
+
+void FmDemodulator::demodulate(std::vector<uint8_t> &rdsBits)
+{
+    const float *table = sineTable();
+    const size_t n = m_baseI.size();
+    const float scale = float(MpxRate / (2.0 * kPi * MaxDeviation));
+    m_sum.resize(n);
+    m_diff.resize(n);
+
+    for (size_t k = 0; k < n; ++k) {
+        // Polar discriminator: phase step between consecutive samples
+        const float i = m_baseI[k], q = m_baseQ[k];
+        const float mpx = fastAtan2(q * m_lastI - i * m_lastQ, i * m_lastI + q * m_lastQ) * scale;
+        m_lastI = i;
+        m_lastQ = q;
+
+        // Pilot A sin(phi) against cos(theta): (A/2) sin(phi - theta)
+        const uint32_t phase = m_pllPhase;
+        const float error = mpx * cosAt(table, phase);
+        m_pilotLevel += (mpx * sinAt(table, phase) - m_pilotLevel) * kLevelAlpha;
+        if (!m_pilotLocked && m_pilotLevel > kLockLevel) m_pilotLocked = true;
+        else if (m_pilotLocked && m_pilotLevel < kUnlockLevel) m_pilotLocked = false;
+        m_pllStep = std::clamp(m_pllStep + kLoopI * error, kPilotStep - kMaxPull, kPilotStep + kMaxPull);
+        // Without a pilot, drift back to free running rather than along the noise
+        if (!m_pilotLocked) m_pllStep += (kPilotStep - m_pllStep) * kFreeRunAlpha;
+
+        m_sum[k] = mpx;
+        m_diff[k] = 2.0f * mpx * sinAt(table, 2 * phase);
+        m_cycleI += mpx * sinAt(table, 3 * phase);
+        m_cycleQ += mpx * cosAt(table, 3 * phase);
+
+        m_pllPhase = phase + uint32_t(int64_t(m_pllStep + kLoopP * error));
+        if (m_pllPhase < phase) sliceRds(rdsBits); // pilot cycle complete
+    }
+}
+
+void FmDemodulator::sliceRds(std::vector<uint8_t> &rdsBits)
+{
+    const int slot = int(m_cycles % 16);
+    m_ringI[slot] = m_cycleI;
+    m_ringQ[slot] = m_cycleQ;
+    m_cycleI = m_cycleQ = 0.0f;
+    ++m_cycles;
+    if (m_cycles < 16) return;
+
+    // The last 16 cycles (8 per half) are one biphase symbol for this alignment
+    const int alignment = int(m_cycles % 16);
+    float symbol[2] = {0.0f, 0.0f};
+    for (int j = 0; j < 16; ++j) {
+        const int index = int((m_cycles + uint64_t(j)) % 16);
+        const float sign = j < 8 ? 1.0f : -1.0f;
+        symbol[0] += sign * m_ringI[index];
+        symbol[1] += sign * m_ringQ[index];
+    }
+
+    bool level[2];
+    for (int c = 0; c < 2; ++c) {
+        m_energy[alignment][c] += (symbol[c] * symbol[c] - m_energy[alignment][c]) * kRdsEnergyAlpha;
+        level[c] = symbol[c] > 0.0f;
+    }
+    // Differential decoding also removes the 180 degree carrier ambiguity
+    if (alignment == m_bestAlignment) {
+        rdsBits.push_back(level[m_bestComponent] != m_lastSymbol[alignment][m_bestComponent] ? 1 : 0);
+    }
+    m_lastSymbol[alignment][0] = level[0];
+    m_lastSymbol[alignment][1] = level[1];
+
+    // Once per bit: follow the strongest alignment, with some hysteresis
+    if (alignment == 0) {
+        int best = m_bestAlignment, component = m_bestComponent;
+        for (int a = 0; a < 16; ++a) {
+            for (int c = 0; c < 2; ++c) {
+                if (m_energy[a][c] > 1.5f * m_energy[best][component]) {
+                    best = a;
+                    component = c;
+                }
+            }
+        }
+        m_bestAlignment = best;
+        m_bestComponent = component;
+    }
+}
+
+FmDemodulator::Quality FmDemodulator::measure(int inputRate, double offset, const float *iq, size_t count)
+{
+    FmDemodulator probe(inputRate);
+    probe.setOffset(offset);
+    probe.mix(iq, count);
+    probe.m_channelI.process(probe.m_mixI.data(), count, probe.m_baseI);
+    probe.m_channelQ.process(probe.m_mixQ.data(), count, probe.m_baseQ);
+    // Skip the filter's start-up transient
+    const size_t settle = size_t(probe.m_channelI.taps() / probe.m_decimation + 1);
+    if (probe.m_baseI.size() > 2 * settle) {
+        probe.m_baseI.erase(probe.m_baseI.begin(), probe.m_baseI.begin() + std::ptrdiff_t(settle));
+        probe.m_baseQ.erase(probe.m_baseQ.begin(), probe.m_baseQ.begin() + std::ptrdiff_t(settle));
+    }
+    return envelopeQuality(probe.m_baseI, probe.m_baseQ);
+}
+
+size_t FmDemodulator::bytesPerSample(IqFormat format)
+{
+    switch (format) {
+    case IqFormat::U8: return 2;
+    case IqFormat::S16: return 4;
+    case IqFormat::F32: break;
+    }
+    return 8;
+}
+
+void FmDemodulator::toFloat(IqFormat format, const uint8_t *data, size_t bytes, std::vector<float> &iq)
+{
+    const size_t samples = bytes / bytesPerSample(format);
+    iq.resize(samples * 2);
+    if (format == IqFormat::U8) {
+        for (size_t k = 0; k < samples * 2; ++k) iq[k] = (float(data[k]) - 127.5f) / 127.5f;
+    } else if (format == IqFormat::S16) {
+        for (size_t k = 0; k < samples * 2; ++k) {
+            const int16_t v = int16_t(uint16_t(data[2 * k]) | uint16_t(data[2 * k + 1]) << 8);
+            iq[k] = float(v) / 32768.0f;
+        }
+    } else {
+        std::memcpy(iq.data(), data, samples * 2 * sizeof(float));
+    }
+}
+
+// =============================================================================
+// MODULATOR
+// =============================================================================
+
+FmModulator::FmModulator(int sampleRate)
+    : m_sampleRate(sampleRate)
+{
+}
+
+void FmModulator::setTones(double leftHz, double rightHz)
+{
+    m_leftHz = leftHz;
+    m_rightHz = rightHz;
+}
+
+void FmModulator::setCarrierToNoise(double db)
+{
+    if (db <= 0.0) {
+        m_noise = 0.0;
+        return;
+    }
+    // Carrier power 0.25; noise spread over the whole capture
+    const double noisePower = 0.25 / std::pow(10.0, db / 10.0) * m_sampleRate / 240000.0;
+    m_noise = std::sqrt(noisePower / 2.0);
+}
+
+void FmModulator::generate(size_t count, std::vector<float> &iq)
+{
+    const float *table = sineTable();
+    const double deviation = FmDemodulator::MaxDeviation / m_sampleRate * kPhaseUnits;
+    const double offsetStep = m_offset / m_sampleRate * kPhaseUnits;
+    const uint32_t pilotStep = uint32_t(19000.0 / m_sampleRate * kPhaseUnits);
+    const uint32_t leftStep = uint32_t(m_leftHz / m_sampleRate * kPhaseUnits);
+    const uint32_t rightStep = uint32_t(m_rightHz / m_sampleRate * kPhaseUnits);
+    std::normal_distribution<float> noise(0.0f, float(m_noise));
+
+    iq.reserve(iq.size() + count * 2);
+    for (size_t k = 0; k < count; ++k) {
+        const float left = 0.4f * sinAt(table, m_leftPhase);
+        const float right = 0.4f * sinAt(table, m_rightPhase);
+        float mpx = 0.5f * (left + right) + 0.5f * (left - right) * sinAt(table, 2 * m_pilotPhase);
+        if (m_pilot) mpx += 0.09f * sinAt(table, m_pilotPhase);
+        if (m_rds) {
+            // Biphase symbol of the differentially encoded bit, 8 pilot cycles per half
+            const float level = (m_rdsLevel ? 1.0f : -1.0f) * (m_secondHalf ? -1.0f : 1.0f);
+            mpx += 0.04f * level * sinAt(table, 3 * m_pilotPhase);
+        }
+
+        const uint32_t pilot = m_pilotPhase;
+        m_pilotPhase += pilotStep;
+        m_leftPhase += leftStep;
+        m_rightPhase += rightStep;
+        if (m_pilotPhase < pilot && ++m_halfCycles == 8) {
+            m_halfCycles = 0;
+            m_secondHalf = !m_secondHalf;
+            if (!m_secondHalf && m_rds) {
+                if (m_rdsPos >= m_rdsBits.size()) {
+                    m_rdsBits.clear();
+                    m_rdsPos = 0;
+                    m_rds->generate(1024, m_rdsBits);
+                }
+                m_rdsLevel = m_rdsLevel != (m_rdsBits[m_rdsPos++] != 0);
+            }
+        }
+
+        m_phase += offsetStep + deviation * mpx;
+        const uint32_t carrier = uint32_t(int64_t(std::fmod(m_phase, kPhaseUnits)));
+        float i = 0.5f * cosAt(table, carrier);
+        float q = 0.5f * sinAt(table, carrier);
+        if (m_noise > 0.0) {
+            i += noise(m_rng);
+            q += noise(m_rng);
+        }
+        iq.push_back(i);
+        iq.push_back(q);
+    }
+    m_phase = std::fmod(m_phase, kPhaseUnits);
+}
+
+void FmModulator::toU8(const std::vector<float> &iq, std::vector<uint8_t> &out)
+{
+    out.resize(iq.size());
+    for (size_t k = 0; k < iq.size(); ++k) out[k] = uint8_t(std::clamp(std::lround(iq[k] * 127.5f + 127.5f), 0L, 255L));
+}
@@ -0,0 +1,175 @@
+#ifndef FMDEMODULATOR_H
+#define FMDEMODULATOR_H
+
+#include <cstddef>
+#include <cstdint>
+#include <random>
+#include <vector>
+
+class RdsEncoder;
+
+/**
+ * @brief Decimating FIR low-pass (windowed sinc, Hamming), one output per
+ * `factor` inputs. The taps are symmetric, so every output is one
+ * contiguous SIMD dot product over the input history.
+ */
+class FirDecimator
+{
+public:
+    FirDecimator() = default;
+    // cutoff as a fraction of the input rate (0..0.5); taps rounded up to a multiple of 8
+    FirDecimator(int factor, int taps, double cutoff);
+
+    void reset();
+    void process(const float *in, size_t count, std::vector<float> &out);
+    int taps() const { return int(m_taps.size()); }
+
+private:
+    int m_factor = 1;
+    std::vector<float> m_taps;
+    std::vector<float> m_history; // taps - 1 samples of context, then the block
+    size_t m_next = 0;            // history index of the next output's newest sample
+};
+
+/**
+ * @brief Software FM broadcast receiver for recorded or live complex IQ.
+ *
+ * Input at any multiple of MpxRate (960 kHz, 1.2, 1.92 and 2.4 Msps are
+ * the usual SDR rates):
+ *
+ * 1. The channel is shifted to DC (complex rotator) and low-passed to
+ *    +-140 kHz while decimating to MpxRate.
+ * 2. A polar discriminator yields the multiplex (MPX), scaled so the
+ *    75 kHz maximum deviation reads 1.0.
+ * 3. A PLL locks to the 19 kHz pilot. Its phase doubled demodulates L-R
+ *    at 38 kHz; tripled, it gives the 57 kHz RDS carrier and, divided by
+ *    16, the RDS bit clock (1187.5 Hz = 19 kHz / 16).
+ * 4. L+R and L-R are low-passed to 15 kHz while decimating to AudioRate,
+ *    matrixed (blending to mono while the pilot is not locked) and
+ *    de-emphasised.
+ * 5. RDS: the 57 kHz products are integrated per pilot cycle; the 16
+ *    possible biphase symbol alignments are tracked and the strongest one
+ *    (in phase or in quadrature to the pilot) is sliced and differentially
+ *    decoded into data bits for RdsDecoder.
+ *
+ * Without a pilot (mono transmissions) RDS is only recovered while the
+ * free-running 19 kHz reference stays coherent with the station's carrier.
+ */
+class FmDemodulator
+{
+public:
+    static constexpr int MpxRate = 240000;
+    static constexpr int AudioRate = 48000;
+    static constexpr double MaxDeviation = 75000.0;
+
+    enum class IqFormat { U8, S16, F32 }; // rtl_sdr .cu8, .cs16, .cf32
+
+    struct Quality {
+        float powerDb = -100.0f; // channel power, dBFS
+        float snrDb = 0.0f;      // from the envelope spread (FM is constant-envelope)
+    };
+
+    explicit FmDemodulator(int inputRate);
+    static bool supportsRate(int inputRate) { return inputRate >= 2 * MpxRate && inputRate % MpxRate == 0; }
+
+    void reset();
+    void setOffset(double hz);         // station relative to the capture centre
+    void setDeemphasis(double tauUs);  // 50 (Europe), 75 (Americas), 0 = off
+    int inputRate() const { return m_inputRate; }
+    double offset() const { return m_offset; }
+
+    // `count` complex samples, interleaved I/Q. Appends interleaved stereo
+    // audio at AudioRate and RDS data bits (0/1 per byte).
+    void process(const float *iq, size_t count, std::vector<float> &audio, std::vector<uint8_t> &rdsBits);
+
+    const Quality &quality() const { return m_quality; } // of the last block
+    bool pilotLocked() const { return m_pilotLocked; }
+    double pilotFrequency() const;                        // Hz
+
+    // Quality of one channel without demodulating it (seek, scan, AF checks)
+    static Quality measure(int inputRate, double offset, const float *iq, size_t count);
+
+    static size_t bytesPerSample(IqFormat format);
+    // Raw samples to interleaved floats in [-1, 1]; trailing partial samples are dropped
+    static void toFloat(IqFormat format, const uint8_t *data, size_t bytes, std::vector<float> &iq);
+
+private:
+    void mix(const float *iq, size_t count);
+    void demodulate(std::vector<uint8_t> &rdsBits);
+    void sliceRds(std::vector<uint8_t> &rdsBits);
+
+    int m_inputRate;
+    int m_decimation;
+    double m_offset = 0.0;
+
+    // Channel: rotator and filters
+    double m_rotRe = 1.0, m_rotIm = 0.0;
+    double m_stepRe = 1.0, m_stepIm = 0.0;
+    FirDecimator m_channelI, m_channelQ;
+    std::vector<float> m_mixI, m_mixQ, m_baseI, m_baseQ;
+    float m_lastI = 0.0f, m_lastQ = 0.0f;
+    Quality m_quality;
+
+    // Pilot PLL, phase in 2^32 units per cycle
+    uint32_t m_pllPhase = 0;
+    double m_pllStep = 0.0;
+    double m_pilotLevel = 0.0;
+    bool m_pilotLocked = false;
+
+    // Audio
+    std::vector<float> m_sum, m_diff, m_sumAudio, m_diffAudio;
+    FirDecimator m_audioSum, m_audioDiff;
+    float m_blend = 0.0f;      // 0 mono .. 1 stereo
+    float m_deemphasis = 1.0f; // one-pole coefficient
+    float m_deemL = 0.0f, m_deemR = 0.0f;
+
+    // RDS: per-pilot-cycle integrals, last 16 cycles
+    float m_cycleI = 0.0f, m_cycleQ = 0.0f;
+    float m_ringI[16] = {}, m_ringQ[16] = {};
+    uint64_t m_cycles = 0;
+    float m_energy[16][2] = {};
+    bool m_lastSymbol[16][2] = {};
+    int m_bestAlignment = 0;
+    int m_bestComponent = 0;
+};
+
+/**
+ * @brief FM broadcast signal generator for tests and benchmarks: a stereo
+ * tone pair with pilot and RDS (from an RdsEncoder), frequency modulated
+ * onto a carrier at `offset` in a capture of `sampleRate`, plus noise.
+ */
+class FmModulator
+{
+public:
+    explicit FmModulator(int sampleRate);
+
+    void setOffset(double hz) { m_offset = hz; }
+    void setTones(double leftHz, double rightHz);
+    void setPilot(bool enabled) { m_pilot = enabled; }
+    void setRds(RdsEncoder *encoder) { m_rds = encoder; } // not owned; null = none
+    void setCarrierToNoise(double db);                    // in a 240 kHz channel; 0 = no noise
+
+    // Appends `count` interleaved I/Q samples (carrier amplitude 0.5)
+    void generate(size_t count, std::vector<float> &iq);
+    static void toU8(const std::vector<float> &iq, std::vector<uint8_t> &out);
+
+private:
+    int m_sampleRate;
+    double m_offset = 0.0;
+    double m_leftHz = 1000.0, m_rightHz = 2500.0;
+    bool m_pilot = true;
+    RdsEncoder *m_rds = nullptr;
+    double m_noise = 0.0; // per-component standard deviation
+
+    double m_phase = 0.0;      // carrier
+    uint32_t m_pilotPhase = 0;
+    uint32_t m_leftPhase = 0, m_rightPhase = 0;
+    int m_halfCycles = 0;      // pilot cycles into the current RDS half symbol
+    bool m_secondHalf = false;
+    bool m_rdsLevel = false;   // differentially encoded bit
+    std::vector<uint8_t> m_rdsBits;
+    size_t m_rdsPos = 0;
+    std::mt19937 m_rng{0x1F0};
+};
+
+#endif // FMDEMODULATOR_H
@@ -0,0 +1,495 @@
+#include "RdsDecoder.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+namespace {
+
+constexpr uint32_t kPoly = 0x5B9; // x^10 + x^8 + x^7 + x^5 + x^4 + x^3 + 1
+constexpr uint16_t kOffsetWords[RdsDecoder::OffsetCount] = {0x0FC, 0x198, 0x168, 0x350, 0x1B4};
+constexpr int kMaxTableBurst = 5;
+constexpr int kMaxBadBlocks = 12;  // consecutive uncorrectable blocks before resync
+constexpr int kGroupsPerMinute = 685;
+
+uint32_t remainderBitwise(uint32_t value, int bits) {
+    for (int i = bits - 1; i >= 10; --i) {
+        if (value & (1u << i)) value ^= kPoly << (i - 10);
+    }
+    return value & 0x3FF;
+}
+
+struct Tables {
+    uint16_t high[256];      // (b << 18) mod g
+    uint16_t mid[256];       // (b << 10) mod g
+    uint32_t error[1024];    // syndrome -> shortest burst pattern
+    uint8_t burst[1024];     // its length, 0 = none
+
+    Tables() {
+        for (uint32_t b = 0; b < 256; ++b) {
+            high[b] = uint16_t(remainderBitwise(b << 18, 26));
+            mid[b] = uint16_t(remainderBitwise(b << 10, 26));
+        }
+        std::memset(error, 0, sizeof(error));
+        std::memset(burst, 0, sizeof(burst));
+        // Bursts: first and last bit set, anything in between; shortest wins
+        for (int length = 1; length <= kMaxTableBurst; ++length) {
+            const uint32_t inner = length > 2 ? (1u << (length - 2)) : 1;
+            for (uint32_t fill = 0; fill < inner; ++fill) {
+                const uint32_t pattern = length == 1 ? 1u : ((1u << (length - 1)) | (fill << 1) | 1u);
+                for (int shift = 0; shift + length <= 26; ++shift) {
+                    const uint32_t e = pattern << shift;
+                    const uint16_t s = uint16_t(remainderBitwise(e, 26));
+                    if (s && !burst[s]) {
+                        error[s] = e;
+                        burst[s] = uint8_t(length);
+                    }
+                }
+            }
+        }
+    }
+};
+
+const Tables &tables() {
+    static const Tables t;
+    return t;
+}
+
+} // namespace
+
+// =============================================================================
+// CODE
+// =============================================================================
+
+uint16_t RdsDecoder::syndrome(uint32_t block) {
+    const Tables &t = tables();
+    return uint16_t(t.high[(block >> 18) & 0xFF] ^ t.mid[(block >> 10) & 0xFF] ^ (block & 0x3FF));
+}
+
+uint16_t RdsDecoder::checkword(uint16_t data, Offset offset) {
+    const Tables &t = tables();
+    return uint16_t(t.high[data >> 8] ^ t.mid[data & 0xFF] ^ kOffsetWords[offset]);
+}
+
+int RdsDecoder::dateToMjd(int year, int month, int day) {
+    const int y = year - 1900;
+    const int l = (month == 1 || month == 2) ? 1 : 0;
+    return 14956 + day + int((y - l) * 365.25) + int((month + 1 + l * 12) * 30.6001);
+}
+
+void RdsDecoder::mjdToDate(int mjd, int &year, int &month, int &day) {
+    const int yp = int((mjd - 15078.2) / 365.25);
+    const int mp = int((mjd - 14956.1 - int(yp * 365.25)) / 30.6001);
+    day = mjd - 14956 - int(yp * 365.25) - int(mp * 30.6001);
+    const int k = (mp == 14 || mp == 15) ? 1 : 0;
+    year = 1900 + yp + k;
+    month = mp - 1 - k * 12;
+}
+
+// =============================================================================
+// DECODER
+// =============================================================================
+
+RdsDecoder::RdsDecoder() {
+    tables();
+    reset();
+}
+
+void RdsDecoder::reset() {
+    m_register = 0;
+    m_bitIndex = 0;
+    m_synced = false;
+    m_blockBits = 0;
+    m_expected = 0;
+    m_badBlocks = 0;
+    m_hitCount = 0;
+    std::fill(std::begin(m_groupValid), std::end(m_groupValid), false);
+
+    const bool hadData = m_hasPi || !m_ps.empty() || !m_rt.empty() || !m_afs.empty() || m_clock.valid;
+    m_hasPi = false;
+    m_pi = 0;
+    m_pty = -1;
+    m_tp = false;
+    m_ps.clear();
+    m_rt.clear();
+    m_afs.clear();
+    m_afSkipNext = false;
+    m_clock = ClockTime();
+    m_changes = hadData ? (PiChanged | PtyChanged | PsChanged | RadioTextChanged | AfChanged | ClockChanged) : 0;
+
+    std::memset(m_psBuffer, ' ', sizeof(m_psBuffer));
+    m_psMask = 0;
+    m_psCandidate.clear();
+    std::memset(m_rtBuffer, ' ', sizeof(m_rtBuffer));
+    m_rtMask = 0;
+    m_rtEnd = 64;
+    m_rtFlag = -1;
+    m_rtCandidate.clear();
+    m_stats = Stats();
+}
+
+unsigned RdsDecoder::takeChanges() {
+    const unsigned changes = m_changes;
+    m_changes = 0;
+    return changes;
+}
+
+void RdsDecoder::pushBits(const uint8_t *bits, size_t count) {
+    for (size_t i = 0; i < count; ++i) pushBit(bits[i] & 1);
+}
+
+void RdsDecoder::pushPacked(const uint8_t *bytes, size_t count) {
+    for (size_t i = 0; i < count; ++i) {
+        for (int b = 7; b >= 0; --b) pushBit((bytes[i] >> b) & 1);
+    }
+}
+
+void RdsDecoder::pushBit(int bit) {
+    m_register = ((m_register << 1) | uint32_t(bit)) & 0x3FFFFFF;
+    ++m_bitIndex;
+    ++m_stats.bits;
+
+    if (m_synced) {
+        if (++m_blockBits == 26) {
+            m_blockBits = 0;
+            decodeBlock();
+        }
+    } else if (m_bitIndex >= 26) {
+        acquire();
+    }
+}
+
+void RdsDecoder::acquire() {
+    const uint16_t s = syndrome(m_register);
+    int position = -1;
+    bool cPrime = false;
+    for (int o = 0; o < OffsetCount; ++o) {
+        if (s == kOffsetWords[o]) {
+            position = o == OffsetA ? 0 : o == OffsetB ? 1 : o == OffsetD ? 3 : 2;
+            cPrime = o == OffsetCPrime;
+            break;
+        }
+    }
+    if (position < 0) return;
+
+    // Two offset words at block distance and in block order lock the clock
+    for (int i = 0; i < m_hitCount; ++i) {
+        const uint64_t distance = m_bitIndex - m_hits[i].bit;
+        if (distance % 26 || distance / 26 > 6) continue;
+        if ((m_hits[i].position + int(distance / 26)) % 4 != position) continue;
+
+        m_synced = true;
+        m_blockBits = 0;
+        m_badBlocks = 0;
+        m_hitCount = 0;
+        std::fill(std::begin(m_groupValid), std::end(m_groupValid), false);
+        m_group[position] = uint16_t(m_register >> 10);
+        m_groupValid[position] = true;
+        if (position == 2) m_cPrime = cPrime;
+        m_expected = (position + 1) % 4;
+        ++m_stats.blocks;
+        if (position == 3) handleGroup();
+        return;
+    }
+
+    if (m_hitCount == 8) {
+        std::memmove(m_hits, m_hits + 1, sizeof(Hit) * 7);
+        --m_hitCount;
+    }
+    m_hits[m_hitCount++] = {m_bitIndex, position};
+}
+
+void RdsDecoder::decodeBlock() {
+    const Tables &t = tables();
+    const int position = m_expected;
+    m_expected = (position + 1) % 4;
+    ++m_stats.blocks;
+
+    uint32_t block = m_register;
+    const uint16_t s = syndrome(block);
+    const Offset candidates[2] = {position == 0 ? OffsetA : position == 1 ? OffsetB : position == 2 ? OffsetC : OffsetD,
+                                  OffsetCPrime};
+    const int candidateCount = position == 2 ? 2 : 1;
+
+    int matched = -1;
+    for (int c = 0; c < candidateCount && matched < 0; ++c) {
+        if (s == kOffsetWords[candidates[c]]) matched = c;
+    }
+    for (int c = 0; c < candidateCount && matched < 0; ++c) {
+        const uint16_t errorSyndrome = s ^ kOffsetWords[candidates[c]];
+        if (t.burst[errorSyndrome] && t.burst[errorSyndrome] <= m_maxBurst) {
+            block ^= t.error[errorSyndrome];
+            matched = c;
+            ++m_stats.corrected;
+        }
+    }
+
+    if (position == 0) std::fill(std::begin(m_groupValid), std::end(m_groupValid), false);
+    if (matched < 0) {
+        ++m_stats.uncorrectable;
+        m_groupValid[position] = false;
+        if (++m_badBlocks > kMaxBadBlocks) {
+            m_synced = false;
+            m_hitCount = 0;
+            ++m_stats.syncLosses;
+        }
+    } else {
+        m_badBlocks = 0;
+        m_group[position] = uint16_t(block >> 10);
+        m_groupValid[position] = true;
+        if (position == 2) m_cPrime = candidates[matched] == OffsetCPrime;
+    }
+    if (position == 3) handleGroup();
+}
+
+// =============================================================================
+// GROUPS
+// =============================================================================
+
+void RdsDecoder::setPi(uint16_t pi) {
+    if (m_hasPi && pi == m_pi) return;
+    if (m_hasPi) {
+        // Another programme: everything learned about the old one is void
+        m_ps.clear();
+        m_rt.clear();
+        m_afs.clear();
+        m_psMask = 0;
+        m_psCandidate.clear();
+        m_rtMask = 0;
+        m_rtFlag = -1;
+        m_rtCandidate.clear();
+        m_changes |= PsChanged | RadioTextChanged | AfChanged;
+    }
+    m_hasPi = true;
+    m_pi = pi;
+    m_changes |= PiChanged;
+}
+
+void RdsDecoder::handleGroup() {
+    ++m_stats.groups;
+    const bool *valid = m_groupValid;
+    const uint16_t *g = m_group;
+
+    if (valid[0]) setPi(g[0]);
+    if (valid[2] && m_cPrime) setPi(g[2]);
+    if (!valid[1]) return;
+
+    const int type = g[1] >> 12;
+    const bool versionB = (g[1] >> 11) & 1;
+    const bool tp = (g[1] >> 10) & 1;
+    const int pty = (g[1] >> 5) & 0x1F;
+    if (pty != m_pty || tp != m_tp) {
+        m_pty = pty;
+        m_tp = tp;
+        m_changes |= PtyChanged;
+    }
+
+    switch (type) {
+    case 0:
+        if (valid[3]) handlePs(g[1] & 3, g[3]);
+        if (!versionB && valid[2]) {
+            handleAf(uint8_t(g[2] >> 8));
+            handleAf(uint8_t(g[2] & 0xFF));
+        }
+        break;
+    case 2:
+        if (!versionB && valid[2] && valid[3]) {
+            const uint16_t words[2] = {g[2], g[3]};
+            handleRadioText(g[1] & 0xF, (g[1] >> 4) & 1, words, 2);
+        } else if (versionB && valid[3]) {
+            handleRadioText(g[1] & 0xF, (g[1] >> 4) & 1, &g[3], 1);
+        }
+        break;
+    case 4:
+        if (!versionB && valid[2] && valid[3]) {
+            const int mjd = ((g[1] & 3) << 15) | (g[2] >> 1);
+            const int hour = ((g[2] & 1) << 4) | (g[3] >> 12);
+            const int minute = (g[3] >> 6) & 0x3F;
+            const int offset = ((g[3] >> 5) & 1 ? -1 : 1) * (g[3] & 0x1F);
+            if (hour > 23 || minute > 59 || mjd < 15079) break;
+            ClockTime clock;
+            clock.valid = true;
+            mjdToDate(mjd, clock.year, clock.month, clock.day);
+            clock.hour = hour;
+            clock.minute = minute;
+            clock.offsetHalfHours = offset;
+            m_clock = clock;
+            m_changes |= ClockChanged;
+        }
+        break;
+    default:
+        break;
+    }
+}
+
+void RdsDecoder::handlePs(int segment, uint16_t chars) {
+    const char c0 = char(chars >> 8);
+    const char c1 = char(chars & 0xFF);
+    const unsigned bit = 1u << segment;
+    // A segment that changed under us restarts the assembly
+    if ((m_psMask & bit) && (m_psBuffer[segment * 2] != c0 || m_psBuffer[segment * 2 + 1] != c1)) m_psMask = 0;
+    m_psBuffer[segment * 2] = c0;
+    m_psBuffer[segment * 2 + 1] = c1;
+    m_psMask |= bit;
+    if (m_psMask != 0xF) return;
+
+    m_psMask = 0;
+    std::string candidate(m_psBuffer, 8);
+    if (candidate == m_psCandidate && candidate != m_ps) {
+        m_ps = candidate;
+        m_changes |= PsChanged;
+    }
+    m_psCandidate.swap(candidate);
+}
+
+void RdsDecoder::handleRadioText(int segment, bool abFlag, const uint16_t *words, int wordCount) {
+    if (m_rtFlag != int(abFlag)) {
+        // Text A/B toggled: the broadcaster started a new message
+        if (m_rtFlag >= 0) std::memset(m_rtBuffer, ' ', sizeof(m_rtBuffer));
+        m_rtFlag = abFlag;
+        m_rtMask = 0;
+        m_rtEnd = 64;
+        m_rtCandidate.clear();
+    }
+
+    const int perSegment = wordCount * 2;
+    const int limit = perSegment * 16;
+    const int base = segment * perSegment;
+    const unsigned bit = 1u << segment;
+    char chars[4];
+    for (int w = 0; w < wordCount; ++w) {
+        chars[w * 2] = char(words[w] >> 8);
+        chars[w * 2 + 1] = char(words[w] & 0xFF);
+    }
+    if ((m_rtMask & bit) && std::memcmp(m_rtBuffer + base, chars, size_t(perSegment)) != 0) m_rtMask = 0;
+    std::memcpy(m_rtBuffer + base, chars, size_t(perSegment));
+    m_rtMask |= bit;
+    for (int i = 0; i < perSegment; ++i) {
+        if (chars[i] == '\r') m_rtEnd = std::min(m_rtEnd, base + i);
+    }
+
+    const int end = std::min(m_rtEnd, limit);
+    const int segments = end == 0 ? 1 : (end + perSegment - 1) / perSegment;
+    const unsigned needed = segments >= 32 ? ~0u : ((1u << segments) - 1);
+    if ((m_rtMask & needed) != needed) return;
+
+    m_rtMask = 0;
+    std::string candidate(m_rtBuffer, size_t(end));
+    while (!candidate.empty() && candidate.back() == ' ') candidate.pop_back();
+    if (candidate == m_rtCandidate && candidate != m_rt) {
+        m_rt = candidate;
+        m_changes |= RadioTextChanged;
+    }
+    m_rtCandidate.swap(candidate);
+}
+
+void RdsDecoder::handleAf(uint8_t code) {
+    if (m_afSkipNext) {
+        m_afSkipNext = false;
+        return;
+    }
+    if (code == 250) {
+        m_afSkipNext = true;
+        return;
+    }
+    if (code < 1 || code > 204) return; // count header (224-249), filler (205), unused
+    const int frequency = 8750 + code * 10;
+    if (m_afs.size() >= 25 || std::find(m_afs.begin(), m_afs.end(), frequency) != m_afs.end()) return;
+    m_afs.push_back(frequency);
+    m_changes |= AfChanged;
+}
+
+// =============================================================================
+// ENCODER
+// =============================================================================
+
+void RdsEncoder::setStation(uint16_t pi, int pty, const std::string &ps, const std::string &radioText,
+                            const std::vector<int> &afs, bool tp) {
+    m_pi = pi;
+    m_pty = pty & 0x1F;
+    m_tp = tp;
+    m_ps = (ps + "        ").substr(0, 8);
+    m_rt = radioText.substr(0, 64);
+
+    // AF method A: count header, then the frequencies in pairs, filler-padded
+    m_afCodes.clear();
+    const size_t count = std::min<size_t>(afs.size(), 25);
+    if (count > 0) {
+        m_afCodes.push_back(uint8_t(224 + count));
+        for (size_t i = 0; i < count; ++i) m_afCodes.push_back(uint8_t((afs[i] - 8750) / 10));
+        if (m_afCodes.size() % 2) m_afCodes.push_back(205);
+    }
+    m_psSegment = 0;
+    m_afIndex = 0;
+    m_rtSegment = 0;
+}
+
+void RdsEncoder::setClock(int year, int month, int day, int hour, int minute, int offsetHalfHours) {
+    m_hasClock = true;
+    m_mjd = RdsDecoder::dateToMjd(year, month, day);
+    m_hour = hour;
+    m_minute = minute;
+    m_offset = offsetHalfHours;
+    m_nextClockGroup = m_groupCount;
+}
+
+void RdsEncoder::nextGroup(uint16_t blocks[4]) {
+    const uint16_t header = uint16_t((m_tp ? 1 : 0) << 10 | m_pty << 5);
+    blocks[0] = m_pi;
+
+    if (m_hasClock && m_groupCount >= m_nextClockGroup) {
+        blocks[1] = uint16_t(4 << 12 | header | ((m_mjd >> 15) & 3));
+        blocks[2] = uint16_t(((m_mjd & 0x7FFF) << 1) | (m_hour >> 4));
+        blocks[3] = uint16_t((m_hour & 0xF) << 12 | m_minute << 6 | (m_offset < 0 ? 1 : 0) << 5 | (std::abs(m_offset) & 0x1F));
+        m_nextClockGroup += kGroupsPerMinute;
+        if (++m_minute == 60) {
+            m_minute = 0;
+            if (++m_hour == 24) {
+                m_hour = 0;
+                ++m_mjd;
+            }
+        }
+    } else if (m_groupCount % 2 == 0 || m_rt.empty()) {
+        // 0A: PS segment, music flag set, AF pair
+        blocks[1] = uint16_t(header | 1 << 3 | m_psSegment);
+        if (m_afCodes.empty()) {
+            blocks[2] = 0xCDCD;
+        } else {
+            blocks[2] = uint16_t(m_afCodes[m_afIndex] << 8 | m_afCodes[m_afIndex + 1]);
+            m_afIndex = (m_afIndex + 2) % int(m_afCodes.size());
+        }
+        blocks[3] = uint16_t(uint8_t(m_ps[m_psSegment * 2]) << 8 | uint8_t(m_ps[m_psSegment * 2 + 1]));
+        m_psSegment = (m_psSegment + 1) % 4;
+    } else {
+        // 2A: four RadioText characters, terminated by CR when shorter than 64
+        std::string text = m_rt;
+        if (text.size() < 64) text += '\r';
+        const int segments = int((text.size() + 3) / 4);
+        text.resize(size_t(segments) * 4, ' ');
+        blocks[1] = uint16_t(2 << 12 | header | m_rtSegment);
+        blocks[2] = uint16_t(uint8_t(text[m_rtSegment * 4]) << 8 | uint8_t(text[m_rtSegment * 4 + 1]));
+        blocks[3] = uint16_t(uint8_t(text[m_rtSegment * 4 + 2]) << 8 | uint8_t(text[m_rtSegment * 4 + 3]));
+        m_rtSegment = (m_rtSegment + 1) % segments;
+    }
+    ++m_groupCount;
+}
+
+void RdsEncoder::generate(size_t count, std::vector<uint8_t> &bits) {
+    static const RdsDecoder::Offset kOrder[4] = {RdsDecoder::OffsetA, RdsDecoder::OffsetB, RdsDecoder::OffsetC, RdsDecoder::OffsetD};
+    bits.reserve(bits.size() + count);
+    while (count > 0) {
+        if (m_pendingPos == m_pending.size()) {
+            uint16_t blocks[4];
+            nextGroup(blocks);
+            m_pending.clear();
+            m_pendingPos = 0;
+            for (int b = 0; b < 4; ++b) {
+                const uint32_t block = uint32_t(blocks[b]) << 10 | RdsDecoder::checkword(blocks[b], kOrder[b]);
+                for (int i = 25; i >= 0; --i) m_pending.push_back(uint8_t((block >> i) & 1));
+            }
+        }
+        const size_t take = std::min(count, m_pending.size() - m_pendingPos);
+        bits.insert(bits.end(), m_pending.begin() + long(m_pendingPos), m_pending.begin() + long(m_pendingPos + take));
+        m_pendingPos += take;
+        count -= take;
+    }
+}
@@ -0,0 +1,181 @@
+#ifndef RDSDECODER_H
+#define RDSDECODER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/**
+ * @brief RDS (IEC 62106) decoder from the raw demodulated bit stream.
+ *
+ * Block sync is acquired from the syndromes of a sliding 26-bit window:
+ * two offset words whose distance and order agree lock the block clock.
+ * Synced blocks are checked against the expected offset word and repaired
+ * through a 1024-entry syndrome -> burst-error table. Groups 0A/0B (PS, AF,
+ * TP/TA), 2A/2B (RadioText) and 4A (clock time) are parsed; PI and PTY come
+ * from every group.
+ *
+ * PS and RadioText are only published after the same complete text has
+ * been received twice in a row, so a miscorrected or half-updated segment
+ * never reaches the UI.
+ */
+class RdsDecoder
+{
+public:
+    enum Offset { OffsetA, OffsetB, OffsetC, OffsetCPrime, OffsetD, OffsetCount };
+
+    // Bits in takeChanges()
+    enum Change : unsigned {
+        PiChanged = 1u << 0,
+        PtyChanged = 1u << 1,
+        PsChanged = 1u << 2,
+        RadioTextChanged = 1u << 3,
+        AfChanged = 1u << 4,
+        ClockChanged = 1u << 5,
+    };
+
+    struct ClockTime {
+        bool valid = false;
+        int year = 0, month = 0, day = 0; // UTC date
+        int hour = 0, minute = 0;         // UTC time
+        int offsetHalfHours = 0;          // local time offset
+    };
+
+    struct Stats {
+        uint64_t bits = 0;
+        uint64_t blocks = 0;
+        uint64_t corrected = 0;
+        uint64_t uncorrectable = 0;
+        uint64_t groups = 0;
+        uint64_t syncLosses = 0;
+    };
+
+    RdsDecoder();
+
+    void reset();
+
+    // One bit per byte (0/1)
+    void pushBits(const uint8_t *bits, size_t count);
+    // Packed, MSB first (recorded streams)
+    void pushPacked(const uint8_t *bytes, size_t count);
+    void pushBit(int bit);
+
+    // Bursts up to this length are repaired (the code reaches 5; beyond 2
+    // the miscorrection rate on noisy blocks climbs quickly)
+    void setMaxBurst(int bits) { m_maxBurst = bits; }
+
+    bool isSynced() const { return m_synced; }
+    bool hasPi() const { return m_hasPi; }
+    uint16_t pi() const { return m_pi; }
+    int pty() const { return m_pty; }
+    bool trafficProgramme() const { return m_tp; }
+    const std::string &ps() const { return m_ps; }
+    const std::string &radioText() const { return m_rt; }
+    const std::vector<int> &alternativeFrequencies() const { return m_afs; } // FM tuner units (10 kHz)
+    const ClockTime &clockTime() const { return m_clock; }
+    const Stats &stats() const { return m_stats; }
+
+    // Fields changed since the last call
+    unsigned takeChanges();
+
+    // Encoder side: 10-bit checkword for `data` in the block position `offset`
+    static uint16_t checkword(uint16_t data, Offset offset);
+    static uint16_t syndrome(uint32_t block);
+    // MJD <-> calendar date (RDS 4A)
+    static int dateToMjd(int year, int month, int day);
+    static void mjdToDate(int mjd, int &year, int &month, int &day);
+
+private:
+    void acquire();
+    void decodeBlock();
+    void handleGroup();
+    void handlePs(int segment, uint16_t chars);
+    void handleRadioText(int segment, bool abFlag, const uint16_t *words, int words16);
+    void handleAf(uint8_t code);
+    void setPi(uint16_t pi);
+
+    int m_maxBurst = 2;
+
+    // Bit / block sync
+    uint32_t m_register = 0;   // last 26 bits
+    uint64_t m_bitIndex = 0;
+    bool m_synced = false;
+    int m_blockBits = 0;       // bits into the current synced block
+    int m_expected = 0;        // next block position 0..3 (A, B, C/C', D)
+    int m_badBlocks = 0;       // consecutive uncorrectable blocks
+    struct Hit { uint64_t bit; int position; };
+    Hit m_hits[8];
+    int m_hitCount = 0;
+
+    // Group assembly
+    uint16_t m_group[4] = {};
+    bool m_groupValid[4] = {};
+    bool m_cPrime = false;
+
+    // Decoded state
+    bool m_hasPi = false;
+    uint16_t m_pi = 0;
+    int m_pty = -1;
+    bool m_tp = false;
+    std::string m_ps;
+    std::string m_rt;
+    std::vector<int> m_afs;
+    bool m_afSkipNext = false; // LF/MF frequency follows code 250
+    ClockTime m_clock;
+    unsigned m_changes = 0;
+
+    // PS / RT assembly and double-receive validation
+    char m_psBuffer[8];
+    unsigned m_psMask = 0;
+    std::string m_psCandidate;
+    char m_rtBuffer[64];
+    unsigned m_rtMask = 0;
+    int m_rtEnd = 64;          // chars up to the 0x0D terminator
+    int m_rtFlag = -1;
+    std::string m_rtCandidate;
+
+    Stats m_stats;
+};
+
+/**
+ * @brief RDS group generator for the simulated tuner, tests and benchmarks.
+ *
+ * Cycles 0A (PS + AF method A) and 2A (RadioText) groups, with a 4A clock
+ * group once a minute of stream time, and serializes them with checkwords
+ * as the raw 1187.5 bit/s stream.
+ */
+class RdsEncoder
+{
+public:
+    static constexpr double BitRate = 1187.5;
+
+    void setStation(uint16_t pi, int pty, const std::string &ps, const std::string &radioText,
+                    const std::vector<int> &afs, bool tp = false);
+    void setClock(int year, int month, int day, int hour, int minute, int offsetHalfHours = 0);
+
+    // Appends `count` bits (one per byte) of the stream
+    void generate(size_t count, std::vector<uint8_t> &bits);
+    void nextGroup(uint16_t blocks[4]);
+
+private:
+    uint16_t m_pi = 0;
+    int m_pty = 0;
+    bool m_tp = false;
+    std::string m_ps = "        ";
+    std::string m_rt;
+    std::vector<uint8_t> m_afCodes;
+
+    bool m_hasClock = false;
+    int m_mjd = 0, m_hour = 0, m_minute = 0, m_offset = 0;
+
+    uint64_t m_groupCount = 0;
+    int m_psSegment = 0;
+    int m_afIndex = 0;
+    int m_rtSegment = 0;
+    uint64_t m_nextClockGroup = 0;
+    std::vector<uint8_t> m_pending; // bits of the current group not yet handed out
+    size_t m_pendingPos = 0;
+};
+
+#endif // RDSDECODER_H
@@ -4,41 +4,50 @@
 #include <QJsonDocument>
 #include <QJsonArray>
 #include <QJsonObject>
+#include <QTimeZone>
 #include <QDebug>
-#include <QRandomGenerator>
 
-RadioTuner::RadioTuner(QObject *parent)
+RadioTuner::RadioTuner(IRadioHAL *hal, QObject *parent)
     : QObject(parent),
+      m_hal(hal),
       m_currentBand(BandFM),
-      m_isScanning(false)
+      m_isSeeking(false)
 {
     m_model = new RadioModel(this);
+    m_scanner = new BandScanner(hal, this);
     m_frequency = 8750; // 87.5 MHz default
-
-    m_scanTimer = new QTimer(this);
-    m_scanTimer->setInterval(200);
-    connect(m_scanTimer, &QTimer::timeout, this, [this]() {
-        stepUp();
-        // Simulate finding a station randomly
-        if (m_frequency % 50 == 0) { // e.g. 90.0, 95.0
-             m_isScanning = false;
-             m_scanTimer->stop();
-             emit scanningChanged();
-        }
-    });
-    
-    // Seek down timer
-    m_seekDownTimer = new QTimer(this);
-    m_seekDownTimer->setInterval(200);
-    connect(m_seekDownTimer, &QTimer::timeout, this, [this]() {
-        stepDown();
-        // Simulate finding a station randomly
-        if (m_frequency % 50 == 0) {
-             m_isScanning = false;
-             m_seekDownTimer->stop();
-             emit scanningChanged();
-        }
+    connect(m_scanner, &BandScanner::runningChanged, this, &RadioTuner::scanningChanged);
+    m_dab = new DabServiceList(QString(), this);
+    connect(m_dab, &DabServiceList::ensembleUpdated, this, [this](int channel) {
+        if (m_currentBand == BandDAB && channel == m_frequency) updateStationName();
     });
+    connect(m_model, &QAbstractItemModel::rowsInserted, this, &RadioTuner::rebuildPresetIndex);
+    connect(m_model, &QAbstractItemModel::rowsRemoved, this, &RadioTuner::rebuildPresetIndex);
+    connect(m_model, &QAbstractItemModel::modelReset, this, &RadioTuner::rebuildPresetIndex);
+
+    m_psTimer = new QTimer(this);
+    m_psTimer->setSingleShot(true);
+    m_psTimer->setInterval(PsDebounceMs);
+    connect(m_psTimer, &QTimer::timeout, this, &RadioTuner::publishRdsName);
+    m_rtTimer = new QTimer(this);
+    m_rtTimer->setSingleShot(true);
+    m_rtTimer->setInterval(RadioTextDebounceMs);
+    connect(m_rtTimer, &QTimer::timeout, this, &RadioTuner::publishRadioText);
+
+    if (!m_hal) {
+        qWarning() << "RadioTuner created with null HAL!";
+    } else {
+        // Queued: results arrive from the HAL thread, final values only
+        connect(m_hal, &IRadioHAL::tuned, this, &RadioTuner::onHalTuned);
+        connect(m_hal, &IRadioHAL::signalMeasured, this, &RadioTuner::onHalTuned);
+        connect(m_hal, &IRadioHAL::alternativeSwitched, this, &RadioTuner::onHalAlternativeSwitched);
+        connect(m_hal, &IRadioHAL::seekFinished, this, &RadioTuner::onHalSeekFinished);
+        connect(m_hal, &IRadioHAL::seekProgress, this, &RadioTuner::onHalSeekProgress);
+        connect(m_hal, &IRadioHAL::rdsData, this, &RadioTuner::onHalRdsData);
+        connect(m_hal, &IRadioHAL::ficData, this, &RadioTuner::onHalFicData);
+        m_hal->setBand(IRadioHAL::Band(m_currentBand));
+        m_hal->tune(m_frequency);
+    }
 
     loadPresets();
 }
@@ -49,19 +58,11 @@ QString RadioTuner::frequencyString() const {
     return formatFrequency(m_frequency);
 }
 
-QString RadioTuner::stationName() const {
-    // Check presets
-    for (const auto &s : m_model->getAll()) {
-        if (s.frequency == frequencyString()) return s.name;
-    }
-    // Check DAB logic or RDS simulation
-    if (m_currentBand == BandDAB) return "DAB Station " + frequencyString();
-    return "";
-}
+QString RadioTuner::stationName() const { return m_stationName; }
 
 RadioTuner::Band RadioTuner::band() const { return m_currentBand; }
 RadioModel* RadioTuner::model() const { return m_model; }
-bool RadioTuner::isScanning() const { return m_isScanning; }
+bool RadioTuner::isScanning() const { return m_isSeeking || m_scanner->isRunning(); }
 
 void RadioTuner::setBand(Band band) {
     if (m_currentBand == band) return;
@@ -71,35 +72,41 @@ void RadioTuner::setBand(Band band) {
     if (m_currentBand == BandFM) m_frequency = 8750;
     else if (m_currentBand == BandAM) m_frequency = 531;
     else if (m_currentBand == BandDAB) m_frequency = 0;
+    resetStationData();
+
+    // Cancels a seek in progress; the HAL retunes to the band start
+    if (m_isSeeking) {
+        m_isSeeking = false;
+        emit scanningChanged();
+    }
+    if (m_hal) m_hal->setBand(IRadioHAL::Band(m_currentBand));
 
     emit bandChanged();
     emit frequencyChanged();
-    emit stationNameChanged();
+    updateStationName();
 }
 
 void RadioTuner::tuneTo(int frequency) {
     int newFreq = clampFrequency(frequency);
-    if (m_frequency != newFreq) {
+    const bool wasScanning = m_isSeeking;
+    if (wasScanning) {
+        // Manual tuning overrides a seek in progress (the HAL has moved on)
+        m_isSeeking = false;
+        emit scanningChanged();
+    }
+    if (m_frequency != newFreq || wasScanning) {
         m_frequency = newFreq;
-        // Simulate signal strength (random 50-100 for stations on .5, lower for others)
-        m_signalStrength = (m_frequency % 50 == 0) ? (75 + QRandomGenerator::global()->bounded(25)) : (30 + QRandomGenerator::global()->bounded(40));
-        emit signalStrengthChanged();
+        resetStationData();
+        // Signal strength follows from the HAL once the tuner has settled
+        if (m_hal) m_hal->tune(m_frequency);
         emit frequencyChanged();
-        emit stationNameChanged();
         updateStationName();
     }
 }
 
 void RadioTuner::tuneToString(const QString &frequency) {
-    if (m_currentBand == BandFM) {
-        bool ok;
-        double f = frequency.toDouble(&ok);
-        if (ok) tuneTo(static_cast<int>(f * 100 + 0.5));
-    } else if (m_currentBand == BandAM) {
-        bool ok;
-        int f = frequency.toInt(&ok);
-        if (ok) tuneTo(f);
-    }
+    const int f = parseFrequency(m_currentBand, frequency);
+    if (f >= 0) tuneTo(f);
 }
 
 void RadioTuner::stepUp() {
@@ -111,44 +118,197 @@ void RadioTuner::stepDown() {
 }
 
 void RadioTuner::seekUp() {
-    // Simulate seek
-    m_isScanning = true;
-    emit scanningChanged();
-    m_scanTimer->start();
+    startSeek(true);
 }
 
 void RadioTuner::seekDown() {
-    // Proper seek down implementation
-    m_isScanning = true;
-    emit scanningChanged();
-    m_seekDownTimer->start();
+    startSeek(false);
 }
 
 void RadioTuner::scan() {
-    m_isScanning = true;
+    // Background tuner: the list fills in while the current station keeps playing
+    m_scanner->start(IRadioHAL::Band(m_currentBand));
+}
+
+void RadioTuner::stopScan() {
+    m_scanner->cancel();
+}
+
+void RadioTuner::tuneToAvailable(int index) {
+    const ScannedStation station = m_scanner->stations()->getStation(index);
+    if (station.band.isEmpty()) return;
+    if (m_scanner->band() != IRadioHAL::Band(m_currentBand)) setBand(Band(m_scanner->band()));
+    tuneTo(station.channel);
+}
+
+void RadioTuner::startSeek(bool up) {
+    if (!m_hal) return;
+    // Frequency, name and signal stay on the last station until the result arrives
+    m_seekStart = m_frequency;
+    m_seekUp = up;
+    m_seekProgress = 0.0;
+    emit seekProgressChanged();
+    if (!m_isSeeking) {
+        m_isSeeking = true;
+        emit scanningChanged();
+    }
+    m_hal->seek(up);
+}
+
+// HAL Results
+void RadioTuner::onHalTuned(int frequency, int signalStrength) {
+    if (m_isSeeking || frequency != m_frequency || signalStrength == m_signalStrength) return;
+    m_signalStrength = signalStrength;
+    emit signalStrengthChanged();
+}
+
+void RadioTuner::onHalSeekFinished(int frequency, int signalStrength, bool found) {
+    if (!m_isSeeking) return; // superseded by manual tuning
+    m_isSeeking = false;
+    m_seekProgress = 1.0;
+    m_frequency = frequency;
+    resetStationData();
+    m_signalStrength = signalStrength;
+
+    emit seekProgressChanged();
+    emit signalStrengthChanged();
+    emit frequencyChanged();
+    updateStationName();
     emit scanningChanged();
-    // Simulate scan by clearing and repopulating logic, 
-    // but here we just start seeking for next
-    m_scanTimer->start();
+    if (found) emit stationFound(frequencyString(), stationName());
+}
+
+void RadioTuner::onHalSeekProgress(int frequency) {
+    if (!m_isSeeking) return;
+    // Distance covered in the seek direction, as a fraction of the band
+    const int span = maxFreq() - minFreq() + stepSize();
+    int covered = m_seekUp ? frequency - m_seekStart : m_seekStart - frequency;
+    if (covered < 0) covered += span;
+    m_seekProgress = double(covered) / span;
+    emit seekProgressChanged();
+}
+
+// RDS
+void RadioTuner::onHalRdsData(const QByteArray &bits) {
+    if (m_isSeeking) return; // stale batch from before the seek
+    m_rds.pushBits(reinterpret_cast<const uint8_t *>(bits.constData()), size_t(bits.size()));
+    const unsigned changes = m_rds.takeChanges();
+    if (!changes) return;
+
+    // Decoder output can change every group; the UI gets the settled value
+    if ((changes & RdsDecoder::PsChanged) && !m_psTimer->isActive()) m_psTimer->start();
+    if ((changes & RdsDecoder::RadioTextChanged) && !m_rtTimer->isActive()) m_rtTimer->start();
+    if (changes & RdsDecoder::ClockChanged) {
+        const RdsDecoder::ClockTime &ct = m_rds.clockTime();
+        m_rdsClock = QDateTime(QDate(ct.year, ct.month, ct.day), QTime(ct.hour, ct.minute), QTimeZone::utc())
+                         .toOffsetFromUtc(ct.offsetHalfHours * 1800);
+    }
+    if (changes & (RdsDecoder::PiChanged | RdsDecoder::PtyChanged | RdsDecoder::ClockChanged)) emit rdsChanged();
+    if (changes & (RdsDecoder::PiChanged | RdsDecoder::AfChanged)) updateAfFollowing();
+}
+
+void RadioTuner::onHalAlternativeSwitched(int from, int to, int signalStrength) {
+    if (m_isSeeking || m_currentBand != BandFM || from != m_frequency) return; // tuned elsewhere since
+    // Same programme on another frequency: RDS and the displayed name carry over
+    m_frequency = to;
+    m_signalStrength = signalStrength;
+    emit frequencyChanged();
+    emit signalStrengthChanged();
+    updateStationName();
+}
+
+void RadioTuner::setAfEnabled(bool enabled) {
+    if (m_afEnabled == enabled) return;
+    m_afEnabled = enabled;
+    updateAfFollowing();
+    emit afEnabledChanged();
+}
+
+void RadioTuner::updateAfFollowing() {
+    if (!m_hal || m_currentBand != BandFM) return;
+    if (m_afEnabled && m_rds.hasPi()) m_hal->followAlternatives(m_frequency, m_rds.pi(), alternativeFrequencies());
+    else m_hal->followAlternatives(m_frequency, 0, {});
+}
+
+void RadioTuner::publishRdsName() {
+    const QString name = QString::fromLatin1(m_rds.ps().c_str()).trimmed();
+    if (name == m_rdsName) return;
+    m_rdsName = name;
+    updateStationName();
+}
+
+void RadioTuner::publishRadioText() {
+    const QString text = QString::fromLatin1(m_rds.radioText().c_str()).trimmed();
+    if (text == m_radioText) return;
+    m_radioText = text;
+    emit radioTextChanged();
+}
+
+void RadioTuner::resetStationData() {
+    const bool hadRds = m_rds.hasPi() || m_rds.pty() >= 0 || m_rdsClock.isValid();
+    m_rds.reset();
+    m_rds.takeChanges();
+    m_psTimer->stop();
+    m_rtTimer->stop();
+    m_rdsClock = QDateTime();
+    // The retune refreshes the station name
+    m_rdsName.clear();
+    m_dabServiceId = 0;
+    if (!m_radioText.isEmpty()) {
+        m_radioText.clear();
+        emit radioTextChanged();
+    }
+    if (hadRds) emit rdsChanged();
+    emit programmeChanged();
+}
+
+QString RadioTuner::programType() const {
+    // RDS (Europe) programme type codes
+    static const char *const names[32] = {
+        "", "News", "Current Affairs", "Information", "Sport", "Education", "Drama", "Culture",
+        "Science", "Varied", "Pop Music", "Rock Music", "Easy Listening", "Light Classical", "Serious Classical", "Other Music",
+        "Weather", "Finance", "Children's", "Social Affairs", "Religion", "Phone-In", "Travel", "Leisure",
+        "Jazz Music", "Country Music", "National Music", "Oldies Music", "Folk Music", "Documentary", "Alarm Test", "Alarm"};
+    const int pty = m_rds.pty();
+    return pty >= 0 ? QString::fromLatin1(names[pty & 31]) : QString();
+}
+
+QString RadioTuner::piCode() const {
+    return m_rds.hasPi() ? QString::number(m_rds.pi(), 16).toUpper().rightJustified(4, '0') : QString();
+}
+
+QVector<int> RadioTuner::alternativeFrequencies() const {
+    const std::vector<int> &afs = m_rds.alternativeFrequencies();
+    return QVector<int>(afs.begin(), afs.end());
+}
+
+// DAB
+void RadioTuner::onHalFicData(int channel, const QByteArray &fibs) {
+    if (m_isSeeking || m_currentBand != BandDAB || channel != m_frequency) return;
+    m_dab->pushFic(channel, fibs);
+}
+
+void RadioTuner::tuneToService(int index) {
+    const DabServiceEntry service = m_dab->services()->getService(index);
+    if (service.channel < 0) return;
+    setBand(BandDAB);
+    tuneTo(service.channel);
+    // Same ensemble: no retune, only the service changes
+    m_dabServiceId = service.serviceId;
+    updateStationName();
 }
 
 // Private Helpers
 int RadioTuner::minFreq() const {
-    if (m_currentBand == BandFM) return 8750; // 87.50 MHz
-    if (m_currentBand == BandAM) return 531;  // 531 kHz
-    return 0;
+    return IRadioHAL::bandPlan(IRadioHAL::Band(m_currentBand)).min;
 }
 
 int RadioTuner::maxFreq() const {
-    if (m_currentBand == BandFM) return 10800; // 108.00 MHz
-    if (m_currentBand == BandAM) return 1602;  // 1602 kHz
-    return 15; // DAB Channels
+    return IRadioHAL::bandPlan(IRadioHAL::Band(m_currentBand)).max;
 }
 
 int RadioTuner::stepSize() const {
-    if (m_currentBand == BandFM) return 10; // 0.1 MHz -> 10 units
-    if (m_currentBand == BandAM) return 9;  // 9 kHz
-    return 1;
+    return IRadioHAL::bandPlan(IRadioHAL::Band(m_currentBand)).step;
 }
 
 int RadioTuner::clampFrequency(int freq) {
@@ -158,48 +318,75 @@ int RadioTuner::clampFrequency(int freq) {
 }
 
 QString RadioTuner::formatFrequency(int freq) const {
-    if (m_currentBand == BandFM) {
-        return QString::number(freq / 100.0, 'f', 1);
+    return IRadioHAL::channelLabel(IRadioHAL::Band(m_currentBand), freq);
+}
+
+qint64 RadioTuner::presetKey(int band, int frequency) {
+    return qint64(band) << 32 | quint32(frequency);
+}
+
+int RadioTuner::parseFrequency(Band band, const QString &frequency) {
+    bool ok = false;
+    if (band == BandFM) {
+        const double f = frequency.toDouble(&ok);
+        return ok ? static_cast<int>(f * 100 + 0.5) : -1;
     }
-    if (m_currentBand == BandAM) {
-        return QString::number(freq);
+    if (band == BandAM) {
+        const int f = frequency.toInt(&ok);
+        return ok ? f : -1;
     }
-    if (m_currentBand == BandDAB) {
-         static const QStringList dabChannels = { "5A", "5B", "5C", "5D", "6A", "6B", "6C", "6D", "12A", "12B", "12C", "12D" };
-         if (freq >= 0 && freq < dabChannels.size()) return dabChannels[freq];
-         return "5A";
+    const IRadioHAL::BandPlan plan = IRadioHAL::bandPlan(IRadioHAL::BandDAB);
+    for (int ch = plan.min; ch <= plan.max; ++ch) {
+        if (IRadioHAL::channelLabel(IRadioHAL::BandDAB, ch) == frequency) return ch;
     }
-    return "";
+    return -1;
 }
 
-void RadioTuner::updateStationName() {
-    // Update active preset
-    QList<RadioStation> stations = m_model->getAll();
-    QString currentFreqStr = formatFrequency(m_frequency);
-    
-    int activeIndex = -1;
-    for (int i=0; i<stations.count(); ++i) {
-        if (stations[i].frequency == currentFreqStr) {
-            activeIndex = i;
-            break;
-        }
+void RadioTuner::rebuildPresetIndex() {
+    // Runs on preset edits only; lookups while tuning are integer hashes
+    m_presetIndex.clear();
+    const QList<RadioStation> &stations = m_model->getAll();
+    for (int i = 0; i < stations.count(); ++i) {
+        const Band band = stations[i].band == "AM" ? BandAM : stations[i].band == "DAB" ? BandDAB : BandFM;
+        const int frequency = parseFrequency(band, stations[i].frequency);
+        // First preset wins for duplicates, as the linear search did
+        if (frequency >= 0 && !m_presetIndex.contains(presetKey(band, frequency)))
+            m_presetIndex.insert(presetKey(band, frequency), i);
     }
+    updateStationName();
+}
+
+void RadioTuner::updateStationName() {
+    const int activeIndex = m_presetIndex.value(presetKey(m_currentBand, m_frequency), -1);
     m_model->setActive(activeIndex);
+
+    // Preset name, then RDS or the DAB service label, then the DAB placeholder
+    QString name;
+    if (activeIndex >= 0) name = m_model->getAll().at(activeIndex).name;
+    else if (!m_rdsName.isEmpty()) name = m_rdsName;
+    else if (m_currentBand == BandDAB) name = m_dab->serviceLabel(m_frequency, m_dabServiceId);
+    if (name.isEmpty() && m_currentBand == BandDAB) name = "DAB Station " + frequencyString();
+    if (name == m_stationName) return;
+    m_stationName = name;
+    emit stationNameChanged();
 }
 
 void RadioTuner::tuneToPreset(int index) {
     if (index < 0 || index >= m_model->rowCount()) return;
-    RadioStation s = m_model->getStation(index);
-    // Parse Logic
-    // ... Assume correct band for simplicity or switch band
-    tuneToString(s.frequency);
+    const RadioStation &s = m_model->getAll().at(index);
+    const Band band = s.band == "AM" ? BandAM : s.band == "DAB" ? BandDAB : BandFM;
+    const int frequency = parseFrequency(band, s.frequency);
+    if (frequency < 0) return;
+    setBand(band);
+    tuneTo(frequency);
 }
 
 void RadioTuner::savePreset() {
     RadioStation s;
     s.frequency = formatFrequency(m_frequency);
     s.band = (m_currentBand == BandFM) ? "FM" : (m_currentBand == BandAM) ? "AM" : "DAB";
-    s.name = "Saved " + s.frequency; // Could lookup RDS here
+    const QString live = m_currentBand == BandDAB ? m_dab->serviceLabel(m_frequency, m_dabServiceId) : m_rdsName;
+    s.name = live.isEmpty() ? "Saved " + s.frequency : live;
     m_model->addStation(s);
     
     // Persist
@@ -2,8 +2,14 @@
 #define RADIOTUNER_H
 
 #include <QObject>
+#include <QDateTime>
+#include <QHash>
 #include <QTimer>
 #include "Models/RadioModel.h"
+#include "HAL/IRadioHAL.h"
+#include "Radio/BandScanner.h"
+#include "Radio/RdsDecoder.h"
+#include "Radio/DabServiceList.h"
 
 class RadioTuner : public QObject
 {
@@ -14,15 +20,25 @@ class RadioTuner : public QObject
     Q_PROPERTY(int band READ bandInt WRITE setBandInt NOTIFY bandChanged)
     Q_PROPERTY(bool isScanning READ isScanning NOTIFY scanningChanged)
     Q_PROPERTY(RadioModel* model READ model CONSTANT)
+    Q_PROPERTY(BandScanner* scanner READ scanner CONSTANT)
+    Q_PROPERTY(StationListModel* availableStations READ availableStations CONSTANT)
+    Q_PROPERTY(DabServiceModel* dabServices READ dabServices CONSTANT)
     Q_PROPERTY(bool hasError READ hasError NOTIFY hasErrorChanged)
     Q_PROPERTY(QString errorMessage READ errorMessage NOTIFY errorMessageChanged)
     Q_PROPERTY(int signalStrength READ signalStrength NOTIFY signalStrengthChanged)
+    Q_PROPERTY(double seekProgress READ seekProgress NOTIFY seekProgressChanged)
+    Q_PROPERTY(QString radioText READ radioText NOTIFY radioTextChanged)
+    Q_PROPERTY(QString programType READ programType NOTIFY rdsChanged)
+    Q_PROPERTY(QString piCode READ piCode NOTIFY rdsChanged)
+    Q_PROPERTY(QDateTime rdsClock READ rdsClock NOTIFY rdsChanged)
+    Q_PROPERTY(bool afEnabled READ afEnabled WRITE setAfEnabled NOTIFY afEnabledChanged)
 
 public:
     enum Band { BandFM = 0, BandAM = 1, BandDAB = 2 };
     Q_ENUM(Band)
 
-    explicit RadioTuner(QObject *parent = nullptr);
+    // The HAL lives on its own thread; without one tuning is local only
+    explicit RadioTuner(IRadioHAL *hal, QObject *parent = nullptr);
 
     // Getters
     int frequency() const; // Stored as integer (kHz for AM, 100*MHz for FM)
@@ -31,10 +47,25 @@ public:
     Band band() const;
     int bandInt() const { return static_cast<int>(m_currentBand); }
     RadioModel* model() const;
+    BandScanner* scanner() const { return m_scanner; }
+    StationListModel* availableStations() const { return m_scanner->stations(); }
+    DabServiceModel* dabServices() const { return m_dab->services(); } // cached, all ensembles
+    DabServiceList* dab() const { return m_dab; }
     bool isScanning() const;
     bool hasError() const { return m_hasError; }
     QString errorMessage() const { return m_errorMessage; }
     int signalStrength() const { return m_signalStrength; }
+    double seekProgress() const { return m_seekProgress; } // 0..1 of the band while seeking
+
+    // RDS of the tuned station (empty until decoded)
+    QString radioText() const { return m_radioText; }
+    QString programType() const;
+    QString piCode() const;
+    QDateTime rdsClock() const { return m_rdsClock; } // station clock, with its local offset
+    QVector<int> alternativeFrequencies() const;
+    // Follow the RDS network to a better alternative frequency (on by default)
+    bool afEnabled() const { return m_afEnabled; }
+    void setAfEnabled(bool enabled);
 
     // Control
     void setBand(Band band);
@@ -45,7 +76,10 @@ public:
     Q_INVOKABLE void stepDown();
     Q_INVOKABLE void seekUp();
     Q_INVOKABLE void seekDown();
-    Q_INVOKABLE void scan();
+    Q_INVOKABLE void scan();     // full-band background sweep, tuning stays free
+    Q_INVOKABLE void stopScan();
+    Q_INVOKABLE void tuneToAvailable(int index);
+    Q_INVOKABLE void tuneToService(int index); // row of dabServices
 
     // Presets interaction
     Q_INVOKABLE void loadPresets();
@@ -61,26 +95,68 @@ signals:
     void hasErrorChanged();
     void errorMessageChanged();
     void signalStrengthChanged();
+    void seekProgressChanged();
+    void radioTextChanged();
+    void rdsChanged();
+    void afEnabledChanged();
+    // Another station was tuned (not an AF switch: that is the same programme)
+    void programmeChanged();
     void stationFound(const QString &freq, const QString &name);
     void presetRemoved(int index);
 
+private slots:
+    void onHalTuned(int frequency, int signalStrength);
+    void onHalSeekFinished(int frequency, int signalStrength, bool found);
+    void onHalSeekProgress(int frequency);
+    void onHalRdsData(const QByteArray &bits);
+    void onHalAlternativeSwitched(int from, int to, int signalStrength);
+    void onHalFicData(int channel, const QByteArray &fibs);
+    void publishRdsName();
+    void publishRadioText();
+    void rebuildPresetIndex();
+
 private:
+    IRadioHAL *m_hal;
     int m_frequency; // Unit: 10kHz for FM (98.3 -> 9830), 1kHz for AM
     Band m_currentBand;
-    bool m_isScanning;
+    bool m_isSeeking;
+    BandScanner *m_scanner;
     bool m_hasError = false;
     QString m_errorMessage;
-    int m_signalStrength = 75; // Simulated 0-100
+    int m_signalStrength = 75; // 0-100, reported by the HAL
+    double m_seekProgress = 0.0;
+    int m_seekStart = 0;
+    bool m_seekUp = true;
     RadioModel *m_model;
-    QTimer *m_scanTimer;
-    QTimer *m_seekDownTimer;
+    QHash<qint64, int> m_presetIndex; // presetKey(band, frequency) -> model row
+    QString m_stationName;            // cached; refreshed by updateStationName()
+
+    // RDS: PS and RadioText reach QML at most once per debounce interval
+    static constexpr int PsDebounceMs = 1000;
+    static constexpr int RadioTextDebounceMs = 2000;
+    RdsDecoder m_rds;
+    QTimer *m_psTimer;
+    QTimer *m_rtTimer;
+    QString m_rdsName;
+    QString m_radioText;
+    QDateTime m_rdsClock;
+    bool m_afEnabled = true;
+
+    // DAB: service layer and the selected service of the tuned ensemble
+    DabServiceList *m_dab;
+    quint32 m_dabServiceId = 0; // 0 = first audio service
 
     // Helpers
     int minFreq() const;
     int maxFreq() const;
     int stepSize() const;
     QString formatFrequency(int freq) const;
+    static qint64 presetKey(int band, int frequency);
+    static int parseFrequency(Band band, const QString &frequency); // -1 if invalid
     void updateStationName();
+    void startSeek(bool up);
+    void resetStationData(); // RDS and DAB service state of the previous station
+    void updateAfFollowing(); // hands the current RDS network to the HAL
     
     // Validates and wraps frequency
     int clampFrequency(int freq);
@@ -0,0 +1,286 @@
+#include "TileService.h"
+#include "SystemSettings.h"
+#include <QDebug>
+#include <QDir>
+#include <QFileInfo>
+#include <QNetworkAccessManager>
+#include <QNetworkInformation>
+#include <QNetworkReply>
+#include <QStandardPaths>
+#include <QTcpServer>
+#include <QTcpSocket>
+#include <algorithm>
+
+Q_LOGGING_CATEGORY(vcTiles, "nordic.tiles")
+
+namespace {
+// Per SystemSettings::MapStyle: %1 zoom, %2 x, %3 y
+const char *const kUpstream[TileServer::StyleCount] = {
+    "https://tile.openstreetmap.org/%1/%2/%3.png",                                          // Standard
+    "https://a.basemaps.cartocdn.com/dark_all/%1/%2/%3.png",                                // Dark
+    "https://server.arcgisonline.com/ArcGIS/rest/services/World_Imagery/MapServer/tile/%1/%3/%2", // Satellite
+    "https://a.basemaps.cartocdn.com/light_all/%1/%2/%3.png",                               // Hybrid/Light
+};
+// The OSM tile usage policy forbids bulk downloading from tile.openstreetmap.org
+constexpr bool kPrefetchAllowed[TileServer::StyleCount] = {false, true, true, true};
+constexpr int kMaxRequestBytes = 8192;
+}
+
+// =============================================================================
+// SERVER (tile thread)
+// =============================================================================
+
+TileServer::TileServer(const QString &storePath, qint64 budgetBytes)
+    : m_storePath(storePath),
+      m_budget(budgetBytes)
+{
+}
+
+QString TileServer::upstreamUrl(quint64 key) {
+    const TileStore::Tile tile = TileStore::tile(key);
+    return QString(kUpstream[tile.style]).arg(tile.zoom).arg(tile.x).arg(tile.y);
+}
+
+QString TileServer::upstreamHost(int style) {
+    return QString(kUpstream[style]).section("%1", 0, 0);
+}
+
+bool TileServer::allowsPrefetch(int style) {
+    return kPrefetchAllowed[style];
+}
+
+quint16 TileServer::listen() {
+    m_network = new QNetworkAccessManager(this);
+    m_server = new QTcpServer(this);
+    connect(m_server, &QTcpServer::newConnection, this, &TileServer::onNewConnection);
+    if (!m_server->listen(QHostAddress::LocalHost)) {
+        qCWarning(vcTiles) << "Tile server: cannot listen" << m_server->errorString();
+        return 0;
+    }
+    return m_server->serverPort();
+}
+
+void TileServer::open() {
+    if (!m_store.open(m_storePath, m_budget)) return;
+    qCInfo(vcTiles) << "Tile store:" << m_storePath << m_store.count() << "tiles," << m_store.bytes() / (1024 * 1024) << "MB";
+}
+
+void TileServer::close() {
+    m_prefetch.clear();
+    if (m_server) m_server->close();
+    m_store.close();
+}
+
+void TileServer::setOnline(bool online) {
+    m_online = online;
+    pumpPrefetch();
+}
+
+void TileServer::prefetch(const QList<quint64> &tiles) {
+    m_prefetch.assign(tiles.begin(), tiles.end());
+    m_prefetchedBytes = 0;
+    pumpPrefetch();
+}
+
+void TileServer::prefetchRoute(const RoutePath &path, int style) {
+    if (path.isEmpty() || !allowsPrefetch(style)) return;
+
+    // Around the destination first, then along the route, coarse to fine
+    QList<quint64> tiles;
+    for (int zoom = MinPrefetchZoom; zoom <= MaxDestinationZoom; ++zoom) {
+        for (quint64 key : TileStore::around(path.last(), style, zoom, DestinationMeters)) tiles.append(key);
+    }
+    for (int zoom = MinPrefetchZoom; zoom <= MaxCorridorZoom; ++zoom) {
+        for (quint64 key : TileStore::corridor(path, style, zoom, CorridorMeters)) tiles.append(key);
+    }
+    qCDebug(vcTiles) << "Tile prefetch:" << tiles.size() << "tiles along" << path.size() << "route points";
+    prefetch(tiles);
+}
+
+void TileServer::cancelPrefetch() {
+    m_prefetch.clear();
+}
+
+void TileServer::onNewConnection() {
+    while (QTcpSocket *socket = m_server->nextPendingConnection()) {
+        connect(socket, &QTcpSocket::readyRead, this, &TileServer::onReadyRead);
+        connect(socket, &QTcpSocket::disconnected, this, [this, socket]() {
+            m_waiting.remove(socket);
+            socket->deleteLater();
+        });
+    }
+}
+
+void TileServer::onReadyRead() {
+    if (QTcpSocket *socket = qobject_cast<QTcpSocket *>(sender())) serve(socket);
+}
+
+void TileServer::serve(QTcpSocket *socket) {
+    // One request at a time: the next stays buffered until this one is answered
+    while (!m_waiting.contains(socket)) {
+        const QByteArray buffered = socket->peek(socket->bytesAvailable());
+        const qsizetype end = buffered.indexOf("\r\n\r\n");
+        if (end < 0) {
+            if (buffered.size() > kMaxRequestBytes) socket->abort();
+            return;
+        }
+        socket->skip(end + 4);
+
+        // GET /<style>/<z>/<x>/<y>.png HTTP/1.1
+        const QList<QByteArray> line = buffered.left(buffered.indexOf("\r\n")).split(' ');
+        const QList<QByteArray> parts = line.size() == 3 && line[0] == "GET" ? line[1].split('/') : QList<QByteArray>();
+        bool ok[4] = {false, false, false, false};
+        int style = 0, zoom = 0, x = 0, y = 0;
+        if (parts.size() == 5 && parts[0].isEmpty()) {
+            style = parts[1].toInt(&ok[0]);
+            zoom = parts[2].toInt(&ok[1]);
+            x = parts[3].toInt(&ok[2]);
+            y = parts[4].left(parts[4].indexOf('.')).toInt(&ok[3]);
+        }
+        if (!(ok[0] && ok[1] && ok[2] && ok[3]) || style < 0 || style >= StyleCount || zoom < 0
+            || zoom > TileStore::MaxZoom || x < 0 || y < 0 || x >= (1 << zoom) || y >= (1 << zoom)) {
+            respond(socket, QByteArray());
+            continue;
+        }
+
+        const quint64 key = TileStore::key(style, zoom, x, y);
+        const QByteArray image = m_store.read(key);
+        if (!image.isEmpty() || !m_online) {
+            respond(socket, image);
+            continue;
+        }
+        if (!m_fetching.contains(key)) fetch(key);
+        m_fetching[key].append(socket);
+        m_waiting.insert(socket);
+    }
+}
+
+void TileServer::respond(QTcpSocket *socket, const QByteArray &image) {
+    if (image.isEmpty()) {
+        socket->write("HTTP/1.1 404 Not Found\r\nContent-Length: 0\r\n\r\n");
+        return;
+    }
+    // Satellite imagery comes as JPEG
+    const QByteArray type = image.startsWith("\xFF\xD8") ? "image/jpeg" : "image/png";
+    socket->write("HTTP/1.1 200 OK\r\nContent-Type: " + type + "\r\nContent-Length: " + QByteArray::number(image.size())
+                  + "\r\n\r\n");
+    socket->write(image);
+}
+
+void TileServer::fetch(quint64 key) {
+    QNetworkRequest request(QUrl(upstreamUrl(key)));
+    request.setRawHeader("User-Agent", "NordicHeadunit/1.0");
+    request.setTransferTimeout(TransferTimeoutMs);
+    m_fetching.insert(key, {});
+    QNetworkReply *reply = m_network->get(request);
+    connect(reply, &QNetworkReply::finished, this, [this, reply, key]() { onFetched(reply, key); });
+}
+
+void TileServer::onFetched(QNetworkReply *reply, quint64 key) {
+    reply->deleteLater();
+    QByteArray image;
+    if (reply->error() == QNetworkReply::NoError) {
+        image = reply->readAll();
+        m_store.insert(key, image);
+        if (m_fetchFailing) qCInfo(vcTiles) << "Tile server: fetching again";
+        m_fetchFailing = false;
+    } else if (!m_fetchFailing) {
+        // Once per outage: while the server is unreachable every tile fails
+        qCWarning(vcTiles) << "Tile server:" << reply->url().toString() << reply->errorString();
+        m_fetchFailing = true;
+    }
+    if (m_prefetching.remove(key)) m_prefetchedBytes += image.size();
+
+    const QList<QPointer<QTcpSocket>> waiting = m_fetching.take(key);
+    for (const QPointer<QTcpSocket> &socket : waiting) {
+        if (!socket) continue;
+        m_waiting.remove(socket);
+        respond(socket, image);
+        serve(socket);
+    }
+    pumpPrefetch();
+}
+
+void TileServer::pumpPrefetch() {
+    while (m_online && m_prefetching.size() < MaxPrefetchRequests && !m_prefetch.empty()) {
+        if (m_prefetchedBytes >= PrefetchShare * m_budget) {
+            qCInfo(vcTiles) << "Tile server: prefetch stopped at" << m_prefetchedBytes / (1024 * 1024) << "MB";
+            m_prefetch.clear();
+            return;
+        }
+        const quint64 key = m_prefetch.front();
+        m_prefetch.pop_front();
+        if (m_store.contains(key) || m_fetching.contains(key)) continue;
+        m_prefetching.insert(key);
+        fetch(key);
+    }
+}
+
+// =============================================================================
+// SERVICE (GUI thread)
+// =============================================================================
+
+TileService::TileService(SystemSettings *settings, QObject *parent)
+    : QObject(parent),
+      m_settings(settings)
+{
+    QString path = qEnvironmentVariable("NORDIC_TILE_STORE");
+    if (path.isEmpty())
+        path = QStandardPaths::writableLocation(QStandardPaths::AppDataLocation) + "/tiles/tiles.nts";
+    QDir().mkpath(QFileInfo(path).absolutePath());
+    bool ok = false;
+    qint64 budgetMb = qEnvironmentVariableIntValue("NORDIC_TILE_BUDGET_MB", &ok);
+    if (!ok || budgetMb <= 0) budgetMb = DefaultBudgetMb;
+
+    m_thread = new QThread(this);
+    m_thread->setObjectName("TileServer");
+    m_server = new TileServer(path, budgetMb * 1024 * 1024);
+    m_server->moveToThread(m_thread);
+    m_thread->start();
+    // The port before the map asks for it; the store opens after, and
+    // requests meanwhile wait their turn on the tile thread
+    QMetaObject::invokeMethod(m_server, [this]() { return m_server->listen(); }, Qt::BlockingQueuedConnection, &m_port);
+    QMetaObject::invokeMethod(m_server, &TileServer::open, Qt::QueuedConnection);
+
+    // Without a reachability backend the network is taken to be there
+    if (QNetworkInformation::loadBackendByFeatures(QNetworkInformation::Feature::Reachability)) {
+        connect(QNetworkInformation::instance(), &QNetworkInformation::reachabilityChanged, this, &TileService::updateOnline);
+        updateOnline();
+    }
+    connect(m_settings, &SystemSettings::mapStyleChanged, this, &TileService::tileHostChanged);
+}
+
+TileService::~TileService() {
+    if (m_thread->isRunning()) {
+        QMetaObject::invokeMethod(m_server, &TileServer::close, Qt::BlockingQueuedConnection);
+        m_thread->quit();
+        m_thread->wait();
+    }
+    delete m_server;
+}
+
+QString TileService::tileHost() const {
+    const int style = std::clamp(int(m_settings->mapStyle()), 0, TileServer::StyleCount - 1);
+    // Straight from the tile server if the local one is not there
+    if (m_port == 0) return TileServer::upstreamHost(style);
+    return QString("http://127.0.0.1:%1/%2/").arg(m_port).arg(style);
+}
+
+void TileService::prefetchRoute(const RoutePath &path) {
+    if (path.isEmpty()) return;
+    const int style = std::clamp(int(m_settings->mapStyle()), 0, TileServer::StyleCount - 1);
+    // The corridor takes a while on a long route; worked out on the tile thread
+    QMetaObject::invokeMethod(m_server, [this, path, style]() { m_server->prefetchRoute(path, style); },
+                              Qt::QueuedConnection);
+}
+
+void TileService::cancelPrefetch() {
+    QMetaObject::invokeMethod(m_server, &TileServer::cancelPrefetch, Qt::QueuedConnection);
+}
+
+void TileService::updateOnline() {
+    const QNetworkInformation::Reachability reachability = QNetworkInformation::instance()->reachability();
+    const bool online = reachability == QNetworkInformation::Reachability::Online
+                        || reachability == QNetworkInformation::Reachability::Unknown;
+    QMetaObject::invokeMethod(m_server, [this, online]() { m_server->setOnline(online); }, Qt::QueuedConnection);
+}
@@ -0,0 +1,140 @@
+#ifndef TILESERVICE_H
+#define TILESERVICE_H
+
+#include <QObject>
+#include <QThread>
+#include <QHash>
+#include <QLoggingCategory>
+#include <QList>
+#include <QPointer>
+#include <QSet>
+#include <deque>
+#include "Navigation/RoutePath.h"
+#include "Navigation/TileStore.h"
+
+class QNetworkAccessManager;
+class QNetworkReply;
+class QTcpServer;
+class QTcpSocket;
+class SystemSettings;
+
+/**
+ * @brief Local tile server. Lives on its own thread so tile file I/O never
+ * stalls the GUI.
+ *
+ * Answers GET /<style>/<z>/<x>/<y>.png on 127.0.0.1 from the tile store.
+ * A tile not stored is fetched from the style's tile server, stored and
+ * then sent; requests for a tile already being fetched wait for the same
+ * download. A route's prefetch list is worked out here, off the GUI
+ * thread; its tiles are fetched MaxPrefetchRequests at a time, only while
+ * the network is reachable, and stop once they took PrefetchShare of the
+ * store's budget. Styles whose tile server forbids bulk downloads
+ * (openstreetmap.org) are never prefetched.
+ */
+class TileServer : public QObject
+{
+    Q_OBJECT
+
+public:
+    static constexpr int StyleCount = 4; // SystemSettings::MapStyle
+    static constexpr int MaxPrefetchRequests = 2;
+    static constexpr double PrefetchShare = 0.5;
+    static constexpr int TransferTimeoutMs = 15000;
+    static constexpr int MinPrefetchZoom = 12;
+    static constexpr int MaxCorridorZoom = 16;
+    static constexpr int MaxDestinationZoom = 17;
+    static constexpr double CorridorMeters = 250.0;
+    static constexpr double DestinationMeters = 1000.0;
+
+    TileServer(const QString &storePath, qint64 budgetBytes);
+
+    // The tile server's URL of a tile, and the part before its z/x/y
+    static QString upstreamUrl(quint64 key);
+    static QString upstreamHost(int style);
+    // False where the tile server's usage policy rules out bulk downloads
+    static bool allowsPrefetch(int style);
+
+public slots:
+    quint16 listen(); // the port, or 0 when it cannot
+    void open();      // the tile store
+    void close();
+    void setOnline(bool online);
+    // Queues the tiles to fetch, dropping any queued before
+    void prefetch(const QList<quint64> &tiles);
+    // Queues the tiles around the destination and along the route
+    void prefetchRoute(const RoutePath &path, int style);
+    void cancelPrefetch();
+
+private slots:
+    void onNewConnection();
+    void onReadyRead();
+
+private:
+    void serve(QTcpSocket *socket);
+    void respond(QTcpSocket *socket, const QByteArray &image); // 404 if empty
+    void fetch(quint64 key);
+    void onFetched(QNetworkReply *reply, quint64 key);
+    void pumpPrefetch();
+
+    QString m_storePath;
+    qint64 m_budget;
+    TileStore m_store;
+    QTcpServer *m_server = nullptr;
+    QNetworkAccessManager *m_network = nullptr;
+    bool m_online = true;
+    bool m_fetchFailing = false; // warned of the outage already
+
+    QHash<quint64, QList<QPointer<QTcpSocket>>> m_fetching; // and the requests waiting for each
+    QSet<QTcpSocket *> m_waiting;                            // sockets with a request in m_fetching
+    std::deque<quint64> m_prefetch;
+    QSet<quint64> m_prefetching;                             // fetches no request waits for
+    qint64 m_prefetchedBytes = 0;
+};
+
+/**
+ * @brief Offline map tiles: the map's tile source, and prefetching along
+ * the route.
+ *
+ * The map plugin takes its tiles from TileServer on the loopback
+ * interface, so every tile seen is kept on the flash and the map keeps
+ * working where the network does not. When a route is calculated, the
+ * tiles of the current map style within CorridorMeters of it and within
+ * DestinationMeters of the destination are fetched ahead, destination
+ * first, so the map is there on the whole drive even if the connection
+ * drops on the way. The standard OpenStreetMap style is not prefetched.
+ *
+ * The store is NORDIC_TILE_STORE (default tiles/tiles.nts in the app data
+ * directory), kept within NORDIC_TILE_BUDGET_MB megabytes (default 256).
+ */
+class TileService : public QObject
+{
+    Q_OBJECT
+    Q_PROPERTY(QString tileHost READ tileHost NOTIFY tileHostChanged)
+
+public:
+    static constexpr qint64 DefaultBudgetMb = 256;
+
+    explicit TileService(SystemSettings *settings, QObject *parent = nullptr);
+    ~TileService();
+
+    // Where the map plugin gets the current style's tiles, <host>z/x/y.png
+    QString tileHost() const;
+
+    void prefetchRoute(const RoutePath &path);
+    void cancelPrefetch();
+
+signals:
+    void tileHostChanged();
+
+private:
+    void updateOnline();
+
+    SystemSettings *m_settings;
+    QThread *m_thread;
+    TileServer *m_server;
+    quint16 m_port = 0;
+};
+
+Q_DECLARE_LOGGING_CATEGORY(vcTiles)
+
+#endif // TILESERVICE_H
@@ -0,0 +1,382 @@
+#include <QCoreApplication>
+#include <QFile>
+#include <QDebug>
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <random>
+#include <sstream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "Radio/AfFollower.h"
+
+// AF following along a drive: switch latency, false switches and the time
+// spent on a poor signal while a good alternate of the same network was on
+// air. Runs on a generated drive past four transmitters of one network (one
+// AF reused nearby by another station) and optionally on recorded traces.
+//
+//   bench_af [trace.csv ...]    (see DriveTrace for the format)
+//   bench_af --write trace.csv  (saves the generated drive)
+
+namespace {
+
+constexpr int kTickMs = 100;         // IRadioHAL::ProgressIntervalMs
+constexpr int kCheckMs = 200;        // background tuner dwell + PI from block A
+constexpr int kPingPongMs = 15000;   // switching back this soon is a false switch
+constexpr int kPoorSnr = 10;         // audibly degraded below this
+constexpr int kGoodSnr = 20;
+constexpr int kTruthWindow = 10;     // readings averaged for the reference quality
+constexpr uint16_t kNetworkPi = 0xF202;
+
+struct Transmitter {
+    int frequency;
+    double km;
+    uint16_t pi;
+    double power; // dB at the mast
+};
+
+// Reception along a drive. Text, one measurement per line:
+// `time_ms,frequency,rssi,snr,pi` with the frequency in FM tuner units
+// (10 kHz) and the PI in hex (0 when none was decoded); '#' starts a
+// comment line. A lookup returns the last measurement of that frequency at
+// or before the given time.
+class DriveTrace
+{
+public:
+    struct Sample {
+        int64_t timeMs = 0;
+        int rssi = 0;
+        int snr = 0;
+        uint16_t pi = 0;
+    };
+
+    // Returns the number of samples read; malformed lines are skipped
+    size_t parse(const std::string &text)
+    {
+        std::istringstream in(text);
+        std::string line;
+        size_t count = 0;
+        while (std::getline(in, line)) {
+            if (line.empty() || line[0] == '#') continue;
+            const char *p = line.c_str();
+            char *end = nullptr;
+            long long fields[4];
+            bool ok = true;
+            for (long long &field : fields) {
+                field = std::strtoll(p, &end, 10);
+                ok = end != p && *end == ',';
+                if (!ok) break;
+                p = end + 1;
+            }
+            if (!ok) continue;
+            const unsigned long pi = std::strtoul(p, &end, 16);
+            if (end == p) continue;
+
+            Sample sample;
+            sample.timeMs = fields[0];
+            sample.rssi = int(fields[2]);
+            sample.snr = int(fields[3]);
+            sample.pi = uint16_t(pi);
+            add(int(fields[1]), sample);
+            ++count;
+        }
+        for (auto &entry : m_samples) {
+            std::stable_sort(entry.second.begin(), entry.second.end(),
+                             [](const Sample &a, const Sample &b) { return a.timeMs < b.timeMs; });
+        }
+        return count;
+    }
+
+    void add(int frequency, const Sample &sample)
+    {
+        m_samples[frequency].push_back(sample);
+        m_duration = std::max(m_duration, sample.timeMs);
+    }
+
+    std::string serialize() const
+    {
+        std::ostringstream out;
+        out << "# time_ms,frequency,rssi,snr,pi\n";
+        for (int f : frequencies()) {
+            for (const Sample &s : m_samples.at(f))
+                out << std::dec << s.timeMs << ',' << f << ',' << s.rssi << ',' << s.snr << ',' << std::hex << s.pi << '\n';
+        }
+        return out.str();
+    }
+
+    int64_t durationMs() const { return m_duration; }
+
+    std::vector<int> frequencies() const
+    {
+        std::vector<int> result;
+        for (const auto &entry : m_samples) result.push_back(entry.first);
+        std::sort(result.begin(), result.end());
+        return result;
+    }
+
+    bool lookup(int frequency, int64_t timeMs, Sample &sample) const
+    {
+        const auto it = m_samples.find(frequency);
+        if (it == m_samples.end()) return false;
+        const std::vector<Sample> &samples = it->second;
+        const auto next = std::upper_bound(samples.begin(), samples.end(), timeMs,
+                                           [](int64_t t, const Sample &s) { return t < s.timeMs; });
+        if (next == samples.begin()) return false;
+        sample = *(next - 1);
+        return true;
+    }
+
+private:
+    std::unordered_map<int, std::vector<Sample>> m_samples;
+    int64_t m_duration = 0;
+};
+
+int rssiFromSnr(int snr) { return std::clamp(snr * 2 + 15, 0, 100); }
+
+DriveTrace generateDrive()
+{
+    // 42 km at 90 km/h past the network's masts; 95.4 is reused by a local
+    // station near km 9, where the network's own 95.4 is far away
+    const Transmitter masts[] = {
+        {10150, 0.0, kNetworkPi, 46},
+        {8890, 14.0, kNetworkPi, 44},
+        {9540, 28.0, kNetworkPi, 46},
+        {10420, 42.0, kNetworkPi, 45},
+        {9540, 9.0, 0xF3A1, 34},
+    };
+    std::mt19937 rng(0xAF);
+    std::normal_distribution<double> shadowStep(0.0, 0.6);
+    std::exponential_distribution<double> rayleigh(1.0);
+
+    DriveTrace trace;
+    const double kmPerMs = 90.0 / 3600000.0;
+    const int64_t durationMs = int64_t(42.0 / kmPerMs);
+    double shadow[5] = {};
+    for (int64_t t = 0; t <= durationMs; t += kTickMs) {
+        const double km = t * kmPerMs;
+        // Strongest transmitter per frequency captures the receiver
+        struct Capture { double snr = -99; uint16_t pi = 0; };
+        Capture capture[5];
+        int frequencies[5] = {};
+        int count = 0;
+        for (int i = 0; i < 5; ++i) {
+            const Transmitter &m = masts[i];
+            shadow[i] = 0.95 * shadow[i] + shadowStep(rng);
+            const double fading = std::max(-15.0, 10.0 * std::log10(rayleigh(rng)));
+            const double snr = m.power - 35.0 * std::log10(1.0 + std::abs(km - m.km) / 2.0) + shadow[i] + fading;
+            int slot = 0;
+            while (slot < count && frequencies[slot] != m.frequency) ++slot;
+            if (slot == count) frequencies[count++] = m.frequency;
+            if (snr > capture[slot].snr) capture[slot] = {snr, m.pi};
+        }
+        for (int i = 0; i < count; ++i) {
+            DriveTrace::Sample s;
+            s.timeMs = t;
+            s.snr = std::max(0, int(std::lround(capture[i].snr)));
+            s.rssi = rssiFromSnr(s.snr);
+            s.pi = s.snr >= 6 ? capture[i].pi : 0;
+            trace.add(frequencies[i], s);
+        }
+    }
+    return trace;
+}
+
+struct Result {
+    int switches = 0;
+    int wrongPi = 0;
+    int pingPong = 0;
+    std::vector<int64_t> latencies;
+    int64_t poorMs = 0;         // degraded while a good alternate existed
+    int64_t poorStayingMs = 0;  // the same without AF following
+    uint64_t checks = 0;
+    uint64_t piMismatches = 0;
+};
+
+int snrAt(const DriveTrace &trace, int frequency, int64_t t)
+{
+    DriveTrace::Sample s;
+    return trace.lookup(frequency, t, s) ? s.snr : 0;
+}
+
+// Average over the last kTruthWindow readings: the reference the switch
+// decisions are judged against, free of single fading dips
+double meanSnr(const DriveTrace &trace, int frequency, int64_t t)
+{
+    double sum = 0;
+    for (int i = 0; i < kTruthWindow; ++i) sum += snrAt(trace, frequency, std::max<int64_t>(0, t - i * kTickMs));
+    return sum / kTruthWindow;
+}
+
+bool betterAlternate(const DriveTrace &trace, const std::vector<int> &network, int tuned, int64_t t, double margin, double floor)
+{
+    const double current = meanSnr(trace, tuned, t);
+    for (int f : network) {
+        if (f == tuned) continue;
+        DriveTrace::Sample s;
+        if (!trace.lookup(f, t, s) || s.pi != kNetworkPi) continue;
+        const double alt = meanSnr(trace, f, t);
+        if (alt >= floor && alt >= current + margin) return true;
+    }
+    return false;
+}
+
+Result replay(const DriveTrace &trace, int startFrequency)
+{
+    const std::vector<int> network = trace.frequencies();
+    AfFollower::Config config;
+    AfFollower follower(config);
+    follower.setNetwork(startFrequency, kNetworkPi, network);
+
+    std::mt19937 rng(0xC4EC);
+    Result r;
+    int tuned = startFrequency;
+    int previous = 0;
+    int64_t previousSwitch = INT64_MIN / 2;
+    int64_t needSince = -1;
+    int checkFrequency = 0;
+    int64_t checkDone = -1;
+
+    for (int64_t t = 0; t <= trace.durationMs(); t += kTickMs) {
+        // AF check on the background tuner: quality now, PI once block A decodes
+        if (checkDone >= 0 && t >= checkDone) {
+            DriveTrace::Sample s;
+            const bool heard = trace.lookup(checkFrequency, t, s);
+            const double piChance = heard ? std::clamp((s.snr - 4) / 8.0, 0.0, 1.0) : 0.0;
+            const int pi = heard && s.pi && std::uniform_real_distribution<double>(0, 1)(rng) < piChance ? s.pi : -1;
+            follower.checkResult(t, checkFrequency, heard ? s.snr : 0, pi);
+            checkDone = -1;
+        }
+
+        const AfFollower::Decision d = follower.update(t, snrAt(trace, tuned, t));
+        if (d.action == AfFollower::Check) {
+            checkFrequency = d.frequency;
+            checkDone = t + kCheckMs;
+        } else if (d.action == AfFollower::Switch) {
+            DriveTrace::Sample s;
+            trace.lookup(d.frequency, t, s);
+            ++r.switches;
+            if (s.pi != kNetworkPi) ++r.wrongPi;
+            if (d.frequency == previous && t - previousSwitch < kPingPongMs) ++r.pingPong;
+            if (needSince >= 0) r.latencies.push_back(t - needSince);
+            previous = tuned;
+            previousSwitch = t;
+            tuned = d.frequency;
+            follower.switched(t, tuned);
+            checkDone = -1;
+        }
+
+        // Latency runs from the tuned signal fading with a clearly better
+        // alternate on air until the switch
+        const bool need = meanSnr(trace, tuned, t) < config.weakSnr
+                          && betterAlternate(trace, network, tuned, t, config.switchMargin, config.weakSnr);
+        if (need && needSince < 0) needSince = t;
+        if (!need) needSince = -1;
+
+        if (meanSnr(trace, tuned, t) < kPoorSnr && betterAlternate(trace, network, tuned, t, 0, kGoodSnr)) r.poorMs += kTickMs;
+        if (meanSnr(trace, startFrequency, t) < kPoorSnr && betterAlternate(trace, network, startFrequency, t, 0, kGoodSnr))
+            r.poorStayingMs += kTickMs;
+    }
+    r.checks = follower.stats().checks;
+    r.piMismatches = follower.stats().piMismatches;
+    return r;
+}
+
+void report(const char *name, const DriveTrace &trace, const Result &r)
+{
+    int64_t total = 0, worst = 0;
+    for (int64_t l : r.latencies) {
+        total += l;
+        worst = std::max(worst, l);
+    }
+    const double mean = r.latencies.empty() ? 0.0 : double(total) / r.latencies.size();
+    qInfo().noquote() << QString("  %1: %2 s, %3 switches (%4 wrong PI, %5 ping-pong), latency mean %6 ms max %7 ms")
+                             .arg(name)
+                             .arg(trace.durationMs() / 1000)
+                             .arg(r.switches)
+                             .arg(r.wrongPi)
+                             .arg(r.pingPong)
+                             .arg(mean, 0, 'f', 0)
+                             .arg(worst);
+    qInfo().noquote() << QString("  %1: %2 AF checks, %3 PI mismatches, poor signal %4 s (%5 s without following)")
+                             .arg(name)
+                             .arg(r.checks)
+                             .arg(r.piMismatches)
+                             .arg(r.poorMs / 1000.0, 0, 'f', 1)
+                             .arg(r.poorStayingMs / 1000.0, 0, 'f', 1);
+}
+
+bool benchGenerated(const QString &writePath)
+{
+    const DriveTrace trace = generateDrive();
+    if (!writePath.isEmpty()) {
+        QFile file(writePath);
+        if (file.open(QIODevice::WriteOnly)) file.write(QByteArray::fromStdString(trace.serialize()));
+    }
+
+    qInfo() << "[BENCH] AF following, generated 42 km drive past 4 transmitters";
+    const Result r = replay(trace, 10150);
+    report("generated", trace, r);
+
+    int64_t worst = 0;
+    for (int64_t l : r.latencies) worst = std::max(worst, l);
+    // Every mast handover followed, never onto the reused frequency or back
+    return r.switches >= 3 && r.wrongPi == 0 && r.pingPong == 0 && r.piMismatches > 0
+           && worst <= 3000 && r.poorMs * 4 <= r.poorStayingMs;
+}
+
+bool benchRecording(const QString &path)
+{
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly)) {
+        qWarning() << "Cannot open" << path;
+        return false;
+    }
+    DriveTrace trace;
+    if (trace.parse(file.readAll().toStdString()) == 0) {
+        qWarning() << "No samples in" << path;
+        return false;
+    }
+
+    // Start on the network frequency heard best at the beginning
+    int start = 0, startSnr = -1;
+    for (int f : trace.frequencies()) {
+        DriveTrace::Sample s;
+        if (trace.lookup(f, 0, s) && s.pi == kNetworkPi && s.snr > startSnr) {
+            start = f;
+            startSnr = s.snr;
+        }
+    }
+    if (startSnr < 0) {
+        qWarning() << "No station with PI" << QString::number(kNetworkPi, 16) << "at the start of" << path;
+        return false;
+    }
+
+    qInfo() << "[BENCH] AF following, trace" << path;
+    const Result r = replay(trace, start);
+    report("trace", trace, r);
+    return r.wrongPi == 0;
+}
+
+} // namespace
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+
+    QString writePath;
+    QStringList traces;
+    for (int i = 1; i < argc; ++i) {
+        const QString arg = QString::fromLocal8Bit(argv[i]);
+        if (arg == "--write" && i + 1 < argc) writePath = QString::fromLocal8Bit(argv[++i]);
+        else traces << arg;
+    }
+
+    bool ok = benchGenerated(writePath);
+    for (const QString &path : traces) ok &= benchRecording(path);
+    if (!ok) {
+        qCritical() << "AF following out of bounds";
+        return 1;
+    }
+    return 0;
+}
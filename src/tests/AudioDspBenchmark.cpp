@@ -0,0 +1,209 @@
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QDebug>
+#include <cmath>
+#include <vector>
+#include "Audio/TimeStretcher.h"
+#include "Radio/FmDemodulator.h"
+#include "Radio/RdsDecoder.h"
+
+// CPU cost of the audio DSP stages, reported per second of real-time audio
+// so the numbers read directly as a share of one core on the target.
+// The FM stage runs the whole SDR receive chain (8-bit IQ to stereo audio
+// and RDS bits) on a generated broadcast, checked for pilot lock, channel
+// separation and PI, and optionally on a recorded capture.
+//
+//   bench_audio_dsp [capture.cu8 sample_rate station_offset_hz]
+
+namespace {
+
+constexpr int kRate = 48000;
+constexpr int kSeconds = 30;
+constexpr int kBlockFrames = 1024; // typical decoder buffer
+constexpr int kFmSeconds = 5;
+
+// Voice-like test signal: harmonic stack with a wandering fundamental and syllable-rate envelope
+std::vector<float> makeProgramme()
+{
+    std::vector<float> pcm(size_t(kRate) * kSeconds * 2);
+    double phase = 0.0;
+    for (int i = 0; i < kRate * kSeconds; ++i) {
+        const double t = double(i) / kRate;
+        const double f0 = 140.0 + 40.0 * std::sin(2.0 * M_PI * 0.7 * t);
+        phase += 2.0 * M_PI * f0 / kRate;
+        double v = 0.0;
+        for (int h = 1; h <= 8; ++h) v += std::sin(phase * h) / h;
+        v *= 0.25 * (0.6 + 0.4 * std::sin(2.0 * M_PI * 4.0 * t));
+        pcm[size_t(i) * 2] = float(v);
+        pcm[size_t(i) * 2 + 1] = float(0.9 * v);
+    }
+    return pcm;
+}
+
+bool benchTimeStretch(const std::vector<float> &programme)
+{
+    qInfo() << "[BENCH] WSOLA time-stretch," << kSeconds << "s stereo @" << kRate << "Hz";
+    bool ok = true;
+    const int totalFrames = int(programme.size() / 2);
+    std::vector<float> out;
+
+    for (double tempo : {0.5, 0.75, 1.0, 1.25, 1.5, 1.75, 2.0}) {
+        TimeStretcher stretcher(kRate);
+        stretcher.setTempo(tempo);
+        out.clear();
+        out.reserve(size_t(programme.size() / tempo) + 4096);
+
+        QElapsedTimer timer;
+        timer.start();
+        for (int offset = 0; offset < totalFrames; offset += kBlockFrames) {
+            const int frames = qMin(kBlockFrames, totalFrames - offset);
+            stretcher.process(programme.data() + size_t(offset) * 2, frames, out);
+        }
+        const double elapsedMs = timer.nsecsElapsed() / 1e6;
+
+        // Output is real time: each output second is one second on the speaker
+        const double outputSeconds = double(out.size() / 2) / kRate;
+        const double expectedSeconds = kSeconds / tempo;
+        const double msPerSecond = elapsedMs / outputSeconds;
+        qInfo().noquote() << QString("  speed %1x: %2 ms CPU per real-time second (%3% of a core), output %4 s of %5 s")
+                                 .arg(tempo, 0, 'f', 2)
+                                 .arg(msPerSecond, 0, 'f', 2)
+                                 .arg(msPerSecond / 10.0, 0, 'f', 2)
+                                 .arg(outputSeconds, 0, 'f', 2)
+                                 .arg(expectedSeconds, 0, 'f', 2);
+        if (std::abs(outputSeconds - expectedSeconds) > 0.05)
+            ok = false;
+    }
+
+    TimeStretcher probe(kRate);
+    qInfo().noquote() << QString("  latency bound: %1 ms (window %2 + search %3 frames)")
+                             .arg(probe.latencyFrames() * 1000.0 / kRate, 0, 'f', 1)
+                             .arg(probe.windowFrames())
+                             .arg(probe.searchFrames());
+    return ok;
+}
+
+struct FmRun {
+    double msPerSecond = 0.0;
+    bool pilotLocked = false;
+    FmDemodulator::Quality quality;
+    std::vector<float> audio;
+    RdsDecoder rds;
+};
+
+void demodulateCapture(int rate, double offset, const std::vector<uint8_t> &capture, FmRun &run)
+{
+    FmDemodulator demod(rate);
+    demod.setOffset(offset);
+    demod.setDeemphasis(0); // flat, for the separation measurement
+    const size_t blockBytes = size_t(rate) / 10 * 2; // the HAL's 100 ms blocks
+    std::vector<float> iq;
+    std::vector<uint8_t> bits;
+
+    QElapsedTimer timer;
+    timer.start();
+    for (size_t pos = 0; pos + blockBytes <= capture.size(); pos += blockBytes) {
+        FmDemodulator::toFloat(FmDemodulator::IqFormat::U8, capture.data() + pos, blockBytes, iq);
+        demod.process(iq.data(), iq.size() / 2, run.audio, bits);
+    }
+    const double seconds = double(capture.size() / 2) / rate;
+    run.msPerSecond = timer.nsecsElapsed() / 1e6 / seconds;
+    run.pilotLocked = demod.pilotLocked();
+    run.quality = demod.quality();
+    run.rds.pushBits(bits.data(), bits.size());
+}
+
+// Level of a tone in one channel of interleaved stereo, over the settled second half
+double toneLevel(const std::vector<float> &audio, int channel, double hz)
+{
+    double re = 0.0, im = 0.0;
+    const size_t frames = audio.size() / 2;
+    for (size_t i = frames / 2; i < frames; ++i) {
+        const double w = 2.0 * M_PI * hz * double(i) / FmDemodulator::AudioRate;
+        re += audio[i * 2 + channel] * std::cos(w);
+        im += audio[i * 2 + channel] * std::sin(w);
+    }
+    return std::sqrt(re * re + im * im) / double(frames - frames / 2);
+}
+
+bool benchFmDemodulation()
+{
+    qInfo() << "[BENCH] FM receive chain, 8-bit IQ to stereo + RDS," << kFmSeconds << "s per rate";
+    bool ok = true;
+    for (int rate : {960000, 1200000, 2400000}) {
+        RdsEncoder encoder;
+        encoder.setStation(0xF202, 1, "RADIO 1", "Radio 1 - News and traffic", {8890, 9540});
+        FmModulator modulator(rate);
+        modulator.setOffset(-300000.0 * rate / 2400000);
+        modulator.setTones(1000, 2500);
+        modulator.setRds(&encoder);
+        modulator.setCarrierToNoise(25);
+        std::vector<float> iq;
+        modulator.generate(size_t(rate) * kFmSeconds, iq);
+        std::vector<uint8_t> capture;
+        FmModulator::toU8(iq, capture);
+        iq = std::vector<float>();
+
+        FmRun run;
+        demodulateCapture(rate, -300000.0 * rate / 2400000, capture, run);
+        const double separation = 20.0 * std::log10(toneLevel(run.audio, 0, 1000) / toneLevel(run.audio, 1, 1000));
+        qInfo().noquote() << QString("  %1 ksps: %2 ms CPU per real-time second (%3% of a core), SNR %4 dB, "
+                                     "separation %5 dB, PI %6, %7 RDS blocks (%8 uncorrectable)")
+                                 .arg(rate / 1000)
+                                 .arg(run.msPerSecond, 0, 'f', 2)
+                                 .arg(run.msPerSecond / 10.0, 0, 'f', 2)
+                                 .arg(run.quality.snrDb, 0, 'f', 1)
+                                 .arg(separation, 0, 'f', 1)
+                                 .arg(run.rds.hasPi() ? QString::number(run.rds.pi(), 16).toUpper() : QString("-"))
+                                 .arg(run.rds.stats().blocks)
+                                 .arg(run.rds.stats().uncorrectable);
+        if (!run.pilotLocked || separation < 20.0 || !run.rds.hasPi() || run.rds.pi() != 0xF202)
+            ok = false;
+    }
+    return ok;
+}
+
+void benchFmCapture(const QString &path, int rate, double offset)
+{
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly) || !FmDemodulator::supportsRate(rate)) {
+        qWarning() << "Cannot replay" << path << "at" << rate << "sps";
+        return;
+    }
+    const QByteArray bytes = file.readAll();
+    const std::vector<uint8_t> capture(bytes.begin(), bytes.end());
+
+    FmRun run;
+    demodulateCapture(rate, offset, capture, run);
+    qInfo().noquote() << QString("  %1: %2 ms CPU per real-time second (%3% of a core), %4 dBFS, SNR %5 dB, "
+                                 "pilot %6, PI %7, PS \"%8\"")
+                             .arg(path)
+                             .arg(run.msPerSecond, 0, 'f', 2)
+                             .arg(run.msPerSecond / 10.0, 0, 'f', 2)
+                             .arg(run.quality.powerDb, 0, 'f', 1)
+                             .arg(run.quality.snrDb, 0, 'f', 1)
+                             .arg(run.pilotLocked ? "locked" : "none")
+                             .arg(run.rds.hasPi() ? QString::number(run.rds.pi(), 16).toUpper() : QString("-"))
+                             .arg(QString::fromStdString(run.rds.ps()));
+}
+
+} // namespace
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+
+    const std::vector<float> programme = makeProgramme();
+    if (!benchTimeStretch(programme)) {
+        qCritical() << "Time-stretch output duration is off";
+        return 1;
+    }
+    if (!benchFmDemodulation()) {
+        qCritical() << "FM demodulation lost stereo or RDS";
+        return 1;
+    }
+    const QStringList args = app.arguments();
+    if (args.size() >= 4) benchFmCapture(args.at(1), args.at(2).toInt(), args.at(3).toDouble());
+    return 0;
+}
@@ -0,0 +1,71 @@
+#ifndef BENCHROUTES_H
+#define BENCHROUTES_H
+
+#include <QList>
+#include <cmath>
+#include <random>
+#include "Navigation/RouteIndex.h"
+
+/**
+ * @brief Generated roads the navigation benchmarks drive on.
+ *
+ * A route is walked from a start point a fixed spacing at a time, the
+ * heading turned before each step. The default turn is a random drift,
+ * the same for a given seed. Benchmarks that need a particular shape,
+ * such as town corners, U-turns or an out-and-back leg, pass their own
+ * turn or add steps themselves.
+ */
+namespace BenchRoutes {
+
+constexpr double Pi = 3.14159265358979323846;
+constexpr double MetersPerDegree = 6371008.8 * Pi / 180.0;
+
+// `meters` on from the path's last point, `heading` radians from north
+inline void step(RoutePath &path, double heading, double meters) {
+    const double lat = path.latitude(path.size() - 1) + std::cos(heading) * meters / MetersPerDegree;
+    const double lon = path.longitude(path.size() - 1)
+                       + std::sin(heading) * meters / (MetersPerDegree * std::cos(lat * Pi / 180.0));
+    path.append(lat, lon);
+}
+
+// `km` more of road, a point every `spacing` metres; `turn(i, heading)`
+// gives the heading on from the path's ith point
+template <typename Turn>
+void extend(RoutePath &path, double km, double spacing, double heading, Turn turn) {
+    const int count = int(km * 1000.0 / spacing);
+    const int first = path.size() - 1;
+    path.reserve(path.size() + count);
+    for (int i = 0; i < count; ++i) {
+        heading = turn(first + i, heading);
+        step(path, heading, spacing);
+    }
+}
+
+template <typename Turn>
+RoutePath generateRoute(double km, double spacing, double lat, double lon, double heading, Turn turn) {
+    RoutePath path;
+    path.append(lat, lon);
+    extend(path, km, spacing, heading, turn);
+    return path;
+}
+
+// A road drifting by up to `drift` / 2 radians either way at every point
+inline RoutePath generateRoute(double km, double spacing, unsigned seed, double lat, double lon, double heading,
+                               double drift) {
+    std::mt19937 rng(seed);
+    std::uniform_real_distribution<double> unit(0.0, 1.0);
+    return generateRoute(km, spacing, lat, lon, heading,
+                         [&](int, double h) { return h + (unit(rng) - 0.5) * drift; });
+}
+
+// Speed limits per segment, km/h, from a repeating run of zones
+inline QList<quint8> zoneLimits(const RouteIndex &route, double zoneMeters) {
+    static const quint8 zones[] = {50, 80, 110, 80, 110, 110, 50, 80};
+    QList<quint8> limits;
+    for (int i = 0; i + 1 < route.offsets().size(); ++i) limits.append(zones[int(route.offset(i) / zoneMeters) % 8]);
+    return limits;
+}
+
+} // namespace BenchRoutes
+
+#endif // BENCHROUTES_H
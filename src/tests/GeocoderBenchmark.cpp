@@ -0,0 +1,224 @@
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QTemporaryDir>
+#include <QDebug>
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <string>
+#include <vector>
+#include "Navigation/PlaceIndex.h"
+#include "Navigation/PlaceIndexBuilder.h"
+
+// Offline geocoding: search time per keystroke while typing addresses into
+// a generated country of towns whose street names repeat from town to
+// town, as real ones do. The finished query must find the street in the
+// town being driven through, with the house where it is or, when the
+// number is missing from the data, between its neighbours. A place index
+// built by place_index_build can be timed instead.
+//
+//   bench_geocoder [places.npi]
+
+namespace {
+
+constexpr int kTowns = 300;
+constexpr int kStreetsPerTown = 250;
+constexpr int kPoisPerTown = 50;
+constexpr double kHouseShare = 0.4;      // streets with address points
+constexpr int kHousesPerStreet = 40;
+constexpr double kMissingHouses = 0.3;   // numbers left out, found by interpolation
+constexpr double kStreetLengthDeg = 0.004;
+constexpr int kTargets = 300;
+constexpr double kTargetShare = 0.0005;  // of the houses, spread over the country
+constexpr double kBudgetMs = 10.0;       // p95 per keystroke
+constexpr double kHouseToleranceMeters = 5.0;
+
+const char *kTownHeads[] = {"Norr", "Sö", "Väst", "Öster", "Berg", "Lund", "Sand", "Ek", "Björk", "Holm",
+                            "Strand", "Å", "Mal", "Fal", "Hjo", "Kil", "Lin", "Mora", "Nyby", "Ros"};
+const char *kTownTails[] = {"by", "köping", "sala", "vik", "stad", "torp", "hamn", "näs", "löv", "fors",
+                            "sund", "ås", "tuna", "åker", "hult"};
+const char *kStreetHeads[] = {"Stor", "Kyrk", "Skol", "Park", "Sjö", "Ängs", "Tall", "Gran", "Björk", "Ek",
+                              "Lill", "Nygata", "Torg", "Hamn", "Järnvägs", "Kvarn", "Mölle", "Prästgårds",
+                              "Bryggar", "Smed", "Åker", "Ladu", "Hag", "Väster", "Öster", "Norra Esplanad",
+                              "Södra Kyrko", "Gamla Lands", "Stations", "Fabriks"};
+const char *kStreetTails[] = {"gatan", "vägen", "stigen", "gränd", "backen", "allén", "torget", "leden", "slingan"};
+const char *kPoiNames[] = {"ICA", "Coop", "Café", "Pizzeria", "Apotek", "Bibliotek", "Vårdcentral", "Circle K",
+                           "Systembolaget", "Hotell"};
+
+struct Target {
+    std::string street;
+    std::string town;
+    int number;
+    double lat, lon;         // expected position
+    double townLat, townLon; // where the car is
+};
+
+// Towns over a 300 x 300 km area, street names repeating between them
+void generateCountry(PlaceIndexBuilder &builder, std::vector<Target> &targets)
+{
+    std::mt19937 rng(40);
+    std::uniform_real_distribution<double> unit(0.0, 1.0);
+    std::vector<std::string> towns;
+    for (const char *head : kTownHeads)
+        for (const char *tail : kTownTails) towns.push_back(std::string(head) + tail);
+    std::shuffle(towns.begin(), towns.end(), rng);
+    std::vector<std::string> streets;
+    for (const char *head : kStreetHeads)
+        for (const char *tail : kStreetTails) streets.push_back(std::string(head) + tail);
+
+    for (int t = 0; t < kTowns; ++t) {
+        const std::string &town = towns[size_t(t)];
+        // Jittered 20 x 15 grid, towns at least ~9 km apart
+        const double townLat = 56.0 + (t / 20 + 0.3 + unit(rng) * 0.4) * 0.18;
+        const double townLon = 13.0 + (t % 20 + 0.3 + unit(rng) * 0.4) * 0.25;
+        builder.addSettlement(town, townLat, townLon);
+        std::shuffle(streets.begin(), streets.end(), rng);
+        for (int s = 0; s < kStreetsPerTown; ++s) {
+            const std::string &street = streets[size_t(s)];
+            const double lat = townLat + (unit(rng) - 0.5) * 0.05;
+            const double lon = townLon + (unit(rng) - 0.5) * 0.08;
+            const double angle = unit(rng) * 3.14159265358979323846;
+            const double dLat = std::sin(angle) * kStreetLengthDeg, dLon = std::cos(angle) * kStreetLengthDeg * 2;
+            // Two ways, the town left to the nearest settlement
+            builder.addStreet(street, lat, lon);
+            builder.addStreet(street, lat + dLat, lon + dLon);
+            if (unit(rng) >= kHouseShare) continue;
+
+            for (int n = 1; n <= kHousesPerStreet; ++n) {
+                // Odd numbers on one side, even on the other, 1 and 2 at the start
+                const double along = (n - 1) / 2 / double(kHousesPerStreet / 2);
+                const double side = n % 2 ? 0.0001 : -0.0001;
+                const double houseLat = lat + along * dLat + side, houseLon = lon + along * dLon;
+                const bool missing = n > 2 && n < kHousesPerStreet - 1 && unit(rng) < kMissingHouses;
+                if (!missing) builder.addHouse(street, std::to_string(n), houseLat, houseLon, t % 2 ? town : std::string());
+                if (unit(rng) < kTargetShare && targets.size() < size_t(kTargets))
+                    targets.push_back({street, town, n, houseLat, houseLon, townLat, townLon});
+            }
+        }
+        for (int p = 0; p < kPoisPerTown; ++p) {
+            const std::string name = std::string(kPoiNames[p % 10]) + ' ' + streets[size_t(p)].substr(0, 5);
+            builder.addPoi(name, townLat + (unit(rng) - 0.5) * 0.05, townLon + (unit(rng) - 0.5) * 0.08, town);
+        }
+    }
+}
+
+double meters(double lat1, double lon1, double lat2, double lon2) {
+    const double dLat = (lat2 - lat1) * 111195.0;
+    const double dLon = (lon2 - lon1) * 111195.0 * std::cos(lat1 * 3.14159265358979323846 / 180.0);
+    return std::sqrt(dLat * dLat + dLon * dLon);
+}
+
+struct Timing {
+    std::vector<double> times;
+
+    void report(const char *what) {
+        std::sort(times.begin(), times.end());
+        double total = 0;
+        for (double t : times) total += t;
+        qInfo().noquote() << QString("  %1: %2 keystrokes, avg %3 ms, p95 %4 ms, max %5 ms")
+                                 .arg(what)
+                                 .arg(times.size())
+                                 .arg(total / times.size(), 0, 'f', 3)
+                                 .arg(p95(), 0, 'f', 3)
+                                 .arg(times.back(), 0, 'f', 3);
+    }
+    double p95() const { return times[times.size() * 95 / 100]; }
+};
+
+// Every prefix of `query`, as typed; returns the results of the last
+QVariantList type(const PlaceIndex &index, const QString &query, const QGeoCoordinate &near, Timing &timing)
+{
+    QVariantList results;
+    QElapsedTimer clock;
+    for (int length = 1; length <= query.size(); ++length) {
+        clock.start();
+        results = index.search(query.left(length), near, 5);
+        timing.times.push_back(clock.nsecsElapsed() / 1e6);
+    }
+    return results;
+}
+
+bool benchGenerated()
+{
+    QTemporaryDir dir;
+    const QString path = dir.filePath("places.npi");
+    PlaceIndexBuilder builder;
+    std::vector<Target> targets;
+    generateCountry(builder, targets);
+    QElapsedTimer clock;
+    clock.start();
+    if (!builder.write(path)) return false;
+    const PlaceIndexBuilder::Stats &stats = builder.stats();
+    qInfo() << "[BENCH] Offline geocoding, generated" << kTowns << "towns";
+    qInfo().noquote() << QString("  build: %1 places (%2 streets), %3 houses (%4 unmatched), %5 keys in %6 KB, %7 ms")
+                             .arg(stats.places)
+                             .arg(stats.streets)
+                             .arg(stats.houses)
+                             .arg(stats.unmatchedHouses)
+                             .arg(stats.keys)
+                             .arg(stats.keyBytes / 1024)
+                             .arg(clock.elapsed());
+
+    PlaceIndex index;
+    if (!index.open(path)) return false;
+    Timing local, remote;
+    int wrongStreet = 0, wrongHouse = 0;
+    for (const Target &target : targets) {
+        const QString street = QString::fromStdString(target.street);
+        const QString expected = street + " " + QString::number(target.number) + ", " + QString::fromStdString(target.town);
+        // In town, by street and number; from the other end of the country, with the town
+        const QVariantList near = type(index, street + " " + QString::number(target.number),
+                                       QGeoCoordinate(target.townLat, target.townLon), local);
+        const QVariantList far = type(index, street + " " + QString::number(target.number) + " "
+                                                 + QString::fromStdString(target.town),
+                                      QGeoCoordinate(62.0, 20.0), remote);
+        for (const QVariantList &results : {near, far}) {
+            const QVariantMap top = results.isEmpty() ? QVariantMap() : results.first().toMap();
+            if (top.value("address").toString() != expected) {
+                ++wrongStreet;
+                continue;
+            }
+            if (meters(top.value("lat").toDouble(), top.value("lon").toDouble(), target.lat, target.lon)
+                > kHouseToleranceMeters)
+                ++wrongHouse;
+        }
+    }
+    local.report("street and number, in town");
+    remote.report("street, number and town, far away");
+    qInfo().noquote() << QString("  %1 addresses: %2 wrong street, %3 house misplaced")
+                             .arg(targets.size() * 2)
+                             .arg(wrongStreet)
+                             .arg(wrongHouse);
+    return wrongStreet == 0 && wrongHouse == 0 && local.p95() < kBudgetMs && remote.p95() < kBudgetMs;
+}
+
+bool benchFile(const QString &path)
+{
+    PlaceIndex index;
+    if (!index.open(path)) {
+        qWarning() << "Cannot open" << path;
+        return false;
+    }
+    qInfo() << "[BENCH] Offline geocoding," << path << index.placeCount() << "places";
+    // Typing common Swedish addresses around Stockholm
+    Timing timing;
+    const QGeoCoordinate stockholm(59.3293, 18.0686);
+    for (const char *query : {"Drottninggatan 53", "Kungsgatan 10", "Storgatan 1", "Sveavägen 44", "Götgatan 22",
+                              "Centralstationen", "Uppsala", "ICA Maxi", "Karlavägen 100", "Vasagatan 7"})
+        type(index, QString::fromUtf8(query), stockholm, timing);
+    timing.report("queries");
+    return timing.p95() < kBudgetMs;
+}
+
+} // namespace
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    const bool ok = argc > 1 ? benchFile(QString::fromLocal8Bit(argv[1])) : benchGenerated();
+    if (!ok) {
+        qWarning() << "[BENCH] Offline geocoding: FAILED";
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,129 @@
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QDebug>
+#include <algorithm>
+#include <cmath>
+#include <memory>
+#include <random>
+#include <vector>
+#include "Navigation/MapMatcher.h"
+#include "BenchRoutes.h"
+
+// Map matching: a car driving a 50 km route at 90 km/h reports fixes at
+// 10 Hz, each a few metres off (Gaussian, with the odd 40 m outlier). The
+// route starts out and back along one road, 25 m between the carriageways,
+// so a fix is often nearer the other direction. Every fix is matched as it
+// arrives; reports how far along the route each match is from the truth,
+// how many land on the wrong stretch, and the time per fix, against
+// snapping each fix to its nearest segment.
+//
+//   bench_map_matching
+
+namespace {
+
+constexpr double kPi = 3.14159265358979323846;
+constexpr double kMetersPerDegree = 111195.0;
+constexpr double kPointSpacingMeters = 20.0;
+constexpr double kOutAndBackMeters = 5000.0;
+constexpr double kCarriagewayMeters = 25.0;
+constexpr double kOnwardKm = 40.0;
+constexpr double kSpeed = 25.0;          // m/s
+constexpr int kFixIntervalMs = 100;
+constexpr double kNoiseMeters = 5.0;
+constexpr double kOutlierMeters = 40.0;
+constexpr double kOutlierRate = 0.01;
+constexpr double kHeadingNoise = 5.0;    // degrees
+constexpr double kWrongStretchMeters = 50.0;
+constexpr double kNearestMeters = 1000.0; // snapping radius, beyond any fix
+constexpr double kBudgetMs = 1.0;        // p95 per fix; 100 ms between fixes
+
+RoutePath generateRoute() {
+    std::mt19937 rng(44);
+    std::uniform_real_distribution<double> unit(0.0, 1.0);
+    auto straight = [](int, double heading) { return heading; };
+    // North, across to the other carriageway, back south, then on east
+    RoutePath path = BenchRoutes::generateRoute(kOutAndBackMeters / 1000.0, kPointSpacingMeters, 55.605, 13.003, 0.0,
+                                                straight);
+    BenchRoutes::step(path, kPi / 2, kCarriagewayMeters);
+    BenchRoutes::extend(path, kOutAndBackMeters / 1000.0, kPointSpacingMeters, kPi, straight);
+    BenchRoutes::extend(path, kOnwardKm, kPointSpacingMeters, kPi / 2, [&](int, double heading) {
+        return std::clamp(heading + (unit(rng) - 0.5) * 0.2, 0.5, 2.6);
+    });
+    return path;
+}
+
+// Metres east and north of (lat0, lon0)
+void local(double lat0, double lon0, double lat, double lon, double *x, double *y) {
+    *x = (lon - lon0) * kMetersPerDegree * std::cos(lat0 * kPi / 180.0);
+    *y = (lat - lat0) * kMetersPerDegree;
+}
+
+double percentile(std::vector<double> values, int p) {
+    std::sort(values.begin(), values.end());
+    return values[values.size() * size_t(p) / 100];
+}
+
+} // namespace
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    const RoutePath path = generateRoute();
+    const auto route = std::make_shared<const RouteIndex>(path);
+    MapMatcher matcher(route);
+    std::mt19937 rng(45);
+    std::normal_distribution<double> noise(0.0, 1.0);
+    std::uniform_real_distribution<double> unit(0.0, 1.0);
+
+    std::vector<double> times, errors, nearestErrors;
+    int unmatched = 0, wrong = 0, nearestWrong = 0;
+    QElapsedTimer clock;
+    qint64 timestamp = 0;
+    for (double along = 0.0; along <= route->length(); along += kSpeed * kFixIntervalMs / 1000.0) {
+        // The true position, then the receiver's report of it
+        const int s = route->segmentAt(along);
+        const QGeoCoordinate truth = route->coordinateAt(along);
+        const double lat = truth.latitude(), lon = truth.longitude();
+        double east, north;
+        local(path.latitude(s), path.longitude(s), path.latitude(s + 1), path.longitude(s + 1), &east, &north);
+        const double spread = unit(rng) < kOutlierRate ? kOutlierMeters : kNoiseMeters;
+        MapMatcher::Fix fix;
+        fix.latitude = lat + noise(rng) * spread / kMetersPerDegree;
+        fix.longitude = lon + noise(rng) * spread / (kMetersPerDegree * std::cos(lat * kPi / 180.0));
+        fix.heading = std::fmod(std::atan2(east, north) * 180.0 / kPi + noise(rng) * kHeadingNoise + 360.0, 360.0);
+        fix.speed = kSpeed;
+        fix.timestampMs = timestamp += kFixIntervalMs;
+
+        clock.start();
+        const MapMatcher::Match match = matcher.push(fix);
+        times.push_back(clock.nsecsElapsed() / 1e6);
+        if (!match.onRoute) {
+            ++unmatched;
+            continue;
+        }
+        errors.push_back(std::abs(match.offset - along));
+        if (errors.back() > kWrongStretchMeters) ++wrong;
+        nearestErrors.push_back(std::abs(route->nearest(fix.latitude, fix.longitude, kNearestMeters).offset - along));
+        if (nearestErrors.back() > kWrongStretchMeters) ++nearestWrong;
+    }
+
+    qInfo() << "[BENCH] Map matching," << route->length() / 1000.0 << "km route," << times.size() << "fixes at 10 Hz";
+    qInfo().noquote() << QString("  HMM: error along the route p50 %1 m, p95 %2 m; %3 on the wrong stretch, %4 unmatched")
+                             .arg(percentile(errors, 50), 0, 'f', 1)
+                             .arg(percentile(errors, 95), 0, 'f', 1)
+                             .arg(wrong)
+                             .arg(unmatched);
+    qInfo().noquote() << QString("  nearest segment: p50 %1 m, p95 %2 m; %3 on the wrong stretch")
+                             .arg(percentile(nearestErrors, 50), 0, 'f', 1)
+                             .arg(percentile(nearestErrors, 95), 0, 'f', 1)
+                             .arg(nearestWrong);
+    const double p95 = percentile(times, 95);
+    qInfo().noquote() << QString("  per fix: p95 %1 ms, max %2 ms")
+                             .arg(p95, 0, 'f', 3)
+                             .arg(*std::max_element(times.begin(), times.end()), 0, 'f', 3);
+    if (wrong > 0 || unmatched > int(times.size()) / 100 || p95 > kBudgetMs) {
+        qWarning() << "[BENCH] Map matching: FAILED";
+        return 1;
+    }
+    return 0;
+}
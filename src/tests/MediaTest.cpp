@@ -1,9 +1,26 @@
 #include <QCoreApplication>
 #include <QTimer>
 #include <QDebug>
+#include <QElapsedTimer>
+#include <QLocalSocket>
+#include <QtEndian>
+#include <QTemporaryDir>
+#include <algorithm>
 #include <cassert>
+#include <cmath>
 #include "RadioTuner.h"
+#include "HAL/SimulatedRadioHAL.h"
+#include "Radio/DabServiceList.h"
+#include "Radio/AfFollower.h"
+#include "Radio/FmDemodulator.h"
+#include "Radio/RdsDecoder.h"
 #include "MediaLibrary.h"
+#include "Audio/StreamingPcmSource.h"
+#include "Audio/AudioFocusManager.h"
+#include "Audio/RealFft.h"
+#include "Audio/SpectrumAnalyzer.h"
+#include "Audio/SeekIndex.h"
+#include "Audio/TimeshiftOutput.h"
 
 int main(int argc, char *argv[])
 {
@@ -15,7 +32,8 @@ int main(int argc, char *argv[])
 
     // 1. RadioTuner Verification
     qDebug() << "[TEST] RadioTuner correctness...";
-    RadioTuner tuner;
+    SimulatedRadioHAL radioHal; // same thread: commands run inline, seek steps on its timer
+    RadioTuner tuner(&radioHal);
     
     // Test Initial State
     if (tuner.band() != RadioTuner::BandFM) return 1;
@@ -42,8 +60,495 @@ int main(int argc, char *argv[])
     }
     qDebug() << "  -> Frequency Wrapping success";
 
+    // Preset lookup: name and active row follow the tuned (band, frequency)
+    {
+        // Saved presets or the defaults: never none
+        if (tuner.model()->rowCount() == 0) {
+            qCritical() << "No presets loaded";
+            return 20;
+        }
+        const RadioStation preset = tuner.model()->getStation(0);
+        tuner.tuneToPreset(0);
+        if (tuner.stationName() != preset.name || tuner.model()->activeStationIndex() != 0) {
+            qCritical() << "Preset lookup failed for" << preset.frequency << "got" << tuner.stationName();
+            return 20;
+        }
+        tuner.stepUp();
+        if (tuner.model()->activeStationIndex() == 0) return 20;
+        tuner.setBand(RadioTuner::BandFM);
+        qDebug() << "  -> Preset lookup success (" << preset.name << ")";
+    }
+
+    // Test Seek: runs in HAL steps, reports a throttled progress and one final result
+    {
+        int progressUpdates = 0;
+        int frequencyUpdates = 0;
+        QObject::connect(&tuner, &RadioTuner::seekProgressChanged, &app, [&]() { ++progressUpdates; });
+        QObject::connect(&tuner, &RadioTuner::frequencyChanged, &app, [&]() { ++frequencyUpdates; });
+        QElapsedTimer seekTime;
+        seekTime.start();
+        tuner.tuneToString("98.3");
+        frequencyUpdates = 0;
+        tuner.seekUp();
+        while (tuner.isScanning() && seekTime.elapsed() < 10000) QCoreApplication::processEvents();
+        const qint64 elapsed = seekTime.elapsed();
+        if (tuner.isScanning() || tuner.frequency() <= 9830 || tuner.signalStrength() < SimulatedRadioHAL::SeekThreshold) {
+            qCritical() << "Radio seek failed. Stopped at" << tuner.frequency() << "signal" << tuner.signalStrength();
+            return 18;
+        }
+        // Start + final, plus at most one per progress interval
+        if (frequencyUpdates != 1 || progressUpdates > 2 + elapsed / IRadioHAL::ProgressIntervalMs) {
+            qCritical() << "Radio seek not throttled:" << frequencyUpdates << "frequency and" << progressUpdates << "progress updates";
+            return 19;
+        }
+        qDebug() << "  -> Seek up found" << tuner.frequencyString() << "MHz in" << elapsed << "ms," << progressUpdates << "progress updates";
+    }
+
+    // DAB service layer: FIC decode with a lost FIB, cached ensemble survives a restart
+    {
+        DabEnsemble ensemble;
+        ensemble.channel = 32; // 12C
+        ensemble.ensembleId = 0xF123;
+        ensemble.label = "Test Mux";
+        for (int i = 0; i < 4; ++i) {
+            DabService service;
+            service.serviceId = 0xF201 + i;
+            service.label = QString("Service %1").arg(i);
+            DabComponent audio;
+            audio.subChannelId = i + 1;
+            audio.primary = true;
+            audio.bitrate = 96;
+            service.components.append(audio);
+            ensemble.services.append(service);
+        }
+        FicEncoder encoder;
+        encoder.setEnsemble(ensemble);
+        QByteArray fic;
+        encoder.generate(2 * FicDecoder::StableFibs, fic);
+        fic[FicDecoder::FibSize + 4] = char(fic[FicDecoder::FibSize + 4] ^ 0x40);
+
+        QTemporaryDir dir;
+        {
+            DabServiceList list(dir.path());
+            list.pushFic(ensemble.channel, fic);
+            if (list.services()->rowCount() != 4 || list.serviceLabel(32, 0) != "Service 0") {
+                qCritical() << "DAB ensemble not decoded:" << list.services()->rowCount() << "services";
+                return 21;
+            }
+        }
+        DabServiceList restored(dir.path()); // cold boot: no FIC yet
+        const DabEnsemble *cached = restored.ensemble(32);
+        if (!cached || cached->label != "Test Mux" || restored.services()->rowCount() != 4
+            || cached->services[2].components.first().bitrate != 96) {
+            qCritical() << "DAB service cache not restored";
+            return 21;
+        }
+        qDebug() << "  -> DAB ensemble decoded and restored from cache (" << cached->services.size() << "services )";
+    }
+
+    // AF following: a fading station moves to the verified alternate, never to a reused frequency
+    {
+        AfFollower af;
+        af.setNetwork(10150, 0xF202, {10150, 8890, 9540});
+        int tuned = 10150;
+        int switchedAt = -1;
+        bool wrongSwitch = false;
+        for (int t = 0; t <= 10000; t += IRadioHAL::ProgressIntervalMs) {
+            const int snr = tuned == 8890 ? 25 : t < 2000 ? 30 : 8;
+            const AfFollower::Decision d = af.update(t, snr);
+            if (d.action == AfFollower::Check) {
+                // 95.4 is strong here but carries a local station
+                const bool reused = d.frequency == 9540;
+                af.checkResult(t, d.frequency, reused ? 35 : d.frequency == 8890 ? 25 : 8, reused ? 0xF3A1 : 0xF202);
+            } else if (d.action == AfFollower::Switch) {
+                wrongSwitch |= d.frequency != 8890 || switchedAt >= 0;
+                tuned = d.frequency;
+                switchedAt = t;
+                af.switched(t, tuned);
+            }
+        }
+        if (wrongSwitch || switchedAt < 2000 || switchedAt > 4000 || af.stats().piMismatches == 0) {
+            qCritical() << "AF following failed: switch at" << switchedAt << "ms to" << tuned;
+            return 22;
+        }
+        qDebug() << "  -> AF switch to 88.9 MHz" << switchedAt - 2000 << "ms after the fade";
+    }
+
+    // SDR FM demodulation: stereo tones and RDS through the IQ pipeline
+    {
+        const int rate = 960000;
+        RdsEncoder rds;
+        rds.setStation(0xF202, 1, "RADIO 1", "", {8890});
+        FmModulator modulator(rate);
+        modulator.setOffset(-150000);
+        modulator.setTones(1000, 2500);
+        modulator.setRds(&rds);
+        modulator.setCarrierToNoise(30);
+        std::vector<float> iq;
+        modulator.generate(size_t(rate) * 3 / 2, iq);
+
+        FmDemodulator demod(rate);
+        demod.setOffset(-150000);
+        demod.setDeemphasis(0);
+        std::vector<float> audio;
+        std::vector<uint8_t> bits;
+        for (size_t block = 0; block < iq.size() / 2; block += size_t(rate) / 10)
+            demod.process(iq.data() + block * 2, qMin(size_t(rate) / 10, iq.size() / 2 - block), audio, bits);
+        RdsDecoder decoder;
+        decoder.pushBits(bits.data(), bits.size());
+
+        // Tone level per channel over the settled second half
+        auto level = [&audio](int channel, double hz) {
+            double re = 0.0, im = 0.0;
+            const size_t frames = audio.size() / 2;
+            for (size_t i = frames / 2; i < frames; ++i) {
+                const double w = 2.0 * M_PI * hz * double(i) / FmDemodulator::AudioRate;
+                re += audio[i * 2 + channel] * std::cos(w);
+                im += audio[i * 2 + channel] * std::sin(w);
+            }
+            return std::sqrt(re * re + im * im);
+        };
+        const double separation = 20.0 * std::log10(level(0, 1000) / level(1, 1000));
+        if (!demod.pilotLocked() || separation < 20.0 || !decoder.hasPi() || decoder.pi() != 0xF202) {
+            qCritical() << "FM demodulation failed: pilot" << demod.pilotLocked() << "separation" << separation
+                        << "dB, PI" << Qt::hex << decoder.pi();
+            return 23;
+        }
+        qDebug() << "  -> FM stereo" << qRound(separation) << "dB separation, PI" << Qt::hex << decoder.pi();
+    }
+
+    // Radio timeshift: ring window read in place, pause while recording, rewind, back to live
+    {
+        QTemporaryDir dir;
+        TimeshiftOutput timeshift(dir.filePath("timeshift.pcm"), 4);
+        const TimeshiftBuffer &buffer = timeshift.buffer();
+        const int rate = IRadioHAL::AudioSampleRate;
+        const int batchFrames = rate * IRadioHAL::ProgressIntervalMs / 1000;
+        quint64 recorded = 0;
+        // Tuner batches of a ramp: every frame carries its own position
+        auto record = [&](int ms) {
+            for (int t = 0; t < ms; t += IRadioHAL::ProgressIntervalMs) {
+                QByteArray pcm(batchFrames * 2 * int(sizeof(qint16)), Qt::Uninitialized);
+                qint16 *samples = reinterpret_cast<qint16 *>(pcm.data());
+                for (int i = 0; i < batchFrames; ++i, ++recorded) {
+                    samples[2 * i] = qint16(recorded & 0x7FFF);
+                    samples[2 * i + 1] = qint16(-samples[2 * i]);
+                }
+                timeshift.pushPcm(pcm);
+            }
+        };
+        std::vector<float> out(2 * 480);
+        auto render = [&](int frames) {
+            for (; frames > 0; frames -= 480) timeshift.playbackDevice()->render(out.data(), 480, rate);
+        };
+
+        record(6000); // longer than the ring
+        bool intact = timeshift.isAvailable() && buffer.writePosition() == recorded
+                      && timeshift.bufferedSeconds() >= 4
+                      && buffer.stats().segmentWrites == recorded / TimeshiftBuffer::SegmentFrames;
+        for (quint64 p = buffer.oldestPosition(); intact && p < buffer.writePosition();) {
+            const qint16 *data = nullptr;
+            const size_t frames = buffer.span(p, &data);
+            intact = frames > 0;
+            for (size_t i = 0; intact && i < frames; ++i)
+                intact = data[2 * i] == qint16((p + i) & 0x7FFF) && data[2 * i + 1] == -data[2 * i];
+            p += frames;
+        }
+
+        timeshift.setOutputActive(true);
+        render(480); // the reader drops what it held before going live
+        record(500);
+        timeshift.setPaused(true);
+        const quint64 pausedAt = timeshift.playPosition();
+        record(2000);
+        const bool held = timeshift.playPosition() == pausedAt && timeshift.delaySeconds() == 2 && !timeshift.isLive();
+
+        timeshift.setPaused(false);
+        timeshift.rewind(1);
+        const bool rewound = timeshift.playPosition() == pausedAt - quint64(rate);
+        render(480);
+        QElapsedTimer feedTime;
+        feedTime.start();
+        while (feedTime.elapsed() < 100) QCoreApplication::processEvents();
+        render(2400);
+        const int expected = int((pausedAt - quint64(rate) + 2400) & 0x7FFF);
+        const bool shifted = std::abs(qRound(out[2 * 479] * 32768.0f) - expected) < 64;
+
+        timeshift.forward(10);
+        const bool live = timeshift.isLive() && timeshift.delaySeconds() == 0;
+        timeshift.restart();
+        if (!intact || !held || !rewound || !shifted || !live || timeshift.bufferedSeconds() != 0) {
+            qCritical() << "Timeshift failed: intact" << intact << "held" << held << "rewound" << rewound
+                        << "shifted" << shifted << "live" << live << "buffered" << timeshift.bufferedSeconds();
+            return 24;
+        }
+        qDebug() << "  -> Timeshift window" << buffer.capacityFrames() / rate << "s," << buffer.stats().segmentWrites
+                 << "segment writes of" << TimeshiftBuffer::SegmentFrames * 4 / 1024 << "KB";
+    }
+
+
+    // Spectrum: a sine peaks in its FFT bin at full scale, and in its bar
+    qDebug() << "[TEST] Spectrum analyzer...";
+    {
+        const int n = SpectrumAnalyzer::FftSize;
+        RealFft fft(n);
+        std::vector<float> sine(n), power(fft.binCount());
+        for (int i = 0; i < n; ++i) sine[i] = float(std::sin(2.0 * M_PI * 100.0 * i / n));
+        fft.powerSpectrum(sine.data(), power.data());
+        const int peakBin = int(std::max_element(power.begin(), power.end()) - power.begin());
+        // Full scale through the Hann window: (N/4)^2
+        const double fullScale = double(n) * n / 16.0;
+        const bool binOk = peakBin == 100 && std::abs(power[100] / fullScale - 1.0) < 0.01;
+
+        // Bars are log-spaced from 40 Hz to 16 kHz; a tone in the middle of one
+        SpectrumAnalyzer analyzer;
+        const int bars = analyzer.bandCount(), bar = bars / 2;
+        const double hz = 40.0 * std::pow(16000.0 / 40.0, (bar + 0.5) / bars);
+        analyzer.addViewer();
+        analyzer.setSourceRunning(true);
+        std::vector<float> chunk(480);
+        quint64 frame = 0;
+        QElapsedTimer waited;
+        waited.start();
+        int peakBar = -1;
+        while (waited.elapsed() < 2000) {
+            for (float &s : chunk) s = float(0.5 * std::sin(2.0 * M_PI * hz * double(frame++) / 48000.0));
+            analyzer.pushSamples(chunk.data(), int(chunk.size()), 1, 48000);
+            QCoreApplication::processEvents(QEventLoop::AllEvents, 10);
+            const QList<float> bands = analyzer.bands();
+            const auto loudest = std::max_element(bands.begin(), bands.end());
+            if (loudest != bands.end() && *loudest > 0.5f) {
+                peakBar = int(loudest - bands.begin());
+                break;
+            }
+        }
+        analyzer.removeViewer();
+        if (!binOk || peakBar != bar) {
+            qCritical() << "Spectrum failed: peak bin" << peakBin << "power" << power[100] / fullScale << "of full scale,"
+                        << qRound(hz) << "Hz in bar" << peakBar << "expected" << bar;
+            return 25;
+        }
+        qDebug() << "  -> Bin 100 at full scale," << qRound(hz) << "Hz in bar" << peakBar << "of" << bars;
+    }
+
+
+    // 2. Bluetooth Stream Verification (file-feeding client stand-in)
+    qDebug() << "[TEST] Bluetooth stream ingest...";
+    {
+        const QString socketName = "nordic-a2dp-test";
+        StreamingPcmSource stream;
+        stream.setOutputActive(true); // no mixer attached: the test pulls the device itself
+        stream.start(socketName);
+
+        QLocalSocket producer;
+        QElapsedTimer waited;
+        waited.start();
+        while (producer.state() != QLocalSocket::ConnectedState && waited.elapsed() < 2000) {
+            producer.connectToServer(socketName);
+            producer.waitForConnected(100);
+        }
+        while (!stream.isConnected() && waited.elapsed() < 2000) QCoreApplication::processEvents();
+        if (!stream.isConnected()) {
+            qCritical() << "Bluetooth stream producer could not connect";
+            return 6;
+        }
+
+        // 500 ms of a 1 kHz stereo tone in 10 ms frames
+        for (int f = 0; f < 50; ++f) {
+            QByteArray pcm(480 * 4, Qt::Uninitialized);
+            for (int i = 0; i < 480; ++i) {
+                const qint16 v = qint16(8000 * std::sin(2 * M_PI * 1000 * (f * 480 + i) / 48000.0));
+                qToLittleEndian(v, pcm.data() + i * 4);
+                qToLittleEndian(v, pcm.data() + i * 4 + 2);
+            }
+            StreamProtocol::FrameHeader h{qToLittleEndian(StreamProtocol::Magic), StreamProtocol::CodecPcmS16, 2, 0,
+                                          qToLittleEndian(quint32(48000)), qToLittleEndian(quint32(pcm.size())), 0};
+            producer.write(reinterpret_cast<const char *>(&h), sizeof(h));
+            producer.write(pcm);
+        }
+        producer.flush();
+
+        while (stream.framesReceived() < 24000 && waited.elapsed() < 4000) {
+            producer.waitForBytesWritten(10);
+            QCoreApplication::processEvents();
+        }
+        if (stream.framesReceived() < 24000) {
+            qCritical() << "Bluetooth stream dropped frames. Received" << stream.framesReceived();
+            return 7;
+        }
+
+        // Pull 100 ms through the jitter buffer: prefill is satisfied, audio must come out
+        QByteArray out = stream.playbackDevice()->read(4800 * 4);
+        qint16 peak = 0;
+        for (int i = 0; i < out.size() / 2; ++i)
+            peak = qMax<qint16>(peak, qAbs(qFromLittleEndian<qint16>(out.constData() + i * 2)));
+        if (peak < 4000) {
+            qCritical() << "Bluetooth stream produced silence. Peak" << peak;
+            return 8;
+        }
+        qDebug() << "  -> Received" << stream.framesReceived() << "frames, output peak" << peak;
+    }
+
+
+    // 3. Audio Focus Verification (duck-to-prompt latency through the mixer)
+    qDebug() << "[TEST] Audio focus duck-to-prompt latency...";
+    {
+        AudioFocusManager focus;
+        AudioMixer *mixer = focus.mixer(); // never started: the test pulls render() itself
+
+        // Media bus: constant level through the same reader the players use;
+        // the test prompt is a constant step, so its first sample is a jump
+        constexpr float mediaLevel = 0.5f;
+        StreamState media;
+        StreamPlaybackDevice mediaReader(&media);
+        std::vector<float> dc(48000 * 2, mediaLevel);
+        media.ring.write(dc.data(), dc.size());
+        media.accepting.store(true);
+        mixer->setMediaSource(&mediaReader);
+        focus.request(AudioFocusManager::Media);
+
+        std::vector<float> step(4800 * 2, 0.25f);
+        focus.preparePrompt("test", step.data(), 4800, AudioMixer::SampleRate);
+
+        constexpr int block = 240; // 5 ms pull period
+        std::vector<float> out(block * 2);
+        for (int i = 0; i < 20; ++i) mixer->render(out.data(), block);
+
+        QElapsedTimer handoff;
+        handoff.start();
+        focus.playNavigationPrompt("test");
+        const qint64 handoffUs = handoff.nsecsElapsed() / 1000;
+
+        int promptFrame = -1;
+        float mediaBeforePrompt = out[(block - 1) * 2];
+        for (int b = 0; b < 40 && promptFrame < 0; ++b) {
+            mixer->render(out.data(), block);
+            for (int i = 0; i < block; ++i) {
+                if (out[i * 2] - mediaBeforePrompt > 0.1f) {
+                    promptFrame = b * block + i;
+                    break;
+                }
+                mediaBeforePrompt = out[i * 2];
+            }
+        }
+        const float ducked = mediaLevel * 0.3f;
+        // The first prompt sample in the mix, counted from the first block rendered after the handoff
+        const double latencyMs = promptFrame * 1000.0 / AudioMixer::SampleRate;
+        if (promptFrame != AudioFocusManager::DuckRampMs * AudioMixer::SampleRate / 1000) {
+            qCritical() << "Prompt not started as the duck ends: first sample at" << latencyMs << "ms";
+            return 9;
+        }
+        if (std::abs(mediaBeforePrompt - ducked) > 0.01f) {
+            qCritical() << "Media not ducked when the prompt started. Level" << mediaBeforePrompt;
+            return 14;
+        }
+
+        // A prompt started while the finish of the one before is still queued keeps the focus
+        for (int b = 0; b < 40; ++b) mixer->render(out.data(), block); // "test" ends; its finish is queued
+        focus.playNavigationPrompt();
+        QCoreApplication::processEvents();
+        const bool kept = focus.promptPlaying() && focus.isActive(AudioFocusManager::Navigation);
+        for (int b = 0; b < 80; ++b) mixer->render(out.data(), block); // the 240 ms chime ends
+        QCoreApplication::processEvents();
+        if (!kept || focus.promptPlaying() || focus.isActive(AudioFocusManager::Navigation)) {
+            qCritical() << "Prompt focus wrong across a stale finish: kept" << kept << "released" << !focus.promptPlaying();
+            return 26;
+        }
+
+        // A prompt re-prepared while it plays: the mixer reads the old clip on to its end
+        focus.playNavigationPrompt("test");
+        for (int b = 0; b < 8; ++b) mixer->render(out.data(), block); // past the duck, into the prompt
+        std::vector<float> louder(4800 * 2, 0.75f);
+        focus.preparePrompt("test", louder.data(), 4800, AudioMixer::SampleRate);
+        mixer->render(out.data(), block);
+        const float replacedLevel = out[(block - 1) * 2];
+        for (int b = 0; b < 40; ++b) mixer->render(out.data(), block);
+        QCoreApplication::processEvents();
+        if (std::abs(replacedLevel - (ducked + 0.25f)) > 0.01f || focus.promptPlaying()) {
+            qCritical() << "Prompt replaced in the cache while playing: level" << replacedLevel << "playing" << focus.promptPlaying();
+            return 27;
+        }
+        qDebug() << "  -> Prompt handoff" << handoffUs << "us, first prompt sample" << latencyMs << "ms into the mix";
+    }
+
+
+    // 4. Seek Index Verification (synthetic VBR MP3: ID3v2 tag + mixed-bitrate frames)
+    qDebug() << "[TEST] Seek index on a VBR MP3...";
+    {
+        QTemporaryDir dir;
+        const QString path = dir.filePath("vbr.mp3");
+        QByteArray bytes("ID3\x04\x00\x00\x00\x00\x00\x5A", 10);
+        bytes.append(90, '\0');
+
+        constexpr int frameCount = 2000;
+        QVector<qint64> offsets;
+        for (int i = 0; i < frameCount; ++i) {
+            const int bitrateIndex = (i * 7) % 3 == 0 ? 11 : 9; // 192 / 128 kbps
+            const int kbps = bitrateIndex == 11 ? 192 : 128;
+            QByteArray frame(144 * kbps * 1000 / 44100, '\0');
+            frame[0] = char(0xFF);
+            frame[1] = char(0xFB); // MPEG-1 Layer III, no CRC
+            frame[2] = char(bitrateIndex << 4);
+            offsets.append(bytes.size());
+            bytes.append(frame);
+        }
+        QFile out(path);
+        out.open(QIODevice::WriteOnly);
+        out.write(bytes);
+        out.close();
+
+        const SeekIndex index = SeekIndex::build(path);
+        const qint64 expectedMs = qint64(frameCount) * 1152 * 1000 / 44100;
+        if (!index.isValid() || !index.isVbr() || index.durationMs() != expectedMs) {
+            qCritical() << "Seek index build failed. Duration" << index.durationMs() << "expected" << expectedMs;
+            return 15;
+        }
+
+        QFile file(path);
+        file.open(QIODevice::ReadOnly);
+        for (qint64 ms : {0LL, 1234LL, 20000LL, expectedMs - 10}) {
+            const int frame = int(ms * 44100 / 1000 / 1152);
+            const SeekIndex::Position pos = index.locate(ms, &file);
+            if (pos.offset != offsets[frame] || pos.ms != qint64(frame) * 1152 * 1000 / 44100) {
+                qCritical() << "Seek to" << ms << "ms landed at" << pos.offset << "expected frame" << frame << "at" << offsets[frame];
+                return 16;
+            }
+        }
+
+        SeekIndex cached;
+        const QString cacheFile = dir.filePath("vbr.idx");
+        if (!index.save(cacheFile) || !cached.load(cacheFile)
+            || cached.locate(20000, &file).offset != index.locate(20000, &file).offset) {
+            qCritical() << "Seek index cache round trip failed.";
+            return 17;
+        }
+
+        // Skipping to a WAV while the MP3's index is still building must
+        // leave the WAV without one, not with the MP3's
+        SeekIndexLoader loader;
+        int delivered = 0;
+        QObject::connect(&loader, &SeekIndexLoader::ready, [&]() { ++delivered; });
+        loader.load(path);
+        loader.load(dir.filePath("next.wav"));
+        QElapsedTimer waited;
+        waited.start();
+        while (waited.elapsed() < 1000) QCoreApplication::processEvents();
+        if (delivered != 0 || loader.index().isValid() || loader.path() != dir.filePath("next.wav")) {
+            qCritical() << "Previous track's seek index applied to the next." << delivered << "delivered";
+            return 28;
+        }
+        loader.load(path);
+        waited.restart();
+        while (delivered == 0 && waited.elapsed() < 5000) QCoreApplication::processEvents();
+        if (delivered != 1 || loader.index().durationMs() != expectedMs) {
+            qCritical() << "Seek index loader never delivered the MP3's index.";
+            return 28;
+        }
+        qDebug() << "  -> Indexed" << frameCount << "frames," << index.entryCount() << "checkpoints";
+    }
+
 
-    // 2. MediaLibrary Verification
+    // 5. MediaLibrary Verification
     qDebug() << "[TEST] MediaLibrary Async Scan...";
     MediaLibrary lib;
     
@@ -72,7 +577,7 @@ int main(int argc, char *argv[])
             return;
         }
 
-        // 3. Search Verification
+        // 6. Search Verification
         qDebug() << "[TEST] Search functionality...";
         lib.search("Weeknd");
         int results = lib.searchResultsModel()->rowCount();
@@ -84,7 +589,7 @@ int main(int argc, char *argv[])
              return;
         }
         
-        // 4. Persistence Verification
+        // 7. Persistence Verification
         // Toggle like on first track
         lib.toggleLike(0);
         if (!lib.isLiked(0)) {
@@ -0,0 +1,267 @@
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QDebug>
+#include <algorithm>
+#include <cmath>
+#include <memory>
+#include <random>
+#include <vector>
+#include "Navigation/OffRouteDetector.h"
+#include "Navigation/RouteSuffix.h"
+#include "BenchRoutes.h"
+
+// Off-route detection and rerouting: a car follows a 40 km route with
+// maneuvers every kilometre or so, reporting fixes at 10 Hz a few metres
+// off (with the odd 40 m outlier); the whole drive must not once be taken
+// off the route. Then it leaves the route at points along it, at angles
+// from a slight fork to turning back, and comes back the way it went.
+// Reports how long after leaving it is taken off the route and how long
+// after coming back it is on again. For each departure the route left is
+// joined on to a way back to it; the joined route must end on the old
+// route's points, maneuvers, limits and traffic. Reports how much of the
+// route is kept and the time to join it.
+//
+//   bench_off_route
+
+namespace {
+
+constexpr double kPi = 3.14159265358979323846;
+constexpr double kMetersPerDegree = 111195.0;
+constexpr double kPointSpacingMeters = 20.0;
+constexpr double kRouteKm = 40.0;
+constexpr double kStepMinMeters = 500.0;
+constexpr double kStepMaxMeters = 1500.0;
+constexpr double kSpanMeters = 500.0;   // traffic feed resolution
+constexpr double kSpeed = 25.0;         // m/s
+constexpr int kFixIntervalMs = 100;
+constexpr double kNoiseMeters = 5.0;
+constexpr double kOutlierMeters = 40.0;
+constexpr double kOutlierRate = 0.01;
+constexpr double kHeadingNoise = 5.0;   // degrees
+constexpr int kDepartures = 40;
+constexpr double kApproachMeters = 300.0;
+constexpr double kAwaySeconds = 30.0;
+constexpr double kDetectBudgetSeconds = 8.0; // p95 to be taken off the route
+constexpr double kRejoinBudgetSeconds = 5.0; // longest to be back on it
+constexpr double kJoinBudgetMs = 20.0;
+const double kAngles[] = {20.0, 45.0, 90.0, 180.0};
+
+RoutePath generateRoute() {
+    std::mt19937 rng(46);
+    std::uniform_real_distribution<double> unit(0.0, 1.0);
+    return BenchRoutes::generateRoute(kRouteKm, kPointSpacingMeters, 59.33, 18.07, kPi / 2, [&](int, double heading) {
+        return std::clamp(heading + (unit(rng) - 0.5) * 0.1, 0.8, 2.3);
+    });
+}
+
+QList<RouteStep> generateSteps(const RouteIndex &route) {
+    std::mt19937 rng(47);
+    std::uniform_real_distribution<double> gap(kStepMinMeters, kStepMaxMeters);
+    QList<RouteStep> steps;
+    for (double along = 0.0; along < route.length(); along += gap(rng)) {
+        RouteStep step;
+        step.instruction = "Turn";
+        step.offset = along;
+        step.maneuverCoordinate = route.coordinateAt(along);
+        steps.append(step);
+    }
+    RouteStep arrive;
+    arrive.instruction = "Arrive at destination";
+    arrive.offset = route.length();
+    arrive.maneuverCoordinate = route.path().last();
+    steps.append(arrive);
+    return steps;
+}
+
+double bearing(const QGeoCoordinate &from, const QGeoCoordinate &to) {
+    const double north = (to.latitude() - from.latitude()) * kMetersPerDegree;
+    const double east = (to.longitude() - from.longitude()) * kMetersPerDegree * std::cos(from.latitude() * kPi / 180.0);
+    return std::fmod(std::atan2(east, north) * 180.0 / kPi + 360.0, 360.0);
+}
+
+double percentile(std::vector<double> values, int p) {
+    std::sort(values.begin(), values.end());
+    return values[values.size() * size_t(p) / 100];
+}
+
+// Reports positions as a receiver would, to the matcher and the detector
+struct Drive {
+    std::shared_ptr<const RouteIndex> route;
+    MapMatcher matcher;
+    OffRouteDetector detector;
+    std::mt19937 rng{48};
+    std::normal_distribution<double> noise{0.0, 1.0};
+    std::uniform_real_distribution<double> unit{0.0, 1.0};
+    qint64 timestamp = 0;
+
+    explicit Drive(std::shared_ptr<const RouteIndex> r) : route(r), matcher(r) {}
+
+    bool fix(const QGeoCoordinate &truth, double heading) {
+        const double spread = unit(rng) < kOutlierRate ? kOutlierMeters : kNoiseMeters;
+        MapMatcher::Fix f;
+        f.latitude = truth.latitude() + noise(rng) * spread / kMetersPerDegree;
+        f.longitude = truth.longitude()
+                      + noise(rng) * spread / (kMetersPerDegree * std::cos(truth.latitude() * kPi / 180.0));
+        f.heading = std::fmod(heading + noise(rng) * kHeadingNoise + 720.0, 360.0);
+        f.speed = kSpeed;
+        f.timestampMs = timestamp += kFixIntervalMs;
+        return detector.update(f, matcher.push(f));
+    }
+    double routeBearing(double along) const {
+        const int s = route->segmentAt(along);
+        return bearing(route->path().at(s), route->path().at(s + 1));
+    }
+};
+
+} // namespace
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    const RoutePath path = generateRoute();
+    const auto route = std::make_shared<const RouteIndex>(path);
+    const QList<RouteStep> steps = generateSteps(*route);
+    const double step = kSpeed * kFixIntervalMs / 1000.0;
+    qInfo() << "[BENCH] Off route," << route->length() / 1000.0 << "km route," << steps.size() << "maneuvers";
+
+    // Along the route all the way: never off it
+    int falseAlarms = 0, fixes = 0;
+    {
+        Drive drive(route);
+        bool off = false;
+        for (double along = 0.0; along <= route->length(); along += step, ++fixes) {
+            const bool now = drive.fix(route->coordinateAt(along), drive.routeBearing(along));
+            if (now && !off) ++falseAlarms;
+            off = now;
+        }
+    }
+    qInfo().noquote() << QString("  on the route: %1 fixes, taken off it %2 times").arg(fixes).arg(falseAlarms);
+
+    // Away from the route and back
+    std::vector<double> detect, rejoin;
+    int missed = 0, stuck = 0;
+    const double first = 2000.0, last = route->length() - 3000.0;
+    for (int d = 0; d < kDepartures; ++d) {
+        const double leftAt = first + (last - first) * d / (kDepartures - 1);
+        const double angle = kAngles[d % 4];
+        Drive drive(route);
+        for (double along = leftAt - kApproachMeters; along < leftAt; along += step)
+            drive.fix(route->coordinateAt(along), drive.routeBearing(along));
+
+        const QGeoCoordinate exit = route->coordinateAt(leftAt);
+        const double heading = std::fmod(drive.routeBearing(leftAt) + angle, 360.0);
+        double seconds = 0.0, detectedAfter = -1.0;
+        for (; seconds < kAwaySeconds; seconds += kFixIntervalMs / 1000.0) {
+            const bool off = drive.fix(exit.atDistanceAndAzimuth(seconds * kSpeed, heading), heading);
+            if (off && detectedAfter < 0.0) detectedAfter = seconds;
+        }
+        if (detectedAfter < 0.0) {
+            ++missed;
+            continue;
+        }
+        detect.push_back(detectedAfter);
+
+        // The same way back, then on along the route
+        for (; seconds > 0.0; seconds -= kFixIntervalMs / 1000.0)
+            drive.fix(exit.atDistanceAndAzimuth(seconds * kSpeed, heading), std::fmod(heading + 180.0, 360.0));
+        // Timed from the exit; turned back along the route, it may be on before
+        double rejoinedAfter = -1.0;
+        for (double along = leftAt; along < leftAt + kAwaySeconds * kSpeed; along += step) {
+            if (!drive.fix(route->coordinateAt(along), drive.routeBearing(along))) {
+                rejoinedAfter = (along - leftAt) / kSpeed;
+                break;
+            }
+        }
+        if (rejoinedAfter < 0.0) ++stuck;
+        else rejoin.push_back(rejoinedAfter);
+    }
+    qInfo().noquote() << QString("  %1 departures at 20-180 degrees: off after p50 %2 s, p95 %3 s; %4 missed")
+                             .arg(kDepartures)
+                             .arg(percentile(detect, 50), 0, 'f', 1)
+                             .arg(percentile(detect, 95), 0, 'f', 1)
+                             .arg(missed);
+    qInfo().noquote() << QString("  back on after p50 %1 s, max %2 s; %3 never")
+                             .arg(percentile(rejoin, 50), 0, 'f', 1)
+                             .arg(*std::max_element(rejoin.begin(), rejoin.end()), 0, 'f', 1)
+                             .arg(stuck);
+
+    // Rerouting: a way back to the rejoin point, joined on to the rest
+    std::mt19937 rng(49);
+    std::uniform_int_distribution<int> congestion(TrafficModel::Free, TrafficModel::Jammed);
+    TrafficModel traffic(*route);
+    for (double from = 0.0; from < traffic.length(); from += kSpanMeters)
+        traffic.update(from, from + kSpanMeters, TrafficModel::Congestion(congestion(rng)));
+    QList<quint8> limits;
+    for (int s = 0; s + 1 < path.size(); ++s) limits.append(quint8(30 + 10 * (s / 100 % 8)));
+    const double seconds = route->length() / kSpeed;
+
+    std::vector<double> joinTimes;
+    double kept = 0.0;
+    int wrong = 0;
+    QElapsedTimer clock;
+    for (int d = 0; d < kDepartures; ++d) {
+        const double leftAt = first + (last - first) * d / (kDepartures - 1);
+        const RouteSuffix suffix(*route, steps, limits, traffic, seconds, leftAt);
+        if (suffix.isEmpty()) {
+            ++wrong;
+            continue;
+        }
+        // The prefix a router would return: straight from beside the route
+        // to the rejoin point, with a maneuver on the way and the arrival
+        const QGeoCoordinate car = route->coordinateAt(leftAt).atDistanceAndAzimuth(400.0, 0.0);
+        RouteResult res;
+        res.success = true;
+        const double way = car.distanceTo(suffix.start());
+        const double azimuth = bearing(car, suffix.start());
+        for (double m = 0.0; m < way; m += kPointSpacingMeters) {
+            const QGeoCoordinate p = car.atDistanceAndAzimuth(m, azimuth);
+            res.currentRoutePath.append(p.latitude(), p.longitude());
+            if (m > 0.0) res.speedLimits.append(50);
+        }
+        res.currentRoutePath.append(suffix.start().latitude(), suffix.start().longitude());
+        res.speedLimits.append(50);
+        res.routeSteps.append(RouteStep{"Head", "", 0, car, "", 0.0});
+        res.routeSteps.append(RouteStep{"Turn", "right", 0, car, "", way / 2});
+        res.routeSteps.append(RouteStep{"Arrive at destination", "", 0, suffix.start(), "", way});
+        res.routeData["distance"] = way;
+        res.routeData["duration"] = way / 14.0;
+        const int prefixPoints = res.currentRoutePath.size();
+
+        clock.start();
+        suffix.appendTo(res);
+        RouteIndex joined(res.currentRoutePath);
+        TrafficModel joinedTraffic(joined);
+        joinedTraffic.update(0.0, joinedTraffic.length(), TrafficModel::Unknown);
+        suffix.restoreTraffic(joinedTraffic);
+        joinTimes.push_back(clock.nsecsElapsed() / 1e6);
+        kept += suffix.length() / route->length() / kDepartures;
+
+        // Ends on the old route: points, limits, maneuvers and traffic
+        const int tail = res.currentRoutePath.size() - (prefixPoints - 1);
+        const int cut = path.size() - tail;
+        bool ok = res.speedLimits.size() == res.currentRoutePath.size() - 1
+                  && res.routeSteps.size() > 2 && res.routeSteps[1].instruction == "Turn"
+                  && res.routeSteps.last().instruction == "Arrive at destination";
+        for (int i = 0; ok && i < tail; ++i)
+            ok = res.currentRoutePath.latitude(prefixPoints - 1 + i) == path.latitude(cut + i)
+                 && res.currentRoutePath.longitude(prefixPoints - 1 + i) == path.longitude(cut + i);
+        for (int s = 0; ok && s + 1 < tail; ++s) ok = res.speedLimits[prefixPoints - 1 + s] == limits[cut + s];
+        const double shift = joined.length() - suffix.length();
+        for (double m = 10.0; ok && m < suffix.length(); m += 100.0)
+            ok = joinedTraffic.at(shift + m) == traffic.at(route->offset(cut) + m);
+        if (!ok) ++wrong;
+    }
+    const double p95 = percentile(joinTimes, 95);
+    qInfo().noquote() << QString("  rerouting: %1% of the route kept on average, joined in p95 %2 ms; %3 of %4 wrong")
+                             .arg(kept * 100.0, 0, 'f', 0)
+                             .arg(p95, 0, 'f', 2)
+                             .arg(wrong)
+                             .arg(kDepartures);
+
+    if (falseAlarms > 0 || missed > 0 || stuck > 0 || wrong > 0 || percentile(detect, 95) > kDetectBudgetSeconds
+        || *std::max_element(rejoin.begin(), rejoin.end()) > kRejoinBudgetSeconds || p95 > kJoinBudgetMs) {
+        qWarning() << "[BENCH] Off route: FAILED";
+        return 1;
+    }
+    return 0;
+}
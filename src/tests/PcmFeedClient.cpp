@@ -0,0 +1,160 @@
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QLocalSocket>
+#include <QTimer>
+#include <QtEndian>
+#include <QDebug>
+#include <cstring>
+#include "Audio/StreamProtocol.h"
+
+// Feeds a WAV (16-bit PCM) or raw S16LE file into the Bluetooth stream
+// socket in real time, standing in for a phone connected over A2DP.
+//
+//   pcm_feed_client music.wav
+//   pcm_feed_client --drift 300 --jitter 15 --title "Song" --artist "Band" music.wav
+
+namespace {
+
+struct PcmInput {
+    QByteArray data;
+    int sampleRate = 48000;
+    int channels = 2;
+};
+
+bool loadInput(const QString &path, PcmInput &input)
+{
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly)) return false;
+    const QByteArray bytes = file.readAll();
+
+    if (!bytes.startsWith("RIFF") || bytes.mid(8, 4) != "WAVE") {
+        input.data = bytes; // raw S16LE, defaults apply
+        return true;
+    }
+
+    // Walk RIFF chunks for "fmt " and "data"
+    qsizetype pos = 12;
+    while (pos + 8 <= bytes.size()) {
+        const QByteArray id = bytes.mid(pos, 4);
+        const quint32 size = qFromLittleEndian<quint32>(bytes.constData() + pos + 4);
+        const char *body = bytes.constData() + pos + 8;
+        if (id == "fmt ") {
+            const quint16 format = qFromLittleEndian<quint16>(body);
+            input.channels = qFromLittleEndian<quint16>(body + 2);
+            input.sampleRate = int(qFromLittleEndian<quint32>(body + 4));
+            const quint16 bits = qFromLittleEndian<quint16>(body + 14);
+            if (format != 1 || bits != 16) {
+                qCritical() << "Only 16-bit PCM WAV files are supported";
+                return false;
+            }
+        } else if (id == "data") {
+            input.data = bytes.mid(pos + 8, size);
+            return true;
+        }
+        pos += 8 + size + (size & 1);
+    }
+    return false;
+}
+
+QByteArray makeFrame(quint8 codec, quint8 channels, quint32 sampleRate, const QByteArray &payload, quint64 timestampUs)
+{
+    StreamProtocol::FrameHeader header;
+    header.magic = qToLittleEndian(StreamProtocol::Magic);
+    header.codec = codec;
+    header.channels = channels;
+    header.reserved = 0;
+    header.sampleRate = qToLittleEndian(sampleRate);
+    header.payloadBytes = qToLittleEndian(quint32(payload.size()));
+    header.timestampUs = qToLittleEndian(timestampUs);
+
+    QByteArray frame(reinterpret_cast<const char *>(&header), sizeof(header));
+    frame.append(payload);
+    return frame;
+}
+
+} // namespace
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Feeds PCM into the Nordic Headunit Bluetooth stream socket");
+    parser.addHelpOption();
+    parser.addPositionalArgument("file", "WAV (16-bit PCM) or raw S16LE stereo 48 kHz file");
+    QCommandLineOption socketOpt("socket", "Socket name", "name", StreamProtocol::defaultSocketName());
+    QCommandLineOption frameOpt("frame-ms", "Frame duration in milliseconds", "ms", "10");
+    QCommandLineOption driftOpt("drift", "Simulated producer clock drift in ppm", "ppm", "0");
+    QCommandLineOption jitterOpt("jitter", "Send in bursts every N ms to simulate radio jitter", "ms", "0");
+    QCommandLineOption titleOpt("title", "Track title metadata", "text");
+    QCommandLineOption artistOpt("artist", "Artist metadata", "text");
+    QCommandLineOption loopOpt("loop", "Loop the file forever");
+    parser.addOptions({socketOpt, frameOpt, driftOpt, jitterOpt, titleOpt, artistOpt, loopOpt});
+    parser.process(app);
+
+    if (parser.positionalArguments().isEmpty()) parser.showHelp(1);
+
+    PcmInput input;
+    if (!loadInput(parser.positionalArguments().first(), input) || input.data.isEmpty()) {
+        qCritical() << "Could not read PCM from" << parser.positionalArguments().first();
+        return 1;
+    }
+
+    const int frameMs = qBound(2, parser.value(frameOpt).toInt(), 50);
+    const double clockScale = 1.0 + parser.value(driftOpt).toDouble() / 1e6;
+    const int burstMs = qMax(0, parser.value(jitterOpt).toInt());
+    const qsizetype bytesPerFrame = qsizetype(input.channels) * 2;
+    const qsizetype chunkBytes = qsizetype(input.sampleRate) * frameMs / 1000 * bytesPerFrame;
+
+    QLocalSocket socket;
+    socket.connectToServer(parser.value(socketOpt));
+    if (!socket.waitForConnected(2000)) {
+        qCritical() << "Cannot connect to" << parser.value(socketOpt) << ":" << socket.errorString();
+        return 2;
+    }
+    qInfo() << "Streaming" << input.data.size() / bytesPerFrame << "frames at" << input.sampleRate << "Hz,"
+            << input.channels << "ch, drift" << parser.value(driftOpt) << "ppm";
+
+    if (parser.isSet(titleOpt) || parser.isSet(artistOpt)) {
+        const QByteArray meta = (parser.value(titleOpt) + QChar(0x1F) + parser.value(artistOpt)).toUtf8();
+        socket.write(makeFrame(StreamProtocol::CodecMetadata, 0, 0, meta, 0));
+    }
+
+    QElapsedTimer clock;
+    clock.start();
+    qsizetype offset = 0;
+    quint64 sentUs = 0;
+    const bool loop = parser.isSet(loopOpt);
+
+    QTimer pacer;
+    pacer.setTimerType(Qt::PreciseTimer);
+    pacer.setInterval(qMax(1, burstMs > 0 ? burstMs : frameMs / 2));
+    QObject::connect(&pacer, &QTimer::timeout, &app, [&]() {
+        // Send everything that is due according to the (drifted) producer clock
+        const quint64 nowUs = quint64(clock.nsecsElapsed() / 1000 * clockScale);
+        while (sentUs <= nowUs) {
+            if (offset >= input.data.size()) {
+                if (!loop) {
+                    socket.flush();
+                    socket.disconnectFromServer();
+                    app.quit();
+                    return;
+                }
+                offset = 0;
+            }
+            const QByteArray chunk = input.data.mid(offset, chunkBytes);
+            offset += chunk.size();
+            socket.write(makeFrame(StreamProtocol::CodecPcmS16, quint8(input.channels), quint32(input.sampleRate), chunk, sentUs));
+            sentUs += quint64(chunk.size() / bytesPerFrame) * 1000000 / quint64(input.sampleRate);
+        }
+    });
+    QObject::connect(&socket, &QLocalSocket::disconnected, &app, [&]() {
+        qInfo() << "Disconnected";
+        app.quit();
+    });
+    pacer.start();
+
+    return app.exec();
+}
@@ -0,0 +1,46 @@
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QDebug>
+#include "Navigation/PlaceIndexBuilder.h"
+
+// Builds the offline place index (street, POI and settlement search) from
+// the same OSM XML extract as road_graph_build.
+//
+//   place_index_build extract.osm places.npi
+//
+// Copy the result to <AppData>/routing/places.npi on the target, or point
+// NORDIC_PLACE_INDEX at it.
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    if (argc != 3) {
+        qCritical() << "Usage: place_index_build extract.osm places.npi";
+        return 2;
+    }
+
+    QFile input(QString::fromLocal8Bit(argv[1]));
+    if (!input.open(QIODevice::ReadOnly)) {
+        qCritical() << "Cannot open" << input.fileName();
+        return 1;
+    }
+    QElapsedTimer clock;
+    clock.start();
+    PlaceIndexBuilder builder;
+    if (!builder.readOsmXml(&input)) return 1;
+    const qint64 readMs = clock.restart();
+    if (!builder.write(QString::fromLocal8Bit(argv[2]))) return 1;
+
+    const PlaceIndexBuilder::Stats &stats = builder.stats();
+    qInfo().noquote() << QString("%1 places (%2 streets), %3 house numbers (%4 without a matching street), "
+                                 "%5 words in %6 KB")
+                             .arg(stats.places)
+                             .arg(stats.streets)
+                             .arg(stats.houses)
+                             .arg(stats.unmatchedHouses)
+                             .arg(stats.keys)
+                             .arg(stats.keyBytes / 1024);
+    qInfo().noquote() << QString("read %1 ms, index %2 ms").arg(readMs).arg(clock.elapsed());
+    return 0;
+}
@@ -0,0 +1,99 @@
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QEventLoop>
+#include <QThread>
+#include <QTimer>
+#include <QDebug>
+#include "HAL/SimulatedRadioHAL.h"
+#include "Radio/BandScanner.h"
+
+// Full-band background scan on the simulated HAL: sweep time per band,
+// stations found, and how long a tune command waits while the sweep runs
+// (the HAL sits on its own thread, as in the app).
+//
+//   bench_radio_scan
+
+namespace {
+
+bool benchBand(SimulatedRadioHAL *hal, IRadioHAL::Band band, const char *name)
+{
+    BandScanner scanner(hal);
+    const IRadioHAL::BandPlan plan = IRadioHAL::bandPlan(band);
+
+    // Tune round trips while the background tuner sweeps
+    qint64 worstTuneMs = 0;
+    int tunes = 0;
+    QElapsedTimer tuneClock;
+    QTimer tuneTimer;
+    tuneTimer.setInterval(50);
+    QObject::connect(&tuneTimer, &QTimer::timeout, [&]() {
+        tuneClock.start();
+        hal->tune(plan.min + (tunes++ % 8) * plan.step);
+    });
+    QObject::connect(hal, &IRadioHAL::tuned, &scanner, [&]() {
+        if (tuneClock.isValid()) worstTuneMs = qMax(worstTuneMs, tuneClock.elapsed());
+    });
+
+    QEventLoop loop;
+    QObject::connect(&scanner, &BandScanner::finished, &loop, &QEventLoop::quit);
+    QElapsedTimer sweep;
+    sweep.start();
+    scanner.start(band);
+    tuneTimer.start();
+    loop.exec();
+    tuneTimer.stop();
+    const qint64 sweepMs = sweep.elapsed();
+
+    const QVector<IRadioHAL::ChannelQuality> &map = scanner.qualityMap(band);
+    const QVector<int> stations = BandScanner::detectStations(map);
+
+    QElapsedTimer detect;
+    detect.start();
+    constexpr int kRepeats = 1000;
+    int sink = 0;
+    for (int i = 0; i < kRepeats; ++i) sink += BandScanner::detectStations(map).size();
+    const double detectUs = detect.nsecsElapsed() / 1e3 / kRepeats;
+
+    qInfo().noquote() << QString("  %1: %2 channels in %3 ms (%4 ms/channel), %5 stations, detection %6 us, worst tune wait %7 ms over %8 tunes")
+                             .arg(name)
+                             .arg(map.size())
+                             .arg(sweepMs)
+                             .arg(double(sweepMs) / qMax(1, int(map.size())), 0, 'f', 2)
+                             .arg(scanner.stations()->rowCount())
+                             .arg(detectUs, 0, 'f', 1)
+                             .arg(worstTuneMs)
+                             .arg(tunes);
+
+    // Incremental list must equal a pass over the complete map, ghost-free
+    bool ok = scanner.stations()->rowCount() == stations.size() && !stations.isEmpty() && sink > 0;
+    for (int i = 1; i < stations.size(); ++i)
+        ok &= stations[i] - stations[i - 1] > BandScanner::GhostSpan * plan.step;
+    return ok && map.size() == (plan.max - plan.min) / plan.step + 1;
+}
+
+} // namespace
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+
+    QThread radioThread;
+    SimulatedRadioHAL *hal = new SimulatedRadioHAL(nullptr);
+    hal->moveToThread(&radioThread);
+    QObject::connect(&radioThread, &QThread::finished, hal, &QObject::deleteLater);
+    radioThread.start();
+
+    qInfo() << "[BENCH] Background band scan, dwell" << SimulatedRadioHAL::ScanDwellMs << "ms per channel";
+    bool ok = true;
+    ok &= benchBand(hal, IRadioHAL::BandFM, "FM");
+    ok &= benchBand(hal, IRadioHAL::BandAM, "AM");
+    ok &= benchBand(hal, IRadioHAL::BandDAB, "DAB");
+
+    radioThread.quit();
+    radioThread.wait();
+    if (!ok) {
+        qCritical() << "Scan result inconsistent (incremental vs full pass, ghosts, or missing channels)";
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,48 @@
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QDebug>
+#include "Navigation/RoadGraphBuilder.h"
+
+// Builds the offline routing graph from an OSM XML extract (for example a
+// country extract converted with `osmium cat extract.osm.pbf -o extract.osm`).
+//
+//   road_graph_build extract.osm graph.nrg
+//
+// Copy the result to <AppData>/routing/graph.nrg on the target, or point
+// NORDIC_ROUTING_GRAPH at it.
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    if (argc != 3) {
+        qCritical() << "Usage: road_graph_build extract.osm graph.nrg";
+        return 2;
+    }
+
+    QFile input(QString::fromLocal8Bit(argv[1]));
+    if (!input.open(QIODevice::ReadOnly)) {
+        qCritical() << "Cannot open" << input.fileName();
+        return 1;
+    }
+    QElapsedTimer clock;
+    clock.start();
+    RoadGraphBuilder builder;
+    if (!builder.readOsmXml(&input)) return 1;
+    const qint64 readMs = clock.restart();
+    if (!builder.write(QString::fromLocal8Bit(argv[2]))) return 1;
+
+    const RoadGraphBuilder::Stats &stats = builder.stats();
+    qInfo().noquote() << QString("%1 nodes, %2 segments, %3 shortcuts; %4 nodes outside the connected network, "
+                                 "%5 ways with missing nodes")
+                             .arg(stats.nodes)
+                             .arg(stats.segments)
+                             .arg(stats.shortcuts)
+                             .arg(stats.droppedNodes)
+                             .arg(stats.incompleteWays);
+    qInfo().noquote() << QString("read %1 ms, contraction %2 ms, total build %3 ms")
+                             .arg(readMs)
+                             .arg(stats.contractMs)
+                             .arg(clock.elapsed());
+    return 0;
+}
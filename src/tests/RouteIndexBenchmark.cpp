@@ -0,0 +1,118 @@
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QDebug>
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <vector>
+#include "Navigation/RouteIndex.h"
+#include "BenchRoutes.h"
+
+// Route index: build time for a 1000 km route, then the nearest segment
+// within 50 m for positions scattered around it (and some far off it),
+// through the grid and by projecting onto every segment. Both must find
+// the same distance and offset; the offset must lead back to the foot of
+// the projection through the prefix sums.
+//
+//   bench_route_index
+
+namespace {
+
+constexpr double kPi = 3.14159265358979323846;
+constexpr double kRouteKm = 1000.0;
+constexpr double kPointSpacingMeters = 20.0;
+constexpr double kRadiusMeters = 50.0;
+constexpr double kScatterMeters = 80.0;
+constexpr double kFarShare = 0.1;        // positions nowhere near the route
+constexpr int kQueries = 5000;
+constexpr int kScanQueries = 200;        // the scan is slow; compared on these
+constexpr double kBudgetUs = 50.0;       // p95 per query
+
+// A meandering road north from Malmö that turns back on itself now and then
+RoutePath generateRoute() {
+    std::mt19937 rng(46);
+    std::uniform_real_distribution<double> unit(0.0, 1.0);
+    return BenchRoutes::generateRoute(kRouteKm, kPointSpacingMeters, 55.605, 13.003, 0.0, [&](int, double heading) {
+        return heading + (unit(rng) - 0.5) * 0.2 + (unit(rng) < 0.002 ? kPi * 0.9 : 0.0);
+    });
+}
+
+// Every segment projected, as RouteIndex projects
+RouteIndex::Projection scan(const RouteIndex &index, double lat, double lon, double radius) {
+    const RoutePath &path = index.path();
+    const double ky = 6371008.8 * kPi / 180.0, kx = ky * std::cos(lat * kPi / 180.0);
+    RouteIndex::Projection best;
+    for (int s = 0; s + 1 < path.size(); ++s) {
+        const double ax = (path.longitude(s) - lon) * kx, ay = (path.latitude(s) - lat) * ky;
+        const double dx = (path.longitude(s + 1) - lon) * kx - ax, dy = (path.latitude(s + 1) - lat) * ky - ay;
+        const double length2 = dx * dx + dy * dy;
+        const double t = length2 > 0 ? std::clamp(-(ax * dx + ay * dy) / length2, 0.0, 1.0) : 0.0;
+        const double d = std::hypot(ax + t * dx, ay + t * dy);
+        if (d <= radius && (best.segment < 0 || d < best.distance)) {
+            best.segment = s;
+            best.distance = d;
+            best.offset = index.offset(s) + t * (index.offset(s + 1) - index.offset(s));
+        }
+    }
+    return best;
+}
+
+double percentile(std::vector<double> values, int p) {
+    std::sort(values.begin(), values.end());
+    return values[values.size() * size_t(p) / 100];
+}
+
+} // namespace
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    const RoutePath path = generateRoute();
+    QElapsedTimer clock;
+    clock.start();
+    const RouteIndex index(path);
+    qInfo() << "[BENCH] Route index," << kRouteKm << "km route";
+    qInfo().noquote() << QString("  build: %1 points in %2 ms").arg(path.size()).arg(clock.elapsed());
+
+    std::mt19937 rng(47);
+    std::uniform_real_distribution<double> unit(0.0, 1.0);
+    std::vector<double> indexTimes, scanTimes;
+    int found = 0, wrong = 0;
+    for (int q = 0; q < kQueries; ++q) {
+        // Around a random place on the route, or anywhere in its bounds
+        QGeoCoordinate position = index.coordinateAt(unit(rng) * index.length());
+        position = unit(rng) < kFarShare
+                       ? position.atDistanceAndAzimuth(2000.0 + unit(rng) * 20000.0, unit(rng) * 360.0)
+                       : position.atDistanceAndAzimuth(unit(rng) * kScatterMeters, unit(rng) * 360.0);
+        clock.start();
+        const RouteIndex::Projection p = index.nearest(position.latitude(), position.longitude(), kRadiusMeters);
+        indexTimes.push_back(clock.nsecsElapsed() / 1e3);
+        if (p.segment >= 0) {
+            ++found;
+            // Back from the offset to the same point
+            const QGeoCoordinate foot = index.coordinateAt(p.offset);
+            if (foot.distanceTo(QGeoCoordinate(p.latitude, p.longitude)) > 0.01) ++wrong;
+        }
+        if (q % (kQueries / kScanQueries) != 0) continue;
+        clock.start();
+        const RouteIndex::Projection expected = scan(index, position.latitude(), position.longitude(), kRadiusMeters);
+        scanTimes.push_back(clock.nsecsElapsed() / 1e3);
+        if (expected.segment != p.segment && (expected.segment < 0 || p.segment < 0
+                                              || std::abs(expected.distance - p.distance) > 1e-6
+                                              || std::abs(expected.offset - p.offset) > 1e-6))
+            ++wrong;
+    }
+    const double p95 = percentile(indexTimes, 95);
+    qInfo().noquote() << QString("  %1 queries, %2 within %3 m: grid p95 %4 us, scan p95 %5 us; %6 wrong")
+                             .arg(kQueries)
+                             .arg(found)
+                             .arg(kRadiusMeters)
+                             .arg(p95, 0, 'f', 2)
+                             .arg(percentile(scanTimes, 95), 0, 'f', 0)
+                             .arg(wrong);
+    if (wrong > 0 || p95 > kBudgetUs) {
+        qWarning() << "[BENCH] Route index: FAILED";
+        return 1;
+    }
+    return 0;
+}
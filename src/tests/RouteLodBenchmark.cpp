@@ -0,0 +1,119 @@
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QDebug>
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <vector>
+#include "Navigation/RouteLod.h"
+#include "BenchRoutes.h"
+
+// Route drawing: simplification time for a 1000 km route, then, at zoom
+// levels from country to street, the points kept over the whole route and
+// the points handed to the map for a 1280 x 720 view centred on places
+// along it. Every dropped point must lie within the tolerance of the
+// simplified line, and no view may exceed RouteLod::MaxLinePoints.
+//
+//   bench_route_lod
+
+namespace {
+
+constexpr double kPi = 3.14159265358979323846;
+constexpr double kRouteKm = 1000.0;
+constexpr double kPointSpacingMeters = 20.0;
+constexpr int kViewWidth = 1280;
+constexpr int kViewHeight = 720;
+constexpr int kViewAreaScale = 3;      // as MapSurface asks for
+constexpr int kViews = 50;
+constexpr double kBudgetMs = 2.0;      // p95 per area change
+const int kZooms[] = {5, 8, 11, 14, 17};
+
+// A meandering road north from Malmö with town streets every 50 km
+RoutePath generateRoute() {
+    std::mt19937 rng(42);
+    std::uniform_real_distribution<double> unit(0.0, 1.0);
+    return BenchRoutes::generateRoute(kRouteKm, kPointSpacingMeters, 55.605, 13.003, 0.0, [&](int i, double heading) {
+        const bool town = (i / 250) % 10 == 0;
+        const double turn = town && unit(rng) < 0.05 ? (unit(rng) < 0.5 ? -1.5 : 1.5) : (unit(rng) - 0.5) * 0.1;
+        return std::clamp(heading + turn, -1.5, 1.5);
+    });
+}
+
+// Web Mercator pixels at zoom 0, as RouteLod measures
+void project(double lat, double lon, double *x, double *y) {
+    const double s = std::sin(lat * kPi / 180.0);
+    *x = (lon + 180.0) / 360.0 * 256.0;
+    *y = (0.5 - std::log((1.0 + s) / (1.0 - s)) / (4.0 * kPi)) * 256.0;
+}
+
+// Farthest any point strays from the level's line, in pixels at its zoom
+double worstDeviation(const RoutePath &path, const std::vector<int> &kept, int zoom) {
+    double worst = 0.0;
+    for (size_t k = 0; k + 1 < kept.size(); ++k) {
+        double ax, ay, bx, by;
+        project(path.latitude(kept[k]), path.longitude(kept[k]), &ax, &ay);
+        project(path.latitude(kept[k + 1]), path.longitude(kept[k + 1]), &bx, &by);
+        const double dx = bx - ax, dy = by - ay, length2 = dx * dx + dy * dy;
+        for (int i = kept[k] + 1; i < kept[k + 1]; ++i) {
+            double px, py;
+            project(path.latitude(i), path.longitude(i), &px, &py);
+            const double t = length2 > 0 ? std::clamp(((px - ax) * dx + (py - ay) * dy) / length2, 0.0, 1.0) : 0.0;
+            worst = std::max(worst, std::hypot(ax + t * dx - px, ay + t * dy - py));
+        }
+    }
+    return worst * std::ldexp(1.0, zoom);
+}
+
+// The area MapSurface asks for around a view centred on `centre`
+QGeoRectangle viewArea(const QGeoCoordinate &centre, int zoom) {
+    const double degreesPerPixel = 360.0 / (256.0 * std::ldexp(1.0, zoom));
+    const double width = kViewWidth * degreesPerPixel * kViewAreaScale;
+    const double height = kViewHeight * degreesPerPixel * std::cos(centre.latitude() * kPi / 180.0) * kViewAreaScale;
+    return QGeoRectangle(centre, std::min(width, 360.0), std::min(height, 170.0));
+}
+
+} // namespace
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    const RoutePath path = generateRoute();
+    QElapsedTimer clock;
+    clock.start();
+    const RouteLod lod(path);
+    qInfo() << "[BENCH] Route drawing levels," << kRouteKm << "km route";
+    qInfo().noquote() << QString("  build: %1 points in %2 ms").arg(path.size()).arg(clock.elapsed());
+
+    bool ok = true;
+    for (int zoom : kZooms) {
+        const std::vector<std::vector<int>> whole = lod.stretches(zoom, QGeoRectangle(), 0, -1);
+        const double deviation = worstDeviation(path, whole.front(), zoom);
+
+        std::vector<double> times;
+        int mostPoints = 0;
+        for (int v = 0; v < kViews; ++v) {
+            const QGeoRectangle area = viewArea(path.at(path.size() * v / kViews), zoom);
+            clock.start();
+            const QVariantList lines = lod.lines(zoom, area);
+            times.push_back(clock.nsecsElapsed() / 1e6);
+            int points = 0;
+            for (const QVariant &line : lines) points += int(line.toList().size());
+            mostPoints = std::max(mostPoints, points);
+        }
+        std::sort(times.begin(), times.end());
+        const double p95 = times[times.size() * 95 / 100];
+        qInfo().noquote() << QString("  zoom %1: %2 of %3 points kept, deviation %4 px; view: at most %5 points, p95 %6 ms")
+                                 .arg(zoom)
+                                 .arg(lod.pointCount(zoom))
+                                 .arg(path.size())
+                                 .arg(deviation, 0, 'f', 2)
+                                 .arg(mostPoints)
+                                 .arg(p95, 0, 'f', 3);
+        ok = ok && deviation <= RouteLod::TolerancePixels && mostPoints <= RouteLod::MaxLinePoints && p95 < kBudgetMs;
+    }
+    if (!ok) {
+        qWarning() << "[BENCH] Route drawing levels: FAILED";
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,217 @@
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QDebug>
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <vector>
+#include "Navigation/RouteResponseParser.h"
+
+// Online routing: parse time for OSRM responses of 10, 100 and 1000 km
+// routes (overview=full&geometries=geojson&steps=true, so every step
+// repeats its stretch of the geometry), streaming versus a QJsonDocument
+// walked into QGeoCoordinates as the service used to. Both must agree on
+// every point and step. A saved response can be timed instead.
+//
+//   bench_route_parse [response.json]
+
+namespace {
+
+constexpr double kPointSpacingMeters = 20.0;
+constexpr double kStepSpacingMeters = 2000.0;
+constexpr double kMetersPerDegree = 111195.0;
+constexpr int kRuns = 5;
+const char *kRoadNames[] = {"E4", "Riksväg 40", "Storgatan", "Kungsgatan", "Sm\\u00e5landsv\\u00e4gen",
+                            "\\\"Gamla\\\" v\\u00e4gen", "", "Ringleden"};
+const char *kTypes[] = {"turn", "continue", "new name", "merge", "on ramp", "off ramp", "fork", "roundabout"};
+const char *kModifiers[] = {"left", "right", "slight left", "slight right", "straight", "sharp right"};
+
+QByteArray number(double value, int decimals) { return QByteArray::number(value, 'f', decimals); }
+
+void appendPoint(QByteArray &json, double lat, double lon) {
+    json += '[' + number(lon, 6) + ',' + number(lat, 6) + ']';
+}
+
+void appendCoordinates(QByteArray &json, const std::vector<std::pair<double, double>> &points, size_t from,
+                       size_t to) {
+    json += "{\"coordinates\":[";
+    for (size_t i = from; i < to; ++i) {
+        if (i > from) json += ',';
+        appendPoint(json, points[i].first, points[i].second);
+    }
+    json += "],\"type\":\"LineString\"}";
+}
+
+// A meandering route north from Malmö, laid out like OSRM's responses
+QByteArray generateResponse(double km) {
+    std::mt19937 rng(41);
+    std::uniform_real_distribution<double> unit(0.0, 1.0);
+    std::vector<std::pair<double, double>> points;
+    const int count = int(km * 1000.0 / kPointSpacingMeters) + 1;
+    double lat = 55.605, lon = 13.003, heading = 0.0;
+    for (int i = 0; i < count; ++i) {
+        // OSRM rounds to 6 decimals
+        points.emplace_back(std::round(lat * 1e6) / 1e6, std::round(lon * 1e6) / 1e6);
+        heading = std::clamp(heading + (unit(rng) - 0.5) * 0.3, -1.2, 1.2);
+        lat += std::cos(heading) * kPointSpacingMeters / kMetersPerDegree;
+        lon += std::sin(heading) * kPointSpacingMeters / (kMetersPerDegree * std::cos(lat * 3.14159265358979323846 / 180.0));
+    }
+    const double distance = km * 1000.0;
+    const double duration = distance / 22.0;
+
+    QByteArray json = "{\"code\":\"Ok\",\"routes\":[{\"geometry\":";
+    appendCoordinates(json, points, 0, points.size());
+    json += ",\"legs\":[{\"steps\":[";
+    // A step every two kilometres, then the arrival at the last point
+    std::vector<size_t> starts;
+    const size_t pointsPerStep = size_t(kStepSpacingMeters / kPointSpacingMeters);
+    for (size_t from = 0; from + 1 < points.size(); from += pointsPerStep) starts.push_back(from);
+    starts.push_back(points.size() - 1);
+    for (size_t s = 0; s < starts.size(); ++s) {
+        const size_t from = starts[s];
+        const bool depart = s == 0, arrive = s + 1 == starts.size();
+        const size_t to = arrive ? points.size() : starts[s + 1] + 1;
+        const double stepMeters = (to - from - 1) * kPointSpacingMeters;
+        if (s) json += ',';
+        json += "{\"geometry\":";
+        appendCoordinates(json, points, from, to);
+        json += ",\"maneuver\":{\"bearing_after\":" + QByteArray::number(int(unit(rng) * 360))
+                + ",\"bearing_before\":" + QByteArray::number(int(unit(rng) * 360)) + ",\"location\":";
+        appendPoint(json, points[from].first, points[from].second);
+        if (!depart && !arrive) json += QByteArray(",\"modifier\":\"") + kModifiers[s % 6] + '"';
+        json += QByteArray(",\"type\":\"") + (depart ? "depart" : arrive ? "arrive" : kTypes[s % 8]) + "\"}";
+        json += ",\"mode\":\"driving\",\"driving_side\":\"right\",\"name\":\"";
+        json += kRoadNames[s % 8];
+        json += "\",\"intersections\":[{\"out\":0,\"entry\":[true,false],\"bearings\":[10,190],\"location\":";
+        appendPoint(json, points[from].first, points[from].second);
+        json += "}],\"weight\":" + number(stepMeters / 22.0, 1) + ",\"duration\":" + number(stepMeters / 22.0, 1)
+                + ",\"distance\":" + number(stepMeters, 1) + '}';
+    }
+    json += "],\"summary\":\"E4, Riksväg 40\",\"weight\":" + number(duration, 1) + ",\"duration\":"
+            + number(duration, 1) + ",\"distance\":" + number(distance, 1) + "}],\"weight_name\":\"routability\","
+            + "\"weight\":" + number(duration, 1) + ",\"duration\":" + number(duration, 1)
+            + ",\"distance\":" + number(distance, 1) + "}],\"waypoints\":[{\"hint\":\"AbCdEf0123456789\","
+            + "\"distance\":3.1,\"name\":\"Stortorget\",\"location\":";
+    appendPoint(json, points.front().first, points.front().second);
+    json += "},{\"hint\":\"ZyXw9876543210\",\"distance\":1.7,\"name\":\"\",\"location\":";
+    appendPoint(json, points.back().first, points.back().second);
+    json += "}]}";
+    return json;
+}
+
+// The service's former parser: a document, then a QGeoCoordinate per point
+struct DocumentRoute {
+    QList<QGeoCoordinate> path;
+    QList<RouteStep> steps;
+    double distance = 0.0;
+};
+
+DocumentRoute parseDocument(const QByteArray &data) {
+    DocumentRoute res;
+    const QJsonObject root = QJsonDocument::fromJson(data).object();
+    const QJsonArray routes = root["routes"].toArray();
+    if (routes.isEmpty()) return res;
+    const QJsonObject route = routes.first().toObject();
+    for (const QJsonValue &pt : route["geometry"].toObject()["coordinates"].toArray()) {
+        const QJsonArray point = pt.toArray();
+        res.path.append(QGeoCoordinate(point[1].toDouble(), point[0].toDouble()));
+    }
+    for (const QJsonValue &leg : route["legs"].toArray()) {
+        for (const QJsonValue &s : leg.toObject()["steps"].toArray()) {
+            const QJsonObject stepObj = s.toObject();
+            const QJsonObject maneuver = stepObj["maneuver"].toObject();
+            const QJsonArray loc = maneuver["location"].toArray();
+            RouteStep step;
+            step.distance = int(std::lround(stepObj["distance"].toDouble()));
+            step.maneuverCoordinate = QGeoCoordinate(loc[1].toDouble(), loc[0].toDouble());
+            const QString type = maneuver["type"].toString();
+            const QString modifier = maneuver["modifier"].toString();
+            const QString name = stepObj["name"].toString();
+            step.modifier = modifier;
+            if (type == "depart") step.instruction = "Head to " + name;
+            else if (type == "arrive") step.instruction = "Arrive at destination";
+            else if (name.isEmpty()) step.instruction = type + " " + modifier;
+            else step.instruction = type + " " + modifier + " on " + name;
+            step.instruction = step.instruction.left(1).toUpper() + step.instruction.mid(1);
+            res.steps.append(step);
+        }
+    }
+    res.distance = route["distance"].toDouble();
+    return res;
+}
+
+int mismatches(const DocumentRoute &expected, const RouteResult &actual) {
+    int wrong = 0;
+    if (!actual.success || expected.path.size() != actual.currentRoutePath.size()
+        || expected.steps.size() != actual.routeSteps.size()
+        || expected.distance != actual.routeData.value("distance").toDouble())
+        return 1;
+    for (int i = 0; i < expected.path.size(); ++i) {
+        if (expected.path[i].latitude() != actual.currentRoutePath.latitude(i)
+            || expected.path[i].longitude() != actual.currentRoutePath.longitude(i))
+            ++wrong;
+    }
+    for (int i = 0; i < expected.steps.size(); ++i) {
+        const RouteStep &a = expected.steps[i], &b = actual.routeSteps[i];
+        if (a.instruction != b.instruction || a.modifier != b.modifier || a.distance != b.distance
+            || a.maneuverCoordinate != b.maneuverCoordinate)
+            ++wrong;
+    }
+    return wrong;
+}
+
+bool benchResponse(const QString &label, const QByteArray &json) {
+    double documentMs = 1e9, streamingMs = 1e9;
+    DocumentRoute expected;
+    RouteResult actual;
+    QElapsedTimer clock;
+    for (int run = 0; run < kRuns; ++run) {
+        clock.start();
+        expected = parseDocument(json);
+        documentMs = std::min(documentMs, clock.nsecsElapsed() / 1e6);
+        clock.start();
+        actual = RouteResponseParser::parse(json);
+        streamingMs = std::min(streamingMs, clock.nsecsElapsed() / 1e6);
+    }
+    const int wrong = mismatches(expected, actual);
+    qInfo().noquote() << QString("  %1: %2 KB, %3 points, %4 steps; document %5 ms, streaming %6 ms (%7x), %8 mismatches")
+                             .arg(label)
+                             .arg(json.size() / 1024)
+                             .arg(actual.currentRoutePath.size())
+                             .arg(actual.routeSteps.size())
+                             .arg(documentMs, 0, 'f', 2)
+                             .arg(streamingMs, 0, 'f', 2)
+                             .arg(documentMs / streamingMs, 0, 'f', 1)
+                             .arg(wrong);
+    return wrong == 0 && streamingMs < documentMs;
+}
+
+} // namespace
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    bool ok = true;
+    if (argc > 1) {
+        QFile file(QString::fromLocal8Bit(argv[1]));
+        if (!file.open(QIODevice::ReadOnly)) {
+            qWarning() << "Cannot open" << file.fileName();
+            return 1;
+        }
+        qInfo() << "[BENCH] Route response parsing," << file.fileName();
+        ok = benchResponse("response", file.readAll());
+    } else {
+        qInfo() << "[BENCH] Route response parsing, generated OSRM responses";
+        for (double km : {10.0, 100.0, 1000.0})
+            ok = benchResponse(QString("%1 km").arg(km), generateResponse(km)) && ok;
+    }
+    if (!ok) {
+        qWarning() << "[BENCH] Route response parsing: FAILED";
+        return 1;
+    }
+    return 0;
+}
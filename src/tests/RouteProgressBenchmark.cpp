@@ -0,0 +1,152 @@
+#include <QCoreApplication>
+#include <QDebug>
+#include <QElapsedTimer>
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <vector>
+#include "Navigation/RouteProgress.h"
+#include "BenchRoutes.h"
+
+// Route progress: 150 km drives through 50, 80 and 110 zones, for which
+// the router took the limits as they are and added a tenth. One drive is
+// a little under the limits with a 6 km jam a third of the way; the other
+// is in heavy traffic all the way, at three quarters of them. Matched
+// positions come once a second a few metres off. Each second the arrival
+// time is estimated at the pace so far and, for comparison, from the
+// router's times alone; both are compared with when the car arrives. The
+// paced estimate must be the closer one and must not jump from one second
+// to the next with the noise. Also times an update and the time left on a
+// 10 km and a 1000 km route, which must cost the same.
+//
+//   bench_route_progress
+
+namespace {
+
+constexpr double kPointSpacingMeters = 25.0;
+constexpr double kRouteKm = 150.0;
+constexpr double kZoneMeters = 4000.0;
+constexpr double kRouterMargin = 1.1;     // the router's duration over the limits'
+constexpr double kDrivenShare = 0.95;     // of the limit, outside the jam
+constexpr double kHeavyShare = 0.75;      // all the way
+constexpr double kJamFrom = 40000.0;
+constexpr double kJamTo = 46000.0;
+constexpr double kJamKmh = 15.0;
+constexpr double kNoiseMeters = 3.0;
+constexpr int kUpdates = 1000000;
+constexpr double kUpdateBudgetNs = 500.0;
+constexpr double kStepBudgetSeconds = 10.0; // p99 change of the estimate in a second, outside the jam
+
+double limitSeconds(const RouteIndex &route, const QList<quint8> &limits) {
+    double seconds = 0.0;
+    for (int i = 0; i < limits.size(); ++i) seconds += (route.offset(i + 1) - route.offset(i)) * 3.6 / limits[i];
+    return seconds;
+}
+
+double percentile(std::vector<double> values, int p) {
+    std::sort(values.begin(), values.end());
+    return values[std::min(values.size() - 1, values.size() * size_t(p) / 100)];
+}
+
+// Nanoseconds per update and estimate, driving the route in kUpdates steps
+double updateCost(double km) {
+    const RouteIndex route(BenchRoutes::generateRoute(km, kPointSpacingMeters, 49, 59.86, 17.64, 3.5, 0.1));
+    const QList<quint8> limits = BenchRoutes::zoneLimits(route, kZoneMeters);
+    RouteProgress progress(route, limits, 0.0);
+    const double step = route.length() / kUpdates;
+    double sink = 0.0;
+    int segment = 0;
+    QElapsedTimer timer;
+    timer.start();
+    for (int i = 0; i < kUpdates; ++i) {
+        const double offset = i * step;
+        while (segment + 2 < route.offsets().size() && route.offset(segment + 1) <= offset) ++segment;
+        progress.update(segment, offset, qint64(i) * 100);
+        sink += progress.remainingSeconds() + progress.remainingMeters();
+    }
+    const double ns = double(timer.nsecsElapsed()) / kUpdates;
+    if (sink < 0.0) qInfo() << sink;
+    return ns;
+}
+
+struct Drive {
+    int seconds = 0;                     // to arrive
+    double routerSeconds = 0.0;
+    std::vector<double> paced, plain;    // estimates each second, minutes off
+    std::vector<double> steps;           // seconds the paced estimate moved by
+};
+
+Drive drive(const RouteIndex &route, const QList<quint8> &limits, double share, bool jam) {
+    RouteProgress progress(route, limits, limitSeconds(route, limits) * kRouterMargin);
+    std::mt19937 rng(50);
+    std::normal_distribution<double> noise(0.0, kNoiseMeters);
+    Drive result;
+    result.routerSeconds = progress.duration();
+
+    // A second at a time, with the estimates made on the way
+    std::vector<std::pair<double, double>> estimates; // arrival at pace, from the router alone
+    double driven = 0.0, previous = -1.0;
+    while (driven < route.length()) {
+        const bool jammed = jam && driven >= kJamFrom && driven < kJamTo;
+        const double kmh = jammed ? kJamKmh : limits[route.segmentAt(driven)] * share;
+        const double seen = std::clamp(driven + noise(rng), 0.0, route.length());
+        const int segment = route.segmentAt(seen);
+        progress.update(segment, seen, qint64(result.seconds) * 1000);
+        const double paced = result.seconds + progress.remainingSeconds();
+        estimates.push_back({paced, result.seconds + progress.duration() - progress.secondsAt(segment, seen)});
+        // Outside the jam and the pace's time to forget it
+        if (previous >= 0.0 && !(jam && driven >= kJamFrom - 1000.0 && driven < kJamTo + 4000.0))
+            result.steps.push_back(std::abs(paced - previous));
+        previous = paced;
+        driven += kmh / 3.6;
+        ++result.seconds;
+    }
+    for (const auto &estimate : estimates) {
+        result.paced.push_back(std::abs(estimate.first - result.seconds) / 60.0);
+        result.plain.push_back(std::abs(estimate.second - result.seconds) / 60.0);
+    }
+    return result;
+}
+
+} // namespace
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    const RouteIndex route(BenchRoutes::generateRoute(kRouteKm, kPointSpacingMeters, 49, 59.86, 17.64, 3.5, 0.1));
+    const QList<quint8> limits = BenchRoutes::zoneLimits(route, kZoneMeters);
+    bool ok = true;
+
+    qInfo() << "[BENCH] Route progress," << kRouteKm << "km route";
+    const struct {
+        const char *name;
+        double share;
+        bool jam;
+    } drives[] = {{"jam", kDrivenShare, true}, {"heavy traffic", kHeavyShare, false}};
+    for (const auto &d : drives) {
+        const Drive result = drive(route, limits, d.share, d.jam);
+        qInfo().noquote() << QString("  %1: arrived after %2 min, router said %3 min")
+                                 .arg(d.name)
+                                 .arg(result.seconds / 60)
+                                 .arg(int(result.routerSeconds / 60));
+        qInfo().noquote() << QString("    at the pace so far: off by p50 %1 min, p95 %2 min; moves by p99 %3 s a second")
+                                 .arg(percentile(result.paced, 50), 0, 'f', 1)
+                                 .arg(percentile(result.paced, 95), 0, 'f', 1)
+                                 .arg(percentile(result.steps, 99), 0, 'f', 1);
+        qInfo().noquote() << QString("    from the router's times: off by p50 %1 min, p95 %2 min")
+                                 .arg(percentile(result.plain, 50), 0, 'f', 1)
+                                 .arg(percentile(result.plain, 95), 0, 'f', 1);
+        if (percentile(result.paced, 50) > percentile(result.plain, 50) || percentile(result.steps, 99) > kStepBudgetSeconds)
+            ok = false;
+    }
+
+    const double shortNs = updateCost(10.0), longNs = updateCost(1000.0);
+    qInfo().noquote() << QString("  update and estimate: %1 ns on 10 km, %2 ns on 1000 km")
+                             .arg(shortNs, 0, 'f', 0)
+                             .arg(longNs, 0, 'f', 0);
+    if (!ok || longNs > kUpdateBudgetNs || longNs > 2.0 * shortNs + 50.0) {
+        qWarning() << "[BENCH] Route progress: FAILED";
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,247 @@
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QTemporaryDir>
+#include <QDebug>
+#include <algorithm>
+#include <limits>
+#include <queue>
+#include <random>
+#include <string>
+#include <vector>
+#include "Navigation/RoadGraph.h"
+#include "Navigation/RoadGraphBuilder.h"
+#include "Navigation/RoadRouter.h"
+
+// Offline routing: contraction time for a generated town-and-motorway
+// network, then query time for random routes across it (snapping, search,
+// unpacking, geometry and steps) with every travel time checked against a
+// plain Dijkstra over the original segments. A graph file built by
+// road_graph_build can be benchmarked instead.
+//
+//   bench_routing [graph.nrg]
+
+namespace {
+
+constexpr int kGridSize = 300;            // junctions per side, ~45 x 45 km
+constexpr double kSpacingDegrees = 0.0013; // ~145 m north-south
+constexpr double kOriginLat = 59.0;
+constexpr double kOriginLon = 17.5;
+constexpr int kQueries = 1000;
+constexpr int kChecked = 50;
+constexpr int kCheckedFromFile = 10;      // Dijkstra on a whole country takes seconds
+constexpr double kBudgetMs = 50.0;        // p95 for a country-scale query
+constexpr qint64 kShapeIdBase = 1000000000;
+
+RoadGraph::RoadClass lineClass(int line) {
+    if (line % 50 == 0) return RoadGraph::Motorway;
+    if (line % 10 == 0) return RoadGraph::Primary;
+    return RoadGraph::Residential;
+}
+
+// Perturbed grid: every 10th line a primary road, every 50th a motorway,
+// some residential streets one way, 5% of the residential links missing
+// and one shape point between junctions.
+void generateNetwork(RoadGraphBuilder &builder)
+{
+    std::mt19937 rng(39);
+    std::uniform_real_distribution<double> jitter(-0.25, 0.25);
+    std::uniform_real_distribution<double> unit(0.0, 1.0);
+    const double lonSpacing = kSpacingDegrees * 2.0; // cos(59°) ~ 0.5
+
+    auto junction = [](int row, int col) { return qint64(row) * kGridSize + col + 1; };
+    for (int row = 0; row < kGridSize; ++row) {
+        for (int col = 0; col < kGridSize; ++col) {
+            builder.addNode(junction(row, col), kOriginLat + (row + jitter(rng)) * kSpacingDegrees,
+                            kOriginLon + (col + jitter(rng)) * lonSpacing);
+            // Bends halfway east and halfway north
+            builder.addNode(kShapeIdBase + 2 * junction(row, col), kOriginLat + (row + jitter(rng)) * kSpacingDegrees,
+                            kOriginLon + (col + 0.5 + jitter(rng)) * lonSpacing);
+            builder.addNode(kShapeIdBase + 2 * junction(row, col) + 1,
+                            kOriginLat + (row + 0.5 + jitter(rng)) * kSpacingDegrees,
+                            kOriginLon + (col + jitter(rng)) * lonSpacing);
+        }
+    }
+
+    for (int horizontal = 0; horizontal < 2; ++horizontal) {
+        for (int line = 0; line < kGridSize; ++line) {
+            const RoadGraph::RoadClass roadClass = lineClass(line);
+            int oneway = 0;
+            if (roadClass == RoadGraph::Residential && line % 7 == 3) oneway = 1;
+            if (roadClass == RoadGraph::Residential && line % 7 == 5) oneway = -1;
+            std::string name;
+            if (roadClass == RoadGraph::Motorway) name = "E" + std::to_string(line / 50 * 2 + 4);
+            else name = (horizontal ? "Street " : "Avenue ") + std::to_string(line);
+
+            std::vector<qint64> way;
+            for (int i = 0; i < kGridSize; ++i) {
+                const qint64 node = horizontal ? junction(line, i) : junction(i, line);
+                way.push_back(node);
+                const bool last = i + 1 == kGridSize;
+                const bool missing = roadClass == RoadGraph::Residential && unit(rng) < 0.05;
+                if (last || missing) {
+                    builder.addWay(way, roadClass, 0, oneway, name);
+                    way.clear();
+                    if (!last) way.push_back(node);
+                    continue;
+                }
+                way.push_back(kShapeIdBase + 2 * node + (horizontal ? 0 : 1));
+            }
+        }
+    }
+}
+
+// Travel time by Dijkstra over the original segments
+class ReferenceRouter
+{
+public:
+    explicit ReferenceRouter(const RoadGraph &graph)
+        : m_first(graph.nodeCount() + 1, 0), m_dist(graph.nodeCount())
+    {
+        for (quint32 s = 0; s < graph.segmentCount(); ++s) ++m_first[graph.segment(s).from + 1];
+        for (quint32 n = 0; n < graph.nodeCount(); ++n) m_first[n + 1] += m_first[n];
+        m_edges.resize(graph.segmentCount());
+        std::vector<quint32> fill(m_first.begin(), m_first.end() - 1);
+        for (quint32 s = 0; s < graph.segmentCount(); ++s) {
+            const RoadGraph::Segment &segment = graph.segment(s);
+            m_edges[fill[segment.from]++] = {segment.to, segment.weight};
+        }
+    }
+
+    quint32 weight(quint32 from, quint32 to)
+    {
+        constexpr quint32 infinity = std::numeric_limits<quint32>::max();
+        std::fill(m_dist.begin(), m_dist.end(), infinity);
+        using Entry = std::pair<quint32, quint32>;
+        std::priority_queue<Entry, std::vector<Entry>, std::greater<Entry>> queue;
+        m_dist[from] = 0;
+        queue.push({0, from});
+        while (!queue.empty()) {
+            const auto [d, v] = queue.top();
+            queue.pop();
+            if (v == to) return d;
+            if (d > m_dist[v]) continue;
+            for (quint32 i = m_first[v]; i < m_first[v + 1]; ++i) {
+                const auto [target, w] = m_edges[i];
+                if (d + w < m_dist[target]) {
+                    m_dist[target] = d + w;
+                    queue.push({d + w, target});
+                }
+            }
+        }
+        return infinity;
+    }
+
+private:
+    std::vector<quint32> m_first;
+    std::vector<std::pair<quint32, quint32>> m_edges;
+    std::vector<quint32> m_dist;
+};
+
+QGeoCoordinate coordinate(const RoadGraph::Point &p) {
+    return QGeoCoordinate(p.lat * 1e-7, p.lon * 1e-7);
+}
+
+bool benchQueries(const RoadGraph &graph, int checked)
+{
+    RoadRouter router(&graph);
+    ReferenceRouter reference(graph);
+    std::mt19937 rng(7);
+    std::uniform_int_distribution<quint32> pick(0, graph.nodeCount() - 1);
+
+    std::vector<double> times;
+    quint64 settled = 0, points = 0, steps = 0;
+    int mismatches = 0, failures = 0;
+    QElapsedTimer clock;
+    for (int q = 0; q < kQueries; ++q) {
+        const quint32 from = pick(rng), to = pick(rng);
+        clock.start();
+        const RouteResult result = router.route(coordinate(graph.node(from)), coordinate(graph.node(to)));
+        times.push_back(clock.nsecsElapsed() / 1e6);
+        if (!result.success) {
+            ++failures;
+            continue;
+        }
+        settled += router.lastSettled();
+        points += result.currentRoutePath.size();
+        steps += result.routeSteps.size();
+
+        if (q < checked) {
+            std::vector<quint32> segments;
+            quint32 weight = 0;
+            router.findPath(from, to, segments, &weight);
+            quint32 sum = 0;
+            for (quint32 s : segments) sum += graph.segment(s).weight;
+            if (weight != reference.weight(from, to) || sum != weight) ++mismatches;
+        }
+    }
+    std::sort(times.begin(), times.end());
+    double total = 0;
+    for (double t : times) total += t;
+    const double p95 = times[times.size() * 95 / 100];
+    const int found = kQueries - failures;
+    qInfo().noquote() << QString("  %1 queries: avg %2 ms, p95 %3 ms, max %4 ms, %5 nodes settled")
+                             .arg(kQueries)
+                             .arg(total / kQueries, 0, 'f', 3)
+                             .arg(p95, 0, 'f', 3)
+                             .arg(times.back(), 0, 'f', 3)
+                             .arg(found ? settled / found : 0);
+    qInfo().noquote() << QString("  route: %1 points, %2 steps on average; %3 of %4 checked against Dijkstra differ, %5 failed")
+                             .arg(found ? points / found : 0)
+                             .arg(found ? steps / found : 0)
+                             .arg(mismatches)
+                             .arg(checked)
+                             .arg(failures);
+    // Every node is in one strongly connected part, so every query has a route
+    return mismatches == 0 && failures == 0 && p95 < kBudgetMs;
+}
+
+bool benchGenerated()
+{
+    QTemporaryDir dir;
+    const QString path = dir.filePath("graph.nrg");
+    RoadGraphBuilder builder;
+    generateNetwork(builder);
+    QElapsedTimer clock;
+    clock.start();
+    if (!builder.write(path)) return false;
+    const RoadGraphBuilder::Stats &stats = builder.stats();
+
+    qInfo() << "[BENCH] Offline routing, generated" << kGridSize << "x" << kGridSize << "junction network";
+    qInfo().noquote() << QString("  build: %1 nodes, %2 segments, %3 shortcuts (%4 dropped), contraction %5 ms, total %6 ms")
+                             .arg(stats.nodes)
+                             .arg(stats.segments)
+                             .arg(stats.shortcuts)
+                             .arg(stats.droppedNodes)
+                             .arg(stats.contractMs)
+                             .arg(clock.elapsed());
+    RoadGraph graph;
+    return graph.open(path) && benchQueries(graph, kChecked);
+}
+
+bool benchFile(const QString &path)
+{
+    RoadGraph graph;
+    if (!graph.open(path)) {
+        qWarning() << "Cannot open" << path;
+        return false;
+    }
+    qInfo() << "[BENCH] Offline routing," << path;
+    qInfo().noquote() << QString("  graph: %1 nodes, %2 segments, %3 hierarchy edges")
+                             .arg(graph.nodeCount())
+                             .arg(graph.segmentCount())
+                             .arg(graph.upEdgeCount() + graph.downEdgeCount());
+    return benchQueries(graph, kCheckedFromFile);
+}
+
+} // namespace
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    const bool ok = argc > 1 ? benchFile(QString::fromLocal8Bit(argv[1])) : benchGenerated();
+    if (!ok) {
+        qWarning() << "[BENCH] Offline routing: FAILED";
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,230 @@
+#include <QCoreApplication>
+#include <QDebug>
+#include <QDir>
+#include <QElapsedTimer>
+#include <QFile>
+#include <algorithm>
+#include <cmath>
+#include <list>
+#include <random>
+#include <unordered_map>
+#include <vector>
+#include "Navigation/TileStore.h"
+#include "BenchRoutes.h"
+
+// Tile store: a day of driving seen through the map. Tiles along a 200 km
+// route are stored as they would be viewed and prefetched, with earlier
+// ones viewed again now and then, until three times the budget has gone
+// through the store. The store must hold exactly the tiles a reference
+// LRU holds, within the budget, and read back what was stored, also after
+// reopening and after a damaged last record. Reports read times, the file
+// size against the tiles held, and the route corridor's tiles per zoom
+// level, each of which must cover every point of the route.
+//
+//   bench_tile_store
+
+namespace {
+
+constexpr double kPi = 3.14159265358979323846;
+constexpr double kMetersPerDegree = 6371008.8 * kPi / 180.0;
+constexpr double kRouteKm = 200.0;
+constexpr double kPointSpacingMeters = 20.0;
+constexpr double kCorridorMeters = 250.0;
+constexpr int kMinZoom = 12;
+constexpr int kMaxZoom = 16;
+constexpr qint64 kBudget = 32 * 1024 * 1024;
+constexpr double kThroughput = 3.0;     // budgets stored in all
+constexpr double kRevisitShare = 0.3;   // views of a tile seen before
+constexpr int kReads = 20000;
+constexpr double kReadBudgetUs = 500.0; // p99
+constexpr double kOpenBudgetMs = 200.0;
+
+// 5-40 KB of bytes only this tile has
+QByteArray image(quint64 key) {
+    const quint64 hash = key * 0x9E3779B97F4A7C15ull;
+    QByteArray bytes(int(5000 + (hash >> 40) % 35000), '\0');
+    for (int i = 0; i < bytes.size(); ++i) bytes.data()[i] = char((hash >> (i % 7 * 8)) + i);
+    return bytes;
+}
+
+// The tiles an LRU of the same budget holds, most recently used first
+struct ReferenceLru {
+    std::list<std::pair<quint64, qint64>> uses;
+    std::unordered_map<quint64, std::list<std::pair<quint64, qint64>>::iterator> entries;
+    qint64 bytes = 0;
+
+    void use(quint64 key) {
+        auto found = entries.find(key);
+        if (found != entries.end()) uses.splice(uses.begin(), uses, found->second);
+    }
+    void insert(quint64 key, qint64 size) {
+        auto found = entries.find(key);
+        if (found != entries.end()) {
+            bytes -= found->second->second;
+            uses.erase(found->second);
+        }
+        uses.push_front({key, size});
+        entries[key] = uses.begin();
+        bytes += size;
+        while (bytes > kBudget && uses.back().first != key) {
+            bytes -= uses.back().second;
+            entries.erase(uses.back().first);
+            uses.pop_back();
+        }
+    }
+};
+
+double percentile(std::vector<double> values, int p) {
+    std::sort(values.begin(), values.end());
+    return values[std::min(values.size() - 1, values.size() * size_t(p) / 100)];
+}
+
+bool sameAsReference(TileStore &store, const ReferenceLru &reference) {
+    if (store.count() != int(reference.entries.size()) || store.bytes() != reference.bytes) return false;
+    for (const auto &entry : reference.uses) {
+        if (!store.contains(entry.first)) return false;
+    }
+    return true;
+}
+
+} // namespace
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    const QString path = QDir::tempPath() + "/bench_tile_store.nts";
+    QFile::remove(path);
+    const RoutePath route = BenchRoutes::generateRoute(kRouteKm, kPointSpacingMeters, 48, 57.70, 11.97, 0.8, 0.2);
+    bool ok = true;
+
+    // The corridor at each zoom level; every route point's tile must be in it
+    std::vector<quint64> seen;
+    QElapsedTimer timer;
+    qInfo() << "[BENCH] Tile store," << kRouteKm << "km route," << kBudget / (1024 * 1024) << "MB budget";
+    for (int zoom = kMinZoom; zoom <= kMaxZoom; ++zoom) {
+        timer.start();
+        const std::vector<quint64> tiles = TileStore::corridor(route, 0, zoom, kCorridorMeters);
+        const double ms = timer.nsecsElapsed() / 1e6;
+        std::vector<quint64> sorted = tiles;
+        std::sort(sorted.begin(), sorted.end());
+        int missing = 0;
+        for (int i = 0; i < route.size(); ++i) {
+            const double side = (i % 2 ? 1.0 : -1.0) * kCorridorMeters * 0.9 / kMetersPerDegree;
+            for (double dLat : {0.0, side}) {
+                const quint64 key = TileStore::key(0, zoom, TileStore::tileX(route.longitude(i), zoom),
+                                                   TileStore::tileY(route.latitude(i) + dLat, zoom));
+                if (!std::binary_search(sorted.begin(), sorted.end(), key)) ++missing;
+            }
+        }
+        qInfo().noquote() << QString("  corridor z%1: %2 tiles in %3 ms, %4 route positions outside")
+                                 .arg(zoom)
+                                 .arg(int(tiles.size()))
+                                 .arg(ms, 0, 'f', 2)
+                                 .arg(missing);
+        if (missing > 0) ok = false;
+        seen.insert(seen.end(), tiles.begin(), tiles.end());
+    }
+    const std::vector<quint64> destination = TileStore::around(route.last(), 0, 17, 1000.0);
+    qInfo() << "  destination z17:" << int(destination.size()) << "tiles within 1 km";
+
+    // Tiles viewed along the route, earlier ones now and then again
+    TileStore store;
+    if (!store.open(path, kBudget)) {
+        qWarning() << "[BENCH] Tile store: cannot open" << path;
+        return 1;
+    }
+    ReferenceLru reference;
+    std::mt19937 rng(49);
+    std::uniform_real_distribution<double> unit(0.0, 1.0);
+    qint64 stored = 0;
+    size_t next = 0;
+    // Round the corridor again in another style each lap
+    auto viewed = [&seen](size_t i) { return seen[i % seen.size()] + (quint64(i / seen.size()) << 56); };
+    int inserts = 0, revisits = 0, checks = 0, mismatches = 0;
+    timer.start();
+    while (stored < kThroughput * kBudget) {
+        if (next > 0 && unit(rng) < kRevisitShare) {
+            // A recent tile is likelier seen again than an old one
+            const quint64 key = viewed(next - 1 - size_t(std::pow(unit(rng), 3.0) * next));
+            const QByteArray bytes = store.read(key);
+            reference.use(key);
+            if (!bytes.isEmpty() && bytes != image(key)) ++mismatches;
+            if (bytes.isEmpty() && reference.entries.count(key)) ++mismatches;
+            if (bytes.isEmpty()) {
+                store.insert(key, image(key));
+                reference.insert(key, image(key).size());
+            }
+            ++revisits;
+        } else {
+            const quint64 key = viewed(next++);
+            const QByteArray bytes = image(key);
+            store.insert(key, bytes);
+            reference.insert(key, bytes.size());
+            stored += bytes.size();
+            ++inserts;
+        }
+        if (++checks % 1000 == 0 && !sameAsReference(store, reference)) ++mismatches;
+    }
+    const double fillMs = timer.nsecsElapsed() / 1e6;
+    if (!sameAsReference(store, reference)) ++mismatches;
+
+    // Reads of the tiles held
+    std::vector<quint64> held;
+    for (const auto &entry : reference.uses) held.push_back(entry.first);
+    std::vector<double> reads;
+    for (int i = 0; i < kReads; ++i) {
+        const quint64 key = held[size_t(unit(rng) * held.size())];
+        timer.start();
+        const QByteArray bytes = store.read(key);
+        reads.push_back(timer.nsecsElapsed() / 1000.0);
+        reference.use(key);
+        if (bytes != image(key)) ++mismatches;
+    }
+    const qint64 fileBytes = store.fileBytes();
+    const qint64 recordBytes = qint64(sizeof(TileStore::Record)) * store.count();
+
+    // Reopened, and again after a power loss halfway through a record
+    store.close();
+    timer.start();
+    const bool reopened = store.open(path, kBudget);
+    const double openMs = timer.nsecsElapsed() / 1e6;
+    if (!reopened || !sameAsReference(store, reference)) ++mismatches;
+    store.close();
+    {
+        QFile file(path);
+        file.open(QIODevice::ReadWrite);
+        file.seek(file.size());
+        const TileStore::Record record = {TileStore::key(0, 16, 1, 1), 30000, 0};
+        file.write(reinterpret_cast<const char *>(&record), sizeof(record));
+        file.write(QByteArray(1000, 'x'));
+    }
+    const bool recovered = store.open(path, kBudget) && sameAsReference(store, reference);
+    if (!recovered) ++mismatches;
+    for (const quint64 key : held) {
+        if (store.read(key) != image(key)) ++mismatches;
+    }
+    store.close();
+    QFile::remove(path);
+
+    qInfo().noquote() << QString("  fill: %1 MB through the store (%2 new, %3 seen again) in %4 ms, %5 tiles held, %6 MB")
+                             .arg(stored / (1024 * 1024))
+                             .arg(inserts)
+                             .arg(revisits)
+                             .arg(fillMs, 0, 'f', 0)
+                             .arg(int(held.size()))
+                             .arg(reference.bytes / (1024.0 * 1024.0), 0, 'f', 1);
+    qInfo().noquote() << QString("  read: p50 %1 us, p99 %2 us; file %3 MB; reopened in %4 ms; %5 mismatches")
+                             .arg(percentile(reads, 50), 0, 'f', 1)
+                             .arg(percentile(reads, 99), 0, 'f', 1)
+                             .arg(fileBytes / (1024.0 * 1024.0), 0, 'f', 1)
+                             .arg(openMs, 0, 'f', 1)
+                             .arg(mismatches);
+
+    // Compaction keeps dead records under the live ones
+    if (!ok || mismatches > 0 || reference.bytes > kBudget || fileBytes > 2 * (kBudget + recordBytes) + 64 * 1024
+        || percentile(reads, 99) > kReadBudgetUs || openMs > kOpenBudgetMs) {
+        qWarning() << "[BENCH] Tile store: FAILED";
+        return 1;
+    }
+    return 0;
+}
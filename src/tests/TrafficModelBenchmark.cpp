@@ -0,0 +1,105 @@
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QDebug>
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <vector>
+#include "Navigation/TrafficModel.h"
+#include "BenchRoutes.h"
+
+// Traffic along a route: a 1000 km route rated by a feed in 500 m spans,
+// then random updates of a few kilometres each, as a live feed sends them.
+// After every update the runs must match a per-metre reference rating,
+// with no two neighbouring runs equal. Reports the update time and how
+// many polylines the overlay needs, against the fixed 20-point chunks the
+// map used to draw.
+//
+//   bench_traffic
+
+namespace {
+
+constexpr double kRouteKm = 1000.0;
+constexpr double kPointSpacingMeters = 20.0;
+constexpr double kSpanMeters = 500.0;
+constexpr int kUpdates = 20000;
+constexpr int kChecked = 200;          // updates compared metre by metre
+constexpr int kOldChunkPoints = 20;
+constexpr double kBudgetUs = 20.0;     // p95 per update
+
+bool matches(const TrafficModel &model, const std::vector<TrafficModel::Congestion> &reference) {
+    const std::vector<TrafficModel::Run> runs = model.runs();
+    for (size_t r = 0; r < runs.size(); ++r) {
+        if (r > 0 && (runs[r].congestion == runs[r - 1].congestion || runs[r].from != runs[r - 1].to)) return false;
+        // Whole metres inside the run
+        for (double m = std::ceil(runs[r].from); m < runs[r].to && m < reference.size(); ++m)
+            if (reference[size_t(m)] != runs[r].congestion) return false;
+    }
+    return !runs.empty() && runs.front().from == 0.0;
+}
+
+} // namespace
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    // Straight north
+    const RoutePath path = BenchRoutes::generateRoute(kRouteKm, kPointSpacingMeters, 55.605, 13.003, 0.0,
+                                                      [](int, double heading) { return heading; });
+    TrafficModel model{RouteIndex(path)};
+    std::vector<TrafficModel::Congestion> reference(size_t(model.length()), TrafficModel::Unknown);
+    std::mt19937 rng(43);
+    std::uniform_real_distribution<double> unit(0.0, 1.0);
+    auto rate = [&](double from, double to, TrafficModel::Congestion congestion) {
+        model.update(from, to, congestion);
+        for (double m = std::max(0.0, std::ceil(from)); m < to && m < reference.size(); ++m)
+            reference[size_t(m)] = congestion;
+    };
+    auto randomCongestion = [&]() {
+        const double r = unit(rng);
+        return r < 0.6 ? TrafficModel::Free : r < 0.8 ? TrafficModel::Slow : TrafficModel::Jammed;
+    };
+
+    // The feed as the route arrives, with congestion lasting a few spans
+    TrafficModel::Congestion congestion = randomCongestion();
+    for (double from = 0.0; from < model.length(); from += kSpanMeters) {
+        if (unit(rng) < 0.2) congestion = randomCongestion();
+        rate(from, from + kSpanMeters, congestion);
+    }
+    bool ok = matches(model, reference);
+    qInfo() << "[BENCH] Traffic model," << kRouteKm << "km route";
+    qInfo().noquote() << QString("  initial feed: %1 spans into %2 runs (%3 chunks of %4 points before)")
+                             .arg(int(model.length() / kSpanMeters))
+                             .arg(model.runCount())
+                             .arg(path.size() / kOldChunkPoints)
+                             .arg(kOldChunkPoints);
+
+    std::vector<double> times;
+    QElapsedTimer clock;
+    int wrong = 0;
+    for (int u = 0; u < kUpdates; ++u) {
+        const double from = unit(rng) * model.length();
+        const double to = from + 200.0 + unit(rng) * 5000.0;
+        const TrafficModel::Congestion c = randomCongestion();
+        clock.start();
+        model.update(from, to, c);
+        times.push_back(clock.nsecsElapsed() / 1e3);
+        for (double m = std::ceil(from); m < to && m < reference.size(); ++m) reference[size_t(m)] = c;
+        if (u % (kUpdates / kChecked) == 0 && !matches(model, reference)) ++wrong;
+    }
+    std::sort(times.begin(), times.end());
+    const double p95 = times[times.size() * 95 / 100];
+    qInfo().noquote() << QString("  %1 updates: p95 %2 us, max %3 us; %4 runs after, %5 of %6 checks wrong")
+                             .arg(kUpdates)
+                             .arg(p95, 0, 'f', 2)
+                             .arg(times.back(), 0, 'f', 2)
+                             .arg(model.runCount())
+                             .arg(wrong)
+                             .arg(kChecked);
+    ok = ok && wrong == 0 && matches(model, reference) && p95 < kBudgetUs;
+    if (!ok) {
+        qWarning() << "[BENCH] Traffic model: FAILED";
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,159 @@
+#include <QCoreApplication>
+#include <QDebug>
+#include <algorithm>
+#include <cmath>
+#include <memory>
+#include <random>
+#include <vector>
+#include "Navigation/VehicleMotion.h"
+#include "BenchRoutes.h"
+
+// Vehicle motion: a car drives a 20 km route of straights and corners,
+// speeding up and slowing down between 30 and 90 km/h, and reports fixes
+// at 10 Hz a few metres off. Each fix is matched and given to the motion
+// model; the map draws at 60 Hz from the keyframes last published. Reports
+// how often a motion is published, how far the drawn vehicle is from the
+// truth, and how far its step from one frame to the next differs from the
+// car's, against drawing each matched fix as it comes.
+//
+//   bench_vehicle_motion
+
+namespace {
+
+constexpr double kPi = 3.14159265358979323846;
+constexpr double kMetersPerDegree = 6371008.8 * kPi / 180.0;
+constexpr double kPointSpacingMeters = 10.0;
+constexpr double kRouteKm = 20.0;
+constexpr double kCornerEvery = 400.0;   // metres, a 90 degree corner on average
+constexpr double kMinSpeed = 8.0;        // m/s
+constexpr double kMaxSpeed = 25.0;
+constexpr double kSpeedPeriod = 60.0;    // seconds, slowing down and speeding up
+constexpr int kFixIntervalMs = 100;
+constexpr double kFrameMs = 1000.0 / 60.0;
+constexpr double kNoiseMeters = 5.0;
+constexpr double kHeadingNoise = 5.0;    // degrees
+constexpr double kPublishBudget = 1.5;   // per second
+constexpr double kErrorBudgetMeters = 10.0; // p95
+constexpr double kStepBudgetMeters = 1.0;   // p99 difference from the car's step
+
+RoutePath generateRoute() {
+    std::mt19937 rng(50);
+    std::uniform_real_distribution<double> unit(0.0, 1.0);
+    double turn = 0.0, turning = 0.0; // radians per point, points left
+    return BenchRoutes::generateRoute(kRouteKm, kPointSpacingMeters, 59.33, 18.07, kPi / 2, [&](int, double heading) {
+        if (turning <= 0.0 && unit(rng) < kPointSpacingMeters / kCornerEvery) {
+            turning = 3.0 + unit(rng) * 5.0; // 30-80 m round
+            turn = (unit(rng) < 0.5 ? -1.0 : 1.0) * kPi / 2 / turning;
+        }
+        if (turning <= 0.0) return heading;
+        turning -= 1.0;
+        return heading + turn;
+    });
+}
+
+// The car's speed and distance along the route after `seconds`
+double speedAt(double seconds) {
+    return kMinSpeed + (kMaxSpeed - kMinSpeed) * 0.5 * (1.0 - std::cos(2.0 * kPi * seconds / kSpeedPeriod));
+}
+double drivenAt(double seconds) {
+    return kMinSpeed * seconds
+           + (kMaxSpeed - kMinSpeed) * 0.5 * (seconds - kSpeedPeriod / (2.0 * kPi) * std::sin(2.0 * kPi * seconds / kSpeedPeriod));
+}
+
+double meters(double lat1, double lon1, double lat2, double lon2) {
+    return std::hypot((lon2 - lon1) * kMetersPerDegree * std::cos(lat1 * kPi / 180.0), (lat2 - lat1) * kMetersPerDegree);
+}
+
+double percentile(std::vector<double> values, int p) {
+    std::sort(values.begin(), values.end());
+    return values[std::min(values.size() - 1, values.size() * size_t(p) / 100)];
+}
+
+} // namespace
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    const auto route = std::make_shared<const RouteIndex>(generateRoute());
+    MapMatcher matcher(route);
+    VehicleMotion motion;
+    std::mt19937 rng(51);
+    std::normal_distribution<double> noise(0.0, 1.0);
+
+    const qint64 epoch = 1700000000000;
+    int fixes = 0, publishes = 0;
+    VehicleMotion::Pose snapped;
+    bool haveSnapped = false, havePrevious = false;
+    double previousLat = 0, previousLon = 0, previousSnapLat = 0, previousSnapLon = 0, previousTrueLat = 0, previousTrueLon = 0;
+    std::vector<double> errors, snapErrors, steps, snapSteps;
+    qint64 nextFixMs = 0;
+    for (double ms = 0.0; drivenAt(ms / 1000.0) < route->length(); ms += kFrameMs) {
+        const qint64 now = epoch + qint64(ms);
+
+        // Fixes due before this frame
+        while (nextFixMs <= ms) {
+            const double drivenAtFix = drivenAt(nextFixMs / 1000.0);
+            const QGeoCoordinate truth = route->coordinateAt(drivenAtFix);
+            MapMatcher::Fix fix;
+            fix.latitude = truth.latitude() + noise(rng) * kNoiseMeters / kMetersPerDegree;
+            fix.longitude = truth.longitude()
+                            + noise(rng) * kNoiseMeters / (kMetersPerDegree * std::cos(truth.latitude() * kPi / 180.0));
+            fix.heading = std::fmod(route->bearingAt(drivenAtFix) + noise(rng) * kHeadingNoise + 360.0, 360.0);
+            fix.speed = speedAt(nextFixMs / 1000.0);
+            fix.timestampMs = epoch + nextFixMs;
+            const MapMatcher::Match match = matcher.push(fix);
+            const bool published = match.onRoute ? motion.follow(*route, match, fix.timestampMs)
+                                                 : motion.follow(fix, fix.timestampMs);
+            if (published) ++publishes;
+            if (match.onRoute) {
+                snapped = {fix.timestampMs, match.latitude, match.longitude, match.bearing};
+                haveSnapped = true;
+            }
+            ++fixes;
+            nextFixMs += kFixIntervalMs;
+        }
+        if (motion.keyframes().empty() || !haveSnapped) continue;
+
+        // A frame: the drawn vehicle against the truth, and its step against the car's
+        const QGeoCoordinate truth = route->coordinateAt(drivenAt(double(now - epoch) / 1000.0));
+        const double trueLat = truth.latitude(), trueLon = truth.longitude();
+        const VehicleMotion::Pose drawn = motion.poseAt(now);
+        errors.push_back(meters(trueLat, trueLon, drawn.latitude, drawn.longitude));
+        snapErrors.push_back(meters(trueLat, trueLon, snapped.latitude, snapped.longitude));
+        if (havePrevious) {
+            const double carStep = meters(previousTrueLat, previousTrueLon, trueLat, trueLon);
+            steps.push_back(std::abs(meters(previousLat, previousLon, drawn.latitude, drawn.longitude) - carStep));
+            snapSteps.push_back(std::abs(meters(previousSnapLat, previousSnapLon, snapped.latitude, snapped.longitude) - carStep));
+        }
+        previousLat = drawn.latitude;
+        previousLon = drawn.longitude;
+        previousSnapLat = snapped.latitude;
+        previousSnapLon = snapped.longitude;
+        previousTrueLat = trueLat;
+        previousTrueLon = trueLon;
+        havePrevious = true;
+    }
+
+    const double seconds = fixes * kFixIntervalMs / 1000.0;
+    qInfo() << "[BENCH] Vehicle motion," << route->length() / 1000.0 << "km route," << fixes << "fixes," << steps.size()
+            << "frames";
+    qInfo().noquote() << QString("  keyframes: %1 motions per second (%2 fixes), drawn p50 %3 m, p95 %4 m from the car; "
+                                 "step off the car's by p99 %5 m, max %6 m")
+                             .arg(publishes / seconds, 0, 'f', 2)
+                             .arg(fixes / seconds, 0, 'f', 0)
+                             .arg(percentile(errors, 50), 0, 'f', 1)
+                             .arg(percentile(errors, 95), 0, 'f', 1)
+                             .arg(percentile(steps, 99), 0, 'f', 2)
+                             .arg(*std::max_element(steps.begin(), steps.end()), 0, 'f', 2);
+    qInfo().noquote() << QString("  each fix drawn: p50 %1 m, p95 %2 m from the car; step off by p99 %3 m, max %4 m")
+                             .arg(percentile(snapErrors, 50), 0, 'f', 1)
+                             .arg(percentile(snapErrors, 95), 0, 'f', 1)
+                             .arg(percentile(snapSteps, 99), 0, 'f', 2)
+                             .arg(*std::max_element(snapSteps.begin(), snapSteps.end()), 0, 'f', 2);
+    if (publishes / seconds > kPublishBudget || percentile(errors, 95) > kErrorBudgetMeters
+        || percentile(steps, 99) > kStepBudgetMeters) {
+        qWarning() << "[BENCH] Vehicle motion: FAILED";
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,189 @@
+#include <QCoreApplication>
+#include <QDebug>
+#include <QElapsedTimer>
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <vector>
+#include "Navigation/VoiceGuidance.h"
+#include "BenchRoutes.h"
+
+// Voice guidance: a 300 km drive through 50, 80 and 110 zones, with a
+// maneuver every 60 m to 8 km, driven at 70 to 115% of the limit. Matched
+// positions come at 10 Hz a few metres off, and a prompt handed over is
+// heard the audio path's and the speech's latency later. Where each prompt
+// is heard is compared with the distance it announces, and the last one of
+// each maneuver with how long is left to it, with the lead and without.
+// Every maneuver must be announced in order and before it is reached. Also
+// times an update on a 10 km and a 1000 km route, which must cost the same.
+//
+//   bench_voice_guidance
+
+namespace {
+
+constexpr double kPointSpacingMeters = 25.0;
+constexpr double kRouteKm = 300.0;
+constexpr double kZoneMeters = 4000.0;
+constexpr double kMinGapMeters = 60.0;   // between maneuvers
+constexpr double kMaxGapMeters = 8000.0;
+constexpr double kMinShare = 0.7;        // of the limit, per zone
+constexpr double kMaxShare = 1.15;
+constexpr int kFixIntervalMs = 100;
+constexpr double kNoiseMeters = 3.0;
+constexpr double kSpeedNoise = 0.5;      // m/s
+constexpr double kLatencySeconds = 0.64; // mixer and speech
+constexpr int kUpdates = 1000000;
+constexpr double kUpdateBudgetNs = 200.0;
+constexpr double kDistanceBudgetMeters = 10.0; // p95 off the announced distance
+constexpr double kNowBudgetSeconds = 1.0;      // p95 off NowSeconds
+
+// Departure at the start, then gaps even on a log scale, arrival at the end
+QList<double> generateManeuvers(const RouteIndex &route) {
+    std::mt19937 rng(51);
+    std::uniform_real_distribution<double> logGap(std::log(kMinGapMeters), std::log(kMaxGapMeters));
+    QList<double> maneuvers;
+    maneuvers.append(0.0);
+    for (double at = std::exp(logGap(rng)); at < route.length(); at += std::exp(logGap(rng))) maneuvers.append(at);
+    maneuvers.append(route.length());
+    return maneuvers;
+}
+
+double percentile(std::vector<double> values, int p) {
+    std::sort(values.begin(), values.end());
+    return values[std::min(values.size() - 1, values.size() * size_t(p) / 100)];
+}
+
+struct Drive {
+    std::vector<double> distanceErrors; // metres heard off the announced distance
+    std::vector<double> nowErrors;      // seconds heard off NowSeconds
+    int prompts = 0;
+    int unannounced = 0; // maneuvers without a last prompt
+    int late = 0;        // heard at or past their maneuver, or out of order
+};
+
+Drive drive(const RouteIndex &route, const QList<double> &maneuvers, const QList<quint8> &limits, double lead) {
+    VoiceGuidance voice(route, maneuvers, limits);
+    voice.setLeadSeconds(lead);
+    std::mt19937 rng(52);
+    std::normal_distribution<double> noise(0.0, 1.0);
+    std::uniform_real_distribution<double> share(kMinShare, kMaxShare);
+
+    // The true drive first, a fix interval at a time
+    std::vector<double> offsets, speeds;
+    std::vector<double> shares;
+    for (double driven = 0.0; driven < route.length();) {
+        const int zone = int(driven / kZoneMeters);
+        while (int(shares.size()) <= zone) shares.push_back(share(rng));
+        const double speed = limits[route.segmentAt(driven)] / 3.6 * shares[size_t(zone)];
+        offsets.push_back(driven);
+        speeds.push_back(speed);
+        driven += speed * kFixIntervalMs / 1000.0;
+    }
+    offsets.push_back(route.length());
+    speeds.push_back(0.0);
+    auto offsetAt = [&](double seconds) {
+        const double tick = seconds * 1000.0 / kFixIntervalMs;
+        const size_t i = std::min(size_t(tick), offsets.size() - 1);
+        return std::min(offsets[i] + speeds[i] * (tick - double(i)) * kFixIntervalMs / 1000.0, route.length());
+    };
+    auto secondsTo = [&](double offset) {
+        const size_t i = size_t(std::lower_bound(offsets.begin(), offsets.end(), offset) - offsets.begin());
+        if (i == 0) return 0.0;
+        return (double(i - 1) + (offset - offsets[i - 1]) / std::max(offsets[i] - offsets[i - 1], 1e-9)) * kFixIntervalMs / 1000.0;
+    };
+
+    Drive result;
+    std::vector<bool> announced(size_t(maneuvers.size()), false);
+    int lastStep = -1;
+    for (size_t i = 0; i < offsets.size(); ++i) {
+        const double seen = std::clamp(offsets[i] + noise(rng) * kNoiseMeters, 0.0, route.length());
+        const VoiceGuidance::Prompt *prompt = voice.update(seen, speeds[i] + noise(rng) * kSpeedNoise, qint64(i) * kFixIntervalMs);
+        if (!prompt) continue;
+        ++result.prompts;
+        const double heardAt = i * kFixIntervalMs / 1000.0 + kLatencySeconds;
+        const double maneuver = maneuvers[prompt->step];
+        const double left = maneuver - offsetAt(heardAt);
+        if (left <= 0.0 || prompt->step < lastStep) ++result.late;
+        lastStep = prompt->step;
+        if (prompt->kind == VoiceGuidance::Now) {
+            announced[size_t(prompt->step)] = true;
+            // Slow, the prompt comes at NowMinMeters instead
+            if (speeds[i] * VoiceGuidance::NowSeconds > VoiceGuidance::NowMinMeters)
+                result.nowErrors.push_back(secondsTo(maneuver) - heardAt - VoiceGuidance::NowSeconds);
+        } else {
+            result.distanceErrors.push_back(left - prompt->meters);
+        }
+    }
+    // The departure is announced when navigation starts
+    for (int step = 1; step < maneuvers.size(); ++step) {
+        if (!announced[size_t(step)]) ++result.unannounced;
+    }
+    return result;
+}
+
+// Nanoseconds per update, driving the route in kUpdates steps
+double updateCost(double km) {
+    const RouteIndex route(BenchRoutes::generateRoute(km, kPointSpacingMeters, 50, 62.39, 17.31, 4.2, 0.1));
+    VoiceGuidance voice(route, generateManeuvers(route), BenchRoutes::zoneLimits(route, kZoneMeters));
+    const double step = route.length() / kUpdates;
+    int prompts = 0;
+    QElapsedTimer timer;
+    timer.start();
+    for (int i = 0; i < kUpdates; ++i) {
+        if (voice.update(i * step, 30.0, qint64(i) * kFixIntervalMs)) ++prompts;
+    }
+    const double ns = double(timer.nsecsElapsed()) / kUpdates;
+    if (prompts < 0) qInfo() << prompts;
+    return ns;
+}
+
+QString summary(const std::vector<double> &errors, const QString &unit) {
+    std::vector<double> magnitudes;
+    for (double error : errors) magnitudes.push_back(std::abs(error));
+    return QString("off by p50 %1, p95 %2; early by p50 %3")
+               .arg(percentile(magnitudes, 50), 0, 'f', 1)
+               .arg(percentile(magnitudes, 95), 0, 'f', 1)
+               .arg(percentile(errors, 50), 0, 'f', 1)
+           + " " + unit;
+}
+
+} // namespace
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    const RouteIndex route(BenchRoutes::generateRoute(kRouteKm, kPointSpacingMeters, 50, 62.39, 17.31, 4.2, 0.1));
+    const QList<quint8> limits = BenchRoutes::zoneLimits(route, kZoneMeters);
+    const QList<double> maneuvers = generateManeuvers(route);
+    bool ok = true;
+
+    qInfo() << "[BENCH] Voice guidance," << kRouteKm << "km route," << maneuvers.size() << "maneuvers,"
+            << kLatencySeconds << "s to be heard";
+    for (const bool led : {true, false}) {
+        const Drive result = drive(route, maneuvers, limits, led ? kLatencySeconds : 0.0);
+        qInfo().noquote() << QString("  %1: %2 prompts, %3 maneuvers unannounced, %4 late")
+                                 .arg(led ? "with the lead" : "without")
+                                 .arg(result.prompts)
+                                 .arg(result.unannounced)
+                                 .arg(result.late);
+        qInfo().noquote() << "    distances:" << summary(result.distanceErrors, "m");
+        qInfo().noquote() << "    as it comes up:" << summary(result.nowErrors, "s");
+        if (!led) continue;
+        std::vector<double> distances, nows;
+        for (double error : result.distanceErrors) distances.push_back(std::abs(error));
+        for (double error : result.nowErrors) nows.push_back(std::abs(error));
+        if (result.unannounced > 0 || result.late > 0 || percentile(distances, 95) > kDistanceBudgetMeters
+            || percentile(nows, 95) > kNowBudgetSeconds)
+            ok = false;
+    }
+
+    const double shortNs = updateCost(10.0), longNs = updateCost(1000.0);
+    qInfo().noquote() << QString("  update: %1 ns on 10 km, %2 ns on 1000 km")
+                             .arg(shortNs, 0, 'f', 0)
+                             .arg(longNs, 0, 'f', 0);
+    if (!ok || longNs > kUpdateBudgetNs || longNs > 2.0 * shortNs + 50.0) {
+        qWarning() << "[BENCH] Voice guidance: FAILED";
+        return 1;
+    }
+    return 0;
+}